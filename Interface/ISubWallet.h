@@ -158,6 +158,23 @@ namespace Elastos {
 					const nlohmann::json &createdTx,
 					const std::string &payPassword) = 0;
 
+			/**
+			 * Sign several transactions with one decryption of the root private key. Either all of them are signed, or none.
+			 * @param createdTxs json array of transactions, each in the format returned by the create transaction methods.
+			 * @param payPassword use to decrypt the root private key temporarily. Pay password should between 8 and 128, otherwise will throw invalid argument exception.
+			 * @return If success return json array of the signed transactions, in the same order.
+			 * The default implementation calls SignTransaction for each of them, so a sub wallet written before this
+			 * method was added keeps building, it only decrypts the key once per transaction.
+			 */
+			virtual nlohmann::json SignTransactions(
+					const nlohmann::json &createdTxs,
+					const std::string &payPassword) {
+				nlohmann::json signedTxs = nlohmann::json::array();
+				for (nlohmann::json::const_iterator it = createdTxs.begin(); it != createdTxs.end(); ++it)
+					signedTxs.push_back(SignTransaction(*it, payPassword));
+				return signedTxs;
+			}
+
 			/**
 			 * Get signers already signed specified transaction.
 			 * @param tx a signed transaction to find signed signers.
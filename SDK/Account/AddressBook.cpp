@@ -0,0 +1,94 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "AddressBook.h"
+
+#include <cstring>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		AddressBook::AddressBook() {
+		}
+
+		bool AddressBook::Insert(const uint168 &programHash) {
+			if (programHash.size() != HashSize)
+				return false;
+
+			size_t slot;
+			if (Find(programHash.begin(), slot))
+				return false;
+
+			if ((_entries.size() + 1) * 10 > _slots.size() * 7) {
+				Rehash(_slots.empty() ? 64 : _slots.size() * 2);
+				Find(programHash.begin(), slot);
+			}
+
+			Entry entry;
+			memcpy(entry.hash, programHash.begin(), HashSize);
+			_entries.push_back(entry);
+			_slots[slot] = (uint32_t)_entries.size();
+
+			return true;
+		}
+
+		bool AddressBook::Insert(const Address &address) {
+			if (!address.Valid())
+				return false;
+
+			return Insert(address.ProgramHash());
+		}
+
+		bool AddressBook::Contains(const uint168 &programHash) const {
+			size_t slot;
+			return programHash.size() == HashSize && Find(programHash.begin(), slot);
+		}
+
+		bool AddressBook::Contains(const Address &address) const {
+			return Contains(address.ProgramHash());
+		}
+
+		size_t AddressBook::Size() const {
+			return _entries.size();
+		}
+
+		void AddressBook::Clear() {
+			_entries.clear();
+			_slots.clear();
+		}
+
+		bool AddressBook::Find(const uint8_t *hash, size_t &slot) const {
+			slot = 0;
+			if (_slots.empty())
+				return false;
+
+			size_t mask = _slots.size() - 1;
+			for (slot = Hash(hash) & mask; _slots[slot] != 0; slot = (slot + 1) & mask) {
+				if (memcmp(_entries[_slots[slot] - 1].hash, hash, HashSize) == 0)
+					return true;
+			}
+
+			return false;
+		}
+
+		void AddressBook::Rehash(size_t capacity) {
+			_slots.assign(capacity, 0);
+			size_t mask = capacity - 1;
+			for (size_t i = 0; i < _entries.size(); ++i) {
+				size_t slot = Hash(_entries[i].hash) & mask;
+				while (_slots[slot] != 0)
+					slot = (slot + 1) & mask;
+				_slots[slot] = (uint32_t)(i + 1);
+			}
+		}
+
+		size_t AddressBook::Hash(const uint8_t *hash) {
+			// the bytes after the prefix are a ripemd160 digest, as good as random
+			size_t h;
+			memcpy(&h, hash + 1, sizeof(h));
+			return h;
+		}
+
+	}
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_ADDRESSBOOK_H__
+#define __ELASTOS_SDK_ADDRESSBOOK_H__
+
+#include <SDK/WalletCore/BIPs/Address.h>
+#include <SDK/Common/uint256.h>
+
+#include <vector>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Set of addresses keyed by the raw 21 bytes of their program hash.
+		 *
+		 * The program hashes are copied into a flat array, found through an open addressing table with linear
+		 * probing. A lookup from a TransactionOutput program hash neither allocates nor builds an Address or its
+		 * string. There is no removal, only Clear.
+		 */
+		class AddressBook {
+		public:
+			AddressBook();
+
+			// return false if it is already there, or isn't 21 bytes
+			bool Insert(const uint168 &programHash);
+
+			// invalid addresses are left out
+			bool Insert(const Address &address);
+
+			bool Contains(const uint168 &programHash) const;
+
+			bool Contains(const Address &address) const;
+
+			size_t Size() const;
+
+			void Clear();
+
+		private:
+			enum {
+				HashSize = 21
+			};
+
+			struct Entry {
+				uint8_t hash[HashSize];
+			};
+
+			// slot of programHash if found, otherwise the empty slot where it should be inserted
+			bool Find(const uint8_t *hash, size_t &slot) const;
+
+			void Rehash(size_t capacity);
+
+			static size_t Hash(const uint8_t *hash);
+
+		private:
+			std::vector<Entry> _entries;
+			std::vector<uint32_t> _slots; // index + 1 into _entries, 0 means empty
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_ADDRESSBOOK_H__
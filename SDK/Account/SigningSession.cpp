@@ -0,0 +1,46 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "SigningSession.h"
+
+#include <SDK/Common/ErrorChecker.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		SigningSession::SigningSession(const Account &account, const std::string &payPasswd) :
+			_rootKey(new HDKeychain(account.RootKey(payPasswd))) {
+		}
+
+		SigningSession::~SigningSession() {
+			Close();
+		}
+
+		const HDKeychain &SigningSession::Derive(const std::string &path) {
+			ErrorChecker::CheckLogic(_rootKey == nullptr, Error::Key, "Signing session closed");
+
+			std::map<std::string, HDKeychain>::iterator it = _nodes.find(path);
+			if (it != _nodes.end())
+				return it->second;
+
+			// the parent is derived, and kept, first
+			size_t slash = path.rfind('/');
+			const HDKeychain &parent = slash == std::string::npos ? *_rootKey : Derive(path.substr(0, slash));
+			HDKeychain child = parent.getChild(path.substr(slash == std::string::npos ? 0 : slash + 1));
+
+			return _nodes.insert(std::make_pair(path, child)).first->second;
+		}
+
+		bool SigningSession::IsOpen() const {
+			return _rootKey != nullptr;
+		}
+
+		void SigningSession::Close() {
+			// HDKeychain wipes its key and chain code when destroyed
+			_nodes.clear();
+			_rootKey.reset();
+		}
+
+	}
+}
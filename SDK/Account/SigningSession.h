@@ -0,0 +1,44 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_SIGNINGSESSION_H__
+#define __ELASTOS_SDK_SIGNINGSESSION_H__
+
+#include "Account.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <map>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Decrypts the root key once for a run of signatures. Every node derived on the way to a signing key is
+		 * kept, so the keys of one chain share their account and chain nodes. Keys are wiped when the session
+		 * is closed, at the latest when it goes out of scope, so keep it on the stack of the call that signs.
+		 */
+		class SigningSession : public boost::noncopyable {
+		public:
+			SigningSession(const Account &account, const std::string &payPasswd);
+
+			~SigningSession();
+
+			// node at a path from the root, like "44'/0'/0'/0/5", valid until the session is closed
+			const HDKeychain &Derive(const std::string &path);
+
+			bool IsOpen() const;
+
+			void Close();
+
+		private:
+			boost::shared_ptr<HDKeychain> _rootKey;
+			std::map<std::string, HDKeychain> _nodes;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_SIGNINGSESSION_H__
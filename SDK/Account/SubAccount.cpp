@@ -13,9 +13,102 @@
 #include <SDK/Plugin/Transaction/Program.h>
 #include <SDK/Plugin/Transaction/Attribute.h>
 
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include <exception>
+
+#define SIGN_JOBS_PER_THREAD 8
+#define ADDRESS_JOBS_PER_THREAD 16
+
 namespace Elastos {
 	namespace ElaWallet {
 
+		namespace {
+
+			struct SignJob {
+				HDKeychain keychain;
+				uint256 md;
+				bytes_t parameter; // signatures there before, ours is appended
+				std::exception_ptr error;
+			};
+
+			// signs every step-th job from first, each with a key of its own
+			void SignJobs(std::vector<SignJob> *jobs, size_t first, size_t step) {
+				for (size_t i = first; i < jobs->size(); i += step) {
+					SignJob &job = (*jobs)[i];
+
+					try {
+						Key key(job.keychain);
+						ByteStream stream;
+						bytes_t signature;
+
+						if (job.parameter.size() > 0) {
+							ByteStream verifyStream(job.parameter);
+							while (verifyStream.ReadVarBytes(signature)) {
+								ErrorChecker::CheckLogic(key.Verify(job.md, signature), Error::AlreadySigned,
+														 "Already signed");
+							}
+							stream.WriteBytes(job.parameter);
+						}
+
+						stream.WriteVarBytes(key.Sign(job.md));
+						job.parameter = stream.GetBytes();
+					} catch (...) {
+						job.error = std::current_exception();
+					}
+				}
+			}
+
+			void AppendAddress(std::vector<Address> *addrs, const Address &address) {
+				addrs->push_back(address);
+			}
+
+			struct AddressJob {
+				uint32_t index;
+				Address address;
+				std::exception_ptr error;
+			};
+
+			void DeriveAddressJobs(const HDKeychain *chain, std::vector<AddressJob> *jobs, size_t first, size_t step) {
+				for (size_t i = first; i < jobs->size(); i += step) {
+					AddressJob &job = (*jobs)[i];
+
+					try {
+						job.address = Address(PrefixStandard, chain->getChild(job.index).pubkey());
+					} catch (...) {
+						job.error = std::current_exception();
+					}
+				}
+			}
+
+			// standard addresses of children first to first + count - 1 of a chain node, on worker threads when
+			// there are enough of them
+			void DeriveAddresses(std::vector<Address> &addrs, const HDKeychain &chain, uint32_t first, size_t count) {
+				std::vector<AddressJob> jobs(count);
+				for (size_t i = 0; i < count; ++i)
+					jobs[i].index = first + (uint32_t) i;
+
+				size_t threads = std::min<size_t>(boost::thread::hardware_concurrency(), count / ADDRESS_JOBS_PER_THREAD);
+				if (threads > 1) {
+					boost::thread_group workers;
+					for (size_t i = 0; i < threads; ++i)
+						workers.create_thread(boost::bind(&DeriveAddressJobs, &chain, &jobs, i, threads));
+					workers.join_all();
+				} else {
+					DeriveAddressJobs(&chain, &jobs, 0, 1);
+				}
+
+				addrs.clear();
+				addrs.reserve(count);
+				for (size_t i = 0; i < count; ++i) {
+					if (jobs[i].error)
+						std::rethrow_exception(jobs[i].error);
+					addrs.push_back(jobs[i].address);
+				}
+			}
+
+		}
 
 		SubAccount::SubAccount(const AccountPtr &parent, uint32_t coinIndex) :
 			_parent(parent),
@@ -25,11 +118,18 @@ namespace Elastos {
 			if (!ownerPubKey->empty()) {
 				_depositAddress = Address(PrefixDeposit, *ownerPubKey);
 				_ownerAddress = Address(PrefixStandard, *ownerPubKey);
+				_allAddrs.Insert(_depositAddress);
+				_allAddrs.Insert(_ownerAddress);
 			}
 
 			if (_parent->GetSignType() != Account::MultiSign) {
 				HDKeychain mpk = _parent->MasterPubKey();
-				_crDepositAddress = Address(PrefixDeposit, mpk.getChild(0).getChild(0).pubkey());
+				_externalKeychain = mpk.getChild(SEQUENCE_EXTERNAL_CHAIN);
+				_internalKeychain = mpk.getChild(SEQUENCE_INTERNAL_CHAIN);
+				_crDepositAddress = Address(PrefixDeposit, _externalKeychain.getChild(0).pubkey());
+				_allAddrs.Insert(_crDepositAddress);
+			} else {
+				_allAddrs.Insert(_parent->GetAddress());
 			}
 
 		}
@@ -42,14 +142,23 @@ namespace Elastos {
 		}
 
 		void SubAccount::Init(const std::vector<TransactionPtr> &tx, Lockable *lock) {
-			_lock = lock;
+			std::vector<Address> usedAddrs;
 
 			for (size_t i = 0; i < tx.size(); i++) {
 				const OutputArray &outputs = tx[i]->GetOutputs();
 				for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o)
-					AddUsedAddrs((*o)->Addr());
+					usedAddrs.push_back((*o)->Addr());
 			}
 
+			InitUsedAddrs(usedAddrs, lock);
+		}
+
+		void SubAccount::InitUsedAddrs(const std::vector<Address> &usedAddrs, Lockable *lock) {
+			_lock = lock;
+
+			for (size_t i = 0; i < usedAddrs.size(); i++)
+				AddUsedAddrs(usedAddrs[i]);
+
 			UnusedAddresses(SEQUENCE_GAP_LIMIT_EXTERNAL + 100, 0);
 			UnusedAddresses(SEQUENCE_GAP_LIMIT_INTERNAL + 100, 1);
 		}
@@ -83,30 +192,31 @@ namespace Elastos {
 		}
 
 		void SubAccount::AddUsedAddrs(const Address &address) {
-			_usedAddrs.insert(address);
+			_usedAddrs.Insert(address.ProgramHash());
 		}
 
 		size_t SubAccount::GetAllAddresses(std::vector<Address> &addr, uint32_t start, size_t count, bool containInternal) const {
 			addr.clear();
+			return GetAllAddresses(boost::bind(&AppendAddress, &addr, _1), start, count, containInternal);
+		}
+
+		size_t SubAccount::GetAllAddresses(const AddressVisitor &visitor, uint32_t start, size_t count,
+										   bool containInternal) const {
 			if (_parent->GetSignType() == Account::MultiSign) {
-				addr.push_back(_parent->GetAddress());
+				visitor(_parent->GetAddress());
 				return 1;
 			}
 
 			size_t maxCount = _externalChain.size() + (containInternal ? _internalChain.size() : 0);
+			size_t visited = 0;
 
-			if ((!containInternal && start >= _externalChain.size()) ||
-				(containInternal && start >= _externalChain.size() + _internalChain.size())) {
-				return maxCount;
-			}
-
-			for (size_t i = start; i < _externalChain.size() && addr.size() < count; i++) {
-				addr.push_back(_externalChain[i]);
+			for (size_t i = start; i < _externalChain.size() && visited < count; i++, visited++) {
+				visitor(_externalChain[i]);
 			}
 
 			if (containInternal) {
-				for (size_t i = start + addr.size(); addr.size() < count && i < _externalChain.size() + _internalChain.size(); i++) {
-					addr.push_back(_internalChain[i - _externalChain.size()]);
+				for (size_t i = start + visited; visited < count && i < _externalChain.size() + _internalChain.size(); i++, visited++) {
+					visitor(_internalChain[i - _externalChain.size()]);
 				}
 			}
 
@@ -124,35 +234,47 @@ namespace Elastos {
 				if (_externalChain.empty()) {
 					bytes_t pubkey = _parent->MasterPubKey().getChild("0/0").pubkey();
 					_externalChain.push_back(Address(PrefixStandard, pubkey));
-					_allAddrs.insert(_externalChain[0]);
+					_allAddrs.Insert(_externalChain[0]);
 				}
 				addrs = _externalChain;
 				return addrs;
 			}
 
 			size_t i, j = 0, count, startCount;
-			uint32_t chain = (internal) ? SEQUENCE_INTERNAL_CHAIN : SEQUENCE_EXTERNAL_CHAIN;
+			bool invalid = false;
 
 			assert(gapLimit > 0);
 
+			if (!_externalKeychain.valid()) {
+				// multi sign accounts with a master public key of their own
+				HDKeychain mpk = _parent->MasterPubKey();
+				_externalKeychain = mpk.getChild(SEQUENCE_EXTERNAL_CHAIN);
+				_internalKeychain = mpk.getChild(SEQUENCE_INTERNAL_CHAIN);
+			}
+
 			std::vector<Address> &addrChain = internal ? _internalChain : _externalChain;
+			const HDKeychain &chainKey = internal ? _internalKeychain : _externalKeychain;
 			i = count = startCount = addrChain.size();
 
 			// keep only the trailing contiguous block of addresses with no transactions
-			while (i > 0 && _usedAddrs.find(addrChain[i - 1]) == _usedAddrs.end()) i--;
-
-			HDKeychain mpk = _parent->MasterPubKey();
-
-			while (i + gapLimit > count) { // generate new addresses up to gapLimit
-				bytes_t pubKey = mpk.getChild(chain).getChild(count).pubkey();
+			while (i > 0 && !_usedAddrs.Contains(addrChain[i - 1])) i--;
 
-				Address address(PrefixStandard, pubKey);
+			// generate new addresses up to gapLimit, all those missing at once; a used one among them moves the
+			// limit and takes another batch
+			std::vector<Address> derived;
+			while (i + gapLimit > count && !invalid) {
+				DeriveAddresses(derived, chainKey, (uint32_t) count, i + gapLimit - count);
 
-				if (!address.Valid()) break;
+				for (size_t k = 0; k < derived.size(); ++k) {
+					if (!derived[k].Valid()) {
+						invalid = true;
+						break;
+					}
 
-				addrChain.push_back(address);
-				count++;
-				if (_usedAddrs.find(address) != _usedAddrs.end()) i = count;
+					addrChain.push_back(derived[k]);
+					count++;
+					if (_usedAddrs.Contains(derived[k])) i = count;
+				}
 			}
 
 			if (i + gapLimit <= count) {
@@ -161,8 +283,10 @@ namespace Elastos {
 				}
 			}
 
-			for (i = startCount; i < count; i++) {
-				_allAddrs.insert(addrChain[i]);
+			// a multi sign account is known by its own address only
+			if (_parent->GetSignType() != Account::MultiSign) {
+				for (i = startCount; i < count; i++)
+					_allAddrs.Insert(addrChain[i]);
 			}
 
 			return addrs;
@@ -177,47 +301,69 @@ namespace Elastos {
 		}
 
 		void SubAccount::SignTransaction(const TransactionPtr &tx, const std::string &payPasswd) {
-			std::string addr;
-			Key key;
-			bytes_t signature;
-			ByteStream stream;
-
-			ErrorChecker::CheckParam(tx->IsSigned(), Error::AlreadySigned, "Transaction signed");
-			ErrorChecker::CheckParam(tx->GetPrograms().empty(), Error::InvalidTransaction,
-			                         "Invalid transaction program");
-
-			uint256 md = tx->GetShaData();
-
-			const std::vector<ProgramPtr> &programs = tx->GetPrograms();
-			for (size_t i = 0; i < programs.size(); ++i) {
-				std::vector<bytes_t> publicKeys = programs[i]->DecodePublicKey();
-				ErrorChecker::CheckLogic(publicKeys.empty(), Error::InvalidRedeemScript, "Invalid redeem script");
-				ErrorChecker::CheckLogic(programs[i]->GetPath().empty(), Error::UnSupportOldTx, "Unsupport old tx");
-
-				HDKeychain rootKey = _parent->RootKey(payPasswd);
-				key = rootKey.getChild(programs[i]->GetPath());
-				bool found = false;
-				for (size_t k = 0; k < publicKeys.size(); ++k) {
-					if (publicKeys[k] == key.PubKey()) {
-						found = true;
-						break;
-					}
-				}
-				ErrorChecker::CheckLogic(!found, Error::PrivateKeyNotFound, "Private key not found");
+			SignTransactions(std::vector<TransactionPtr>(1, tx), payPasswd);
+		}
+
+		void SubAccount::SignTransactions(const std::vector<TransactionPtr> &txns, const std::string &payPasswd) {
+			SigningSession session(*_parent, payPasswd);
+			SignTransactions(txns, session);
+		}
 
-				stream.Reset();
-				if (programs[i]->GetParameter().size() > 0) {
-					ByteStream verifyStream(programs[i]->GetParameter());
-					while (verifyStream.ReadVarBytes(signature)) {
-						ErrorChecker::CheckLogic(key.Verify(md, signature), Error::AlreadySigned, "Already signed");
+		void SubAccount::SignTransactions(const std::vector<TransactionPtr> &txns, SigningSession &session) {
+			std::vector<SignJob> jobs;
+			std::vector<ProgramPtr> signedPrograms;
+
+			// keys are derived here, through the session's cache, the signatures are left to SignJobs
+			for (size_t t = 0; t < txns.size(); ++t) {
+				const TransactionPtr &tx = txns[t];
+				ErrorChecker::CheckParam(tx->IsSigned(), Error::AlreadySigned, "Transaction signed");
+				ErrorChecker::CheckParam(tx->GetPrograms().empty(), Error::InvalidTransaction,
+										 "Invalid transaction program");
+
+				uint256 md = tx->GetShaData();
+
+				const std::vector<ProgramPtr> &programs = tx->GetPrograms();
+				for (size_t i = 0; i < programs.size(); ++i) {
+					std::vector<bytes_t> publicKeys = programs[i]->DecodePublicKey();
+					ErrorChecker::CheckLogic(publicKeys.empty(), Error::InvalidRedeemScript, "Invalid redeem script");
+					ErrorChecker::CheckLogic(programs[i]->GetPath().empty(), Error::UnSupportOldTx, "Unsupport old tx");
+
+					const HDKeychain &keychain = session.Derive(programs[i]->GetPath());
+					bool found = false;
+					for (size_t k = 0; k < publicKeys.size(); ++k) {
+						if (publicKeys[k] == keychain.pubkey()) {
+							found = true;
+							break;
+						}
 					}
-					stream.WriteBytes(programs[i]->GetParameter());
+					ErrorChecker::CheckLogic(!found, Error::PrivateKeyNotFound, "Private key not found");
+
+					SignJob job;
+					job.keychain = keychain;
+					job.md = md;
+					job.parameter = programs[i]->GetParameter();
+					jobs.push_back(job);
+					signedPrograms.push_back(programs[i]);
 				}
+			}
 
-				signature = key.Sign(md);
-				stream.WriteVarBytes(signature);
-				programs[i]->SetParameter(stream.GetBytes());
+			size_t threads = std::min<size_t>(boost::thread::hardware_concurrency(), jobs.size() / SIGN_JOBS_PER_THREAD);
+			if (threads > 1) {
+				boost::thread_group workers;
+				for (size_t i = 0; i < threads; ++i)
+					workers.create_thread(boost::bind(&SignJobs, &jobs, i, threads));
+				workers.join_all();
+			} else {
+				SignJobs(&jobs, 0, 1);
 			}
+
+			for (size_t i = 0; i < jobs.size(); ++i) {
+				if (jobs[i].error)
+					std::rethrow_exception(jobs[i].error);
+			}
+
+			for (size_t i = 0; i < jobs.size(); ++i)
+				signedPrograms[i]->SetParameter(jobs[i].parameter);
 		}
 
 		Key SubAccount::DeriveOwnerKey(const std::string &payPasswd) {
@@ -278,32 +424,19 @@ namespace Elastos {
 		}
 
 		bool SubAccount::ContainsAddress(const Address &address) const {
-			if (IsDepositAddress(address)) {
-				return true;
-			}
-
-			if (IsOwnerAddress(address)) {
-				return true;
-			}
-
-			if (IsCRDepositAddress(address)) {
-				return true;
-			}
-
-			if (_parent->GetSignType() == Account::MultiSign) {
-				return _parent->GetAddress() == address;
-			}
+			return ContainsAddress(address.ProgramHash());
+		}
 
-			return _allAddrs.find(address) != _allAddrs.end();
+		bool SubAccount::ContainsAddress(const uint168 &programHash) const {
+			return _allAddrs.Contains(programHash);
 		}
 
 		void SubAccount::ClearUsedAddresses() {
-			_usedAddrs.clear();
+			_usedAddrs.Clear();
 		}
 
 		bool SubAccount::GetCodeAndPath(const Address &addr, bytes_t &code, std::string &path) const {
 			uint32_t index;
-			bytes_t pubKey;
 			if (IsDepositAddress(addr)) {
 				code = _depositAddress.RedeemScript();
 				path = "44'/0'/1'/0/0";
@@ -331,34 +464,35 @@ namespace Elastos {
 				return true;
 			}
 
-			HDKeychain mpk = _parent->MasterPubKey();
+			const Address *found = nullptr;
 
 			path = "44'/0'/0'/";
 
+			// the chain addresses already carry their code
 			for (index = _internalChain.size(); index > 0; index--) {
 				if (_internalChain[index - 1] == addr) {
-					pubKey = mpk.getChild(SEQUENCE_INTERNAL_CHAIN).getChild(index - 1).pubkey();
+					found = &_internalChain[index - 1];
 
 					path = path + "1/" + std::to_string(index - 1);
 					break;
 				}
 			}
 
-			for (index = _externalChain.size(); index > 0 && pubKey.empty(); index--) {
+			for (index = _externalChain.size(); index > 0 && found == nullptr; index--) {
 				if (_externalChain[index - 1] == addr) {
-					pubKey = mpk.getChild(SEQUENCE_EXTERNAL_CHAIN).getChild(index - 1).pubkey();
+					found = &_externalChain[index - 1];
 
 					path = path + "0/" + std::to_string(index - 1);
 					break;
 				}
 			}
 
-			if (pubKey.empty()) {
+			if (found == nullptr) {
 				ErrorChecker::ThrowLogicException(Error::Address, "Can't found code and path for address " + addr.String());
 				return false;
 			}
 
-			code = Address(PrefixStandard, pubKey).RedeemScript();
+			code = found->RedeemScript();
 
 			return true;
 		}
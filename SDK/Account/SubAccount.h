@@ -6,10 +6,12 @@
 #define __ELASTOS_SDK_SUBACCOUNT_H__
 
 #include "Account.h"
+#include "AddressBook.h"
+#include "SigningSession.h"
 
 #include <SDK/Common/Lockable.h>
 
-#include <set>
+#include <boost/function.hpp>
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -18,6 +20,9 @@ namespace Elastos {
 		typedef boost::shared_ptr<Transaction> TransactionPtr;
 
 		class SubAccount {
+		public:
+			typedef boost::function<void(const Address &)> AddressVisitor;
+
 		public:
 			SubAccount(const AccountPtr &parent, uint32_t coinIndex);
 
@@ -25,6 +30,8 @@ namespace Elastos {
 
 			void Init(const std::vector<TransactionPtr> &tx, Lockable *lock);
 
+			void InitUsedAddrs(const std::vector<Address> &usedAddrs, Lockable *lock);
+
 			bool IsSingleAddress() const;
 
 			bool IsDepositAddress(const Address &address) const;
@@ -37,10 +44,15 @@ namespace Elastos {
 
 			size_t GetAllAddresses(std::vector<Address> &addr, uint32_t start, size_t count, bool internal) const;
 
+			// the addresses of GetAllAddresses in the same order, handed to visitor instead of copied out
+			size_t GetAllAddresses(const AddressVisitor &visitor, uint32_t start, size_t count, bool internal) const;
+
 			std::vector<Address> UnusedAddresses(uint32_t gapLimit, bool internal);
 
 			bool ContainsAddress(const Address &address) const;
 
+			bool ContainsAddress(const uint168 &programHash) const;
+
 			void ClearUsedAddresses();
 
 			bytes_ptr OwnerPubKey() const;
@@ -49,6 +61,11 @@ namespace Elastos {
 
 			void SignTransaction(const TransactionPtr &tx, const std::string &payPasswd);
 
+			void SignTransactions(const std::vector<TransactionPtr> &txns, const std::string &payPasswd);
+
+			// all programs of all txns are signed, or none if one of them can't be
+			void SignTransactions(const std::vector<TransactionPtr> &txns, SigningSession &session);
+
 			Key DeriveOwnerKey(const std::string &payPasswd);
 
 			Key DeriveDIDKey(const std::string &payPasswd);
@@ -65,7 +82,9 @@ namespace Elastos {
 		private:
 			uint32_t _coinIndex;
 			std::vector<Address> _internalChain, _externalChain;
-			std::set<Address> _usedAddrs, _allAddrs;
+			HDKeychain _internalKeychain, _externalKeychain; // chain nodes of the master public key
+			AddressBook _usedAddrs;
+			AddressBook _allAddrs; // chain and special addresses, what ContainsAddress looks up
 			mutable Address _depositAddress, _ownerAddress, _crDepositAddress;
 
 			AccountPtr _parent;
@@ -6,15 +6,25 @@
 
 namespace Elastos {
 	namespace ElaWallet {
-		ByteStream::ByteStream() : _rpos(0) {
+		ByteStream::ByteStream() : _rpos(0), _view(nullptr), _viewSize(0) {
 
 		}
 
-		ByteStream::ByteStream(const void *buf, size_t size) : _rpos(0), _buf((const unsigned char *) buf, size) {
+		ByteStream::ByteStream(const void *buf, size_t size) :
+			_rpos(0), _buf((const unsigned char *) buf, size), _view(nullptr), _viewSize(0) {
 
 		}
 
-		ByteStream::ByteStream(const bytes_t &buf) : _rpos(0), _buf(buf) {
+		ByteStream::ByteStream(const void *buf, size_t size, bool copy) : _rpos(0), _view(nullptr), _viewSize(0) {
+			if (copy) {
+				_buf.assign((const unsigned char *) buf, (const unsigned char *) buf + size);
+			} else {
+				_view = (const uint8_t *) buf;
+				_viewSize = size;
+			}
+		}
+
+		ByteStream::ByteStream(const bytes_t &buf) : _rpos(0), _buf(buf), _view(nullptr), _viewSize(0) {
 
 		}
 
@@ -25,23 +35,37 @@ namespace Elastos {
 		void ByteStream::Reset() {
 			_rpos = 0;
 			_buf.clear();
+			_view = nullptr;
 		}
 
 		void ByteStream::clear() {
 			_rpos = 0;
 			_buf.clear();
+			_view = nullptr;
 		}
 
 		uint64_t ByteStream::size() const {
-			return _buf.size();
+			return _view ? _viewSize : _buf.size();
+		}
+
+		const uint8_t *ByteStream::Data() const {
+			return _view ? _view : _buf.data();
+		}
+
+		void ByteStream::Own() const {
+			if (_view) {
+				_buf.assign(_view, _view + _viewSize);
+				_view = nullptr;
+			}
 		}
 
 		void ByteStream::Skip(size_t bytes) const {
-			if (_rpos + bytes <= _buf.size())
+			if (_rpos + bytes <= size())
 				_rpos += bytes;
 		}
 
 		const bytes_t &ByteStream::GetBytes() const {
+			Own();
 			return _buf;
 		}
 
@@ -66,57 +90,57 @@ namespace Elastos {
 		}
 
 		bool ByteStream::ReadBytes(void *buf, size_t len) const {
-			if (_rpos + len > _buf.size())
+			if (_rpos + len > size())
 				return false;
 
-			memcpy(buf, &_buf[_rpos], len);
+			memcpy(buf, Data() + _rpos, len);
 			_rpos += len;
 
 			return true;
 		}
 
 		bool ByteStream::ReadBytes(bytes_t &bytes, size_t len) const {
-			if (_rpos + len > _buf.size())
+			if (_rpos + len > size())
 				return false;
 
-			bytes.assign(_buf.begin() + _rpos, _buf.begin() + _rpos + len);
+			bytes.assign(Data() + _rpos, Data() + _rpos + len);
 
 			_rpos += len;
 			return true;
 		}
 
 		bool ByteStream::ReadBytes(uint128 &u) const {
-			if (_rpos + u.size() > _buf.size())
+			if (_rpos + u.size() > size())
 				return false;
 
-			memcpy(u.begin(), &_buf[_rpos], u.size());
+			memcpy(u.begin(), Data() + _rpos, u.size());
 			_rpos += u.size();
 			return true;
 		}
 
 		bool ByteStream::ReadBytes(uint160 &u) const {
-			if (_rpos + u.size() > _buf.size())
+			if (_rpos + u.size() > size())
 				return false;
 
-			memcpy(u.begin(), &_buf[_rpos], u.size());
+			memcpy(u.begin(), Data() + _rpos, u.size());
 			_rpos += u.size();
 			return true;
 		}
 
 		bool ByteStream::ReadBytes(uint168 &u) const {
-			if (_rpos + u.size() > _buf.size())
+			if (_rpos + u.size() > size())
 				return false;
 
-			memcpy(u.begin(), &_buf[_rpos], u.size());
+			memcpy(u.begin(), Data() + _rpos, u.size());
 			_rpos += u.size();
 			return true;
 		}
 
 		bool ByteStream::ReadBytes(uint256 &u) const {
-			if (_rpos + u.size() > _buf.size())
+			if (_rpos + u.size() > size())
 				return false;
 
-			memcpy(u.begin(), &_buf[_rpos], u.size());
+			memcpy(u.begin(), Data() + _rpos, u.size());
 			_rpos += u.size();
 			return true;
 		}
@@ -131,30 +155,30 @@ namespace Elastos {
 		}
 
 		bool ByteStream::ReadVarUint(uint64_t &len) const {
-			if (_rpos + 1 > _buf.size())
+			if (_rpos + 1 > size())
 				return false;
 
-			uint8_t h = _buf[_rpos++];
+			uint8_t h = Data()[_rpos++];
 
 			switch (h) {
 				case VAR_INT16_HEADER:
-					if (_rpos + 2 > _buf.size())
+					if (_rpos + 2 > size())
 						return false;
-					len = *(uint16_t *) &_buf[_rpos];
+					len = *(uint16_t *) (Data() + _rpos);
 					_rpos += 2;
 					break;
 
 				case VAR_INT32_HEADER:
-					if (_rpos + 4 > _buf.size())
+					if (_rpos + 4 > size())
 						return false;
-					len = *(uint32_t *) &_buf[_rpos];
+					len = *(uint32_t *) (Data() + _rpos);
 					_rpos += 4;
 					break;
 
 				case VAR_INT64_HEADER:
-					if (_rpos + 8 > _buf.size())
+					if (_rpos + 8 > size())
 						return false;
-					len = *(uint64_t *) &_buf[_rpos];
+					len = *(uint64_t *) (Data() + _rpos);
 					_rpos += 8;
 					break;
 
@@ -177,10 +201,12 @@ namespace Elastos {
 		}
 
 		void ByteStream::WriteByte(uint8_t val) {
+			Own();
 			_buf.push_back(val);
 		}
 
 		void ByteStream::WriteUint8(uint8_t val) {
+			Own();
 			_buf.push_back(val);
 		}
 
@@ -197,26 +223,32 @@ namespace Elastos {
 		}
 
 		void ByteStream::WriteBytes(const void *buf, size_t len) {
+			Own();
 			_buf += bytes_t(buf, len);
 		}
 
 		void ByteStream::WriteBytes(const bytes_t &bytes) {
+			Own();
 			_buf += bytes;
 		}
 
 		void ByteStream::WriteBytes(const uint128 &u) {
+			Own();
 			_buf += u.bytes();
 		}
 
 		void ByteStream::WriteBytes(const uint160 &u) {
+			Own();
 			_buf += u.bytes();
 		}
 
 		void ByteStream::WriteBytes(const uint168 &u) {
+			Own();
 			_buf += u.bytes();
 		}
 
 		void ByteStream::WriteBytes(const uint256 &u) {
+			Own();
 			_buf += u.bytes();
 		}
 
@@ -231,6 +263,7 @@ namespace Elastos {
 		}
 
 		size_t ByteStream::WriteVarUint(uint64_t len) {
+			Own();
 			size_t count;
 			if (len < VAR_INT16_HEADER) {
 				_buf.push_back((uint8_t) len);
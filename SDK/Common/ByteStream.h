@@ -27,6 +27,9 @@ namespace Elastos {
 
 			ByteStream(const void *buf, size_t size);
 
+			// with copy false the stream only reads buf in place, buf has to outlive it or its first write
+			ByteStream(const void *buf, size_t size, bool copy);
+
 			explicit ByteStream(const bytes_t &buf);
 
 			~ByteStream();
@@ -99,9 +102,17 @@ namespace Elastos {
 
 			void WriteVarString(const std::string &str);
 
+		private:
+			const uint8_t *Data() const;
+
+			// copies a viewed buffer into the stream, before writing to it or handing it out
+			void Own() const;
+
 		private:
 			mutable size_t _rpos;
-			bytes_t _buf;
+			mutable bytes_t _buf;
+			mutable const uint8_t *_view;
+			size_t _viewSize;
 		};
 
 	}
@@ -5,69 +5,207 @@
 #ifndef __ELASTOS_SDK_TRANSACTIONSET_H__
 #define __ELASTOS_SDK_TRANSACTIONSET_H__
 
-#include <set>
 #include <SDK/Common/uint256.h>
 
+#include <vector>
+#include <iterator>
+
 namespace Elastos {
 	namespace ElaWallet {
 
+		/*
+		 * Set of shared pointers (transactions, blocks...) keyed by element->GetHash().
+		 *
+		 * Lookup table is open addressing with linear probing, erase uses backward shift so there is no tombstone
+		 * in the table. Elements are kept in a separate array in insertion order, which is what iteration walks.
+		 * Erased elements leave a hole in that array, holes are squeezed out once they outnumber live elements.
+		 */
 		template<class T>
 		class ElementSet {
+		private:
+			struct Entry {
+				uint256 hash;
+				T element;
+			};
+
+			typedef std::vector<Entry> EntryArray;
+
 		public:
+			class const_iterator : public std::iterator<std::forward_iterator_tag, T> {
+			public:
+				const_iterator() : _it(), _end() {}
 
-			T Get(const uint256 &hash) const {
-				typename std::set<T>::const_iterator it;
-				it = std::find_if(_elements.begin(), _elements.end(), [&hash](const T &e) {
-					return hash == e->GetHash();
-				});
+				const_iterator(typename EntryArray::const_iterator it, typename EntryArray::const_iterator end) :
+					_it(it), _end(end) {
+					SkipHoles();
+				}
 
-				if (it == _elements.end())
-					return nullptr;
+				const T &operator*() const { return _it->element; }
 
-				return *it;
-			}
+				const T *operator->() const { return &_it->element; }
+
+				const_iterator &operator++() {
+					++_it;
+					SkipHoles();
+					return *this;
+				}
 
-			bool Contains(const T &tx) const {
-				if (_elements.find(tx) != _elements.end()) {
-					return true;
+				const_iterator operator++(int) {
+					const_iterator tmp = *this;
+					++(*this);
+					return tmp;
 				}
 
-				return Contains(tx->GetHash());
+				bool operator==(const const_iterator &other) const { return _it == other._it; }
+
+				bool operator!=(const const_iterator &other) const { return _it != other._it; }
+
+			private:
+				void SkipHoles() {
+					while (_it != _end && _it->element == nullptr)
+						++_it;
+				}
+
+			private:
+				typename EntryArray::const_iterator _it, _end;
+			};
+
+		public:
+			ElementSet() : _size(0) {}
+
+			T Get(const uint256 &hash) const {
+				size_t slot;
+				if (!Find(hash, slot))
+					return nullptr;
+
+				return _entries[_slots[slot] - 1].element;
+			}
+
+			bool Contains(const T &e) const {
+				return Contains(e->GetHash());
 			}
 
 			bool Contains(const uint256 &hash) const {
-				typename std::set<T>::const_iterator it;
-				it = std::find_if(_elements.begin(), _elements.end(), [&hash](const T &e) {
-					return hash == e->GetHash();
-				});
-				return it != _elements.end();
+				size_t slot;
+				return Find(hash, slot);
 			}
 
-			void Insert(const T &tx) {
-				_elements.insert(tx);
+			// return false if an element with the same hash already exist
+			bool Insert(const T &e) {
+				const uint256 &hash = e->GetHash();
+				size_t slot;
+
+				if (Find(hash, slot))
+					return false;
+
+				if ((_size + 1) * 10 > _slots.size() * 7) {
+					Rehash(_slots.empty() ? 16 : _slots.size() * 2);
+					Find(hash, slot);
+				}
+
+				Entry entry;
+				entry.hash = hash;
+				entry.element = e;
+				_entries.push_back(entry);
+				_slots[slot] = (uint32_t)_entries.size();
+				_size++;
+
+				return true;
+			}
+
+			size_t Size() const {
+				return _size;
 			}
 
-			size_t Size() {
-				return _elements.size();
+			void Remove(const T &e) {
+				Remove(e->GetHash());
 			}
 
-			void Remove(const T &tx) {
-				typename std::set<T>::const_iterator it;
-				for(it = _elements.cbegin(); it != _elements.cend();) {
-					if (tx->GetHash() == (*it)->GetHash()) {
-						it = _elements.erase(it);
-					} else {
-						++it;
+			bool Remove(const uint256 &hash) {
+				size_t slot;
+				if (!Find(hash, slot))
+					return false;
+
+				Entry &entry = _entries[_slots[slot] - 1];
+				entry.element = nullptr;
+				entry.hash = 0;
+				_size--;
+
+				// backward shift deletion: move later entries of the probe sequence into the emptied slot
+				size_t mask = _slots.size() - 1, hole = slot, next = (slot + 1) & mask;
+				while (_slots[next] != 0) {
+					size_t home = uint256Hasher()(_entries[_slots[next] - 1].hash) & mask;
+					if (((next - home) & mask) >= ((next - hole) & mask)) {
+						_slots[hole] = _slots[next];
+						hole = next;
 					}
+					next = (next + 1) & mask;
 				}
+				_slots[hole] = 0;
+
+				if (_size == 0) {
+					_entries.clear();
+				} else if (_entries.size() > 32 && _entries.size() > _size * 2) {
+					Rehash(_slots.size());
+				}
+
+				return true;
 			}
 
 			void Clear() {
-				_elements.clear();
+				_entries.clear();
+				_slots.clear();
+				_size = 0;
+			}
+
+			const_iterator begin() const {
+				return const_iterator(_entries.begin(), _entries.end());
+			}
+
+			const_iterator end() const {
+				return const_iterator(_entries.end(), _entries.end());
+			}
+
+		private:
+			// slot of element if found, otherwise the empty slot where it should be inserted
+			bool Find(const uint256 &hash, size_t &slot) const {
+				slot = 0;
+				if (_slots.empty())
+					return false;
+
+				size_t mask = _slots.size() - 1;
+				for (slot = uint256Hasher()(hash) & mask; _slots[slot] != 0; slot = (slot + 1) & mask) {
+					if (_entries[_slots[slot] - 1].hash == hash)
+						return true;
+				}
+
+				return false;
+			}
+
+			// squeeze out the holes of entries and rebuild the table with the given capacity (power of two)
+			void Rehash(size_t capacity) {
+				EntryArray entries;
+				entries.reserve(_size);
+				for (typename EntryArray::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+					if (it->element != nullptr)
+						entries.push_back(*it);
+				}
+				_entries.swap(entries);
+
+				_slots.assign(capacity, 0);
+				size_t mask = capacity - 1;
+				for (size_t i = 0; i < _entries.size(); ++i) {
+					size_t slot = uint256Hasher()(_entries[i].hash) & mask;
+					while (_slots[slot] != 0)
+						slot = (slot + 1) & mask;
+					_slots[slot] = (uint32_t)(i + 1);
+				}
 			}
 
 		private:
-			std::set<T> _elements;
+			EntryArray _entries;
+			std::vector<uint32_t> _slots; // index + 1 into _entries, 0 means empty
+			size_t _size;
 		};
 
 	}
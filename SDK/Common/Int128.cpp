@@ -0,0 +1,275 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "Int128.h"
+#include "BigInt.h"
+#include "ErrorChecker.h"
+
+#include <algorithm>
+
+#define INT128_SIGN_BIT (1ull << 63)
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		// magnitude as 32 bit limbs, most significant first
+		static void ToLimbs(uint64_t hi, uint64_t lo, uint32_t limbs[4]) {
+			limbs[0] = (uint32_t)(hi >> 32);
+			limbs[1] = (uint32_t)hi;
+			limbs[2] = (uint32_t)(lo >> 32);
+			limbs[3] = (uint32_t)lo;
+		}
+
+		static void FromLimbs(const uint32_t limbs[4], uint64_t &hi, uint64_t &lo) {
+			hi = ((uint64_t)limbs[0] << 32) | limbs[1];
+			lo = ((uint64_t)limbs[2] << 32) | limbs[3];
+		}
+
+		Int128::Int128() :
+			_hi(0),
+			_lo(0) {
+		}
+
+		Int128::Int128(uint64_t num) :
+			_hi(0),
+			_lo(num) {
+		}
+
+		Int128::Int128(uint64_t hi, uint64_t lo) :
+			_hi(hi),
+			_lo(lo) {
+		}
+
+		Int128::Int128(const BigInt &bn) :
+			_hi(0),
+			_lo(0) {
+			if (bn < BigInt(0)) {
+				setHexBytes((BigInt(0) - bn).getHexBytes());
+				*this = Negate();
+			} else {
+				setHexBytes(bn.getHexBytes());
+			}
+		}
+
+		Int128 &Int128::operator+=(const Int128 &rhs) {
+			uint64_t lo = _lo + rhs._lo;
+			uint64_t hi = _hi + rhs._hi + (lo < _lo ? 1 : 0);
+
+			if ((_hi & INT128_SIGN_BIT) == (rhs._hi & INT128_SIGN_BIT) && (hi & INT128_SIGN_BIT) != (_hi & INT128_SIGN_BIT))
+				ErrorChecker::ThrowLogicException(Error::BigInt, "Int128 add overflow");
+
+			_hi = hi;
+			_lo = lo;
+			return *this;
+		}
+
+		Int128 &Int128::operator-=(const Int128 &rhs) {
+			uint64_t lo = _lo - rhs._lo;
+			uint64_t hi = _hi - rhs._hi - (_lo < rhs._lo ? 1 : 0);
+
+			if ((_hi & INT128_SIGN_BIT) != (rhs._hi & INT128_SIGN_BIT) && (hi & INT128_SIGN_BIT) != (_hi & INT128_SIGN_BIT))
+				ErrorChecker::ThrowLogicException(Error::BigInt, "Int128 sub overflow");
+
+			_hi = hi;
+			_lo = lo;
+			return *this;
+		}
+
+		const Int128 Int128::operator+(const Int128 &rhs) const {
+			return Int128(*this) += rhs;
+		}
+
+		const Int128 Int128::operator-(const Int128 &rhs) const {
+			return Int128(*this) -= rhs;
+		}
+
+		bool Int128::operator==(const Int128 &rhs) const {
+			return _hi == rhs._hi && _lo == rhs._lo;
+		}
+
+		bool Int128::operator!=(const Int128 &rhs) const {
+			return !(*this == rhs);
+		}
+
+		bool Int128::operator<(const Int128 &rhs) const {
+			if (_hi != rhs._hi)
+				return (int64_t)_hi < (int64_t)rhs._hi;
+
+			return _lo < rhs._lo;
+		}
+
+		bool Int128::operator>(const Int128 &rhs) const {
+			return rhs < *this;
+		}
+
+		bool Int128::operator<=(const Int128 &rhs) const {
+			return !(rhs < *this);
+		}
+
+		bool Int128::operator>=(const Int128 &rhs) const {
+			return !(*this < rhs);
+		}
+
+		bool Int128::isZero() const {
+			return _hi == 0 && _lo == 0;
+		}
+
+		bool Int128::isNegative() const {
+			return (_hi & INT128_SIGN_BIT) != 0;
+		}
+
+		uint64_t Int128::getUint64() const {
+			return isNegative() ? Negate()._lo : _lo;
+		}
+
+		void Int128::setUint64(uint64_t num) {
+			_hi = 0;
+			_lo = num;
+		}
+
+		int Int128::numBytes() const {
+			Int128 m = isNegative() ? Negate() : *this;
+			int n = 0;
+
+			for (uint64_t w = m._hi; w != 0; w >>= 8)
+				n++;
+
+			if (n > 0)
+				return n + 8;
+
+			for (uint64_t w = m._lo; w != 0; w >>= 8)
+				n++;
+
+			return n;
+		}
+
+		BigInt Int128::getBigInt() const {
+			BigInt bn;
+			bn.setHexBytes(getHexBytes());
+
+			if (isNegative())
+				return BigInt(0) - bn;
+
+			return bn;
+		}
+
+		bytes_t Int128::getHexBytes(bool littleEndian) const {
+			Int128 m = isNegative() ? Negate() : *this;
+			bytes_t bytes;
+			int n = m.numBytes();
+
+			if (n == 0) {
+				bytes.push_back(0);
+				return bytes;
+			}
+
+			bytes.resize(n);
+			for (int i = 0; i < n; ++i) {
+				uint64_t w = i < 8 ? m._lo : m._hi;
+				bytes[n - 1 - i] = (uint8_t)(w >> ((i % 8) * 8));
+			}
+
+			if (littleEndian)
+				std::reverse(bytes.begin(), bytes.end());
+
+			return bytes;
+		}
+
+		void Int128::setHexBytes(const bytes_t &bytes, bool littleEndian) {
+			bytes_t be(bytes);
+			if (littleEndian)
+				std::reverse(be.begin(), be.end());
+
+			size_t start = 0;
+			while (start < be.size() && be[start] == 0)
+				start++;
+
+			ErrorChecker::CheckCondition(!HexBytesInRange(be), Error::BigInt, "Int128 out of range: " + be.getHex());
+
+			_hi = _lo = 0;
+			for (size_t i = start; i < be.size(); ++i) {
+				_hi = (_hi << 8) | (_lo >> 56);
+				_lo = (_lo << 8) | be[i];
+			}
+		}
+
+		bool Int128::HexBytesInRange(const bytes_t &bytes, bool littleEndian) {
+			// index of the most significant byte, walking down from it
+			size_t size = bytes.size();
+			size_t top = littleEndian ? size - 1 : 0;
+			while (size > 0 && bytes[top] == 0) {
+				size--;
+				top = littleEndian ? top - 1 : top + 1;
+			}
+
+			return size < 16 || (size == 16 && (bytes[top] & 0x80) == 0);
+		}
+
+		std::string Int128::getDec() const {
+			Int128 m = isNegative() ? Negate() : *this;
+			uint32_t limbs[4];
+			std::string dec;
+
+			ToLimbs(m._hi, m._lo, limbs);
+			do {
+				// divide by 10^9, collecting nine digits a time
+				uint64_t rem = 0;
+				for (int i = 0; i < 4; ++i) {
+					uint64_t cur = (rem << 32) | limbs[i];
+					limbs[i] = (uint32_t)(cur / 1000000000);
+					rem = cur % 1000000000;
+				}
+
+				bool more = limbs[0] || limbs[1] || limbs[2] || limbs[3];
+				for (int i = 0; i < 9 && (more || rem != 0 || dec.empty()); ++i) {
+					dec.push_back((char)('0' + rem % 10));
+					rem /= 10;
+				}
+
+				if (!more)
+					break;
+			} while (true);
+
+			if (isNegative())
+				dec.push_back('-');
+
+			std::reverse(dec.begin(), dec.end());
+			return dec;
+		}
+
+		void Int128::setDec(const std::string &dec) {
+			bool negative = !dec.empty() && dec[0] == '-';
+			size_t start = negative ? 1 : 0;
+			uint32_t limbs[4] = {0, 0, 0, 0};
+
+			ErrorChecker::CheckCondition(dec.size() <= start, Error::BigInt, "Int128 invalid dec: " + dec);
+
+			for (size_t i = start; i < dec.size(); ++i) {
+				ErrorChecker::CheckCondition(dec[i] < '0' || dec[i] > '9', Error::BigInt, "Int128 invalid dec: " + dec);
+
+				uint64_t carry = (uint64_t)(dec[i] - '0');
+				for (int j = 3; j >= 0; --j) {
+					uint64_t cur = (uint64_t)limbs[j] * 10 + carry;
+					limbs[j] = (uint32_t)cur;
+					carry = cur >> 32;
+				}
+
+				ErrorChecker::CheckCondition(carry != 0 || (limbs[0] & 0x80000000), Error::BigInt,
+											 "Int128 out of range: " + dec);
+			}
+
+			FromLimbs(limbs, _hi, _lo);
+			if (negative)
+				*this = Negate();
+		}
+
+		const Int128 Int128::Negate() const {
+			uint64_t lo = ~_lo + 1;
+			uint64_t hi = ~_hi + (lo == 0 ? 1 : 0);
+
+			return Int128(hi, lo);
+		}
+
+	}
+}
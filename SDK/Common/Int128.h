@@ -0,0 +1,91 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_INT128_H__
+#define __ELASTOS_SDK_INT128_H__
+
+#include "typedefs.h"
+
+#include <string>
+#include <stdint.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class BigInt;
+
+		/*
+		 * Signed 128 bit integer for amounts and balances, kept on the stack as two 64 bit words in two's complement.
+		 * Arithmetic throws Error::BigInt on overflow instead of wrapping. The accessors follow BigInt so it can
+		 * stand in for it, values out of range of BigInt conversion throw too.
+		 */
+		class Int128 {
+		public:
+			Int128();
+
+			Int128(uint64_t num);
+
+			Int128(const BigInt &bn);
+
+			Int128 &operator+=(const Int128 &rhs);
+
+			Int128 &operator-=(const Int128 &rhs);
+
+			const Int128 operator+(const Int128 &rhs) const;
+
+			const Int128 operator-(const Int128 &rhs) const;
+
+			bool operator==(const Int128 &rhs) const;
+
+			bool operator!=(const Int128 &rhs) const;
+
+			bool operator<(const Int128 &rhs) const;
+
+			bool operator>(const Int128 &rhs) const;
+
+			bool operator<=(const Int128 &rhs) const;
+
+			bool operator>=(const Int128 &rhs) const;
+
+			bool isZero() const;
+
+			bool isNegative() const;
+
+			// low 64 bits, same as BigInt::getUint64
+			uint64_t getUint64() const;
+
+			void setUint64(uint64_t num);
+
+			// bytes of the magnitude without leading zero
+			int numBytes() const;
+
+			BigInt getBigInt() const;
+
+			// magnitude in big endian without leading zero, "00" for zero, which is what BigInt serialize to
+			bytes_t getHexBytes(bool littleEndian = false) const;
+
+			// throw if the magnitude doesn't fit, see HexBytesInRange
+			void setHexBytes(const bytes_t &bytes, bool littleEndian = false);
+
+			// true if the magnitude in bytes fits a positive Int128
+			static bool HexBytesInRange(const bytes_t &bytes, bool littleEndian = false);
+
+			std::string getDec() const;
+
+			void setDec(const std::string &dec);
+
+		private:
+			Int128(uint64_t hi, uint64_t lo);
+
+			const Int128 Negate() const;
+
+		private:
+			uint64_t _hi;
+			uint64_t _lo;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_INT128_H__
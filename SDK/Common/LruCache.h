@@ -0,0 +1,89 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_LRUCACHE_H__
+#define __ELASTOS_SDK_LRUCACHE_H__
+
+#include <cstddef>
+#include <list>
+#include <utility>
+#include <unordered_map>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Fixed capacity map which evicts the least recently used entry. Get and Put move the entry to the front
+		 * of the recency list, the map keeps an iterator into that list. Not thread safe.
+		 */
+		template<class Key, class Value, class Hasher = std::hash<Key> >
+		class LruCache {
+		private:
+			typedef std::pair<Key, Value> Entry;
+			typedef std::list<Entry> EntryList;
+			typedef std::unordered_map<Key, typename EntryList::iterator, Hasher> EntryIndex;
+
+		public:
+			explicit LruCache(size_t capacity) : _capacity(capacity > 0 ? capacity : 1) {}
+
+			bool Get(const Key &key, Value &value) {
+				typename EntryIndex::iterator it = _index.find(key);
+				if (it == _index.end())
+					return false;
+
+				_entries.splice(_entries.begin(), _entries, it->second);
+				value = it->second->second;
+				return true;
+			}
+
+			void Put(const Key &key, const Value &value) {
+				typename EntryIndex::iterator it = _index.find(key);
+				if (it != _index.end()) {
+					it->second->second = value;
+					_entries.splice(_entries.begin(), _entries, it->second);
+					return;
+				}
+
+				if (_entries.size() >= _capacity) {
+					_index.erase(_entries.back().first);
+					_entries.pop_back();
+				}
+
+				_entries.push_front(Entry(key, value));
+				_index[key] = _entries.begin();
+			}
+
+			bool Remove(const Key &key) {
+				typename EntryIndex::iterator it = _index.find(key);
+				if (it == _index.end())
+					return false;
+
+				_entries.erase(it->second);
+				_index.erase(it);
+				return true;
+			}
+
+			void Clear() {
+				_index.clear();
+				_entries.clear();
+			}
+
+			size_t Size() const {
+				return _entries.size();
+			}
+
+			size_t Capacity() const {
+				return _capacity;
+			}
+
+		private:
+			size_t _capacity;
+			EntryList _entries;
+			EntryIndex _index;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_LRUCACHE_H__
@@ -0,0 +1,393 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "Sha256d.h"
+#include "ErrorChecker.h"
+
+#include <openssl/evp.h>
+
+#include <cstring>
+#include <memory>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHA256D_X86
+#include <cpuid.h>
+#include <immintrin.h>
+
+// the kernels are compiled for their instruction set alone, and only called once the cpu is known to have it
+#define SHA256D_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+#define SHA256D_TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		namespace {
+
+			const uint32_t K[64] = {
+				0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+				0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+				0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+				0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+				0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+				0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+				0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+				0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+			};
+
+			const uint32_t H0[8] = {
+				0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+			};
+
+			inline uint32_t ReadBE32(const uint8_t *p) {
+				return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+			}
+
+			inline void WriteBE32(uint8_t *p, uint32_t x) {
+				p[0] = (uint8_t) (x >> 24);
+				p[1] = (uint8_t) (x >> 16);
+				p[2] = (uint8_t) (x >> 8);
+				p[3] = (uint8_t) x;
+			}
+
+			struct DigestContextDeleter {
+				void operator()(EVP_MD_CTX *ctx) const {
+					EVP_MD_CTX_free(ctx);
+				}
+			};
+
+			EVP_MD_CTX *DigestContext() {
+				// allocated once per thread instead of once per hash
+				static thread_local std::unique_ptr<EVP_MD_CTX, DigestContextDeleter> ctx(EVP_MD_CTX_new());
+				return ctx.get();
+			}
+
+			bool Sha256(EVP_MD_CTX *ctx, uint8_t *md, const void *data, size_t size) {
+				return ctx != nullptr && EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) == 1 &&
+					   EVP_DigestUpdate(ctx, data, size) == 1 && EVP_DigestFinal_ex(ctx, md, nullptr) == 1;
+			}
+
+			void HashPortable(uint8_t *md, const void *data, size_t size) {
+				EVP_MD_CTX *ctx = DigestContext();
+				bool ok = Sha256(ctx, md, data, size) && Sha256(ctx, md, md, 32);
+				ErrorChecker::CheckLogic(!ok, Error::Other, "sha256 digest failed");
+			}
+
+#ifdef SHA256D_X86
+			bool CpuSupports(Sha256d::Kernel kernel) {
+				unsigned int eax, ebx, ecx, edx;
+
+				if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+					return false;
+				bool ssse3 = (ecx & bit_SSSE3) != 0, sse41 = (ecx & bit_SSE4_1) != 0;
+				bool avx = (ecx & bit_AVX) != 0 && (ecx & bit_OSXSAVE) != 0;
+
+				if (__get_cpuid_max(0, nullptr) < 7)
+					return false;
+				__cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+				if (kernel == Sha256d::KernelShaNi)
+					return ssse3 && sse41 && (ebx & (1 << 29)) != 0;
+
+				if (kernel == Sha256d::KernelAvx2) {
+					if (!avx || (ebx & bit_AVX2) == 0)
+						return false;
+
+					// the os has to save the ymm registers too
+					uint32_t xcr0, xcr0High;
+					__asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+					return (xcr0 & 6) == 6;
+				}
+
+				return false;
+			}
+
+			// SHA-NI transform, after the one Intel published with the SHA extensions. The state is kept as ABEF
+			// and CDGH halves, each QuadRound does 4 rounds and the message schedule is computed 4 words ahead.
+
+			SHA256D_TARGET_SHANI inline void QuadRound(__m128i &s0, __m128i &s1, __m128i m, int i) {
+				const __m128i msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i *) &K[i]));
+				s1 = _mm_sha256rnds2_epu32(s1, s0, msg);
+				s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0e));
+			}
+
+			SHA256D_TARGET_SHANI inline void ShiftMessageA(__m128i &m0, __m128i m1) {
+				m0 = _mm_sha256msg1_epu32(m0, m1);
+			}
+
+			SHA256D_TARGET_SHANI inline void ShiftMessageC(__m128i &m0, __m128i m1, __m128i &m2) {
+				m2 = _mm_sha256msg2_epu32(_mm_add_epi32(m2, _mm_alignr_epi8(m1, m0, 4)), m1);
+			}
+
+			SHA256D_TARGET_SHANI inline void ShiftMessageB(__m128i &m0, __m128i m1, __m128i &m2) {
+				ShiftMessageC(m0, m1, m2);
+				ShiftMessageA(m0, m1);
+			}
+
+// N independent messages side by side, so the rounds of one fill the latency of the other's
+#define SHA256D_EACH(stmt) for (int j = 0; j < N; ++j) { stmt; }
+
+			template<int N>
+			SHA256D_TARGET_SHANI inline void TransformShaNiN(uint32_t *const *state, const uint8_t *const *chunk,
+															 size_t blocks) {
+				const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+				__m128i m0[N], m1[N], m2[N], m3[N], s0[N], s1[N], so0[N], so1[N], t1[N], t2[N];
+
+				// a..h to ABEF, CDGH
+				SHA256D_EACH(t1[j] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state[j]), 0xB1));
+				SHA256D_EACH(t2[j] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) (state[j] + 4)), 0x1B));
+				SHA256D_EACH(s0[j] = _mm_alignr_epi8(t1[j], t2[j], 0x08));
+				SHA256D_EACH(s1[j] = _mm_blend_epi16(t2[j], t1[j], 0xF0));
+
+				for (size_t b = 0; b < blocks; ++b) {
+					SHA256D_EACH(so0[j] = s0[j]);
+					SHA256D_EACH(so1[j] = s1[j]);
+
+					SHA256D_EACH(m0[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (chunk[j] + b * 64)), mask));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m0[j], 0));
+					SHA256D_EACH(m1[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (chunk[j] + b * 64 + 16)), mask));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m1[j], 4));
+					SHA256D_EACH(ShiftMessageA(m0[j], m1[j]));
+					SHA256D_EACH(m2[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (chunk[j] + b * 64 + 32)), mask));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m2[j], 8));
+					SHA256D_EACH(ShiftMessageA(m1[j], m2[j]));
+					SHA256D_EACH(m3[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (chunk[j] + b * 64 + 48)), mask));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m3[j], 12));
+					SHA256D_EACH(ShiftMessageB(m2[j], m3[j], m0[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m0[j], 16));
+					SHA256D_EACH(ShiftMessageB(m3[j], m0[j], m1[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m1[j], 20));
+					SHA256D_EACH(ShiftMessageB(m0[j], m1[j], m2[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m2[j], 24));
+					SHA256D_EACH(ShiftMessageB(m1[j], m2[j], m3[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m3[j], 28));
+					SHA256D_EACH(ShiftMessageB(m2[j], m3[j], m0[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m0[j], 32));
+					SHA256D_EACH(ShiftMessageB(m3[j], m0[j], m1[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m1[j], 36));
+					SHA256D_EACH(ShiftMessageB(m0[j], m1[j], m2[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m2[j], 40));
+					SHA256D_EACH(ShiftMessageB(m1[j], m2[j], m3[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m3[j], 44));
+					SHA256D_EACH(ShiftMessageB(m2[j], m3[j], m0[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m0[j], 48));
+					SHA256D_EACH(ShiftMessageB(m3[j], m0[j], m1[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m1[j], 52));
+					SHA256D_EACH(ShiftMessageC(m0[j], m1[j], m2[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m2[j], 56));
+					SHA256D_EACH(ShiftMessageC(m1[j], m2[j], m3[j]));
+					SHA256D_EACH(QuadRound(s0[j], s1[j], m3[j], 60));
+
+					SHA256D_EACH(s0[j] = _mm_add_epi32(s0[j], so0[j]));
+					SHA256D_EACH(s1[j] = _mm_add_epi32(s1[j], so1[j]));
+				}
+
+				// ABEF, CDGH back to a..h
+				SHA256D_EACH(t1[j] = _mm_shuffle_epi32(s0[j], 0x1B));
+				SHA256D_EACH(t2[j] = _mm_shuffle_epi32(s1[j], 0xB1));
+				SHA256D_EACH(_mm_storeu_si128((__m128i *) state[j], _mm_blend_epi16(t1[j], t2[j], 0xF0)));
+				SHA256D_EACH(_mm_storeu_si128((__m128i *) (state[j] + 4), _mm_alignr_epi8(t2[j], t1[j], 0x08)));
+			}
+
+#undef SHA256D_EACH
+
+			// 2 merkle nodes from 2 consecutive pairs
+			SHA256D_TARGET_SHANI void HashPairs2ShaNi(uint8_t *md, const uint8_t *in) {
+				// padding block of a 64 byte message
+				static const uint8_t padding[64] = {0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+													0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+													0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+													0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0};
+				uint32_t a[8], b[8];
+				uint32_t *state[2] = {a, b};
+				uint8_t buf[2][64];
+				const uint8_t *chunk[2] = {in, in + 64};
+
+				memcpy(a, H0, sizeof(a));
+				memcpy(b, H0, sizeof(b));
+				TransformShaNiN<2>(state, chunk, 1);
+				chunk[0] = chunk[1] = padding;
+				TransformShaNiN<2>(state, chunk, 1);
+
+				// second pass over the 32 byte digests
+				for (int j = 0; j < 2; ++j) {
+					memset(buf[j], 0, 64);
+					for (int i = 0; i < 8; ++i)
+						WriteBE32(buf[j] + i * 4, state[j][i]);
+					buf[j][32] = 0x80;
+					buf[j][62] = 0x01;
+					memcpy(state[j], H0, sizeof(H0));
+					chunk[j] = buf[j];
+				}
+				TransformShaNiN<2>(state, chunk, 1);
+
+				for (int j = 0; j < 2; ++j) {
+					for (int i = 0; i < 8; ++i)
+						WriteBE32(md + j * 32 + i * 4, state[j][i]);
+				}
+			}
+
+			// AVX2 transform of 8 independent messages, one per 32 bit lane
+
+			template<int n>
+			SHA256D_TARGET_AVX2 inline __m256i Ror(__m256i x) {
+				return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+			}
+
+			SHA256D_TARGET_AVX2 inline __m256i Add(__m256i a, __m256i b) {
+				return _mm256_add_epi32(a, b);
+			}
+
+			SHA256D_TARGET_AVX2 inline __m256i Xor(__m256i a, __m256i b, __m256i c) {
+				return _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+			}
+
+			SHA256D_TARGET_AVX2 void Transform8(__m256i *s, __m256i *w) {
+				__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7], t1, t2;
+
+				for (int i = 0; i < 64; i++) {
+					if (i >= 16) {
+						const __m256i w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+						t1 = Xor(Ror<7>(w15), Ror<18>(w15), _mm256_srli_epi32(w15, 3));
+						t2 = Xor(Ror<17>(w2), Ror<19>(w2), _mm256_srli_epi32(w2, 10));
+						w[i & 15] = Add(Add(w[i & 15], t1), Add(w[(i - 7) & 15], t2));
+					}
+
+					t1 = Add(Add(h, Xor(Ror<6>(e), Ror<11>(e), Ror<25>(e))),
+							 Add(_mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g))),
+								 Add(_mm256_set1_epi32((int) K[i]), w[i & 15])));
+					t2 = Add(Xor(Ror<2>(a), Ror<13>(a), Ror<22>(a)),
+							 _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b))));
+					h = g;
+					g = f;
+					f = e;
+					e = Add(d, t1);
+					d = c;
+					c = b;
+					b = a;
+					a = Add(t1, t2);
+				}
+
+				s[0] = Add(s[0], a);
+				s[1] = Add(s[1], b);
+				s[2] = Add(s[2], c);
+				s[3] = Add(s[3], d);
+				s[4] = Add(s[4], e);
+				s[5] = Add(s[5], f);
+				s[6] = Add(s[6], g);
+				s[7] = Add(s[7], h);
+			}
+
+			// 8 merkle nodes from 8 consecutive pairs
+			SHA256D_TARGET_AVX2 void HashPairs8Avx2(uint8_t *md, const uint8_t *in) {
+				__m256i s[8], w[16];
+				int k;
+
+				for (k = 0; k < 8; ++k)
+					s[k] = _mm256_set1_epi32((int) H0[k]);
+				for (k = 0; k < 16; ++k)
+					w[k] = _mm256_set_epi32((int) ReadBE32(in + 7 * 64 + k * 4), (int) ReadBE32(in + 6 * 64 + k * 4),
+											(int) ReadBE32(in + 5 * 64 + k * 4), (int) ReadBE32(in + 4 * 64 + k * 4),
+											(int) ReadBE32(in + 3 * 64 + k * 4), (int) ReadBE32(in + 2 * 64 + k * 4),
+											(int) ReadBE32(in + 1 * 64 + k * 4), (int) ReadBE32(in + 0 * 64 + k * 4));
+				Transform8(s, w);
+
+				// padding block of a 64 byte message
+				w[0] = _mm256_set1_epi32((int) 0x80000000);
+				for (k = 1; k < 15; ++k)
+					w[k] = _mm256_setzero_si256();
+				w[15] = _mm256_set1_epi32(512);
+				Transform8(s, w);
+
+				// second pass over the 32 byte digests
+				for (k = 0; k < 8; ++k) {
+					w[k] = s[k];
+					s[k] = _mm256_set1_epi32((int) H0[k]);
+				}
+				w[8] = _mm256_set1_epi32((int) 0x80000000);
+				for (k = 9; k < 15; ++k)
+					w[k] = _mm256_setzero_si256();
+				w[15] = _mm256_set1_epi32(256);
+				Transform8(s, w);
+
+				uint32_t out[8][8];
+				for (k = 0; k < 8; ++k)
+					_mm256_storeu_si256((__m256i *) out[k], s[k]);
+
+				for (int lane = 0; lane < 8; ++lane) {
+					for (k = 0; k < 8; ++k)
+						WriteBE32(md + lane * 32 + k * 4, out[k][lane]);
+				}
+			}
+#endif
+
+			Sha256d::Kernel &ActiveKernel() {
+				static Sha256d::Kernel kernel = Sha256d::Supported(Sha256d::KernelShaNi) ? Sha256d::KernelShaNi :
+												Sha256d::Supported(Sha256d::KernelAvx2) ? Sha256d::KernelAvx2 :
+												Sha256d::KernelPortable;
+				return kernel;
+			}
+
+		}
+
+		void Sha256d::Hash(uint256 &md, const void *data, size_t size) {
+			// OpenSSL's EVP picks its own SHA-NI or AVX2 code for a single message, and was faster than a
+			// kernel of ours in every case measured
+			HashPortable(md.begin(), data, size);
+		}
+
+		void Sha256d::Hash(uint256 &md, const bytes_t &data) {
+			Hash(md, data.data(), data.size());
+		}
+
+		uint256 Sha256d::Hash(const bytes_t &data) {
+			uint256 md;
+			Hash(md, data.data(), data.size());
+			return md;
+		}
+
+		void Sha256d::HashPairs(uint256 *md, const uint256 *nodes, size_t count) {
+			static_assert(sizeof(uint256) == 32, "nodes are hashed in place");
+			size_t i = 0;
+
+#ifdef SHA256D_X86
+			// a batch reads all its pairs before writing, and writes below the pairs of the next one
+			if (ActiveKernel() == KernelAvx2) {
+				for (; i + 8 <= count; i += 8)
+					HashPairs8Avx2(md[i].begin(), nodes[2 * i].begin());
+			} else if (ActiveKernel() == KernelShaNi) {
+				for (; i + 2 <= count; i += 2)
+					HashPairs2ShaNi(md[i].begin(), nodes[2 * i].begin());
+			}
+#endif
+
+			for (; i < count; ++i)
+				Hash(md[i], nodes[2 * i].begin(), 64);
+		}
+
+		bool Sha256d::Supported(Kernel kernel) {
+			if (kernel == KernelPortable)
+				return true;
+
+#ifdef SHA256D_X86
+			return CpuSupports(kernel);
+#else
+			return false;
+#endif
+		}
+
+		Sha256d::Kernel Sha256d::GetKernel() {
+			return ActiveKernel();
+		}
+
+		bool Sha256d::SetKernel(Kernel kernel) {
+			if (!Supported(kernel))
+				return false;
+
+			ActiveKernel() = kernel;
+			return true;
+		}
+
+	}
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_SHA256D_H__
+#define __ELASTOS_SDK_SHA256D_H__
+
+#include "typedefs.h"
+#include "uint256.h"
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Double SHA-256 written straight into a uint256, for transaction and block hashes, merkle nodes, message
+		 * and base58 checksums. Single messages go through OpenSSL's EVP interface with one digest context per
+		 * thread, OpenSSL has its own cpu dispatch for them. Merkle pairs are batched through the best kernel the
+		 * cpu supports, picked at runtime, the portable kernel hashes them one by one through EVP.
+		 */
+		class Sha256d {
+		public:
+			enum Kernel {
+				KernelPortable,
+				KernelAvx2,  // 8 merkle nodes at a time
+				KernelShaNi  // x86 SHA extensions, 2 interleaved merkle nodes at a time
+			};
+
+		public:
+			static void Hash(uint256 &md, const void *data, size_t size);
+
+			static void Hash(uint256 &md, const bytes_t &data);
+
+			static uint256 Hash(const bytes_t &data);
+
+			// md[i] = sha256d(nodes[2 * i] || nodes[2 * i + 1]) for i < count, md may be nodes
+			static void HashPairs(uint256 *md, const uint256 *nodes, size_t count);
+
+			static bool Supported(Kernel kernel);
+
+			static Kernel GetKernel();
+
+			// the best supported kernel is used by default, tests and benchmarks may pick another one
+			static bool SetKernel(Kernel kernel);
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_SHA256D_H__
@@ -702,6 +702,13 @@ inline const uint256 operator|(const uint256& a, const uint256& b)      { return
 inline const uint256 operator+(const uint256& a, const uint256& b)      { return (base_uint256)a +  (base_uint256)b; }
 inline const uint256 operator-(const uint256& a, const uint256& b)      { return (base_uint256)a -  (base_uint256)b; }
 
+/** Hasher for unordered containers keyed by uint256. Keys are mostly sha256 digests, so the low 64 bits are
+ * already uniformly distributed and no further mixing is needed. */
+struct uint256Hasher
+{
+    size_t operator()(const uint256& a) const { return (size_t)a.Get64(0); }
+};
+
 
 
 
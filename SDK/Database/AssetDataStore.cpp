@@ -40,14 +40,12 @@ namespace Elastos {
 
 		bool AssetDataStore::DeleteAsset(const std::string &assetID) {
 			return DoTransaction([&assetID, this]() {
-				std::stringstream ss;
-
-				ss << "DELETE FROM "
-				   << ASSET_TABLE_NAME
-				   << " WHERE " << ASSET_COLUMN_ID << " = '" << assetID << "';";
+				CachedStatement stmt = PrepareCached(ASSET_DELETE);
 
-				ErrorChecker::CheckCondition(!_sqlite->exec(ss.str(), nullptr, nullptr), Error::SqliteError,
-											 "exec sql " + ss.str());
+				_sqlite->BindText(stmt, 1, assetID, nullptr);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+											 "exec sql " + ASSET_DELETE);
+				_sqlite->Reset(stmt);
 			});
 		}
 
@@ -102,6 +100,8 @@ namespace Elastos {
 
 					assets.push_back(asset);
 				}
+
+				_sqlite->Finalize(stmt);
 			});
 
 			return assets;
@@ -113,18 +113,9 @@ namespace Elastos {
 
 		bool AssetDataStore::SelectAsset(const std::string &assetID, AssetEntity &asset) const {
 			bool found = false;
-			std::stringstream ss;
-
-			ss << "SELECT "
-				<< ASSET_AMOUNT << ", "
-				<< ASSET_BUFF
-				<< " FROM " << ASSET_TABLE_NAME
-				<< " WHERE " << ASSET_COLUMN_ID << " = '" << assetID << "';";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(ss.str(), &stmt, nullptr), Error::SqliteError,
-										 "Prepare sql " + ss.str());
+			CachedStatement stmt = PrepareCached(ASSET_SELECT);
 
+			_sqlite->BindText(stmt, 1, assetID, nullptr);
 			while (SQLITE_ROW == _sqlite->Step(stmt)) {
 				found = true;
 
@@ -137,55 +128,39 @@ namespace Elastos {
 				asset.Asset.assign(pdata, pdata + len);
 			}
 
+			_sqlite->Reset(stmt);
+
 			return found;
 		}
 
 		bool AssetDataStore::InsertAsset(const std::string &iso, const AssetEntity &asset) {
-			std::stringstream ss;
-
-			ss << "INSERT INTO " << ASSET_TABLE_NAME << "("
-				<< ASSET_COLUMN_ID << ","
-				<< ASSET_AMOUNT    << ","
-				<< ASSET_BUFF      << ","
-				<< ASSET_ISO
-				<< ") VALUES (?, ?, ?, ?);";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(ss.str(), &stmt, nullptr), Error::SqliteError,
-										 "Prepare sql " + ss.str());
+			CachedStatement stmt = PrepareCached(ASSET_INSERT);
+			std::string amount = asset.Amount.getDec();
 
 			_sqlite->BindText(stmt, 1, asset.AssetID, nullptr);
-			_sqlite->BindText(stmt, 2, asset.Amount.getDec(), nullptr);
+			_sqlite->BindText(stmt, 2, amount, nullptr);
 			_sqlite->BindBlob(stmt, 3, asset.Asset, nullptr);
 			_sqlite->BindText(stmt, 4, iso, nullptr);
 
 			_sqlite->Step(stmt);
 
-			_sqlite->Finalize(stmt);
+			_sqlite->Reset(stmt);
 
 			return true;
 		}
 
 		bool AssetDataStore::UpdateAsset(const std::string &iso, const AssetEntity &asset) {
-			std::stringstream ss;
-
-			ss << "UPDATE " << ASSET_TABLE_NAME << " SET "
-				<< ASSET_AMOUNT << " = ?, "
-				<< ASSET_BUFF   << " = ?, "
-				<< ASSET_ISO    << " = ?"
-				<< " WHERE " << ASSET_COLUMN_ID << " = '" << asset.AssetID << "';";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(ss.str(), &stmt, nullptr), Error::SqliteError,
-										 "Prepare sql " + ss.str());
+			CachedStatement stmt = PrepareCached(ASSET_UPDATE);
+			std::string amount = asset.Amount.getDec();
 
-			_sqlite->BindText(stmt, 1, asset.Amount.getDec(), nullptr);
+			_sqlite->BindText(stmt, 1, amount, nullptr);
 			_sqlite->BindBlob(stmt, 2, asset.Asset, nullptr);
 			_sqlite->BindText(stmt, 3, iso, nullptr);
+			_sqlite->BindText(stmt, 4, asset.AssetID, nullptr);
 
 			_sqlite->Step(stmt);
 
-			_sqlite->Finalize(stmt);
+			_sqlite->Reset(stmt);
 
 			return true;
 		}
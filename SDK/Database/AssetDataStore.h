@@ -70,6 +70,17 @@ namespace Elastos {
 				ASSET_AMOUNT + " text DEFAULT '0', " +
 				ASSET_BUFF + " blob, " +
 				ASSET_ISO + " text DEFAULT 'ELA');";
+
+			const std::string ASSET_SELECT = "SELECT " + ASSET_AMOUNT + ", " + ASSET_BUFF + " FROM " + ASSET_TABLE_NAME +
+				" WHERE " + ASSET_COLUMN_ID + " = ?;";
+
+			const std::string ASSET_INSERT = "INSERT INTO " + ASSET_TABLE_NAME + " (" + ASSET_COLUMN_ID + "," +
+				ASSET_AMOUNT + "," + ASSET_BUFF + "," + ASSET_ISO + ") VALUES (?, ?, ?, ?);";
+
+			const std::string ASSET_UPDATE = "UPDATE " + ASSET_TABLE_NAME + " SET " + ASSET_AMOUNT + " = ?, " +
+				ASSET_BUFF + " = ?, " + ASSET_ISO + " = ? WHERE " + ASSET_COLUMN_ID + " = ?;";
+
+			const std::string ASSET_DELETE = "DELETE FROM " + ASSET_TABLE_NAME + " WHERE " + ASSET_COLUMN_ID + " = ?;";
 		};
 
 	}
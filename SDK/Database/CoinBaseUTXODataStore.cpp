@@ -15,7 +15,14 @@ namespace Elastos {
 
 		CoinBaseUTXODataStore::CoinBaseUTXODataStore(Sqlite *sqlite) :
 			TableBase(sqlite) {
-			InitializeTable(_databaseCreate);
+			MigrateHashColumn(_tableName, _txHash, _databaseCreate);
+			InitializeTable(_databaseCreate + _indexCreate);
+		}
+
+		CoinBaseUTXODataStore::CoinBaseUTXODataStore(SqliteTransactionType type, Sqlite *sqlite) :
+			TableBase(type, sqlite) {
+			MigrateHashColumn(_tableName, _txHash, _databaseCreate);
+			InitializeTable(_databaseCreate + _indexCreate);
 		}
 
 		CoinBaseUTXODataStore::~CoinBaseUTXODataStore() {
@@ -77,76 +84,92 @@ namespace Elastos {
 			std::vector<UTXOPtr> entitys;
 
 			DoTransaction([&entitys, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(_select + ";");
 
-				sql = "SELECT "
-				   + _txHash + ", "
-				   + _blockHeight + ", "
-				   + _timestamp + ", "
-				   + _index + ", "
-				   + _programHash + ", "
-				   + _assetID + ", "
-				   + _outputLock + ", "
-				   + _amount + ", "
-				   + _payload + ", "
-				   + _spent
-				   + " FROM " + _tableName + ";";
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					entitys.push_back(ReadUTXO(stmt));
+				}
 
-				sqlite3_stmt *stmt;
-				ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-											 "Prepare sql " + sql);
+				_sqlite->Reset(stmt);
+			});
 
-				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+			return entitys;
+		}
+
+		std::vector<UTXOPtr> CoinBaseUTXODataStore::GetPage(size_t offset, size_t limit) const {
+			std::vector<UTXOPtr> entitys;
+
+			DoTransaction([&offset, &limit, &entitys, this]() {
+				CachedStatement stmt = PrepareCached(_select + " ORDER BY " + _blockHeight + " DESC, " + _timestamp +
+												   " DESC LIMIT ? OFFSET ?;");
 
-					uint256 txHash(_sqlite->ColumnText(stmt, 0));
-					uint32_t blockHeight = _sqlite->ColumnInt(stmt, 1);
-					time_t timestamp = _sqlite->ColumnInt64(stmt, 2);
-					uint16_t index = (uint16_t) _sqlite->ColumnInt(stmt, 3);
-					uint168 programHash(*_sqlite->ColumnBlobBytes(stmt, 4));
-					uint256 assetID(*_sqlite->ColumnBlobBytes(stmt, 5));
-					uint32_t outputLock = _sqlite->ColumnInt(stmt, 6);
-					BigInt amount;
-					amount.setDec(_sqlite->ColumnText(stmt, 7));
-					_sqlite->ColumnBlobBytes(stmt, 8);
-					bool spent = _sqlite->ColumnInt(stmt, 9) != 0;
-
-					OutputPtr o(new TransactionOutput(amount, Address(programHash), assetID));
-					o->SetOutputLock(outputLock);
-					o->SetFixedIndex(index);
-
-					UTXOPtr entity(new UTXO(txHash, index, timestamp, blockHeight, o));
-					entity->SetSpent(spent);
-					entitys.push_back(entity);
+				_sqlite->BindInt64(stmt, 1, limit);
+				_sqlite->BindInt64(stmt, 2, offset);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					entitys.push_back(ReadUTXO(stmt));
 				}
 
-				_sqlite->Finalize(stmt);
+				_sqlite->Reset(stmt);
 			});
 
 			return entitys;
 		}
 
+		UTXOPtr CoinBaseUTXODataStore::Get(const uint256 &hash) const {
+			UTXOPtr entity;
+
+			DoTransaction([&hash, &entity, this]() {
+				CachedStatement stmt = PrepareCached(_select + " WHERE " + _txHash + " = ?;");
+
+				_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
+				if (SQLITE_ROW == _sqlite->Step(stmt))
+					entity = ReadUTXO(stmt);
+
+				_sqlite->Reset(stmt);
+			});
+
+			return entity;
+		}
+
+		UTXOPtr CoinBaseUTXODataStore::ReadUTXO(sqlite3_stmt *stmt) const {
+			uint256 txHash(*_sqlite->ColumnBlobBytes(stmt, 0));
+			uint32_t blockHeight = _sqlite->ColumnInt(stmt, 1);
+			time_t timestamp = _sqlite->ColumnInt64(stmt, 2);
+			uint16_t index = (uint16_t) _sqlite->ColumnInt(stmt, 3);
+			uint168 programHash(*_sqlite->ColumnBlobBytes(stmt, 4));
+			uint256 assetID(*_sqlite->ColumnBlobBytes(stmt, 5));
+			uint32_t outputLock = _sqlite->ColumnInt(stmt, 6);
+			Int128 amount;
+			amount.setDec(_sqlite->ColumnText(stmt, 7));
+			_sqlite->ColumnBlobBytes(stmt, 8);
+			bool spent = _sqlite->ColumnInt(stmt, 9) != 0;
+
+			OutputPtr o(new TransactionOutput(amount, Address(programHash), assetID));
+			o->SetOutputLock(outputLock);
+			o->SetFixedIndex(index);
+
+			UTXOPtr entity(new UTXO(txHash, index, timestamp, blockHeight, o));
+			entity->SetSpent(spent);
+
+			return entity;
+		}
+
 		bool CoinBaseUTXODataStore::Update(const std::vector<uint256> &txHashes, uint32_t blockHeight,
 										   time_t timestamp) {
 			if (txHashes.empty())
 				return true;
 
 			return DoTransaction([&txHashes, &blockHeight, &timestamp, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(_update);
 
 				for (size_t i = 0; i < txHashes.size(); ++i) {
-					sql = "UPDATE " + _tableName + " SET " + _blockHeight + " = ?, " +
-						_timestamp + " = ? " + " WHERE " + _txHash + " = '" + txHashes[i].GetHex() + "';";
-
-					sqlite3_stmt *stmt;
-					ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-												 "Prepare sql " + sql);
-
 					_sqlite->BindInt(stmt, 1, blockHeight);
 					_sqlite->BindInt64(stmt, 2, timestamp);
+					_sqlite->BindBlob(stmt, 3, txHashes[i].begin(), txHashes[i].size(), nullptr);
 
 					_sqlite->Step(stmt);
 
-					_sqlite->Finalize(stmt);
+					_sqlite->Reset(stmt);
 				}
 			});
 		}
@@ -156,33 +179,27 @@ namespace Elastos {
 				return true;
 
 			return DoTransaction([&txHashes, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(_updateSpent);
 
 				for (size_t i = 0; i < txHashes.size(); ++i) {
-					sql = "UPDATE " + _tableName + " SET " + _spent + " = ? " + " WHERE " +
-						_txHash + " = '" + txHashes[i].GetHex() + "';";
-
-					sqlite3_stmt *stmt;
-					ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-												 "Prepare sql " + sql);
-
 					_sqlite->BindInt(stmt, 1, 1);
+					_sqlite->BindBlob(stmt, 2, txHashes[i].begin(), txHashes[i].size(), nullptr);
 
 					_sqlite->Step(stmt);
 
-					_sqlite->Finalize(stmt);
+					_sqlite->Reset(stmt);
 				}
 			});
 		}
 
 		bool CoinBaseUTXODataStore::Delete(const uint256 &hash) {
 			return DoTransaction([&hash, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(_delete);
 
-				sql = "DELETE FROM " + _tableName + " WHERE " + _txHash + " = '" + hash.GetHex() + "';";
-
-				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
-											 "Exec sql " + sql);
+				_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+											 "Exec sql " + _delete);
+				_sqlite->Reset(stmt);
 			});
 		}
 
@@ -191,40 +208,24 @@ namespace Elastos {
 		}
 
 		bool CoinBaseUTXODataStore::PutInternal(const UTXOPtr &entity) {
-			std::string sql;
-
-			sql = "INSERT INTO " + _tableName + "("
-			   + _txHash + ","
-			   + _blockHeight + ","
-			   + _timestamp + ","
-			   + _index + ","
-			   + _programHash + ","
-			   + _assetID + ","
-			   + _outputLock + ","
-			   + _amount + ","
-			   + _payload + ","
-			   + _spent
-			   + ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-										 "Prepare sql " + sql);
-
-			std::string hash = entity->Hash().GetHex();
-			_sqlite->BindText(stmt, 1, hash, nullptr);
+			CachedStatement stmt = PrepareCached(_insert);
+
+			const uint256 &hash = entity->Hash();
+			std::string amount = entity->Output()->Amount().getDec();
+			_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
 			_sqlite->BindInt(stmt, 2, entity->BlockHeight());
 			_sqlite->BindInt64(stmt, 3, entity->Timestamp());
 			_sqlite->BindInt(stmt, 4, entity->Index());
 			_sqlite->BindBlob(stmt, 5, entity->Output()->ProgramHash().bytes(), nullptr);
 			_sqlite->BindBlob(stmt, 6, entity->Output()->AssetID().begin(), entity->Output()->AssetID().size(), nullptr);
 			_sqlite->BindInt(stmt, 7, entity->Output()->OutputLock());
-			_sqlite->BindText(stmt, 8, entity->Output()->Amount().getDec(), nullptr);
+			_sqlite->BindText(stmt, 8, amount, nullptr);
 			_sqlite->BindBlob(stmt, 9, nullptr, 0, nullptr);
 			_sqlite->BindInt(stmt, 10, entity->Spent());
 
 			_sqlite->Step(stmt);
 
-			_sqlite->Finalize(stmt);
+			_sqlite->Reset(stmt);
 
 			return true;
 		}
@@ -21,6 +21,8 @@ namespace Elastos {
 		public:
 			explicit CoinBaseUTXODataStore(Sqlite *sqlite);
 
+			CoinBaseUTXODataStore(SqliteTransactionType type, Sqlite *sqlite);
+
 			~CoinBaseUTXODataStore();
 
 			bool Put(const std::vector<UTXOPtr> &entitys);
@@ -33,6 +35,11 @@ namespace Elastos {
 
 			std::vector<UTXOPtr> GetAll() const;
 
+			// newest first by block height
+			std::vector<UTXOPtr> GetPage(size_t offset, size_t limit) const;
+
+			UTXOPtr Get(const uint256 &hash) const;
+
 			bool Update(const std::vector<uint256> &txHashes, uint32_t blockHeight, time_t timestamp);
 
 			bool UpdateSpent(const std::vector<uint256> &txHashes);
@@ -43,6 +50,8 @@ namespace Elastos {
 		private:
 			bool PutInternal(const UTXOPtr &entity);
 
+			UTXOPtr ReadUTXO(sqlite3_stmt *stmt) const;
+
 		private:
 			/*
 			 * coin base utxo table
@@ -63,7 +72,7 @@ namespace Elastos {
 			const std::string _spent = "spent";
 
 			const std::string _databaseCreate = "create table if not exists " + _tableName + " (" +
-												_txHash + " text not null, " +
+												_txHash + " blob not null, " +
 												_blockHeight + " INTEGER, " +
 												_timestamp + " INTEGER, " +
 												_index + " INTEGER, " +
@@ -72,7 +81,28 @@ namespace Elastos {
 												_outputLock + " INTEGER, " +
 												_amount + " TEXT DEFAULT '0', " +
 												_payload + " BLOB, " +
-												_spent + " INTEGER);";
+												_spent + " INTEGER, " +
+												"primary key (" + _txHash + ", " + _index + "));";
+
+			const std::string _indexCreate = "CREATE INDEX IF NOT EXISTS coinBaseHeightIndex ON " + _tableName + " (" +
+											 _blockHeight + ", " + _timestamp + ");";
+
+			const std::string _select = "SELECT " + _txHash + ", " + _blockHeight + ", " + _timestamp + ", " +
+										_index + ", " + _programHash + ", " + _assetID + ", " + _outputLock + ", " +
+										_amount + ", " + _payload + ", " + _spent + " FROM " + _tableName;
+
+			const std::string _insert = "INSERT OR REPLACE INTO " + _tableName + " (" + _txHash + "," + _blockHeight +
+										"," + _timestamp + "," + _index + "," + _programHash + "," + _assetID + "," +
+										_outputLock + "," + _amount + "," + _payload + "," + _spent +
+										") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+
+			const std::string _update = "UPDATE " + _tableName + " SET " + _blockHeight + " = ?, " + _timestamp +
+										" = ? WHERE " + _txHash + " = ?;";
+
+			const std::string _updateSpent = "UPDATE " + _tableName + " SET " + _spent + " = ? WHERE " + _txHash +
+											 " = ?;";
+
+			const std::string _delete = "DELETE FROM " + _tableName + " WHERE " + _txHash + " = ?;";
 		};
 
 	}
@@ -4,18 +4,46 @@
 
 #include "DatabaseManager.h"
 
+#include <SDK/Plugin/Transaction/Transaction.h>
+
 namespace Elastos {
 	namespace ElaWallet {
 
+		DatabaseConfig::DatabaseConfig() :
+			asyncWrite(false),
+			writeBatchSize(1000),
+			writeWindowMs(200) {
+		}
+
+		DatabaseManager::Readers::Readers(const boost::filesystem::path &path, const SqliteConfig &config) :
+			sqlite(path, config),
+			peerDataSource(DEFERRED, &sqlite),
+			coinbaseDataStore(DEFERRED, &sqlite),
+			transactionDataStore(DEFERRED, &sqlite),
+			merkleBlockDataSource(DEFERRED, &sqlite),
+			assetDataStore(DEFERRED, &sqlite),
+			utxoSnapshotDataStore(DEFERRED, &sqlite) {
+		}
+
 		DatabaseManager::DatabaseManager(const boost::filesystem::path &path) :
+			DatabaseManager(path, DatabaseConfig()) {
+
+		}
+
+		DatabaseManager::DatabaseManager(const boost::filesystem::path &path, const DatabaseConfig &config) :
 			_path(path),
-			_sqlite(path),
+			_sqlite(path, config.sqlite),
 			_peerDataSource(&_sqlite),
 			_coinbaseDataStore(&_sqlite),
 			_transactionDataStore(&_sqlite),
+			_merkleBlockDataSource(&_sqlite),
 			_assetDataStore(&_sqlite),
-			_merkleBlockDataSource(&_sqlite) {
+			_utxoSnapshotDataStore(&_sqlite) {
+			if (config.sqlite.walMode)
+				_readers.reset(new Readers(path, config.sqlite));
 
+			if (config.asyncWrite)
+				_writer.reset(new DatabaseWriter(&_sqlite, config.writeBatchSize, config.writeWindowMs));
 		}
 
 		DatabaseManager::DatabaseManager() :
@@ -24,118 +52,254 @@ namespace Elastos {
 		}
 
 		DatabaseManager::~DatabaseManager() {
-
+			if (_writer)
+				_writer->Stop();
 		}
 
 		bool DatabaseManager::PutCoinBase(const std::vector<UTXOPtr> &entitys) {
-			return _coinbaseDataStore.Put(entitys);
+			return Write([this, entitys]() {
+				return this->_coinbaseDataStore.Put(entitys);
+			});
 		}
 
 		bool DatabaseManager::PutCoinBase(const UTXOPtr &entity) {
-			return _coinbaseDataStore.Put(entity);
+			return Write([this, entity]() {
+				return this->_coinbaseDataStore.Put(entity);
+			});
 		}
 
 		bool DatabaseManager::DeleteAllCoinBase() {
-			return _coinbaseDataStore.DeleteAll();
+			return Write([this]() {
+				return this->_coinbaseDataStore.DeleteAll();
+			});
 		}
 
 		size_t DatabaseManager::GetCoinBaseTotalCount() const {
-			return _coinbaseDataStore.GetTotalCount();
+			WaitForWrites();
+			return CoinBaseReader().GetTotalCount();
 		}
 
 		std::vector<UTXOPtr> DatabaseManager::GetAllCoinBase() const {
-			return _coinbaseDataStore.GetAll();
+			WaitForWrites();
+			return CoinBaseReader().GetAll();
+		}
+
+		std::vector<UTXOPtr> DatabaseManager::GetCoinBasePage(size_t offset, size_t limit) const {
+			WaitForWrites();
+			return CoinBaseReader().GetPage(offset, limit);
+		}
+
+		UTXOPtr DatabaseManager::GetCoinBase(const uint256 &hash) const {
+			WaitForWrites();
+			return CoinBaseReader().Get(hash);
 		}
 
 		bool DatabaseManager::UpdateCoinBase(const std::vector<uint256> &txHashes, uint32_t blockHeight,
 											 time_t timestamp) {
-			return _coinbaseDataStore.Update(txHashes, blockHeight, timestamp);
+			return Write([this, txHashes, blockHeight, timestamp]() {
+				return this->_coinbaseDataStore.Update(txHashes, blockHeight, timestamp);
+			});
 		}
 
 		bool DatabaseManager::UpdateSpentCoinBase(const std::vector<uint256> &txHashes) {
-			return _coinbaseDataStore.UpdateSpent(txHashes);
+			return Write([this, txHashes]() {
+				return this->_coinbaseDataStore.UpdateSpent(txHashes);
+			});
 		}
 
 		bool DatabaseManager::DeleteCoinBase(const uint256 &hash) {
-			return _coinbaseDataStore.Delete(hash);
+			return Write([this, hash]() {
+				return this->_coinbaseDataStore.Delete(hash);
+			});
 		}
 
 		bool DatabaseManager::PutTransaction(const std::string &iso, const TransactionPtr &tx) {
-			return _transactionDataStore.PutTransaction(iso, tx);
+			if (!_writer)
+				return _transactionDataStore.PutTransaction(iso, tx);
+
+			// the wallet keeps changing its copy, store the tx as it is now
+			TransactionPtr snapshot(new Transaction(*tx));
+			return Write([this, iso, snapshot]() {
+				return this->_transactionDataStore.PutTransaction(iso, snapshot);
+			});
 		}
 
 		bool DatabaseManager::PutTransactions(const std::string &iso, const std::vector<TransactionPtr> &txns) {
-			return _transactionDataStore.PutTransactions(iso, txns);
+			if (!_writer)
+				return _transactionDataStore.PutTransactions(iso, txns);
+
+			std::vector<TransactionPtr> snapshots;
+			for (size_t i = 0; i < txns.size(); ++i)
+				snapshots.push_back(TransactionPtr(new Transaction(*txns[i])));
+			return Write([this, iso, snapshots]() {
+				return this->_transactionDataStore.PutTransactions(iso, snapshots);
+			});
 		}
 
 		bool DatabaseManager::DeleteAllTransactions() {
-			return _transactionDataStore.DeleteAllTransactions();
+			return Write([this]() {
+				// the snapshot is built from the history which is going away
+				return this->_transactionDataStore.DeleteAllTransactions() && this->_utxoSnapshotDataStore.DeleteAll();
+			});
 		}
 
 		size_t DatabaseManager::GetAllTransactionsCount() const {
-			return _transactionDataStore.GetAllTransactionsCount();
+			WaitForWrites();
+			return TransactionReader().GetAllTransactionsCount();
 		}
 
 		std::vector<TransactionPtr> DatabaseManager::GetAllTransactions() const {
-			return _transactionDataStore.GetAllTransactions();
+			WaitForWrites();
+			return TransactionReader().GetAllTransactions();
+		}
+
+		std::vector<TransactionPtr> DatabaseManager::GetTransactions(size_t offset, size_t limit) const {
+			WaitForWrites();
+			return TransactionReader().GetTransactions(offset, limit);
+		}
+
+		std::vector<TransactionPtr> DatabaseManager::GetTransactionsByAddress(const uint168 &programHash,
+																			  size_t offset, size_t limit) const {
+			WaitForWrites();
+			return TransactionReader().GetTransactionsByAddress(programHash, offset, limit);
+		}
+
+		size_t DatabaseManager::GetTransactionsCountByAddress(const uint168 &programHash) const {
+			WaitForWrites();
+			return TransactionReader().GetTransactionsCountByAddress(programHash);
+		}
+
+		TransactionPtr DatabaseManager::GetTransaction(const uint256 &hash) const {
+			WaitForWrites();
+			return TransactionReader().GetTransaction(hash);
+		}
+
+		std::vector<TransactionPtr> DatabaseManager::GetTransactions(const std::vector<uint256> &hashes) const {
+			WaitForWrites();
+			return TransactionReader().GetTransactions(hashes);
+		}
+
+		std::vector<TransactionPtr> DatabaseManager::GetTransactionsFrom(uint32_t blockHeight) const {
+			WaitForWrites();
+			return TransactionReader().GetTransactionsFrom(blockHeight);
+		}
+
+		std::vector<uint168> DatabaseManager::GetOutputProgramHashes() const {
+			WaitForWrites();
+			return TransactionReader().GetOutputProgramHashes();
+		}
+
+		std::vector<OutputEntity> DatabaseManager::GetUnspentOutputs() const {
+			WaitForWrites();
+			return TransactionReader().GetUnspentOutputs();
+		}
+
+		size_t DatabaseManager::GetConfirmedTransactionsCount(uint32_t maxHeight) const {
+			WaitForWrites();
+			return TransactionReader().GetConfirmedTransactionsCount(maxHeight);
 		}
 
 		bool DatabaseManager::UpdateTransaction(const std::vector<uint256> &hashes, uint32_t blockHeight,
 												time_t timestamp) {
-			return _transactionDataStore.UpdateTransaction(hashes, blockHeight, timestamp);
+			return Write([this, hashes, blockHeight, timestamp]() {
+				return this->_transactionDataStore.UpdateTransaction(hashes, blockHeight, timestamp);
+			});
 		}
 
 		bool DatabaseManager::DeleteTxByHash(const uint256 &hash) {
-			return _transactionDataStore.DeleteTxByHash(hash);
+			return Write([this, hash]() {
+				return this->_transactionDataStore.DeleteTxByHash(hash);
+			});
 		}
 
 		bool DatabaseManager::DeleteTxByHashes(const std::vector<uint256> &hashes) {
-			return _transactionDataStore.DeleteTxByHashes(hashes);
+			return Write([this, hashes]() {
+				return this->_transactionDataStore.DeleteTxByHashes(hashes);
+			});
+		}
+
+		bool DatabaseManager::PutUTXOSnapshot(const UTXOSnapshot &snapshot) {
+			return Write([this, snapshot]() {
+				// count on the writer, after the transactions queued before this snapshot are in
+				UTXOSnapshot s = snapshot;
+				s.txCount = this->_transactionDataStore.GetConfirmedTransactionsCount(s.blockHeight);
+				return this->_utxoSnapshotDataStore.Put(s);
+			});
+		}
+
+		bool DatabaseManager::GetUTXOSnapshot(UTXOSnapshot &snapshot) const {
+			WaitForWrites();
+			return UTXOSnapshotReader().Get(snapshot);
+		}
+
+		bool DatabaseManager::DeleteUTXOSnapshot() {
+			return Write([this]() {
+				return this->_utxoSnapshotDataStore.DeleteAll();
+			});
 		}
 
 		bool DatabaseManager::PutPeer(const std::string &iso, const PeerEntity &peerEntity) {
-			return _peerDataSource.PutPeer(iso, peerEntity);
+			return Write([this, iso, peerEntity]() {
+				return this->_peerDataSource.PutPeer(iso, peerEntity);
+			});
 		}
 
 		bool DatabaseManager::PutPeers(const std::string &iso, const std::vector<PeerEntity> &peerEntities) {
-			return _peerDataSource.PutPeers(iso, peerEntities);
+			return Write([this, iso, peerEntities]() {
+				return this->_peerDataSource.PutPeers(iso, peerEntities);
+			});
 		}
 
 		bool DatabaseManager::DeletePeer(const std::string &iso, const PeerEntity &peerEntity) {
-			return _peerDataSource.DeletePeer(iso, peerEntity);
+			return Write([this, iso, peerEntity]() {
+				return this->_peerDataSource.DeletePeer(iso, peerEntity);
+			});
 		}
 
 		bool DatabaseManager::DeleteAllPeers() {
-			return _peerDataSource.DeleteAllPeers();
+			return Write([this]() {
+				return this->_peerDataSource.DeleteAllPeers();
+			});
 		}
 
 		std::vector<PeerEntity> DatabaseManager::GetAllPeers(const std::string &iso) const {
-			return _peerDataSource.GetAllPeers(iso);
+			WaitForWrites();
+			return PeerReader().GetAllPeers(iso);
 		}
 
 		size_t DatabaseManager::GetAllPeersCount(const std::string &iso) const {
-			return _peerDataSource.GetAllPeersCount(iso);
+			WaitForWrites();
+			return PeerReader().GetAllPeersCount(iso);
 		}
 
 		bool DatabaseManager::PutMerkleBlock(const std::string &iso, const MerkleBlockPtr &blockPtr) {
-			return _merkleBlockDataSource.PutMerkleBlock(iso, blockPtr);
+			return Write([this, iso, blockPtr]() {
+				return this->_merkleBlockDataSource.PutMerkleBlock(iso, blockPtr);
+			});
 		}
 
 		bool DatabaseManager::PutMerkleBlocks(const std::string &iso,
 											  const std::vector<MerkleBlockPtr> &blocks) {
-			return _merkleBlockDataSource.PutMerkleBlocks(iso, blocks);
+			return Write([this, iso, blocks]() {
+				return this->_merkleBlockDataSource.PutMerkleBlocks(iso, blocks);
+			});
 		}
 
 		bool DatabaseManager::DeleteMerkleBlock(const std::string &iso, long id) {
-			return _merkleBlockDataSource.DeleteMerkleBlock(iso, id);
+			return Write([this, iso, id]() {
+				return this->_merkleBlockDataSource.DeleteMerkleBlock(iso, id);
+			});
 		}
 
 		bool DatabaseManager::DeleteAllBlocks(const std::string &iso) {
-			return _merkleBlockDataSource.DeleteAllBlocks(iso);
+			return Write([this, iso]() {
+				return this->_merkleBlockDataSource.DeleteAllBlocks(iso);
+			});
 		}
 
 		std::vector<MerkleBlockPtr> DatabaseManager::GetAllMerkleBlocks(const std::string &iso, const std::string &pluginType) const {
-			return _merkleBlockDataSource.GetAllMerkleBlocks(iso, pluginType);
+			WaitForWrites();
+			return MerkleBlockReader().GetAllMerkleBlocks(iso, pluginType);
 		}
 
 		const boost::filesystem::path &DatabaseManager::GetPath() const {
@@ -143,31 +307,79 @@ namespace Elastos {
 		}
 
 		bool DatabaseManager::PutAsset(const std::string &iso, const AssetEntity &asset) {
-			return _assetDataStore.PutAsset(iso, asset);
+			return Write([this, iso, asset]() {
+				return this->_assetDataStore.PutAsset(iso, asset);
+			});
 		}
 
 		bool DatabaseManager::DeleteAsset(const std::string &assetID) {
-			return _assetDataStore.DeleteAsset(assetID);
+			return Write([this, assetID]() {
+				return this->_assetDataStore.DeleteAsset(assetID);
+			});
 		}
 
 		bool DatabaseManager::DeleteAllAssets() {
-			return _assetDataStore.DeleteAllAssets();
+			return Write([this]() {
+				return this->_assetDataStore.DeleteAllAssets();
+			});
 		}
 
 		bool DatabaseManager::GetAssetDetails(const std::string &assetID, AssetEntity &asset) const {
-			return _assetDataStore.GetAssetDetails(assetID, asset);
+			WaitForWrites();
+			return AssetReader().GetAssetDetails(assetID, asset);
 		}
 
 		std::vector<AssetEntity> DatabaseManager::GetAllAssets() const {
-			return _assetDataStore.GetAllAssets();
+			WaitForWrites();
+			return AssetReader().GetAllAssets();
 		}
 
-		void DatabaseManager::flush() {
+		bool DatabaseManager::flush() {
+			bool result = _writer ? _writer->Flush() : true;
 			_transactionDataStore.flush();
 			_coinbaseDataStore.flush();
 			_merkleBlockDataSource.flush();
 			_peerDataSource.flush();
 			_assetDataStore.flush();
+			_utxoSnapshotDataStore.flush();
+			return result;
+		}
+
+		bool DatabaseManager::Write(const boost::function<bool()> &job) {
+			if (!_writer)
+				return job();
+
+			_writer->Post(job);
+			return true;
+		}
+
+		void DatabaseManager::WaitForWrites() const {
+			if (_writer)
+				_writer->Wait();
+		}
+
+		const PeerDataSource &DatabaseManager::PeerReader() const {
+			return _readers ? _readers->peerDataSource : _peerDataSource;
+		}
+
+		const CoinBaseUTXODataStore &DatabaseManager::CoinBaseReader() const {
+			return _readers ? _readers->coinbaseDataStore : _coinbaseDataStore;
+		}
+
+		const TransactionDataStore &DatabaseManager::TransactionReader() const {
+			return _readers ? _readers->transactionDataStore : _transactionDataStore;
+		}
+
+		const MerkleBlockDataSource &DatabaseManager::MerkleBlockReader() const {
+			return _readers ? _readers->merkleBlockDataSource : _merkleBlockDataSource;
+		}
+
+		const AssetDataStore &DatabaseManager::AssetReader() const {
+			return _readers ? _readers->assetDataStore : _assetDataStore;
+		}
+
+		const UTXOSnapshotDataStore &DatabaseManager::UTXOSnapshotReader() const {
+			return _readers ? _readers->utxoSnapshotDataStore : _utxoSnapshotDataStore;
 		}
 
 	}
@@ -10,17 +10,36 @@
 #include "PeerDataSource.h"
 #include "AssetDataStore.h"
 #include "CoinBaseUTXODataStore.h"
+#include "UTXOSnapshotDataStore.h"
+#include "DatabaseWriter.h"
 #include "Sqlite.h"
 
+#include <boost/scoped_ptr.hpp>
+
 namespace Elastos {
 	namespace ElaWallet {
 
 		class UTXO;
 		typedef boost::shared_ptr<UTXO> UTXOPtr;
 
+		struct DatabaseConfig {
+			DatabaseConfig();
+
+			SqliteConfig sqlite;
+			/*
+			 * Queue writes on a writer thread and commit them in batches. A crash loses writes which are not committed
+			 * yet, at most writeWindowMs of them, the caller may flush() at points which must be durable. Reads wait
+			 * for queued writes first, and run on their own connection in WAL mode.
+			 */
+			bool asyncWrite;
+			size_t writeBatchSize;
+			uint32_t writeWindowMs;
+		};
+
 		class DatabaseManager {
 		public:
 			DatabaseManager(const boost::filesystem::path &path);
+			DatabaseManager(const boost::filesystem::path &path, const DatabaseConfig &config);
 			DatabaseManager();
 			~DatabaseManager();
 
@@ -30,6 +49,8 @@ namespace Elastos {
 			bool DeleteAllCoinBase();
 			size_t GetCoinBaseTotalCount() const;
 			std::vector<UTXOPtr> GetAllCoinBase() const;
+			std::vector<UTXOPtr> GetCoinBasePage(size_t offset, size_t limit) const;
+			UTXOPtr GetCoinBase(const uint256 &hash) const;
 			bool UpdateCoinBase(const std::vector<uint256> &txHashes, uint32_t blockHeight, time_t timestamp);
 			bool UpdateSpentCoinBase(const std::vector<uint256> &txHashes);
 			bool DeleteCoinBase(const uint256 &hash);
@@ -40,10 +61,26 @@ namespace Elastos {
 			bool DeleteAllTransactions();
 			size_t GetAllTransactionsCount() const;
 			std::vector<TransactionPtr> GetAllTransactions() const;
+			// pages of history newest first, see TransactionDataStore
+			std::vector<TransactionPtr> GetTransactions(size_t offset, size_t limit) const;
+			std::vector<TransactionPtr> GetTransactionsByAddress(const uint168 &programHash, size_t offset,
+																 size_t limit) const;
+			size_t GetTransactionsCountByAddress(const uint168 &programHash) const;
+			TransactionPtr GetTransaction(const uint256 &hash) const;
+			std::vector<TransactionPtr> GetTransactions(const std::vector<uint256> &hashes) const;
+			std::vector<TransactionPtr> GetTransactionsFrom(uint32_t blockHeight) const;
+			std::vector<uint168> GetOutputProgramHashes() const;
+			std::vector<OutputEntity> GetUnspentOutputs() const;
+			size_t GetConfirmedTransactionsCount(uint32_t maxHeight) const;
 			bool UpdateTransaction(const std::vector<uint256> &hashes, uint32_t blockHeight, time_t timestamp);
 			bool DeleteTxByHash(const uint256 &hash);
 			bool DeleteTxByHashes(const std::vector<uint256> &hashes);
 
+			// UTXO snapshot database interface, txCount of the snapshot is counted when it is written
+			bool PutUTXOSnapshot(const UTXOSnapshot &snapshot);
+			bool GetUTXOSnapshot(UTXOSnapshot &snapshot) const;
+			bool DeleteUTXOSnapshot();
+
 			// Peer's database interface
 			bool PutPeer(const std::string &iso, const PeerEntity &peerEntity);
 			bool PutPeers(const std::string &iso, const std::vector<PeerEntity> &peerEntities);
@@ -68,7 +105,33 @@ namespace Elastos {
 
 			const boost::filesystem::path &GetPath() const;
 
-			void flush();
+			// false if an async write queued since the previous flush() failed and was rolled back
+			bool flush();
+
+		private:
+			// run job now, or queue it and return true if writes are async, failures then show up in flush()
+			bool Write(const boost::function<bool()> &job);
+
+			void WaitForWrites() const;
+
+			struct Readers {
+				Readers(const boost::filesystem::path &path, const SqliteConfig &config);
+
+				Sqlite sqlite;
+				PeerDataSource peerDataSource;
+				CoinBaseUTXODataStore coinbaseDataStore;
+				TransactionDataStore transactionDataStore;
+				MerkleBlockDataSource merkleBlockDataSource;
+				AssetDataStore assetDataStore;
+				UTXOSnapshotDataStore utxoSnapshotDataStore;
+			};
+
+			const PeerDataSource &PeerReader() const;
+			const CoinBaseUTXODataStore &CoinBaseReader() const;
+			const TransactionDataStore &TransactionReader() const;
+			const MerkleBlockDataSource &MerkleBlockReader() const;
+			const AssetDataStore &AssetReader() const;
+			const UTXOSnapshotDataStore &UTXOSnapshotReader() const;
 
 		private:
 			boost::filesystem::path _path;
@@ -78,6 +141,10 @@ namespace Elastos {
 			TransactionDataStore  	_transactionDataStore;
 			MerkleBlockDataSource 	_merkleBlockDataSource;
 			AssetDataStore          _assetDataStore;
+			UTXOSnapshotDataStore   _utxoSnapshotDataStore;
+			boost::scoped_ptr<Readers> _readers;
+			// declared last, so it drains before the stores go away
+			boost::scoped_ptr<DatabaseWriter> _writer;
 		};
 
 	}
@@ -0,0 +1,157 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "DatabaseWriter.h"
+
+#include <SDK/Common/Log.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		DatabaseWriter::DatabaseWriter(Sqlite *sqlite, size_t batchSize, uint32_t windowMs) :
+			_sqlite(sqlite),
+			_batchSize(batchSize > 0 ? batchSize : 1),
+			_window(windowMs),
+			_posted(0),
+			_done(0),
+			_lastFailed(0),
+			_lastFlushed(0),
+			_flushWaiters(0),
+			_commits(0),
+			_stop(false) {
+			_thread = boost::thread(boost::bind(&DatabaseWriter::Run, this));
+		}
+
+		DatabaseWriter::~DatabaseWriter() {
+			Stop();
+		}
+
+		void DatabaseWriter::Post(const Job &job) {
+			boost::mutex::scoped_lock scopedLock(_lock);
+			if (_stop) {
+				scopedLock.unlock();
+				std::deque<Job> jobs(1, job);
+				bool committed = RunBatch(jobs);
+				scopedLock.lock();
+				_posted++;
+				_done++;
+				if (!committed)
+					_lastFailed = _done;
+				return;
+			}
+
+			_jobs.push_back(job);
+			_posted++;
+			if (_jobs.size() == 1 || _jobs.size() >= _batchSize)
+				_jobCond.notify_one();
+		}
+
+		void DatabaseWriter::Wait() {
+			boost::mutex::scoped_lock scopedLock(_lock);
+			WaitFor(scopedLock, _posted);
+		}
+
+		bool DatabaseWriter::Flush() {
+			boost::mutex::scoped_lock scopedLock(_lock);
+			uint64_t target = _posted;
+
+			WaitFor(scopedLock, target);
+			bool result = _lastFailed <= _lastFlushed;
+			if (target > _lastFlushed)
+				_lastFlushed = target;
+			return result;
+		}
+
+		void DatabaseWriter::Stop() {
+			{
+				boost::mutex::scoped_lock scopedLock(_lock);
+				if (_stop)
+					return;
+				_stop = true;
+				_jobCond.notify_one();
+			}
+
+			if (_thread.joinable())
+				_thread.join();
+		}
+
+		size_t DatabaseWriter::GetCommitCount() const {
+			boost::mutex::scoped_lock scopedLock(_lock);
+			return _commits;
+		}
+
+		void DatabaseWriter::WaitFor(boost::mutex::scoped_lock &scopedLock, uint64_t target) {
+			_flushWaiters++;
+			_jobCond.notify_one();
+			while (_done < target)
+				_doneCond.wait(scopedLock);
+			_flushWaiters--;
+		}
+
+		bool DatabaseWriter::RunBatch(const std::deque<Job> &jobs) {
+			if (!_sqlite->BeginTransaction(IMMEDIATE)) {
+				Log::error("database writer: begin transaction failed, {} writes dropped", jobs.size());
+				_sqlite->RollbackTransaction();
+				return false;
+			}
+
+			for (std::deque<Job>::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
+				bool ok = false;
+				try {
+					ok = (*it)();
+				} catch (const std::exception &e) {
+					Log::error("database writer error: {}", e.what());
+				}
+
+				if (!ok) {
+					Log::error("database writer: write {} of {} failed, batch rolled back", it - jobs.begin() + 1,
+							   jobs.size());
+					_sqlite->RollbackTransaction();
+					return false;
+				}
+			}
+
+			if (!_sqlite->EndTransaction()) {
+				Log::error("database writer: commit failed, {} writes dropped", jobs.size());
+				return false;
+			}
+
+			return true;
+		}
+
+		void DatabaseWriter::Run() {
+			boost::mutex::scoped_lock scopedLock(_lock);
+
+			while (true) {
+				while (_jobs.empty() && !_stop)
+					_jobCond.wait(scopedLock);
+
+				if (_jobs.empty())
+					break;
+
+				// collect more jobs for this commit, unless somebody is waiting for them
+				boost::system_time deadline = boost::get_system_time() + _window;
+				while (!_stop && _flushWaiters == 0 && _jobs.size() < _batchSize) {
+					if (!_jobCond.timed_wait(scopedLock, deadline))
+						break;
+				}
+
+				std::deque<Job> jobs;
+				jobs.swap(_jobs);
+				scopedLock.unlock();
+
+				bool committed = RunBatch(jobs);
+
+				scopedLock.lock();
+				_done += jobs.size();
+				if (committed)
+					_commits++;
+				else
+					_lastFailed = _done;
+				_doneCond.notify_all();
+			}
+		}
+
+	}
+}
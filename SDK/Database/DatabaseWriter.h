@@ -0,0 +1,73 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_DATABASEWRITER_H__
+#define __ELASTOS_SDK_DATABASEWRITER_H__
+
+#include "Sqlite.h"
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <deque>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Runs database writes on its own thread. Writes posted within the window, or until batchSize of them are
+		 * queued, are committed together in one sqlite transaction, in the order they were posted. A job which returns
+		 * false or throws rolls back the whole batch, the failure is reported by the next Flush().
+		 */
+		class DatabaseWriter {
+		public:
+			typedef boost::function<bool()> Job;
+
+			DatabaseWriter(Sqlite *sqlite, size_t batchSize, uint32_t windowMs);
+
+			~DatabaseWriter();
+
+			void Post(const Job &job);
+
+			// block until every job posted before this call is done
+			void Wait();
+
+			// Wait(), then return false if any job done since the previous Flush() was rolled back
+			bool Flush();
+
+			// commit what is queued and stop the thread, later jobs run on the caller
+			void Stop();
+
+			size_t GetCommitCount() const;
+
+		private:
+			void WaitFor(boost::mutex::scoped_lock &scopedLock, uint64_t target);
+
+			bool RunBatch(const std::deque<Job> &jobs);
+
+			void Run();
+
+		private:
+			Sqlite *_sqlite;
+			size_t _batchSize;
+			boost::posix_time::milliseconds _window;
+
+			mutable boost::mutex _lock;
+			boost::condition_variable _jobCond;
+			boost::condition_variable _doneCond;
+			std::deque<Job> _jobs;
+			uint64_t _posted;
+			uint64_t _done;
+			uint64_t _lastFailed;
+			uint64_t _lastFlushed;
+			size_t _flushWaiters;
+			size_t _commits;
+			bool _stop;
+
+			boost::thread _thread;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_DATABASEWRITER_H__
@@ -50,13 +50,7 @@ namespace Elastos {
 
 		bool
 		MerkleBlockDataSource::PutMerkleBlockInternal(const std::string &iso, const MerkleBlockPtr &blockPtr) {
-			std::string sql;
-
-			sql = "INSERT INTO " + MB_TABLE_NAME + " (" + MB_BUFF + "," + MB_HEIGHT + "," + MB_ISO + ") VALUES (?, ?, ?);";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-										 "prepare sql " + sql);
+			CachedStatement stmt = PrepareCached(MB_INSERT);
 
 			ByteStream stream;
 			blockPtr->Serialize(stream);
@@ -65,7 +59,7 @@ namespace Elastos {
 			_sqlite->BindText(stmt, 3, iso, nullptr);
 
 			_sqlite->Step(stmt);
-			_sqlite->Finalize(stmt);
+			_sqlite->Reset(stmt);
 			return true;
 		}
 
@@ -50,6 +50,9 @@ namespace Elastos {
 				MB_BUFF + " blob, " +
 				MB_HEIGHT + " integer, " +
 				MB_ISO + " text DEFAULT 'ELA');";
+
+			const std::string MB_INSERT = "INSERT INTO " + MB_TABLE_NAME + " (" + MB_BUFF + "," + MB_HEIGHT + "," +
+				MB_ISO + ") VALUES (?, ?, ?);";
 		};
 
 	}
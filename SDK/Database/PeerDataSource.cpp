@@ -43,18 +43,7 @@ namespace Elastos {
 		}
 
 		bool PeerDataSource::PutPeerInternal(const std::string &iso, const PeerEntity &peerEntity) {
-			std::stringstream ss;
-
-			ss << "INSERT INTO " << PEER_TABLE_NAME << " (" <<
-			   PEER_ADDRESS << "," <<
-			   PEER_PORT << "," <<
-			   PEER_TIMESTAMP << "," <<
-			   PEER_ISO <<
-			   ") VALUES (?, ?, ?, ?);";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(ss.str(), &stmt, nullptr), Error::SqliteError,
-										 "Prepare sql " + ss.str());
+			CachedStatement stmt = PrepareCached(PEER_INSERT);
 
 			_sqlite->BindBlob(stmt, 1, peerEntity.address.begin(), peerEntity.address.size(), nullptr);
 			_sqlite->BindInt(stmt, 2, peerEntity.port);
@@ -63,7 +52,7 @@ namespace Elastos {
 
 			_sqlite->Step(stmt);
 
-			_sqlite->Finalize(stmt);
+			_sqlite->Reset(stmt);
 
 			return true;
 		}
@@ -73,6 +73,9 @@ namespace Elastos {
 				PEER_PORT + " integer," +
 				PEER_TIMESTAMP + " integer," +
 				PEER_ISO + " text default 'ELA');";
+
+			const std::string PEER_INSERT = "INSERT INTO " + PEER_TABLE_NAME + " (" + PEER_ADDRESS + "," + PEER_PORT +
+				"," + PEER_TIMESTAMP + "," + PEER_ISO + ") VALUES (?, ?, ?, ?);";
 		};
 
 	}
@@ -13,10 +13,26 @@
 namespace Elastos {
 	namespace ElaWallet {
 
-		Sqlite::Sqlite(const boost::filesystem::path &path) {
+		SqliteConfig::SqliteConfig() :
+			walMode(false),
+			synchronous(SYNCHRONOUS_FULL),
+			cacheSizeKB(0),
+			mmapSize(0) {
+		}
+
+		Sqlite::Sqlite(const boost::filesystem::path &path) :
+			_dataBasePtr(NULL),
+			_txDepth(0) {
 			open(path);
 		}
 
+		Sqlite::Sqlite(const boost::filesystem::path &path, const SqliteConfig &config) :
+			_dataBasePtr(NULL),
+			_txDepth(0) {
+			if (open(path))
+				ApplyConfig(config);
+		}
+
 		Sqlite::~Sqlite() {
 			close();
 		}
@@ -47,11 +63,24 @@ namespace Elastos {
 
 		bool Sqlite::BeginTransaction(SqliteTransactionType type) {
 			_lockMutex.lock();
+			if (_txDepth++ > 0)
+				return true;
+
 			return exec("BEGIN " + GetTxTypeString(type) + " TRANSACTION;", nullptr, nullptr);
 		}
 
 		bool Sqlite::EndTransaction() {
-			bool result = exec("COMMIT;", nullptr, nullptr);
+			bool result = true;
+			if (--_txDepth == 0)
+				result = exec("COMMIT;", nullptr, nullptr);
+			_lockMutex.unlock();
+			return result;
+		}
+
+		bool Sqlite::RollbackTransaction() {
+			bool result = true;
+			if (--_txDepth == 0)
+				result = exec("ROLLBACK;", nullptr, nullptr);
 			_lockMutex.unlock();
 			return result;
 		}
@@ -76,10 +105,32 @@ namespace Elastos {
 			return true;
 		}
 
+		bool Sqlite::PrepareCached(const std::string &sql, sqlite3_stmt **ppStmt) {
+			boost::mutex::scoped_lock scopedLock(_stmtMutex);
+
+			std::map<std::string, sqlite3_stmt *>::iterator it = _stmtCache.find(sql);
+			if (it != _stmtCache.end()) {
+				sqlite3_reset(it->second);
+				sqlite3_clear_bindings(it->second);
+				*ppStmt = it->second;
+				return true;
+			}
+
+			if (!Prepare(sql, ppStmt, nullptr))
+				return false;
+
+			_stmtCache[sql] = *ppStmt;
+			return true;
+		}
+
 		int Sqlite::Step(sqlite3_stmt *pStmt) {
 			return sqlite3_step(pStmt);
 		}
 
+		bool Sqlite::Reset(sqlite3_stmt *pStmt) {
+			return IsValid() && SQLITE_OK == sqlite3_reset(pStmt);
+		}
+
 		bool Sqlite::Finalize(sqlite3_stmt *pStmt) {
 			return IsValid() && SQLITE_OK == sqlite3_finalize(pStmt);
 		}
@@ -112,6 +163,10 @@ namespace Elastos {
 			return IsValid() && SQLITE_OK == sqlite3_bind_text(pStmt, idx, text.c_str(), text.length(), callBack);
 		}
 
+		bool Sqlite::BindValue(sqlite3_stmt *pStmt, int idx, const sqlite3_value *value) {
+			return IsValid() && SQLITE_OK == sqlite3_bind_value(pStmt, idx, value);
+		}
+
 		void Sqlite::flush() {
 			if (SQLITE_OK != sqlite3_db_cacheflush(_dataBasePtr)) {
 				Log::error("sqlite flush to disk error");
@@ -155,6 +210,23 @@ namespace Elastos {
 			return sqlite3_column_bytes(pStmt, iCol);
 		}
 
+		int Sqlite::ColumnCount(sqlite3_stmt *pStmt) {
+			return sqlite3_column_count(pStmt);
+		}
+
+		std::string Sqlite::ColumnName(sqlite3_stmt *pStmt, int iCol) {
+			const char *name = sqlite3_column_name(pStmt, iCol);
+			return name ? std::string(name) : std::string();
+		}
+
+		int Sqlite::ColumnType(sqlite3_stmt *pStmt, int iCol) {
+			return sqlite3_column_type(pStmt, iCol);
+		}
+
+		sqlite3_value *Sqlite::ColumnValue(sqlite3_stmt *pStmt, int iCol) {
+			return sqlite3_column_value(pStmt, iCol);
+		}
+
 		std::string Sqlite::GetTxTypeString(SqliteTransactionType type) {
 			if (type == DEFERRED) {
 				return "DEFERRED";
@@ -191,7 +263,29 @@ namespace Elastos {
 			return true;
 		}
 
+		void Sqlite::ApplyConfig(const SqliteConfig &config) {
+			if (config.walMode) {
+				exec("PRAGMA journal_mode=WAL;", nullptr, nullptr);
+				// the writer and read connections only contend on checkpoints
+				sqlite3_busy_timeout(_dataBasePtr, 5000);
+			}
+
+			exec("PRAGMA synchronous=" + std::to_string((int)config.synchronous) + ";", nullptr, nullptr);
+
+			// negative cache_size is in KiB
+			if (config.cacheSizeKB > 0)
+				exec("PRAGMA cache_size=-" + std::to_string(config.cacheSizeKB) + ";", nullptr, nullptr);
+
+			if (config.mmapSize > 0)
+				exec("PRAGMA mmap_size=" + std::to_string(config.mmapSize) + ";", nullptr, nullptr);
+		}
+
 		void Sqlite::close() {
+			boost::mutex::scoped_lock scopedLock(_stmtMutex);
+			for (std::map<std::string, sqlite3_stmt *>::iterator it = _stmtCache.begin(); it != _stmtCache.end(); ++it)
+				sqlite3_finalize(it->second);
+			_stmtCache.clear();
+
 			if (_dataBasePtr != NULL) {
 				sqlite3_close_v2(_dataBasePtr);
 				_dataBasePtr = NULL;
@@ -10,6 +10,8 @@
 #include <sqlite3.h>
 #include <boost/filesystem.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <map>
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -23,9 +25,72 @@ namespace Elastos {
 			EXCLUSIVE
 		} SqliteTransactionType;
 
+		typedef enum {
+			SYNCHRONOUS_OFF,
+			SYNCHRONOUS_NORMAL,
+			SYNCHRONOUS_FULL
+		} SqliteSynchronous;
+
+		struct SqliteConfig {
+			SqliteConfig();
+
+			// journal_mode=WAL, readers on other connections do not block the writer
+			bool walMode;
+			// power loss may roll back the last commits with NORMAL in WAL mode, the db stays consistent
+			SqliteSynchronous synchronous;
+			// page cache per connection, 0 keep the sqlite default
+			int cacheSizeKB;
+			// bytes of the db file to mmap, 0 disabled
+			int64_t mmapSize;
+		};
+
+		/*
+		 * Statement handed out by the cache of a connection. It is reset when it goes out of scope, so it goes back
+		 * to the cache idle whichever way the caller leaves, an exception between two steps included.
+		 */
+		class CachedStatement {
+		public:
+			CachedStatement() : _stmt(nullptr) {}
+
+			explicit CachedStatement(sqlite3_stmt *stmt) : _stmt(stmt) {}
+
+			CachedStatement(CachedStatement &&other) : _stmt(other._stmt) {
+				other._stmt = nullptr;
+			}
+
+			~CachedStatement() {
+				Release();
+			}
+
+			CachedStatement &operator=(CachedStatement &&other) {
+				if (this != &other) {
+					Release();
+					_stmt = other._stmt;
+					other._stmt = nullptr;
+				}
+				return *this;
+			}
+
+			operator sqlite3_stmt *() const { return _stmt; }
+
+		private:
+			CachedStatement(const CachedStatement &) = delete;
+
+			CachedStatement &operator=(const CachedStatement &) = delete;
+
+			void Release() {
+				if (_stmt != nullptr)
+					sqlite3_reset(_stmt);
+			}
+
+		private:
+			sqlite3_stmt *_stmt;
+		};
+
 		class Sqlite {
 		public:
 			Sqlite(const boost::filesystem::path &path);
+			Sqlite(const boost::filesystem::path &path, const SqliteConfig &config);
 			~Sqlite();
 
 			bool IsValid();
@@ -36,11 +101,24 @@ namespace Elastos {
 			 */
 			bool exec(const std::string &sql, ExecCallBack callBack, void *arg);
 
+			/*
+			 * Transactions nest on the same thread, only the outermost pair issue BEGIN and COMMIT. So a caller may
+			 * batch many store operations, each of which opens its own transaction, into one commit. Rollback ends the
+			 * pair like EndTransaction, but throws away the outermost transaction instead of committing it.
+			 */
 			bool BeginTransaction(SqliteTransactionType type);
 			bool EndTransaction();
+			bool RollbackTransaction();
 
 			bool Prepare(const std::string &sql, sqlite3_stmt **ppStmt, const char **pzTail);
+			/*
+			 * Prepare sql once per connection and hand out the same statement afterwards, reset and with bindings
+			 * cleared. The statement is owned by the connection, never finalize it; wrap it in a CachedStatement so it
+			 * is reset when done.
+			 */
+			bool PrepareCached(const std::string &sql, sqlite3_stmt **ppStmt);
 			int Step(sqlite3_stmt *pStmt);
+			bool Reset(sqlite3_stmt *pStmt);
 			bool Finalize(sqlite3_stmt *pStmt);
 			bool BindBlob(sqlite3_stmt *pStmt, int idx, const bytes_t &blob, BindCallBack callBack);
 			bool BindBlob(sqlite3_stmt *pStmt, int idx, const void *blob, size_t size, BindCallBack callBack);
@@ -49,6 +127,7 @@ namespace Elastos {
 			bool BindInt64(sqlite3_stmt *pStmt, int idx, int64_t i);
 			bool BindNull(sqlite3_stmt *pStmt, int idx);
 			bool BindText(sqlite3_stmt *pStmt, int idx, const std::string &text, BindCallBack callBack);
+			bool BindValue(sqlite3_stmt *pStmt, int idx, const sqlite3_value *value);
 
 			void flush();
 
@@ -59,15 +138,23 @@ namespace Elastos {
 			int64_t ColumnInt64(sqlite3_stmt *pStmt, int iCol);
 			std::string ColumnText(sqlite3_stmt *pStmt, int iCol);
 			int ColumnBytes(sqlite3_stmt *pStmt, int iCol);
+			int ColumnCount(sqlite3_stmt *pStmt);
+			std::string ColumnName(sqlite3_stmt *pStmt, int iCol);
+			int ColumnType(sqlite3_stmt *pStmt, int iCol);
+			sqlite3_value *ColumnValue(sqlite3_stmt *pStmt, int iCol);
 
 		private:
 			std::string GetTxTypeString(SqliteTransactionType type);
 			bool open(const boost::filesystem::path &path);
+			void ApplyConfig(const SqliteConfig &config);
 			void close();
 
 		private:
 			sqlite3 *_dataBasePtr;
-			mutable boost::mutex _lockMutex;
+			mutable boost::recursive_mutex _lockMutex;
+			int _txDepth;
+			boost::mutex _stmtMutex;
+			std::map<std::string, sqlite3_stmt *> _stmtCache;
 		};
 
 	}
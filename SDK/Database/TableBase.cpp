@@ -5,6 +5,10 @@
 #include "TableBase.h"
 
 #include <SDK/Common/Log.h>
+#include <SDK/Common/ErrorChecker.h>
+#include <SDK/Common/uint256.h>
+
+#include <boost/algorithm/string.hpp>
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -46,5 +50,86 @@ namespace Elastos {
 			_sqlite->exec(constructScript, nullptr, nullptr);
 			_sqlite->EndTransaction();
 		}
+
+		CachedStatement TableBase::PrepareCached(const std::string &sql) const {
+			sqlite3_stmt *stmt;
+			ErrorChecker::CheckCondition(!_sqlite->PrepareCached(sql, &stmt), Error::SqliteError, "Prepare sql " + sql);
+			return CachedStatement(stmt);
+		}
+
+		void TableBase::MigrateHashColumn(const std::string &tableName, const std::string &hashColumn,
+										  const std::string &constructScript) {
+			std::string hashType;
+			std::vector<std::string> columns;
+			std::string sql = "PRAGMA table_info(" + tableName + ");";
+
+			sqlite3_stmt *stmt;
+			if (!_sqlite->Prepare(sql, &stmt, nullptr))
+				return;
+
+			// cid, name, type, notnull, dflt_value, pk
+			while (SQLITE_ROW == _sqlite->Step(stmt)) {
+				std::string name = _sqlite->ColumnText(stmt, 1);
+				if (name == hashColumn)
+					hashType = boost::algorithm::to_lower_copy(_sqlite->ColumnText(stmt, 2));
+				columns.push_back(name);
+			}
+			_sqlite->Finalize(stmt);
+
+			if (hashType.empty() || hashType == "blob")
+				return;
+
+			Log::info("migrate {}.{} from {} to blob", tableName, hashColumn, hashType);
+			bool result = DoTransaction([&tableName, &hashColumn, &constructScript, &columns, this]() {
+				std::string oldTableName = tableName + "_old";
+				std::string columnList, params, sql;
+				int hashIndex = -1;
+
+				for (size_t i = 0; i < columns.size(); ++i) {
+					columnList += (i == 0 ? "" : ", ") + columns[i];
+					params += i == 0 ? "?" : ", ?";
+					if (columns[i] == hashColumn)
+						hashIndex = (int) i;
+				}
+
+				sql = "ALTER TABLE " + tableName + " RENAME TO " + oldTableName + ";";
+				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError, "Exec sql " + sql);
+				ErrorChecker::CheckCondition(!_sqlite->exec(constructScript, nullptr, nullptr), Error::SqliteError,
+											 "Exec sql " + constructScript);
+
+				sqlite3_stmt *select, *insert;
+				sql = "SELECT " + columnList + " FROM " + oldTableName + ";";
+				ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &select, nullptr), Error::SqliteError,
+											 "Prepare sql " + sql);
+				sql = "INSERT OR REPLACE INTO " + tableName + " (" + columnList + ") VALUES (" + params + ");";
+				if (!_sqlite->Prepare(sql, &insert, nullptr)) {
+					_sqlite->Finalize(select);
+					ErrorChecker::ThrowLogicException(Error::SqliteError, "Prepare sql " + sql);
+				}
+
+				while (SQLITE_ROW == _sqlite->Step(select)) {
+					for (int i = 0; i < (int) columns.size(); ++i) {
+						if (i == hashIndex) {
+							uint256 hash(_sqlite->ColumnText(select, i));
+							_sqlite->BindBlob(insert, i + 1, hash.begin(), hash.size(), SQLITE_TRANSIENT);
+						} else {
+							_sqlite->BindValue(insert, i + 1, _sqlite->ColumnValue(select, i));
+						}
+					}
+
+					_sqlite->Step(insert);
+					_sqlite->Reset(insert);
+				}
+
+				_sqlite->Finalize(insert);
+				_sqlite->Finalize(select);
+
+				sql = "DROP TABLE " + oldTableName + ";";
+				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError, "Exec sql " + sql);
+			});
+
+			if (!result)
+				Log::error("migrate {}.{} fail", tableName, hashColumn);
+		}
 	}
 }
\ No newline at end of file
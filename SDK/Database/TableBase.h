@@ -27,6 +27,17 @@ namespace Elastos {
 
 			bool DoTransaction(const boost::function<void()> &fun) const;
 
+			// cached statement of this connection, reset when the result goes out of scope; throw if prepare fail
+			CachedStatement PrepareCached(const std::string &sql) const;
+
+			/*
+			 * Tables created by older versions keep tx hashes as hex text. Rebuild tableName with constructScript
+			 * and copy every row over, converting hashColumn to the 32 bytes of uint256. Do nothing if the column
+			 * is already a blob or the table does not exist.
+			 */
+			void MigrateHashColumn(const std::string &tableName, const std::string &hashColumn,
+								   const std::string &constructScript);
+
 		protected:
 			Sqlite *_sqlite;
 			SqliteTransactionType _txType;
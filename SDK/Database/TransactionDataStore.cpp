@@ -8,6 +8,8 @@
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/ErrorChecker.h>
 #include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Plugin/Transaction/TransactionInput.h>
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
 
 #include <string>
 #include <string>
@@ -19,38 +21,28 @@ namespace Elastos {
 
 		TransactionDataStore::TransactionDataStore(Sqlite *sqlite) :
 			TableBase(sqlite) {
-			InitializeTable(TX_DATABASE_CREATE);
+			MigrateHashColumn(TX_TABLE_NAME, TX_COLUMN_ID, TX_DATABASE_CREATE);
+			InitializeTable(TX_DATABASE_CREATE + TX_INDEX_CREATE + ADDR_DATABASE_CREATE + SPENT_DATABASE_CREATE);
+			BuildIndexes();
 		}
 
 		TransactionDataStore::TransactionDataStore(SqliteTransactionType type, Sqlite *sqlite) :
 			TableBase(type, sqlite) {
-			InitializeTable(TX_DATABASE_CREATE);
+			MigrateHashColumn(TX_TABLE_NAME, TX_COLUMN_ID, TX_DATABASE_CREATE);
+			InitializeTable(TX_DATABASE_CREATE + TX_INDEX_CREATE + ADDR_DATABASE_CREATE + SPENT_DATABASE_CREATE);
+			BuildIndexes();
 		}
 
 		TransactionDataStore::~TransactionDataStore() {
 		}
 
 		void TransactionDataStore::PutTransactionInternal(const std::string &iso, const TransactionPtr &tx) {
-			std::string sql, txHash;
-
-			sql = "INSERT INTO " + TX_TABLE_NAME + "("
-				  + TX_COLUMN_ID + ","
-				  + TX_BUFF + ","
-				  + TX_BLOCK_HEIGHT + ","
-				  + TX_TIME_STAMP + ","
-				  + TX_REMARK + ","
-				  + TX_ASSETID + ","
-				  + TX_ISO
-				  + ") VALUES (?, ?, ?, ?, ?, ?, ?);";
-
-			sqlite3_stmt *stmt;
-			ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-										 "Prepare sql " + sql);
+			CachedStatement stmt = PrepareCached(TX_INSERT);
 			ByteStream stream;
 			tx->Serialize(stream, true);
 
-			txHash = tx->GetHash().GetHex();
-			_sqlite->BindText(stmt, 1, txHash, nullptr);
+			const uint256 &txHash = tx->GetHash();
+			_sqlite->BindBlob(stmt, 1, txHash.begin(), txHash.size(), nullptr);
 			_sqlite->BindBlob(stmt, 2, stream.GetBytes(), nullptr);
 			_sqlite->BindInt(stmt, 3, tx->GetBlockHeight());
 			_sqlite->BindInt64(stmt, 4, tx->GetTimestamp());
@@ -60,13 +52,115 @@ namespace Elastos {
 
 			_sqlite->Step(stmt);
 
-			_sqlite->Finalize(stmt);
+			_sqlite->Reset(stmt);
+
+			DeleteIndexes(txHash);
+			IndexOutputs(tx);
+			IndexInputs(tx);
+		}
+
+		void TransactionDataStore::IndexOutputs(const TransactionPtr &tx) {
+			CachedStatement stmt = PrepareCached(ADDR_INSERT);
+			const uint256 &txHash = tx->GetHash();
+			const OutputArray &outputs = tx->GetOutputs();
+
+			for (size_t i = 0; i < outputs.size(); ++i) {
+				const uint168 &programHash = outputs[i]->ProgramHash();
+				_sqlite->BindBlob(stmt, 1, txHash.begin(), txHash.size(), nullptr);
+				_sqlite->BindInt(stmt, 2, 0);
+				_sqlite->BindInt(stmt, 3, outputs[i]->FixedIndex());
+				_sqlite->BindBlob(stmt, 4, programHash.begin(), programHash.size(), nullptr);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+											 "Exec sql " + ADDR_INSERT);
+				_sqlite->Reset(stmt);
+			}
+		}
+
+		void TransactionDataStore::IndexInputs(const TransactionPtr &tx) {
+			CachedStatement select = PrepareCached(ADDR_SELECT_OUTPUT);
+			CachedStatement spent = PrepareCached(SPENT_INSERT);
+			const uint256 &txHash = tx->GetHash();
+			const InputArray &inputs = tx->GetInputs();
+
+			for (size_t i = 0; i < inputs.size(); ++i) {
+				const uint256 &prevHash = inputs[i]->TxHash();
+				bytes_ptr programHash;
+
+				_sqlite->BindBlob(spent, 1, prevHash.begin(), prevHash.size(), nullptr);
+				_sqlite->BindInt(spent, 2, inputs[i]->Index());
+				_sqlite->BindBlob(spent, 3, txHash.begin(), txHash.size(), nullptr);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(spent), Error::SqliteError,
+											 "Exec sql " + SPENT_INSERT);
+				_sqlite->Reset(spent);
+
+				_sqlite->BindBlob(select, 1, prevHash.begin(), prevHash.size(), nullptr);
+				_sqlite->BindInt(select, 2, inputs[i]->Index());
+				if (SQLITE_ROW == _sqlite->Step(select))
+					programHash = _sqlite->ColumnBlobBytes(select, 0);
+				_sqlite->Reset(select);
+
+				if (programHash == nullptr)
+					continue;
+
+				CachedStatement stmt = PrepareCached(ADDR_INSERT);
+				_sqlite->BindBlob(stmt, 1, txHash.begin(), txHash.size(), nullptr);
+				_sqlite->BindInt(stmt, 2, 1);
+				_sqlite->BindInt(stmt, 3, (int) i);
+				_sqlite->BindBlob(stmt, 4, *programHash, nullptr);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+											 "Exec sql " + ADDR_INSERT);
+				_sqlite->Reset(stmt);
+			}
+		}
+
+		void TransactionDataStore::DeleteIndexes(const uint256 &hash) {
+			CachedStatement stmt = PrepareCached(ADDR_DELETE);
+
+			_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
+			ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+										 "Exec sql " + ADDR_DELETE);
+			_sqlite->Reset(stmt);
+
+			stmt = PrepareCached(SPENT_DELETE);
+			_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
+			ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+										 "Exec sql " + SPENT_DELETE);
+			_sqlite->Reset(stmt);
+		}
+
+		void TransactionDataStore::BuildIndexes() {
+			DoTransaction([this]() {
+				CachedStatement stmt = PrepareCached("SELECT (EXISTS (SELECT 1 FROM " + ADDR_TABLE_NAME +
+												   ") AND EXISTS (SELECT 1 FROM " + SPENT_TABLE_NAME +
+												   ")) OR NOT EXISTS (SELECT 1 FROM " + TX_TABLE_NAME + ");");
+				bool built = SQLITE_ROW == _sqlite->Step(stmt) && _sqlite->ColumnInt(stmt, 0) != 0;
+				_sqlite->Reset(stmt);
+
+				if (built)
+					return;
+
+				Log::info("building transaction address and spent index");
+				std::string sql = "DELETE FROM " + ADDR_TABLE_NAME + ";" + "DELETE FROM " + SPENT_TABLE_NAME + ";";
+				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
+											 "Exec sql " + sql);
+
+				std::vector<TransactionPtr> txns;
+				stmt = PrepareCached(TX_SELECT + ";");
+				while (SQLITE_ROW == _sqlite->Step(stmt))
+					txns.push_back(ReadTransaction(stmt));
+				_sqlite->Reset(stmt);
+
+				// every output first, so inputs find what they spend whatever order the rows come in
+				for (size_t i = 0; i < txns.size(); ++i)
+					this->IndexOutputs(txns[i]);
+				for (size_t i = 0; i < txns.size(); ++i)
+					this->IndexInputs(txns[i]);
+			});
 		}
 
 		bool TransactionDataStore::PutTransaction(const std::string &iso, const TransactionPtr &tx) {
 #ifdef SPDLOG_DEBUG_ON
-			std::string txHash = tx->GetHash().GetHex();
-			if (SelectTxByHash(txHash)) {
+			if (SelectTxByHash(tx->GetHash())) {
 				Log::error("should not put in existed tx {}", tx->GetHash().GetHex());
 				return false;
 			}
@@ -92,7 +186,8 @@ namespace Elastos {
 			return DoTransaction([this]() {
 				std::string sql;
 
-				sql = "DELETE FROM " + TX_TABLE_NAME + ";";
+				sql = "DELETE FROM " + TX_TABLE_NAME + ";" + "DELETE FROM " + ADDR_TABLE_NAME + ";" +
+					  "DELETE FROM " + SPENT_TABLE_NAME + ";";
 
 				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
 											 "Exec sql " + sql);
@@ -125,48 +220,13 @@ namespace Elastos {
 		std::vector<TransactionPtr> TransactionDataStore::GetAllTransactions() const {
 			std::vector<TransactionPtr> txns;
 			DoTransaction([&txns, this]() {
-				std::string sql;
-
-				sql = "SELECT "
-					  + TX_COLUMN_ID + ","
-					  + TX_BUFF + ","
-					  + TX_BLOCK_HEIGHT + ","
-					  + TX_TIME_STAMP + ","
-					  + TX_ISO
-					  + " FROM " + TX_TABLE_NAME + ";";
-
-				sqlite3_stmt *stmt;
-				ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-											 "Prepare sql " + sql);
+				CachedStatement stmt = PrepareCached(TX_SELECT + ";");
 
 				while (SQLITE_ROW == _sqlite->Step(stmt)) {
-					TransactionPtr tx(new Transaction());
-
-					uint256 txHash(_sqlite->ColumnText(stmt, 0));
-
-					const uint8_t *pdata = (const uint8_t *) _sqlite->ColumnBlob(stmt, 1);
-					size_t len = (size_t) _sqlite->ColumnBytes(stmt, 1);
-					ByteStream stream(pdata, len);
-
-					uint32_t blockHeight = (uint32_t) _sqlite->ColumnInt(stmt, 2);
-					uint32_t timeStamp = (uint32_t) _sqlite->ColumnInt(stmt, 3);
-					std::string iso = _sqlite->ColumnText(stmt, 4);
-
-					if (iso == "ela") {
-						tx->Deserialize(stream);
-						assert(txHash == tx->GetHash());
-					} else if (iso == "ela1") {
-						tx->Deserialize(stream, true);
-						tx->SetHash(txHash);
-					}
-
-					tx->SetBlockHeight(blockHeight);
-					tx->SetTimestamp(timeStamp);
-
-					txns.push_back(tx);
+					txns.push_back(ReadTransaction(stmt));
 				}
 
-				_sqlite->Finalize(stmt);
+				_sqlite->Reset(stmt);
 			});
 			return txns;
 		}
@@ -174,36 +234,31 @@ namespace Elastos {
 		bool TransactionDataStore::UpdateTransaction(const std::vector<uint256> &hashes, uint32_t blockHeight,
 													 time_t timestamp) {
 			return DoTransaction([&hashes, &blockHeight, &timestamp, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(TX_UPDATE);
 
 				for (size_t i = 0; i < hashes.size(); ++i) {
-					sql = "UPDATE " + TX_TABLE_NAME + " SET "
-						  + TX_BLOCK_HEIGHT + " = ?, "
-						  + TX_TIME_STAMP + " = ? "
-						  + " WHERE " + TX_COLUMN_ID + " = '" + hashes[i].GetHex() + "';";
-
-					sqlite3_stmt *stmt;
-					ErrorChecker::CheckLogic(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-											 "Prepare sql " + sql);
-
 					ErrorChecker::CheckLogic(!_sqlite->BindInt(stmt, 1, blockHeight), Error::SqliteError, "bindint");
 					ErrorChecker::CheckLogic(!_sqlite->BindInt64(stmt, 2, timestamp), Error::SqliteError, "bindint64");
+					ErrorChecker::CheckLogic(!_sqlite->BindBlob(stmt, 3, hashes[i].begin(), hashes[i].size(), nullptr),
+											 Error::SqliteError, "bindblob");
 
 					_sqlite->Step(stmt);
 
-					ErrorChecker::CheckLogic(!_sqlite->Finalize(stmt), Error::SqliteError, "finalize");
+					ErrorChecker::CheckLogic(!_sqlite->Reset(stmt), Error::SqliteError, "reset");
 				}
 			});
 		}
 
 		bool TransactionDataStore::DeleteTxByHash(const uint256 &hash) {
 			return DoTransaction([&hash, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(TX_DELETE);
 
-				sql = "DELETE FROM " + TX_TABLE_NAME + " WHERE " + TX_COLUMN_ID + " = '" + hash.GetHex() + "';";
+				_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+											 "Exec sql " + TX_DELETE);
+				_sqlite->Reset(stmt);
 
-				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
-											 "Exec sql " + sql);
+				this->DeleteIndexes(hash);
 			});
 		}
 
@@ -212,60 +267,219 @@ namespace Elastos {
 				return true;
 
 			return DoTransaction([&hashes, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(TX_DELETE);
+
+				for (size_t i = 0; i < hashes.size(); ++i) {
+					_sqlite->BindBlob(stmt, 1, hashes[i].begin(), hashes[i].size(), nullptr);
+					ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+												 "Exec sql " + TX_DELETE);
+					_sqlite->Reset(stmt);
+
+					this->DeleteIndexes(hashes[i]);
+				}
+			});
+		}
+
+		std::vector<TransactionPtr> TransactionDataStore::GetTransactions(size_t offset, size_t limit) const {
+			std::vector<TransactionPtr> txns;
+
+			DoTransaction([&offset, &limit, &txns, this]() {
+				CachedStatement stmt = PrepareCached(TX_SELECT + TX_ORDER + " LIMIT ? OFFSET ?;");
+
+				_sqlite->BindInt64(stmt, 1, limit);
+				_sqlite->BindInt64(stmt, 2, offset);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					txns.push_back(ReadTransaction(stmt));
+				}
+
+				_sqlite->Reset(stmt);
+			});
+
+			return txns;
+		}
+
+		std::vector<TransactionPtr> TransactionDataStore::GetTransactionsByAddress(const uint168 &programHash,
+																				   size_t offset, size_t limit) const {
+			std::vector<TransactionPtr> txns;
+
+			DoTransaction([&programHash, &offset, &limit, &txns, this]() {
+				CachedStatement stmt = PrepareCached(TX_SELECT + " WHERE " + TX_COLUMN_ID + " IN (" + ADDR_TX_HASHES +
+												   ")" + TX_ORDER + " LIMIT ? OFFSET ?;");
+
+				_sqlite->BindBlob(stmt, 1, programHash.begin(), programHash.size(), nullptr);
+				_sqlite->BindInt64(stmt, 2, limit);
+				_sqlite->BindInt64(stmt, 3, offset);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					txns.push_back(ReadTransaction(stmt));
+				}
+
+				_sqlite->Reset(stmt);
+			});
+
+			return txns;
+		}
+
+		size_t TransactionDataStore::GetTransactionsCountByAddress(const uint168 &programHash) const {
+			size_t count = 0;
+
+			DoTransaction([&programHash, &count, this]() {
+				CachedStatement stmt = PrepareCached("SELECT COUNT(DISTINCT " + ADDR_TX_HASH + ") FROM " +
+												   ADDR_TABLE_NAME + " WHERE " + ADDR_PROGRAM_HASH + " = ?;");
+
+				_sqlite->BindBlob(stmt, 1, programHash.begin(), programHash.size(), nullptr);
+				if (SQLITE_ROW == _sqlite->Step(stmt))
+					count = (size_t) _sqlite->ColumnInt64(stmt, 0);
+
+				_sqlite->Reset(stmt);
+			});
+
+			return count;
+		}
+
+		TransactionPtr TransactionDataStore::GetTransaction(const uint256 &hash) const {
+			return SelectTxByHash(hash);
+		}
+
+		std::vector<TransactionPtr> TransactionDataStore::GetTransactions(const std::vector<uint256> &hashes) const {
+			std::vector<TransactionPtr> txns;
+
+			DoTransaction([&hashes, &txns, this]() {
+				CachedStatement stmt = PrepareCached(TX_SELECT + " WHERE " + TX_COLUMN_ID + " = ?;");
+
 				for (size_t i = 0; i < hashes.size(); ++i) {
-					sql = "DELETE FROM " + TX_TABLE_NAME + " WHERE " + TX_COLUMN_ID + " = '" + hashes[i].GetHex() + "';";
+					_sqlite->BindBlob(stmt, 1, hashes[i].begin(), hashes[i].size(), nullptr);
+					if (SQLITE_ROW == _sqlite->Step(stmt))
+						txns.push_back(ReadTransaction(stmt));
+					_sqlite->Reset(stmt);
+				}
+			});
+
+			return txns;
+		}
+
+		std::vector<TransactionPtr> TransactionDataStore::GetTransactionsFrom(uint32_t blockHeight) const {
+			std::vector<TransactionPtr> txns;
+
+			DoTransaction([&blockHeight, &txns, this]() {
+				CachedStatement stmt = PrepareCached(TX_SELECT + " WHERE " + TX_BLOCK_HEIGHT + " >= ? ORDER BY " +
+												   TX_BLOCK_HEIGHT + ", " + TX_TIME_STAMP + ";");
+
+				_sqlite->BindInt64(stmt, 1, blockHeight);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					txns.push_back(ReadTransaction(stmt));
+				}
+
+				_sqlite->Reset(stmt);
+			});
+
+			return txns;
+		}
+
+		size_t TransactionDataStore::GetConfirmedTransactionsCount(uint32_t maxHeight) const {
+			size_t count = 0;
+
+			DoTransaction([&maxHeight, &count, this]() {
+				CachedStatement stmt = PrepareCached("SELECT COUNT(*) FROM " + TX_TABLE_NAME + " WHERE " +
+												   TX_BLOCK_HEIGHT + " <= ? AND " + TX_BLOCK_HEIGHT + " != ?;");
 
-					ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
-												 "Exec sql " + sql);
+				_sqlite->BindInt64(stmt, 1, maxHeight);
+				_sqlite->BindInt64(stmt, 2, INT32_MAX);
+				if (SQLITE_ROW == _sqlite->Step(stmt))
+					count = (size_t) _sqlite->ColumnInt64(stmt, 0);
+
+				_sqlite->Reset(stmt);
+			});
+
+			return count;
+		}
+
+		std::vector<uint168> TransactionDataStore::GetOutputProgramHashes() const {
+			std::vector<uint168> programHashes;
+
+			DoTransaction([&programHashes, this]() {
+				CachedStatement stmt = PrepareCached("SELECT DISTINCT " + ADDR_PROGRAM_HASH + " FROM " +
+												   ADDR_TABLE_NAME + " WHERE " + ADDR_IS_INPUT + " = 0;");
+
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					programHashes.push_back(uint168(*_sqlite->ColumnBlobBytes(stmt, 0)));
+				}
+
+				_sqlite->Reset(stmt);
+			});
+
+			return programHashes;
+		}
+
+		std::vector<OutputEntity> TransactionDataStore::GetUnspentOutputs() const {
+			std::vector<OutputEntity> outputs;
+
+			DoTransaction([&outputs, this]() {
+				CachedStatement stmt = PrepareCached(
+					"SELECT a." + ADDR_TX_HASH + ", a." + ADDR_INDEX + ", a." + ADDR_PROGRAM_HASH + " FROM " +
+					ADDR_TABLE_NAME + " a WHERE a." + ADDR_IS_INPUT + " = 0 AND NOT EXISTS (SELECT 1 FROM " +
+					SPENT_TABLE_NAME + " s, " + TX_TABLE_NAME + " t WHERE s." + SPENT_PREV_HASH + " = a." +
+					ADDR_TX_HASH + " AND s." + SPENT_PREV_INDEX + " = a." + ADDR_INDEX + " AND t." + TX_COLUMN_ID +
+					" = s." + SPENT_TX_HASH + " AND t." + TX_BLOCK_HEIGHT + " != ?);");
+
+				// block height of unconfirmed transactions
+				_sqlite->BindInt64(stmt, 1, INT32_MAX);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					uint256 txHash(*_sqlite->ColumnBlobBytes(stmt, 0));
+					uint16_t index = (uint16_t) _sqlite->ColumnInt(stmt, 1);
+					uint168 programHash(*_sqlite->ColumnBlobBytes(stmt, 2));
+					outputs.push_back(OutputEntity(txHash, index, programHash));
 				}
+
+				_sqlite->Reset(stmt);
 			});
+
+			return outputs;
 		}
 
 		void TransactionDataStore::flush() {
 			_sqlite->flush();
 		}
 
-		TransactionPtr TransactionDataStore::SelectTxByHash(const std::string &hash) const {
+		TransactionPtr TransactionDataStore::SelectTxByHash(const uint256 &hash) const {
 			TransactionPtr tx = nullptr;
 
 			DoTransaction([&hash, &tx, this]() {
-				std::string sql;
+				CachedStatement stmt = PrepareCached(TX_SELECT + " WHERE " + TX_COLUMN_ID + " = ?;");
 
-				sql = "SELECT " + TX_COLUMN_ID + "," + TX_BUFF + "," + TX_BLOCK_HEIGHT + "," + TX_TIME_STAMP + "," + TX_ISO +
-					  " FROM " + TX_TABLE_NAME +
-					  " WHERE " + TX_COLUMN_ID + " = '" + hash + "';";
+				_sqlite->BindBlob(stmt, 1, hash.begin(), hash.size(), nullptr);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					tx = ReadTransaction(stmt);
+				}
 
-				sqlite3_stmt *stmt;
-				ErrorChecker::CheckCondition(!_sqlite->Prepare(sql, &stmt, nullptr), Error::SqliteError,
-											 "Prepare sql " + sql);
+				_sqlite->Reset(stmt);
+			});
 
-				while (SQLITE_ROW == _sqlite->Step(stmt)) {
-					TransactionPtr t(new Transaction());
+			return tx;
+		}
 
-					uint256 txHash(_sqlite->ColumnText(stmt, 0));
+		TransactionPtr TransactionDataStore::ReadTransaction(sqlite3_stmt *stmt) const {
+			TransactionPtr tx(new Transaction());
 
-					const uint8_t *pdata = (const uint8_t *) _sqlite->ColumnBlob(stmt, 1);
-					size_t len = (size_t) _sqlite->ColumnBytes(stmt, 1);
-					ByteStream stream(pdata, len);
+			uint256 txHash(*_sqlite->ColumnBlobBytes(stmt, 0));
 
-					uint32_t blockHeight = (uint32_t) _sqlite->ColumnInt(stmt, 2);
-					uint32_t timeStamp = (uint32_t) _sqlite->ColumnInt(stmt, 3);
-					std::string iso = _sqlite->ColumnText(stmt, 4);
+			const uint8_t *pdata = (const uint8_t *) _sqlite->ColumnBlob(stmt, 1);
+			size_t len = (size_t) _sqlite->ColumnBytes(stmt, 1);
+			ByteStream stream(pdata, len);
 
-					if (iso == "ela") {
-						t->Deserialize(stream);
-						assert(txHash == tx->GetHash());
-					} else if (iso == "ela1") {
-						t->Deserialize(stream, true);
-						t->SetHash(txHash);
-					}
+			uint32_t blockHeight = (uint32_t) _sqlite->ColumnInt(stmt, 2);
+			uint32_t timeStamp = (uint32_t) _sqlite->ColumnInt(stmt, 3);
+			std::string iso = _sqlite->ColumnText(stmt, 4);
 
-					t->SetBlockHeight(blockHeight);
-					t->SetTimestamp(timeStamp);
-					tx = t;
-				}
-			});
+			if (iso == "ela") {
+				tx->Deserialize(stream);
+				assert(txHash == tx->GetHash());
+			} else if (iso == "ela1") {
+				tx->Deserialize(stream, true);
+				tx->SetHash(txHash);
+			}
+
+			tx->SetBlockHeight(blockHeight);
+			tx->SetTimestamp(timeStamp);
 
 			return tx;
 		}
@@ -16,6 +16,24 @@ namespace Elastos {
 		class Transaction;
 		typedef boost::shared_ptr<Transaction> TransactionPtr;
 
+		struct OutputEntity {
+			OutputEntity() :
+				index(0)
+			{
+			}
+
+			OutputEntity(const uint256 &hash, uint16_t n, const uint168 &ph) :
+				txHash(hash),
+				index(n),
+				programHash(ph)
+			{
+			}
+
+			uint256 txHash;
+			uint16_t index;
+			uint168 programHash;
+		};
+
 		class TransactionDataStore : public TableBase {
 		public:
 			TransactionDataStore(Sqlite *sqlite);
@@ -31,12 +49,45 @@ namespace Elastos {
 			bool DeleteTxByHash(const uint256 &hash);
 			bool DeleteTxByHashes(const std::vector<uint256> &hashes);
 
+			/*
+			 * Pages of the history, newest first: by block height then timestamp, unconfirmed on top. Only the rows
+			 * of the page are read and deserialized, walking the height index.
+			 */
+			std::vector<TransactionPtr> GetTransactions(size_t offset, size_t limit) const;
+			// transactions which pay to, or spend an output of, programHash
+			std::vector<TransactionPtr> GetTransactionsByAddress(const uint168 &programHash, size_t offset,
+																 size_t limit) const;
+			size_t GetTransactionsCountByAddress(const uint168 &programHash) const;
+			TransactionPtr GetTransaction(const uint256 &hash) const;
+			std::vector<TransactionPtr> GetTransactions(const std::vector<uint256> &hashes) const;
+			// at blockHeight or higher, unconfirmed included, oldest first
+			std::vector<TransactionPtr> GetTransactionsFrom(uint32_t blockHeight) const;
+			// confirmed ones at maxHeight or lower
+			size_t GetConfirmedTransactionsCount(uint32_t maxHeight) const;
+
+			// every program hash paid to, read from the address table without loading any transaction
+			std::vector<uint168> GetOutputProgramHashes() const;
+			// outputs which no confirmed transaction spends
+			std::vector<OutputEntity> GetUnspentOutputs() const;
+
 			void flush();
 		private:
-			TransactionPtr SelectTxByHash(const std::string &hash) const;
+			TransactionPtr SelectTxByHash(const uint256 &hash) const;
+
+			TransactionPtr ReadTransaction(sqlite3_stmt *stmt) const;
 
 			void PutTransactionInternal(const std::string &iso, const TransactionPtr &tx);
 
+			void IndexOutputs(const TransactionPtr &tx);
+
+			// the spent outputs must be indexed already to find their address, unknown ones only go to spent table
+			void IndexInputs(const TransactionPtr &tx);
+
+			void DeleteIndexes(const uint256 &hash);
+
+			// fill the address and spent tables of databases written before they existed
+			void BuildIndexes();
+
 		private:
 			/*
 			 * transaction table
@@ -51,13 +102,80 @@ namespace Elastos {
 			const std::string TX_ASSETID = "assetID";
 
 			const std::string TX_DATABASE_CREATE = "create table if not exists " + TX_TABLE_NAME + " (" +
-				TX_COLUMN_ID + " text not null, " +
+				TX_COLUMN_ID + " blob not null primary key, " +
 				TX_BUFF + " blob, " +
 				TX_BLOCK_HEIGHT + " integer, " +
 				TX_TIME_STAMP + " integer, " +
 				TX_REMARK + " text DEFAULT '', " +
 				TX_ASSETID + " text not null, " +
 				TX_ISO + " text DEFAULT 'ELA' );";
+
+			const std::string TX_INSERT = "INSERT OR REPLACE INTO " + TX_TABLE_NAME + " (" +
+				TX_COLUMN_ID + "," + TX_BUFF + "," + TX_BLOCK_HEIGHT + "," + TX_TIME_STAMP + "," +
+				TX_REMARK + "," + TX_ASSETID + "," + TX_ISO + ") VALUES (?, ?, ?, ?, ?, ?, ?);";
+
+			const std::string TX_SELECT = "SELECT " + TX_COLUMN_ID + "," + TX_BUFF + "," + TX_BLOCK_HEIGHT + "," +
+				TX_TIME_STAMP + "," + TX_ISO + " FROM " + TX_TABLE_NAME;
+
+			const std::string TX_UPDATE = "UPDATE " + TX_TABLE_NAME + " SET " + TX_BLOCK_HEIGHT + " = ?, " +
+				TX_TIME_STAMP + " = ? WHERE " + TX_COLUMN_ID + " = ?;";
+
+			const std::string TX_DELETE = "DELETE FROM " + TX_TABLE_NAME + " WHERE " + TX_COLUMN_ID + " = ?;";
+
+			const std::string TX_ORDER = " ORDER BY " + TX_BLOCK_HEIGHT + " DESC, " + TX_TIME_STAMP + " DESC";
+
+			const std::string TX_INDEX_CREATE = "CREATE INDEX IF NOT EXISTS transactionHeightIndex ON " +
+				TX_TABLE_NAME + " (" + TX_BLOCK_HEIGHT + ", " + TX_TIME_STAMP + ");";
+
+			/*
+			 * address table, one row per output and per input of every transaction, with the program hash it pays
+			 * to or spends from
+			 */
+			const std::string ADDR_TABLE_NAME = "transactionAddressTable";
+			const std::string ADDR_TX_HASH = "txHash";
+			const std::string ADDR_IS_INPUT = "isInput";
+			const std::string ADDR_INDEX = "ioIndex";
+			const std::string ADDR_PROGRAM_HASH = "programHash";
+
+			const std::string ADDR_DATABASE_CREATE = "create table if not exists " + ADDR_TABLE_NAME + " (" +
+				ADDR_TX_HASH + " blob not null, " +
+				ADDR_IS_INPUT + " integer not null, " +
+				ADDR_INDEX + " integer not null, " +
+				ADDR_PROGRAM_HASH + " blob not null, " +
+				"primary key (" + ADDR_TX_HASH + ", " + ADDR_IS_INPUT + ", " + ADDR_INDEX + ")) WITHOUT ROWID;" +
+				"CREATE INDEX IF NOT EXISTS transactionAddressIndex ON " + ADDR_TABLE_NAME + " (" +
+				ADDR_PROGRAM_HASH + ", " + ADDR_TX_HASH + ");";
+
+			const std::string ADDR_INSERT = "INSERT OR REPLACE INTO " + ADDR_TABLE_NAME + " (" + ADDR_TX_HASH + "," +
+				ADDR_IS_INPUT + "," + ADDR_INDEX + "," + ADDR_PROGRAM_HASH + ") VALUES (?, ?, ?, ?);";
+
+			const std::string ADDR_SELECT_OUTPUT = "SELECT " + ADDR_PROGRAM_HASH + " FROM " + ADDR_TABLE_NAME +
+				" WHERE " + ADDR_TX_HASH + " = ? AND " + ADDR_IS_INPUT + " = 0 AND " + ADDR_INDEX + " = ?;";
+
+			const std::string ADDR_DELETE = "DELETE FROM " + ADDR_TABLE_NAME + " WHERE " + ADDR_TX_HASH + " = ?;";
+
+			/*
+			 * spent table, the outputs spent by each transaction
+			 */
+			const std::string SPENT_TABLE_NAME = "transactionSpentTable";
+			const std::string SPENT_PREV_HASH = "prevTxHash";
+			const std::string SPENT_PREV_INDEX = "prevIndex";
+			const std::string SPENT_TX_HASH = "txHash";
+
+			const std::string SPENT_DATABASE_CREATE = "create table if not exists " + SPENT_TABLE_NAME + " (" +
+				SPENT_PREV_HASH + " blob not null, " +
+				SPENT_PREV_INDEX + " integer not null, " +
+				SPENT_TX_HASH + " blob not null, " +
+				"primary key (" + SPENT_PREV_HASH + ", " + SPENT_PREV_INDEX + ", " + SPENT_TX_HASH + ")) WITHOUT ROWID;" +
+				"CREATE INDEX IF NOT EXISTS transactionSpentTxIndex ON " + SPENT_TABLE_NAME + " (" + SPENT_TX_HASH + ");";
+
+			const std::string SPENT_INSERT = "INSERT OR REPLACE INTO " + SPENT_TABLE_NAME + " (" + SPENT_PREV_HASH + "," +
+				SPENT_PREV_INDEX + "," + SPENT_TX_HASH + ") VALUES (?, ?, ?);";
+
+			const std::string SPENT_DELETE = "DELETE FROM " + SPENT_TABLE_NAME + " WHERE " + SPENT_TX_HASH + " = ?;";
+
+			const std::string ADDR_TX_HASHES = "SELECT " + ADDR_TX_HASH + " FROM " + ADDR_TABLE_NAME + " WHERE " +
+				ADDR_PROGRAM_HASH + " = ?";
 		};
 
 	}
@@ -0,0 +1,119 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "UTXOSnapshotDataStore.h"
+
+#include <SDK/Common/ErrorChecker.h>
+#include <SDK/Common/ByteStream.h>
+#include <SDK/Common/Log.h>
+#include <SDK/Wallet/UTXO.h>
+#include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		UTXOSnapshotDataStore::UTXOSnapshotDataStore(Sqlite *sqlite) :
+			TableBase(sqlite) {
+			InitializeTable(_infoCreate + _databaseCreate);
+		}
+
+		UTXOSnapshotDataStore::UTXOSnapshotDataStore(SqliteTransactionType type, Sqlite *sqlite) :
+			TableBase(type, sqlite) {
+			InitializeTable(_infoCreate + _databaseCreate);
+		}
+
+		UTXOSnapshotDataStore::~UTXOSnapshotDataStore() {
+
+		}
+
+		bool UTXOSnapshotDataStore::Put(const UTXOSnapshot &snapshot) {
+			return DoTransaction([&snapshot, this]() {
+				std::string sql = "DELETE FROM " + _tableName + ";";
+				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
+											 "Exec sql " + sql);
+
+				CachedStatement stmt = PrepareCached(_infoInsert);
+				_sqlite->BindInt64(stmt, 1, snapshot.version);
+				_sqlite->BindInt64(stmt, 2, snapshot.blockHeight);
+				_sqlite->BindBlob(stmt, 3, snapshot.blockHash.begin(), snapshot.blockHash.size(), nullptr);
+				_sqlite->BindInt64(stmt, 4, snapshot.txCount);
+				ErrorChecker::CheckCondition(SQLITE_DONE != _sqlite->Step(stmt), Error::SqliteError,
+											 "Insert snapshot info");
+				_sqlite->Reset(stmt);
+
+				stmt = PrepareCached(_insert);
+				for (size_t i = 0; i < snapshot.utxos.size(); ++i) {
+					const UTXOPtr &utxo = snapshot.utxos[i];
+					ByteStream stream;
+					utxo->Output()->Serialize(stream, Transaction::TxVersion::V09, true);
+
+					_sqlite->BindBlob(stmt, 1, utxo->Hash().begin(), utxo->Hash().size(), nullptr);
+					_sqlite->BindInt(stmt, 2, utxo->Index());
+					_sqlite->BindInt64(stmt, 3, utxo->BlockHeight());
+					_sqlite->BindInt64(stmt, 4, utxo->Timestamp());
+					_sqlite->BindBlob(stmt, 5, stream.GetBytes(), nullptr);
+
+					_sqlite->Step(stmt);
+					_sqlite->Reset(stmt);
+				}
+			});
+		}
+
+		bool UTXOSnapshotDataStore::Get(UTXOSnapshot &snapshot) const {
+			bool found = false;
+
+			DoTransaction([&snapshot, &found, this]() {
+				CachedStatement stmt = PrepareCached(_infoSelect);
+				if (SQLITE_ROW == _sqlite->Step(stmt)) {
+					snapshot.version = (uint32_t) _sqlite->ColumnInt64(stmt, 0);
+					snapshot.blockHeight = (uint32_t) _sqlite->ColumnInt64(stmt, 1);
+					snapshot.blockHash = uint256(*_sqlite->ColumnBlobBytes(stmt, 2));
+					snapshot.txCount = (size_t) _sqlite->ColumnInt64(stmt, 3);
+					found = true;
+				}
+				_sqlite->Reset(stmt);
+
+				if (!found)
+					return;
+
+				snapshot.utxos.clear();
+				stmt = PrepareCached(_select);
+				while (SQLITE_ROW == _sqlite->Step(stmt)) {
+					uint256 txHash(*_sqlite->ColumnBlobBytes(stmt, 0));
+					uint16_t index = (uint16_t) _sqlite->ColumnInt(stmt, 1);
+					uint32_t blockHeight = (uint32_t) _sqlite->ColumnInt64(stmt, 2);
+					time_t timestamp = _sqlite->ColumnInt64(stmt, 3);
+
+					ByteStream stream(*_sqlite->ColumnBlobBytes(stmt, 4));
+					OutputPtr output(new TransactionOutput());
+					if (!output->Deserialize(stream, Transaction::TxVersion::V09, true)) {
+						Log::error("deserialize snapshot utxo {}:{} fail", txHash.GetHex(), index);
+						found = false;
+						break;
+					}
+
+					snapshot.utxos.push_back(UTXOPtr(new UTXO(txHash, index, timestamp, blockHeight, output)));
+				}
+				_sqlite->Reset(stmt);
+			});
+
+			return found;
+		}
+
+		bool UTXOSnapshotDataStore::DeleteAll() {
+			return DoTransaction([this]() {
+				std::string sql = "DELETE FROM " + _infoTableName + "; DELETE FROM " + _tableName + ";";
+
+				ErrorChecker::CheckCondition(!_sqlite->exec(sql, nullptr, nullptr), Error::SqliteError,
+											 "Exec sql " + sql);
+			});
+		}
+
+		void UTXOSnapshotDataStore::flush() {
+			_sqlite->flush();
+		}
+
+	}
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_UTXOSNAPSHOTDATASTORE_H__
+#define __ELASTOS_SDK_UTXOSNAPSHOTDATASTORE_H__
+
+#include "Sqlite.h"
+#include "TableBase.h"
+
+#include <SDK/Common/uint256.h>
+
+#define UTXO_SNAPSHOT_VERSION 1
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class UTXO;
+		typedef boost::shared_ptr<UTXO> UTXOPtr;
+		typedef std::vector<UTXOPtr> UTXOArray;
+
+		/*
+		 * Confirmed utxos of the wallet, coinbase ones excluded, as of the block blockHeight / blockHash. txCount is
+		 * the count of stored confirmed transactions up to that block when it was taken, a different count later
+		 * means the history below the snapshot changed and it can not be used.
+		 */
+		struct UTXOSnapshot {
+			UTXOSnapshot() : version(UTXO_SNAPSHOT_VERSION), blockHeight(0), txCount(0) {}
+
+			uint32_t version;
+			uint32_t blockHeight;
+			uint256 blockHash;
+			size_t txCount;
+			UTXOArray utxos;
+		};
+
+		class UTXOSnapshotDataStore : public TableBase {
+		public:
+			explicit UTXOSnapshotDataStore(Sqlite *sqlite);
+
+			UTXOSnapshotDataStore(SqliteTransactionType type, Sqlite *sqlite);
+
+			~UTXOSnapshotDataStore();
+
+			// replace the stored snapshot
+			bool Put(const UTXOSnapshot &snapshot);
+
+			// false if there is none
+			bool Get(UTXOSnapshot &snapshot) const;
+
+			bool DeleteAll();
+
+			void flush();
+
+		private:
+			/*
+			 * snapshot info table, one row
+			 */
+			const std::string _infoTableName = "utxoSnapshotInfoTable";
+
+			const std::string _id = "_id";
+			const std::string _version = "version";
+			const std::string _blockHeight = "blockHeight";
+			const std::string _blockHash = "blockHash";
+			const std::string _txCount = "txCount";
+
+			const std::string _infoCreate = "create table if not exists " + _infoTableName + " (" +
+											_id + " INTEGER primary key, " +
+											_version + " INTEGER, " +
+											_blockHeight + " INTEGER, " +
+											_blockHash + " BLOB, " +
+											_txCount + " INTEGER);";
+
+			const std::string _infoInsert = "INSERT OR REPLACE INTO " + _infoTableName + " (" + _id + "," + _version +
+											"," + _blockHeight + "," + _blockHash + "," + _txCount +
+											") VALUES (0, ?, ?, ?, ?);";
+
+			const std::string _infoSelect = "SELECT " + _version + ", " + _blockHeight + ", " + _blockHash + ", " +
+											_txCount + " FROM " + _infoTableName + " WHERE " + _id + " = 0;";
+
+			/*
+			 * snapshot utxo table
+			 */
+			const std::string _tableName = "utxoSnapshotTable";
+
+			const std::string _txHash = "txHash";
+			const std::string _index = "outputIndex";
+			const std::string _timestamp = "timestamp";
+			const std::string _output = "output";
+
+			const std::string _databaseCreate = "create table if not exists " + _tableName + " (" +
+												_txHash + " BLOB not null, " +
+												_index + " INTEGER, " +
+												_blockHeight + " INTEGER, " +
+												_timestamp + " INTEGER, " +
+												_output + " BLOB, " +
+												"primary key (" + _txHash + ", " + _index + ")) WITHOUT ROWID;";
+
+			const std::string _insert = "INSERT OR REPLACE INTO " + _tableName + " (" + _txHash + "," + _index + "," +
+										_blockHeight + "," + _timestamp + "," + _output + ") VALUES (?, ?, ?, ?, ?);";
+
+			const std::string _select = "SELECT " + _txHash + ", " + _index + ", " + _blockHeight + ", " +
+										_timestamp + ", " + _output + " FROM " + _tableName + ";";
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_UTXOSNAPSHOTDATASTORE_H__
@@ -45,6 +45,7 @@ namespace Elastos {
 								   _info->GetEarliestPeerTime(), _config->DisconnectionTime(),
 								   _config->PluginType(), config->ChainParameters()));
 
+			_walletManager->getPeerManager()->SetSyncPeerCount(_config->SyncPeers());
 			_walletManager->RegisterWalletListener(this);
 			_walletManager->RegisterPeerManagerListener(this);
 
@@ -276,6 +277,32 @@ namespace Elastos {
 			return result;
 		}
 
+		nlohmann::json SubWallet::SignTransactions(const nlohmann::json &createdTxs,
+												   const std::string &payPassword) {
+
+			ArgInfo("{} {}", _walletManager->getWallet()->GetWalletID(), GetFunName());
+			ArgInfo("txs: {}", createdTxs.dump());
+			ArgInfo("passwd: *");
+
+			ErrorChecker::CheckParam(!createdTxs.is_array(), Error::JsonFormatError, "txs should be json array");
+
+			std::vector<TransactionPtr> txns;
+			for (nlohmann::json::const_iterator it = createdTxs.begin(); it != createdTxs.end(); ++it)
+				txns.push_back(DecodeTx(*it));
+
+			_walletManager->getWallet()->SignTransactions(txns, payPassword);
+
+			nlohmann::json result = nlohmann::json::array();
+			for (size_t i = 0; i < txns.size(); ++i) {
+				nlohmann::json j;
+				EncodeTx(j, txns[i]);
+				result.push_back(j);
+			}
+
+			ArgInfo("r => {}", result.dump());
+			return result;
+		}
+
 		nlohmann::json SubWallet::PublishTransaction(const nlohmann::json &signedTx) {
 			ArgInfo("{} {}", _walletManager->getWallet()->GetWalletID(), GetFunName());
 			ArgInfo("tx: {}", signedTx.dump());
@@ -349,43 +376,21 @@ namespace Elastos {
 			ArgInfo("addrOrTxID: {}", addressOrTxid);
 
 			const WalletPtr &wallet = _walletManager->getWallet();
-
-			std::vector<TransactionPtr> allTxs = wallet->GetAllTransactions();
-			size_t fullTxCount = allTxs.size();
-			size_t pageCount = count;
+			size_t maxCount = 0;
 			nlohmann::json j;
 
-			if (start >= fullTxCount) {
-				j["Transactions"] = {};
-				j["MaxCount"] = fullTxCount;
-
-				ArgInfo("r => {}", j.dump());
-				return j;
-			}
-
-			if (fullTxCount < start + count)
-				pageCount = fullTxCount - start;
-
-			std::vector<TransactionPtr> transactions(pageCount);
-			uint32_t realCount = 0;
-			for (long i = fullTxCount - 1 - start; i >= 0 && realCount < pageCount; --i) {
-				if (!filterByAddressOrTxId(allTxs[i], addressOrTxid))
-					continue;
-				transactions[realCount++] = allTxs[i];
-			}
-
-			std::vector<nlohmann::json> jsonList(realCount);
-			for (size_t i = 0; i < realCount; ++i) {
-				uint32_t confirms = 0;
-				uint32_t lastBlockHeight = _walletManager->getWallet()->LastBlockHeight();
-				std::string hash = transactions[i]->GetHash().GetHex();
+			std::vector<TransactionPtr> transactions = _walletManager->GetTransactions(start, count, addressOrTxid,
+																					   maxCount);
 
-				confirms = transactions[i]->GetConfirms(lastBlockHeight);
+			std::vector<nlohmann::json> jsonList(transactions.size());
+			uint32_t lastBlockHeight = wallet->LastBlockHeight();
+			for (size_t i = 0; i < transactions.size(); ++i) {
+				uint32_t confirms = transactions[i]->GetConfirms(lastBlockHeight);
 
-				jsonList[i] = transactions[i]->GetSummary(_walletManager->getWallet(), confirms, !addressOrTxid.empty());
+				jsonList[i] = transactions[i]->GetSummary(wallet, confirms, !addressOrTxid.empty());
 			}
 			j["Transactions"] = jsonList;
-			j["MaxCount"] = fullTxCount;
+			j["MaxCount"] = maxCount;
 
 			ArgInfo("r => {}", j.dump());
 			return j;
@@ -399,61 +404,32 @@ namespace Elastos {
 			ArgInfo("txID: {}", txID);
 
 			nlohmann::json j;
-			const WalletPtr wallet = _walletManager->getWallet();
-			std::vector<UTXOPtr> cbs = wallet->GetAllCoinBaseTransactions();
-			size_t maxCount = cbs.size();
-			size_t pageCount = count, realCount = 0;
-
-			if (start >= maxCount) {
-				j["Transactions"] = {};
-				j["MaxCount"] = maxCount;
-				ArgInfo("r => {}", j.dump());
-				return j;
-			}
-
-			if (maxCount < start + count)
-				pageCount = maxCount - start;
-
-			if (!txID.empty())
-				pageCount = 1;
+			size_t maxCount = 0;
+			std::vector<UTXOPtr> cbs = _walletManager->GetCoinBaseTransactions(start, count, txID, maxCount);
+			uint32_t lastBlockHeight = _walletManager->getWallet()->LastBlockHeight();
 
 			std::vector<nlohmann::json> jcbs;
-			jcbs.reserve(pageCount);
-			for (size_t i = maxCount - start; i > 0 && realCount < pageCount; --i) {
-				const UTXOPtr &cbptr = cbs[i - 1];
+			jcbs.reserve(cbs.size());
+			for (size_t i = 0; i < cbs.size(); ++i) {
+				const UTXOPtr &cbptr = cbs[i];
 				nlohmann::json cb;
 
+				uint32_t confirms = cbptr->GetConfirms(lastBlockHeight);
+				cb["TxHash"] = cbptr->Hash().GetHex();
+				cb["Timestamp"] = cbptr->Timestamp();
+				cb["Amount"] = cbptr->Output()->Amount().getDec();
+				cb["Status"] = confirms <= 100 ? "Pending" : "Confirmed";
+				cb["Direction"] = "Received";
+
 				if (!txID.empty()) {
-					if (cbptr->Hash().GetHex() == txID) {
-						cb["TxHash"] = txID;
-						uint32_t confirms = cbptr->GetConfirms(_walletManager->getWallet()->LastBlockHeight());
-						cb["Timestamp"] = cbptr->Timestamp();
-						cb["Amount"] = cbptr->Output()->Amount().getDec();
-						cb["Status"] = confirms <= 100 ? "Pending" : "Confirmed";
-						cb["Direction"] = "Received";
-
-						cb["ConfirmStatus"] = confirms <= 100 ? std::to_string(confirms) : "100+";
-						cb["Height"] = cbptr->BlockHeight();
-						cb["Spent"] = cbptr->Spent();
-						cb["Address"] = Address(cbptr->Output()->ProgramHash()).String();
-						cb["Type"] = Transaction::coinBase;
-						jcbs.push_back(cb);
-						realCount++;
-						break;
-					}
-				} else {
-					nlohmann::json cb;
-
-					cb["TxHash"] = cbptr->Hash().GetHex();
-					uint32_t confirms = cbptr->GetConfirms(_walletManager->getWallet()->LastBlockHeight());
-					cb["Timestamp"] = cbptr->Timestamp();
-					cb["Amount"] = cbptr->Output()->Amount().getDec();
-					cb["Status"] = confirms <= 100 ? "Pending" : "Confirmed";
-					cb["Direction"] = "Received";
-
-					jcbs.push_back(cb);
-					realCount++;
+					cb["ConfirmStatus"] = confirms <= 100 ? std::to_string(confirms) : "100+";
+					cb["Height"] = cbptr->BlockHeight();
+					cb["Spent"] = cbptr->Spent();
+					cb["Address"] = Address(cbptr->Output()->ProgramHash()).String();
+					cb["Type"] = Transaction::coinBase;
 				}
+
+				jcbs.push_back(cb);
 			}
 			j["Transactions"] = jcbs;
 			j["MaxCount"] = maxCount;
@@ -493,7 +469,7 @@ namespace Elastos {
 			return result;
 		}
 
-		void SubWallet::balanceChanged(const uint256 &assetID, const BigInt &balance) {
+		void SubWallet::balanceChanged(const uint256 &assetID, const Int128 &balance) {
 			ArgInfo("{} {} Balance: {}", _walletManager->getWallet()->GetWalletID(), GetFunName(), balance.getDec());
 			boost::mutex::scoped_lock scoped_lock(lock);
 
@@ -578,36 +554,6 @@ namespace Elastos {
 			});
 		}
 
-		bool SubWallet::filterByAddressOrTxId(const TransactionPtr &tx, const std::string &addressOrTxid) const {
-
-			if (addressOrTxid.empty()) {
-				return true;
-			}
-
-			const WalletPtr &wallet = _walletManager->getWallet();
-			for (InputArray::const_iterator in = tx->GetInputs().cbegin(); in != tx->GetInputs().cend(); ++in) {
-				TransactionPtr t = wallet->TransactionForHash((*in)->TxHash());
-				if (t) {
-					OutputPtr o = t->OutputOfIndex((*in)->Index());
-					if (o && o->Addr().String() == addressOrTxid)
-						return true;
-				}
-			}
-			for (OutputArray::const_iterator o = tx->GetOutputs().cbegin(); o != tx->GetOutputs().cend(); ++o) {
-				if ((*o)->Addr().String() == addressOrTxid) {
-					return true;
-				}
-			}
-
-			if (addressOrTxid.length() == 64) {
-				if (uint256(addressOrTxid) == tx->GetHash()) {
-					return true;
-				}
-			}
-
-			return false;
-		}
-
 		void SubWallet::syncStarted() {
 		}
 
@@ -86,6 +86,10 @@ namespace Elastos {
 					const nlohmann::json &createdTx,
 					const std::string &payPassword);
 
+			virtual nlohmann::json SignTransactions(
+					const nlohmann::json &createdTxs,
+					const std::string &payPassword);
+
 			virtual nlohmann::json GetTransactionSignedInfo(
 					const nlohmann::json &rawTransaction) const;
 
@@ -121,7 +125,7 @@ namespace Elastos {
 			virtual void SyncStop();
 
 		protected: //implement Wallet::Listener
-			virtual void balanceChanged(const uint256 &asset, const BigInt &balance);
+			virtual void balanceChanged(const uint256 &asset, const Int128 &balance);
 
 			virtual void onCoinBaseTxAdded(const UTXOPtr &cb);
 
@@ -185,8 +189,6 @@ namespace Elastos {
 
 			virtual void publishTransaction(const TransactionPtr &tx);
 
-			bool filterByAddressOrTxId(const TransactionPtr &transaction, const std::string &addressOrTxid) const;
-
 			virtual void fireTransactionStatusChanged(const uint256 &txid, const std::string &status,
 													  const nlohmann::json &desc, uint32_t confirms);
 
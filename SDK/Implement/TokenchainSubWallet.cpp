@@ -126,7 +126,7 @@ namespace Elastos {
 
 			std::string addr = CreateAddress();
 
-			BigInt bnAmount = _walletManager->getWallet()->GetBalance(uint256(assetID), GroupedAsset::Total);
+			Int128 bnAmount = _walletManager->getWallet()->GetBalance(uint256(assetID), GroupedAsset::Total);
 
 			uint256 asset = uint256(assetID);
 
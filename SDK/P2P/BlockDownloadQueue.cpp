@@ -0,0 +1,173 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockDownloadQueue.h"
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		BlockDownloadQueue::BlockDownloadQueue(size_t batchSize, size_t maxInFlight) :
+			_batchSize(batchSize),
+			_maxInFlight(maxInFlight),
+			_firstSeq(0) {
+		}
+
+		BlockDownloadQueue::~BlockDownloadQueue() {
+		}
+
+		void BlockDownloadQueue::Clear() {
+			_firstSeq += _entries.size();
+			_entries.clear();
+			_index.clear();
+			_peers.clear();
+			_back = uint256();
+		}
+
+		size_t BlockDownloadQueue::Size() const {
+			return _entries.size();
+		}
+
+		bool BlockDownloadQueue::Empty() const {
+			return _entries.empty();
+		}
+
+		bool BlockDownloadQueue::Contains(const uint256 &hash) const {
+			return _index.find(hash) != _index.end();
+		}
+
+		const uint256 &BlockDownloadQueue::Back() const {
+			return _back;
+		}
+
+		BlockDownloadQueue::Entry &BlockDownloadQueue::At(uint64_t seq) {
+			return _entries[seq - _firstSeq];
+		}
+
+		void BlockDownloadQueue::Append(const std::vector<uint256> &hashes) {
+			for (size_t i = 0; i < hashes.size(); ++i) {
+				if (_index.find(hashes[i]) != _index.end())
+					continue;
+
+				Entry entry;
+				entry.hash = hashes[i];
+				_index[hashes[i]] = _firstSeq + _entries.size();
+				_entries.push_back(entry);
+				_back = hashes[i];
+			}
+		}
+
+		std::vector<uint256> BlockDownloadQueue::Assign(const PeerPtr &peer, double now) {
+			std::vector<uint256> hashes;
+			PeerState &state = _peers[peer];
+
+			if (state.inFlight + _batchSize > _batchSize * _maxInFlight)
+				return hashes;
+
+			// first contiguous run nobody is downloading, released ranges are picked up before newer ones
+			for (size_t i = 0; i < _entries.size() && hashes.size() < _batchSize; ++i) {
+				Entry &entry = _entries[i];
+
+				if (entry.peer == nullptr && entry.block == nullptr) {
+					entry.peer = peer;
+					hashes.push_back(entry.hash);
+				} else if (!hashes.empty()) {
+					break;
+				}
+			}
+
+			if (!hashes.empty()) {
+				if (state.inFlight == 0)
+					state.lastProgress = now;
+				state.inFlight += hashes.size();
+			}
+
+			return hashes;
+		}
+
+		bool BlockDownloadQueue::HoldTx(const PeerPtr &peer, const uint256 &blockHash, const TransactionPtr &tx) {
+			std::map<uint256, uint64_t>::iterator it = _index.find(blockHash);
+			if (it == _index.end())
+				return false;
+
+			Entry &entry = At(it->second);
+			if (entry.block == nullptr)
+				entry.pendingTxns[peer].push_back(tx);
+
+			return true;
+		}
+
+		std::vector<BlockDownloadQueue::RelayedBlock> BlockDownloadQueue::Received(const PeerPtr &peer,
+																					 const MerkleBlockPtr &block,
+																					 double now) {
+			std::vector<RelayedBlock> ready;
+			std::map<uint256, uint64_t>::iterator it = _index.find(block->GetHash());
+
+			if (it == _index.end())
+				return ready;
+
+			Entry &entry = At(it->second);
+			if (entry.block != nullptr) // duplicate, e.g. from a peer the range was taken away from
+				return ready;
+
+			Unassign(entry);
+			entry.block = block;
+			entry.relayedBy = peer;
+			entry.txns.swap(entry.pendingTxns[peer]);
+			entry.pendingTxns.clear();
+			_peers[peer].lastProgress = now;
+
+			while (!_entries.empty() && _entries.front().block != nullptr) {
+				ready.push_back(RelayedBlock(_entries.front().relayedBy, _entries.front().block));
+				ready.back().txns.swap(_entries.front().txns);
+				_index.erase(_entries.front().hash);
+				_entries.pop_front();
+				_firstSeq++;
+			}
+
+			return ready;
+		}
+
+		void BlockDownloadQueue::Unassign(Entry &entry) {
+			if (entry.peer == nullptr)
+				return;
+
+			std::map<PeerPtr, PeerState>::iterator it = _peers.find(entry.peer);
+			if (it != _peers.end() && it->second.inFlight > 0)
+				it->second.inFlight--;
+			entry.peer.reset();
+		}
+
+		size_t BlockDownloadQueue::Release(const PeerPtr &peer) {
+			size_t count = 0;
+
+			for (size_t i = 0; i < _entries.size(); ++i) {
+				if (_entries[i].peer == peer) {
+					_entries[i].peer.reset();
+					count++;
+				}
+				_entries[i].pendingTxns.erase(peer);
+			}
+
+			_peers.erase(peer);
+			return count;
+		}
+
+		size_t BlockDownloadQueue::InFlight(const PeerPtr &peer) const {
+			std::map<PeerPtr, PeerState>::const_iterator it = _peers.find(peer);
+			return it == _peers.end() ? 0 : it->second.inFlight;
+		}
+
+		std::vector<PeerPtr> BlockDownloadQueue::Stalled(double now, double timeout) const {
+			std::vector<PeerPtr> stalled;
+
+			for (std::map<PeerPtr, PeerState>::const_iterator it = _peers.begin(); it != _peers.end(); ++it) {
+				if (it->second.inFlight > 0 && it->second.lastProgress + timeout < now)
+					stalled.push_back(it->first);
+			}
+
+			return stalled;
+		}
+
+	}
+}
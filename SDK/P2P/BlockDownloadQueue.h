@@ -0,0 +1,119 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_BLOCKDOWNLOADQUEUE_H__
+#define __ELASTOS_SDK_BLOCKDOWNLOADQUEUE_H__
+
+#include <SDK/Common/uint256.h>
+#include <SDK/Plugin/Interface/IMerkleBlock.h>
+
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <map>
+#include <vector>
+
+#define BLOCK_DOWNLOAD_BATCH      50  // block hashes per getdata
+#define BLOCK_DOWNLOAD_IN_FLIGHT  2   // batches a peer may have outstanding
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class Peer;
+		typedef boost::shared_ptr<Peer> PeerPtr;
+		class Transaction;
+		typedef boost::shared_ptr<Transaction> TransactionPtr;
+
+		/*
+		 * Block hashes still to download during a chain sync, in chain order. Contiguous ranges are handed out to
+		 * the downloading peers and the blocks they relay are held back until every block before them has arrived, so
+		 * they come out of Received() in the order they have to be connected. The matched transactions a peer sends
+		 * ahead of a block are held with it, the wallet has to see them in chain order too. Not thread safe.
+		 */
+		class BlockDownloadQueue {
+		public:
+			struct RelayedBlock {
+				RelayedBlock() {}
+
+				RelayedBlock(const PeerPtr &p, const MerkleBlockPtr &b) : peer(p), block(b) {}
+
+				PeerPtr peer;
+				MerkleBlockPtr block;
+				std::vector<TransactionPtr> txns; // relayed by peer for block, in the order they came
+			};
+
+			BlockDownloadQueue(size_t batchSize = BLOCK_DOWNLOAD_BATCH, size_t maxInFlight = BLOCK_DOWNLOAD_IN_FLIGHT);
+
+			~BlockDownloadQueue();
+
+			void Clear();
+
+			// hashes not connected yet, in flight or not
+			size_t Size() const;
+
+			bool Empty() const;
+
+			bool Contains(const uint256 &hash) const;
+
+			// last hash ever queued, connected or not, where enumerating the next hashes starts from
+			const uint256 &Back() const;
+
+			// queue hashes in chain order, the ones queued already are skipped
+			void Append(const std::vector<uint256> &hashes);
+
+			// next range for peer to request, empty if nothing is left or peer has enough in flight
+			std::vector<uint256> Assign(const PeerPtr &peer, double now);
+
+			/*
+			 * Matched tx peer relayed for the block blockHash it is sending, held until the block comes out of
+			 * Received(). Return false if that block isn't queued; a tx for a block received already is a duplicate
+			 * and dropped.
+			 */
+			bool HoldTx(const PeerPtr &peer, const uint256 &blockHash, const TransactionPtr &tx);
+
+			// block relayed by peer, returns the blocks ready to connect in chain order with their held tx
+			std::vector<RelayedBlock> Received(const PeerPtr &peer, const MerkleBlockPtr &block, double now);
+
+			// give the hashes peer has in flight back to the queue, and drop the tx held from it
+			size_t Release(const PeerPtr &peer);
+
+			size_t InFlight(const PeerPtr &peer) const;
+
+			// peers with hashes in flight and nothing relayed since now - timeout
+			std::vector<PeerPtr> Stalled(double now, double timeout) const;
+
+		private:
+			struct Entry {
+				uint256 hash;
+				PeerPtr peer;
+				PeerPtr relayedBy;
+				MerkleBlockPtr block;
+				std::vector<TransactionPtr> txns;
+				// tx held per peer until one of them delivers the block, a peer may stop half way
+				std::map<PeerPtr, std::vector<TransactionPtr> > pendingTxns;
+			};
+
+			struct PeerState {
+				PeerState() : inFlight(0), lastProgress(0) {}
+
+				size_t inFlight;
+				double lastProgress;
+			};
+
+			Entry &At(uint64_t seq);
+
+			void Unassign(Entry &entry);
+
+		private:
+			size_t _batchSize, _maxInFlight;
+			uint64_t _firstSeq;
+			uint256 _back;
+			std::deque<Entry> _entries;
+			std::map<uint256, uint64_t> _index;
+			std::map<PeerPtr, PeerState> _peers;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_BLOCKDOWNLOADQUEUE_H__
@@ -0,0 +1,105 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockSet.h"
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		BlockSet::BlockSet() :
+			_tipHeight(0) {
+		}
+
+		BlockSet::~BlockSet() {
+		}
+
+		MerkleBlockPtr BlockSet::Get(const uint256 &hash) const {
+			BlockMap::const_iterator it = _blocks.find(hash);
+			if (it == _blocks.end())
+				return nullptr;
+
+			return it->second;
+		}
+
+		bool BlockSet::Contains(const MerkleBlockPtr &block) const {
+			return Contains(block->GetHash());
+		}
+
+		bool BlockSet::Contains(const uint256 &hash) const {
+			return _blocks.find(hash) != _blocks.end();
+		}
+
+		void BlockSet::Insert(const MerkleBlockPtr &block) {
+			_blocks[block->GetHash()] = block;
+		}
+
+		void BlockSet::Remove(const MerkleBlockPtr &block) {
+			const uint256 &hash = block->GetHash();
+			if (_blocks.erase(hash) == 0)
+				return;
+
+			HeightMap::iterator it = _mainChain.find(block->GetHeight());
+			if (it != _mainChain.end() && it->second == hash)
+				_mainChain.erase(it);
+		}
+
+		size_t BlockSet::Size() const {
+			return _blocks.size();
+		}
+
+		void BlockSet::Clear() {
+			_blocks.clear();
+			_mainChain.clear();
+			_tipHeight = 0;
+		}
+
+		void BlockSet::SetChainTip(const MerkleBlockPtr &tip) {
+			uint32_t height = tip->GetHeight();
+
+			// drop the heights above new tip, iterate whichever is smaller
+			if (_tipHeight > height) {
+				if (_tipHeight - height > _mainChain.size()) {
+					for (HeightMap::iterator it = _mainChain.begin(); it != _mainChain.end();) {
+						if (it->first > height)
+							it = _mainChain.erase(it);
+						else
+							++it;
+					}
+				} else {
+					for (uint32_t h = height + 1; h <= _tipHeight; ++h)
+						_mainChain.erase(h);
+				}
+			}
+			_tipHeight = height;
+
+			// walk back until we meet the main chain (fork point), or the chain is broken
+			MerkleBlockPtr b = tip;
+			while (b != nullptr) {
+				HeightMap::iterator it = _mainChain.find(b->GetHeight());
+				if (it != _mainChain.end() && it->second == b->GetHash())
+					break;
+
+				_mainChain[b->GetHeight()] = b->GetHash();
+				if (b->GetHeight() == 0)
+					break;
+
+				b = Get(b->GetPrevBlockHash());
+			}
+		}
+
+		MerkleBlockPtr BlockSet::GetMainChainBlock(uint32_t height) const {
+			HeightMap::const_iterator it = _mainChain.find(height);
+			if (it == _mainChain.end())
+				return nullptr;
+
+			return Get(it->second);
+		}
+
+		bool BlockSet::IsMainChain(const MerkleBlockPtr &block) const {
+			HeightMap::const_iterator it = _mainChain.find(block->GetHeight());
+			return it != _mainChain.end() && it->second == block->GetHash();
+		}
+
+	}
+}
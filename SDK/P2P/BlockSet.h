@@ -0,0 +1,62 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_BLOCKSET_H__
+#define __ELASTOS_SDK_BLOCKSET_H__
+
+#include <SDK/Common/uint256.h>
+#include <SDK/Plugin/Interface/IMerkleBlock.h>
+
+#include <unordered_map>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Block index of PeerManager. Blocks are keyed by hash, so every prev-hash lookup done while walking the
+		 * chain is O(1). Besides that, a height -> hash index of the current main chain is maintained through
+		 * SetChainTip(), which makes main chain membership test and locator generation O(1) per step.
+		 */
+		class BlockSet {
+		public:
+			BlockSet();
+
+			~BlockSet();
+
+			MerkleBlockPtr Get(const uint256 &hash) const;
+
+			bool Contains(const MerkleBlockPtr &block) const;
+
+			bool Contains(const uint256 &hash) const;
+
+			// insert block, an existing block with the same hash will be replaced
+			void Insert(const MerkleBlockPtr &block);
+
+			void Remove(const MerkleBlockPtr &block);
+
+			size_t Size() const;
+
+			void Clear();
+
+			// set the tip of main chain, main chain index will be updated back to the fork point
+			void SetChainTip(const MerkleBlockPtr &tip);
+
+			// return the block of main chain at given height, nullptr if unknown
+			MerkleBlockPtr GetMainChainBlock(uint32_t height) const;
+
+			bool IsMainChain(const MerkleBlockPtr &block) const;
+
+		private:
+			typedef std::unordered_map<uint256, MerkleBlockPtr, uint256Hasher> BlockMap;
+			typedef std::unordered_map<uint32_t, uint256> HeightMap;
+
+			BlockMap _blocks;
+			HeightMap _mainChain;
+			uint32_t _tipHeight;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_BLOCKSET_H__
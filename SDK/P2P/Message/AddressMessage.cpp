@@ -20,8 +20,7 @@ namespace Elastos {
 
 		}
 
-		bool AddressMessage::Accept(const bytes_t &msg) {
-			ByteStream stream(msg);
+		bool AddressMessage::Accept(const ByteStream &stream) {
 			uint64_t count = 0;
 
 			if (!stream.ReadUint64(count)) {
@@ -0,0 +1,39 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "FilterAddMessage.h"
+
+#include <SDK/P2P/Peer.h>
+#include <SDK/Common/ByteStream.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		FilterAddMessage::FilterAddMessage(const MessagePeerPtr &peer) :
+			Message(peer) {
+
+		}
+
+		bool FilterAddMessage::Accept(const ByteStream &) {
+			_peer->error("dropping {} message", Type());
+			return false;
+		}
+
+		void FilterAddMessage::Send(const SendMessageParameter &param) {
+			const FilterAddParameter &filterAddParameter = static_cast<const FilterAddParameter &>(param);
+			if (filterAddParameter.Data.empty() || filterAddParameter.Data.size() > MAX_FILTERADD_DATA_SIZE) {
+				_peer->warn("filteradd data size {} out of range", filterAddParameter.Data.size());
+				return;
+			}
+
+			ByteStream stream;
+			stream.WriteVarBytes(filterAddParameter.Data);
+			SendMessage(stream.GetBytes(), Type());
+		}
+
+		std::string FilterAddMessage::Type() const {
+			return MSG_FILTERADD;
+		}
+	}
+}
@@ -17,7 +17,7 @@ namespace Elastos {
 
 		}
 
-		bool FilterLoadMessage::Accept(const bytes_t &msg) {
+		bool FilterLoadMessage::Accept(const ByteStream &stream) {
 			_peer->error("dropping {} message", Type());
 			return false;
 		}
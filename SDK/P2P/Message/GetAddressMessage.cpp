@@ -14,7 +14,7 @@ namespace Elastos {
 
 		}
 
-		bool GetAddressMessage::Accept(const bytes_t &msg) {
+		bool GetAddressMessage::Accept(const ByteStream &stream) {
 			_peer->info("got getaddr");
 			_peer->SendMessage(MSG_ADDR, Message::DefaultParam);
 			return true;
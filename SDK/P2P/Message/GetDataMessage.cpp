@@ -18,8 +18,7 @@ namespace Elastos {
 
 		}
 
-		bool GetDataMessage::Accept(const bytes_t &msg) {
-			ByteStream stream(msg);
+		bool GetDataMessage::Accept(const ByteStream &stream) {
 			uint32_t count = 0;
 
 			if (!stream.ReadUint32(count)) {
@@ -27,7 +26,7 @@ namespace Elastos {
 				return false;
 			}
 
-			if (count > MAX_GETDATA_HASHES || 36 * count + 4 > msg.size()) {
+			if (count > MAX_GETDATA_HASHES || 36 * count + 4 > stream.size()) {
 				_peer->error("dropping getdata message, invalid count = {}", count);
 				return false;
 			}
@@ -0,0 +1,51 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "GetHeadersMessage.h"
+
+#include <SDK/Common/Log.h>
+#include <SDK/Common/Utils.h>
+#include <SDK/P2P/Peer.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		GetHeadersMessage::GetHeadersMessage(const MessagePeerPtr &peer) : Message(peer) {
+
+		}
+
+		bool GetHeadersMessage::Accept(const ByteStream &) {
+			_peer->error("dropping {} message", Type());
+			return false;
+		}
+
+		void GetHeadersMessage::Send(const SendMessageParameter &param) {
+			const GetHeadersParameter &getHeadersParameter = static_cast<const GetHeadersParameter &>(param);
+
+			size_t i, locatorsCount;
+			ByteStream msg;
+
+			locatorsCount = getHeadersParameter.locators.size();
+			msg.WriteUint32(uint32_t(locatorsCount));
+
+			for (i = 0; i < locatorsCount; i++) {
+				msg.WriteBytes(getHeadersParameter.locators[i]);
+			}
+
+			msg.WriteBytes(getHeadersParameter.hashStop);
+
+			if (locatorsCount > 0) {
+				_peer->debug("calling getheaders with {} locators: [{}{}{}]", locatorsCount,
+							 getHeadersParameter.locators.front().GetHex(),
+							 (locatorsCount > 2 ? ", ...," : (locatorsCount > 1 ? "," : "")),
+							 (locatorsCount > 1 ? " " + getHeadersParameter.locators.back().GetHex() : ""));
+				SendMessage(msg.GetBytes(), Type());
+			}
+		}
+
+		std::string GetHeadersMessage::Type() const {
+			return MSG_GETHEADERS;
+		}
+	}
+}
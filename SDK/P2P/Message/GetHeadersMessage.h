@@ -0,0 +1,39 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_GETHEADERSMESSAGE_H__
+#define __ELASTOS_SDK_GETHEADERSMESSAGE_H__
+
+#include "Message.h"
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		struct GetHeadersParameter : public SendMessageParameter {
+			std::vector<uint256> locators;
+			uint256 hashStop;
+
+			GetHeadersParameter() {}
+
+			GetHeadersParameter(const std::vector<uint256> &locators, const uint256 &hashStop) :
+				locators(locators), hashStop(hashStop)
+			{}
+		};
+
+		class GetHeadersMessage : public Message {
+		public:
+			explicit GetHeadersMessage(const MessagePeerPtr &peer);
+
+			virtual bool Accept(const ByteStream &stream);
+
+			virtual void Send(const SendMessageParameter &param);
+
+			virtual std::string Type() const;
+
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_GETHEADERSMESSAGE_H__
@@ -0,0 +1,95 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "HeadersMessage.h"
+#include "GetHeadersMessage.h"
+#include "GetBlocksMessage.h"
+
+#include <SDK/P2P/PeerManager.h>
+#include <SDK/P2P/Peer.h>
+#include <SDK/Common/Log.h>
+#include <SDK/Common/Utils.h>
+#include <SDK/Plugin/Registry.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		HeadersMessage::HeadersMessage(const MessagePeerPtr &peer) : Message(peer) {
+
+		}
+
+		bool HeadersMessage::Accept(const ByteStream &stream) {
+			uint32_t count = 0;
+			std::vector<MerkleBlockPtr> headers;
+			PeerManager *manager = _peer->GetPeerManager();
+			uint32_t now = (uint32_t) time(nullptr);
+
+			if (!stream.ReadUint32(count) || count > MAX_HEADERS_COUNT) {
+				_peer->error("malformed headers message, length is {}, count is {}", stream.size(), count);
+				return false;
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				MerkleBlockPtr header(Registry::Instance()->CreateMerkleBlock(manager->GetPluginType()));
+
+				if (header == nullptr) {
+					_peer->error("create merkle block pointer with type {} fail", manager->GetPluginType());
+					return false;
+				}
+
+				if (!header->DeserializeHeader(stream)) {
+					_peer->error("malformed headers message, header {} of {} deserialize fail", i, count);
+					return false;
+				}
+
+				if (!header->IsValid(now)) {
+					_peer->error("invalid block header: {}", header->GetHash().GetHex());
+					return false;
+				}
+
+				if (i > 0 && header->GetPrevBlockHash() != headers.back()->GetHash()) {
+					_peer->error("non-continuous headers message, header {} of {}", i, count);
+					return false;
+				}
+
+				headers.push_back(header);
+			}
+
+			_peer->info("got {} header(s)", count);
+			if (count == 0) return true;
+
+			// headers are only worth having up to a week before earliestKeyTime, merkleblocks are needed from there on
+			size_t needed = 0;
+			while (needed < headers.size() &&
+				   headers[needed]->GetTimestamp() + 7 * 24 * 60 * 60 <= _peer->GetEarliestKeyTime())
+				needed++;
+
+			// to improve chain download performance, request the next headers (or the first merkleblocks) right away
+			if (needed == headers.size() && count >= MAX_HEADERS_COUNT) {
+				GetHeadersParameter param;
+				param.locators.push_back(headers.back()->GetHash());
+				param.locators.push_back(headers.front()->GetHash());
+				_peer->SendMessage(MSG_GETHEADERS, param);
+			} else {
+				GetBlocksParameter param;
+				if (needed > 0) param.locators.push_back(headers[needed - 1]->GetHash());
+				param.locators.push_back(headers.front()->GetPrevBlockHash());
+				_peer->SendMessage(MSG_GETBLOCKS, param);
+			}
+
+			for (size_t i = 0; i < needed; ++i) {
+				FireRelayedBlock(headers[i]);
+			}
+
+			return true;
+		}
+
+		void HeadersMessage::Send(const SendMessageParameter &) {
+		}
+
+		std::string HeadersMessage::Type() const {
+			return MSG_HEADERS;
+		}
+	}
+}
@@ -15,8 +15,6 @@
 #include <Core/BRArray.h>
 #include <float.h>
 
-#define MAX_BLOCKS_COUNT 100  //note max blocks count is 500 in btc while 100 in ela
-
 namespace Elastos {
 	namespace ElaWallet {
 
@@ -25,8 +23,7 @@ namespace Elastos {
 
 		}
 
-		bool InventoryMessage::Accept(const bytes_t &msg) {
-			ByteStream stream(msg);
+		bool InventoryMessage::Accept(const ByteStream &stream) {
 			uint32_t type;
 
 			uint32_t count;
@@ -92,6 +89,10 @@ namespace Elastos {
 
 				if (_peer->NeedsFilterUpdate()) blocks.clear();
 
+				// syncing from several peers, the manager spreads the blocks over them and asks for more hashes itself
+				if (blocks.size() > 0 && _peer->GetPeerManager()->QueueBlockDownload(_peer, blocks))
+					blocks.clear();
+
 				std::vector<uint256> txHashes;
 				for (i = 0; i < transactions.size(); i++) {
 					if (_peer->KnownTxHashSet().find(transactions[i]) != _peer->KnownTxHashSet().end()) {
@@ -7,6 +7,8 @@
 
 #include "Message.h"
 
+#define MAX_BLOCKS_COUNT 100  //note max blocks count is 500 in btc while 100 in ela
+
 namespace Elastos {
 	namespace ElaWallet {
 
@@ -18,7 +20,7 @@ namespace Elastos {
 		public:
 			explicit InventoryMessage(const MessagePeerPtr &peer);
 
-			virtual bool Accept(const bytes_t &msg);
+			virtual bool Accept(const ByteStream &stream);
 
 			virtual void Send(const SendMessageParameter &param);
 
@@ -26,9 +26,8 @@ namespace Elastos {
 
 		}
 
-		bool MerkleBlockMessage::Accept(const bytes_t &msg) {
+		bool MerkleBlockMessage::Accept(const ByteStream &stream) {
 			std::vector<uint256> txHashes;
-			ByteStream stream(msg);
 
 			PeerManager *manager = _peer->GetPeerManager();
 			MerkleBlockPtr block(Registry::Instance()->CreateMerkleBlock(manager->GetPluginType()));
@@ -39,7 +38,7 @@ namespace Elastos {
 			}
 
 			if (!block->Deserialize(stream)) {
-				_peer->debug("merkle block orignal data: {}", msg.getHex());
+				_peer->debug("merkle block orignal data: {}", stream.GetBytes().getHex());
 				_peer->error("merkle block deserialize with type {} fail", manager->GetPluginType());
 				return false;
 			}
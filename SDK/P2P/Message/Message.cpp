@@ -5,11 +5,50 @@
 #include "Message.h"
 #include <SDK/P2P/Peer.h>
 
+#include <cstring>
+
 namespace Elastos {
 	namespace ElaWallet {
 
 		SendMessageParameter Message::DefaultParam = SendMessageParameter();
 
+		message_type GetMessageType(const char *command) {
+			static const struct {
+				const char *command;
+				message_type type;
+			} types[] = {
+				{MSG_VERSION, message_version},
+				{MSG_VERACK, message_verack},
+				{MSG_ADDR, message_addr},
+				{MSG_INV, message_inv},
+				{MSG_GETDATA, message_getdata},
+				{MSG_NOTFOUND, message_notfound},
+				{MSG_GETBLOCKS, message_getblocks},
+				{MSG_GETHEADERS, message_getheaders},
+				{MSG_TX, message_tx},
+				{MSG_BLOCK, message_block},
+				{MSG_HEADERS, message_headers},
+				{MSG_GETADDR, message_getaddr},
+				{MSG_MEMPOOL, message_mempool},
+				{MSG_PING, message_ping},
+				{MSG_PONG, message_pong},
+				{MSG_FILTERLOAD, message_filterload},
+				{MSG_FILTERADD, message_filteradd},
+				{MSG_FILTERCLEAR, message_filterclear},
+				{MSG_MERKLEBLOCK, message_merkleblock},
+				{MSG_ALERT, message_alert},
+				{MSG_REJECT, message_reject},
+				{MSG_FEEFILTER, message_feefilter}
+			};
+
+			for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+				if (types[i].command[0] == command[0] && strcmp(types[i].command, command) == 0)
+					return types[i].type;
+			}
+
+			return message_unknown;
+		}
+
 		Message::Message(const MessagePeerPtr &peer) :
 				_peer(peer) {
 
@@ -6,6 +6,7 @@
 #define __ELASTOS_SDK_MESSAGE_H__
 
 #include <SDK/P2P/PeerInfo.h>
+#include <SDK/Common/ByteStream.h>
 #include <SDK/Plugin/Transaction/Transaction.h>
 #include <SDK/Plugin/Interface/IMerkleBlock.h>
 
@@ -53,6 +54,37 @@ namespace Elastos {
 			} inv_type;
 		}
 
+		// message types peers dispatch on, one for every MSG_* command above
+		typedef enum {
+			message_unknown = 0,
+			message_version,
+			message_verack,
+			message_addr,
+			message_inv,
+			message_getdata,
+			message_notfound,
+			message_getblocks,
+			message_getheaders,
+			message_tx,
+			message_block,
+			message_headers,
+			message_getaddr,
+			message_mempool,
+			message_ping,
+			message_pong,
+			message_filterload,
+			message_filteradd,
+			message_filterclear,
+			message_merkleblock,
+			message_alert,
+			message_reject,
+			message_feefilter,
+			message_type_count
+		} message_type;
+
+		// type of the NULL terminated command of a message header, message_unknown if it is none of the above
+		message_type GetMessageType(const char *command);
+
 		typedef boost::shared_ptr<Peer> MessagePeerPtr;
 
 		struct SendMessageParameter {
@@ -65,7 +97,7 @@ namespace Elastos {
 
 			virtual ~Message();
 
-			virtual bool Accept(const bytes_t &msg) = 0;
+			virtual bool Accept(const ByteStream &stream) = 0;
 
 			virtual void Send(const SendMessageParameter &param) = 0;
 
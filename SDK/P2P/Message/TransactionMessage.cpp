@@ -21,13 +21,12 @@ namespace Elastos {
 
 		}
 
-		bool TransactionMessage::Accept(const bytes_t &msg) {
-			ByteStream stream(msg);
+		bool TransactionMessage::Accept(const ByteStream &stream) {
 			TransactionPtr tx = TransactionPtr(new Transaction());
 
 
 			if (!tx->Deserialize(stream)) {
-				_peer->error("malformed tx message with length: {}", msg.size());
+				_peer->error("malformed tx message with length: {}", stream.size());
 				return false;
 			} else if (!_peer->SentFilter() && !_peer->SentGetdata()) {
 				_peer->error("got tx message before loading filter");
@@ -20,8 +20,7 @@ namespace Elastos {
 
 		}
 
-		bool VersionMessage::Accept(const bytes_t &msg) {
-			ByteStream stream(msg);
+		bool VersionMessage::Accept(const ByteStream &stream) {
 
 			uint32_t version = 0;
 			if (!stream.ReadUint32(version)) {
@@ -0,0 +1,106 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "OrphanBlockPool.h"
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		OrphanBlockPool::OrphanBlockPool(size_t capacity) :
+			_capacity(capacity > 0 ? capacity : 1) {
+		}
+
+		OrphanBlockPool::~OrphanBlockPool() {
+		}
+
+		void OrphanBlockPool::Insert(const MerkleBlockPtr &block) {
+			Remove(block->GetHash());
+
+			if (_blocks.size() >= _capacity)
+				Erase(--_blocks.end());
+
+			Entry entry;
+			entry.block = block;
+			entry.hash = block->GetHash();
+			entry.prevHash = block->GetPrevBlockHash();
+			entry.height = block->GetHeight();
+			_blocks.push_front(entry);
+
+			_byHash[entry.hash] = _blocks.begin();
+			_byPrevHash.insert(std::make_pair(entry.prevHash, _blocks.begin()));
+			_byHeight.insert(std::make_pair(entry.height, _blocks.begin()));
+		}
+
+		bool OrphanBlockPool::Contains(const uint256 &hash) const {
+			return _byHash.find(hash) != _byHash.end();
+		}
+
+		bool OrphanBlockPool::Remove(const uint256 &hash) {
+			std::unordered_map<uint256, BlockList::iterator, uint256Hasher>::iterator it = _byHash.find(hash);
+			if (it == _byHash.end())
+				return false;
+
+			Erase(it->second);
+			return true;
+		}
+
+		MerkleBlockPtr OrphanBlockPool::TakeChild(const uint256 &prevHash) {
+			std::unordered_multimap<uint256, BlockList::iterator, uint256Hasher>::iterator it = _byPrevHash.find(prevHash);
+			if (it == _byPrevHash.end())
+				return nullptr;
+
+			MerkleBlockPtr block = it->second->block;
+			Erase(it->second);
+			return block;
+		}
+
+		size_t OrphanBlockPool::Prune(uint32_t height) {
+			size_t count = 0;
+
+			while (!_byHeight.empty() && _byHeight.begin()->first < height) {
+				Erase(_byHeight.begin()->second);
+				count++;
+			}
+
+			return count;
+		}
+
+		size_t OrphanBlockPool::Size() const {
+			return _blocks.size();
+		}
+
+		void OrphanBlockPool::Clear() {
+			_byHash.clear();
+			_byPrevHash.clear();
+			_byHeight.clear();
+			_blocks.clear();
+		}
+
+		void OrphanBlockPool::Erase(BlockList::iterator it) {
+			const Entry &entry = *it;
+
+			typedef std::unordered_multimap<uint256, BlockList::iterator, uint256Hasher>::iterator PrevIterator;
+			std::pair<PrevIterator, PrevIterator> prevRange = _byPrevHash.equal_range(entry.prevHash);
+			for (PrevIterator prev = prevRange.first; prev != prevRange.second; ++prev) {
+				if (prev->second == it) {
+					_byPrevHash.erase(prev);
+					break;
+				}
+			}
+
+			typedef std::multimap<uint32_t, BlockList::iterator>::iterator HeightIterator;
+			std::pair<HeightIterator, HeightIterator> heightRange = _byHeight.equal_range(entry.height);
+			for (HeightIterator h = heightRange.first; h != heightRange.second; ++h) {
+				if (h->second == it) {
+					_byHeight.erase(h);
+					break;
+				}
+			}
+
+			_byHash.erase(entry.hash);
+			_blocks.erase(it);
+		}
+
+	}
+}
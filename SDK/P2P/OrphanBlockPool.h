@@ -0,0 +1,71 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_ORPHANBLOCKPOOL_H__
+#define __ELASTOS_SDK_ORPHANBLOCKPOOL_H__
+
+#include <SDK/Common/uint256.h>
+#include <SDK/Plugin/Interface/IMerkleBlock.h>
+
+#include <list>
+#include <map>
+#include <unordered_map>
+
+#define ORPHAN_POOL_SIZE 1000 // orphans kept at most, the least recently relayed ones go first
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Blocks whose previous block isn't known yet. They are indexed by hash and by previous block hash, so the
+		 * orphan continuing a newly connected block is found in O(1) and connecting a run of N orphans is O(N). The
+		 * pool is bounded, relaying an orphan again makes it the most recent one. Not thread safe.
+		 */
+		class OrphanBlockPool {
+		public:
+			explicit OrphanBlockPool(size_t capacity = ORPHAN_POOL_SIZE);
+
+			~OrphanBlockPool();
+
+			// insert block, an orphan with the same hash is replaced
+			void Insert(const MerkleBlockPtr &block);
+
+			bool Contains(const uint256 &hash) const;
+
+			bool Remove(const uint256 &hash);
+
+			// remove and return an orphan whose previous block is prevHash, nullptr if there is none
+			MerkleBlockPtr TakeChild(const uint256 &prevHash);
+
+			// drop orphans below height, the ones of unknown height are kept
+			size_t Prune(uint32_t height);
+
+			size_t Size() const;
+
+			void Clear();
+
+		private:
+			// keys are kept aside, the blocks may be changed while they wait in the pool
+			struct Entry {
+				MerkleBlockPtr block;
+				uint256 hash, prevHash;
+				uint32_t height;
+			};
+
+			typedef std::list<Entry> BlockList;
+
+			void Erase(BlockList::iterator it);
+
+		private:
+			size_t _capacity;
+			BlockList _blocks; // most recent first
+			std::unordered_map<uint256, BlockList::iterator, uint256Hasher> _byHash;
+			std::unordered_multimap<uint256, BlockList::iterator, uint256Hasher> _byPrevHash;
+			std::multimap<uint32_t, BlockList::iterator> _byHeight;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_ORPHANBLOCKPOOL_H__
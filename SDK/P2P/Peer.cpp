@@ -4,6 +4,7 @@
 
 #include "Peer.h"
 #include "PeerManager.h"
+#include "PeerReactor.h"
 #include "Message/PingMessage.h"
 #include "Message/VersionMessage.h"
 #include "Message/VerackMessage.h"
@@ -12,22 +13,27 @@
 #include "Message/GetDataMessage.h"
 #include "Message/NotFoundMessage.h"
 #include "Message/GetBlocksMessage.h"
+#include "Message/GetHeadersMessage.h"
+#include "Message/HeadersMessage.h"
 #include "Message/TransactionMessage.h"
 #include "Message/MerkleBlockMessage.h"
 #include "Message/MempoolMessage.h"
 #include "Message/PongMessage.h"
 #include "Message/FilterLoadMessage.h"
+#include "Message/FilterAddMessage.h"
 #include "Message/GetAddressMessage.h"
 #include "Message/RejectMessage.h"
 
 #include <SDK/Common/Log.h>
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/hash.h>
+#include <SDK/Common/Sha256d.h>
+
+#include <Core/BRCrypto.h>
 
-#include <arpa/inet.h>
 #include <cfloat>
 #include <sys/time.h>
-#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #define HEADER_LENGTH      24
 #define MAX_MSG_LENGTH     0x02000000
@@ -35,8 +41,9 @@
 #define LOCAL_HOST         ((UInt128) { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x01 })
 #define CONNECT_TIMEOUT    3.0
 #define MESSAGE_TIMEOUT    40.0
-
-#define PTHREAD_STACK_SIZE  (512 * 1024)
+#define READ_CHUNK_SIZE    (64 * 1024)
+#define FRAME_POOL_SIZE    8            // spare frame buffers kept per peer
+#define FRAME_POOL_MAX     (256 * 1024) // larger frames are not kept for reuse
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -48,7 +55,14 @@ namespace Elastos {
 				_mempoolTime(DBL_MAX),
 				_disconnectTime(DBL_MAX),
 				_manager(manager),
-				_socket(-1),
+				_strand(PeerReactor::Instance().Service()),
+				_connection(0),
+				_socketConnected(false),
+				_writing(false),
+				_readStart(0),
+				_readEnd(0),
+				_msgTimeout(DBL_MAX),
+				_armedTime(DBL_MAX),
 				_waitingForNetwork(0),
 				_needsFilterUpdate(false),
 				_nonce(0),
@@ -138,10 +152,6 @@ namespace Elastos {
 		}
 
 		void Peer::Connect() {
-			struct timeval tv;
-			int error = 0;
-			pthread_attr_t attr;
-
 			if (_status == Peer::Disconnected || _waitingForNetwork) {
 				_status = Peer::Connecting;
 
@@ -151,67 +161,51 @@ namespace Elastos {
 				} else {
 					info("connecting");
 					_waitingForNetwork = 0;
-					gettimeofday(&tv, NULL);
-					_disconnectTime = tv.tv_sec + (double) tv.tv_usec / 1000000 + CONNECT_TIMEOUT;
+					_disconnectTime = PeerReactor::Now() + CONNECT_TIMEOUT;
 
-					boost::thread workThread(boost::bind(&Peer::PeerThreadRoutine, this));
+					_strand.post(boost::bind(&Peer::OpenSocket, shared_from_this()));
 				}
 			}
 		}
 
 		void Peer::Disconnect() {
-			int socket = _socket;
-
-			if (socket >= 0) {
-				_socket = -1;
-				if (shutdown(socket, SHUT_RDWR) < 0) {
-					this->error("peer shutdown error: {}", FormatError(errno));
-				}
-				close(socket);
-			}
+			_strand.post(boost::bind(&Peer::Close, shared_from_this(), 0));
 		}
 
-		// sends a bitcoin protocol message to peer
+		// queues a bitcoin protocol message to peer, written out by the reactor
 		void Peer::SendMessage(const bytes_t &message, const std::string &type) {
 			if (message.size() > MAX_MSG_LENGTH) {
 				this->error("failed to send {}, length {} is too long", type, message.size());
 			} else {
-				ssize_t n = 0;
-				struct timeval tv;
-				int socket, error = 0;
-				ByteStream stream;
-
-				stream.WriteUint32(_magicNumber);
-				stream.WriteBytes(bytes_t(type.c_str(), type.size()));
-				if (type.size() < 12)
-					stream.WriteBytes(bytes_t(12 - type.size(), 0));
-				stream.WriteUint32(message.size());
-				bytes_t hash = sha256_2(message);
-				stream.WriteUint32(*(uint32_t *)hash.data());
-				stream.WriteBytes(message);
-
-				const bytes_t &buf = stream.GetBytes();
-
-				this->info("sending {}", type);
-				size_t msgLen = 0;
-				socket = _socket;
-				if (socket < 0) error = ENOTCONN;
-
-				while (socket >= 0 && !error && msgLen < buf.size()) {
-					n = send(socket, &buf[msgLen], buf.size() - msgLen, MSG_NOSIGNAL);
-					if (n >= 0) {
-						msgLen += n;
+				bytes_t frame;
+				uint256 hash;
+
+				{
+					boost::mutex::scoped_lock scopedLock(_writeLock);
+					if (!_framePool.empty()) {
+						frame.swap(_framePool.back());
+						_framePool.pop_back();
 					}
-					if (n < 0 && errno != EWOULDBLOCK) error = errno;
-					gettimeofday(&tv, NULL);
-					if (!error && tv.tv_sec + (double) tv.tv_usec / 1000000 >= _disconnectTime) error = ETIMEDOUT;
-					socket = _socket;
 				}
 
-				if (error) {
-					this->error("sending {} message {}", type, FormatError(error));
-					Disconnect();
+				// header and payload go straight into one (pooled) buffer
+				frame.resize(HEADER_LENGTH + message.size());
+				UInt32SetLE(&frame[0], _magicNumber);
+				memset(&frame[4], 0, 12);
+				memcpy(&frame[4], type.c_str(), type.size() < 12 ? type.size() : 12);
+				UInt32SetLE(&frame[16], (uint32_t) message.size());
+				Sha256d::Hash(hash, message.data(), message.size());
+				memcpy(&frame[20], hash.begin(), sizeof(uint32_t));
+				if (!message.empty())
+					memcpy(&frame[HEADER_LENGTH], message.data(), message.size());
+
+				this->info("sending {}", type);
+				{
+					boost::mutex::scoped_lock scopedLock(_writeLock);
+					_writeQueue.push_back(bytes_t());
+					_writeQueue.back().swap(frame);
 				}
+				_strand.post(boost::bind(&Peer::StartWrite, shared_from_this()));
 			}
 		}
 
@@ -233,6 +227,7 @@ namespace Elastos {
 
 			gettimeofday(&tv, NULL);
 			_disconnectTime = (seconds < 0) ? DBL_MAX : tv.tv_sec + (double) tv.tv_usec / 1000000 + seconds;
+			ArmTimer(_disconnectTime);
 		}
 
 		bool Peer::NeedsFilterUpdate() const {
@@ -288,123 +283,272 @@ namespace Elastos {
 			return _info.IsIPv4();
 		}
 
-		void Peer::PeerThreadRoutine() {
-
-			int socket, error = 0;
-
-			if (OpenSocket(PF_INET6, CONNECT_TIMEOUT, &error)) {
-				struct timeval tv;
-				double time = 0, msgTimeout;
-				uint8_t header[HEADER_LENGTH];
-				bytes_t payload;
-				size_t len = 0;
-				ssize_t n = 0;
-
-				gettimeofday(&tv, NULL);
-				_startTime = tv.tv_sec + (double) tv.tv_usec / 1000000;
-				SendMessage(MSG_VERSION, Message::DefaultParam);
-
-				while (_socket >= 0 && !error) {
-					len = 0;
-					socket = _socket;
-
-					while (socket >= 0 && !error && len < HEADER_LENGTH) {
-						n = read(socket, &header[len], sizeof(header) - len);
-						if (n > 0) len += n;
-						if (n == 0)
-							error = ECONNRESET;
-						if (n < 0 && errno != EWOULDBLOCK) {
-							error = errno;
-							if (error == EINTR) {
-								error = 0;
-								continue;
-							}
-						}
-
-						gettimeofday(&tv, NULL);
-						time = tv.tv_sec + (double) tv.tv_usec / 1000000;
-						if (!error && time >= _disconnectTime) error = ETIMEDOUT;
-
-						if (!error && time >= _mempoolTime) {
-							info("done waiting for mempool response");
-							PingParameter pingParameter(_manager->GetLastBlockHeight(), _mempoolCallback);
-							SendMessage(MSG_PING, pingParameter);
-							_mempoolCallback = PeerCallback();
-							_mempoolTime = DBL_MAX;
-						}
-
-						while (sizeof(uint32_t) <= len && UInt32GetLE(header) != _magicNumber) {
-							memmove(header, &header[1],
-									--len); // consume one byte at a time until we find the magic number
-						}
-
-						socket = _socket;
-					}
+		void Peer::OpenSocket() {
+			boost::system::error_code ec;
+			boost::asio::ip::tcp::endpoint endpoint;
 
-					if (error) {
-						if (_socket != -1) {
-							this->error("read header error: {}", FormatError(error));
-						}
-					} else if (header[15] != 0) { // verify header type field is NULL terminated
-						this->error("malformed message header: type not NULL terminated");
-						error = EPROTO;
-					} else if (len == HEADER_LENGTH) {
-						std::string type = (const char *) (&header[4]);
-						uint32_t msgLen = *(uint32_t*)&header[16];
-						uint32_t checksum = *(uint32_t*)(&header[20]);
-
-						if (msgLen > MAX_MSG_LENGTH) { // check message length
-							this->error("error reading {}, message length {} is too long", type, msgLen);
-							error = EPROTO;
-						} else {
-							payload.resize(size_t(msgLen));
-							len = 0;
-							socket = _socket;
-							msgTimeout = time + MESSAGE_TIMEOUT;
-
-							while (socket >= 0 && !error && len < msgLen) {
-								n = read(socket, &payload[len], msgLen - len);
-								if (n > 0) len += n;
-								if (n == 0)
-									error = ECONNRESET;
-								if (n < 0 && errno != EWOULDBLOCK) {
-									error = errno;
-									if (error == EINTR) {
-										error = 0;
-										continue;
-									}
-								}
-
-								gettimeofday(&tv, NULL);
-								time = tv.tv_sec + (double) tv.tv_usec / 1000000;
-								if (n > 0) msgTimeout = time + MESSAGE_TIMEOUT;
-								if (!error && time >= msgTimeout)
-									error = ETIMEDOUT;
-								socket = _socket;
-							}
-
-							if (error) {
-								if (_socket != -1) {
-									this->error("read message error: {}", FormatError(error));
-								}
-							} else if (len == msgLen) {
-								bytes_t hash = sha256_2(payload);;
-
-								if (*(uint32_t *)(&hash[0]) != checksum) { // verify checksum
-									this->error("reading {}, invalid checksum {:x}, expected {:x}, payload length:{},",
-												type, UInt32GetLE(&hash), checksum, msgLen);
-									error = EPROTO;
-								} else if (!AcceptMessage(payload, type)) error = EPROTO;
-							}
-						}
-					}
+			if (_socket)
+				return;
+
+			if (IsIPv4()) {
+				boost::asio::ip::address_v4::bytes_type bytes;
+				memcpy(bytes.data(), &_info.Address.begin()[12], bytes.size());
+				endpoint = boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4(bytes), _info.Port);
+			} else {
+				boost::asio::ip::address_v6::bytes_type bytes;
+				memcpy(bytes.data(), _info.Address.begin(), bytes.size());
+				endpoint = boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v6(bytes), _info.Port);
+			}
+
+			_connection++;
+			_socketConnected = false;
+			_writing = false;
+			_readStart = _readEnd = 0;
+			_msgTimeout = DBL_MAX;
+			{
+				boost::mutex::scoped_lock scopedLock(_writeLock);
+				_writeQueue.clear();
+			}
+			_socket = boost::shared_ptr<Socket>(new Socket(PeerReactor::Instance().Service()));
+			_socket->open(endpoint.protocol(), ec);
+			if (ec) {
+				this->error("connect error: {}", ec.message());
+				Close(ec.value());
+				return;
+			}
+
+			_socket->set_option(boost::asio::socket_base::keep_alive(true), ec);
+			_socket->async_connect(endpoint, _strand.wrap(boost::bind(&Peer::OnSocketConnected, shared_from_this(),
+																	   _connection, boost::asio::placeholders::error)));
+			ArmTimer(_disconnectTime);
+		}
+
+		void Peer::OnSocketConnected(uint64_t connection, const boost::system::error_code &ec) {
+			if (!_socket || connection != _connection)
+				return;
+
+			if (ec) {
+				this->error("connect error: {}", ec.message());
+				Close(ec.value());
+				return;
+			}
+
+			info("socket connected");
+			_socketConnected = true;
+			_startTime = PeerReactor::Now();
+			SendMessage(MSG_VERSION, Message::DefaultParam);
+			StartRead();
+		}
+
+		void Peer::StartRead() {
+			if (_readBuffer.size() - _readEnd < READ_CHUNK_SIZE)
+				_readBuffer.resize(_readEnd + READ_CHUNK_SIZE);
+
+			_socket->async_read_some(boost::asio::buffer(&_readBuffer[_readEnd], _readBuffer.size() - _readEnd),
+									 _strand.wrap(boost::bind(&Peer::OnRead, shared_from_this(), _connection,
+															  boost::asio::placeholders::error,
+															  boost::asio::placeholders::bytes_transferred)));
+		}
+
+		void Peer::OnRead(uint64_t connection, const boost::system::error_code &ec, size_t n) {
+			int error = 0;
+
+			if (!_socket || connection != _connection)
+				return;
+
+			if (ec) {
+				error = (ec == boost::asio::error::eof) ? ECONNRESET : ec.value();
+				this->error("read error: {}", FormatError(error));
+			} else {
+				_readEnd += n;
+				error = ReadMessages();
+			}
+
+			if (error) {
+				Close(error);
+			} else if (_socket && connection == _connection) {
+				StartRead();
+			}
+		}
+
+		// frames and accepts every complete message in the read buffer
+		int Peer::ReadMessages() {
+			uint64_t connection = _connection;
+			int error = 0;
+
+			while (!error && _socket && connection == _connection) {
+				size_t skip = 0, len = _readEnd - _readStart;
+				const uint8_t *header = &_readBuffer[_readStart];
+
+				// skip ahead until we find the magic number
+				while (skip + sizeof(uint32_t) <= len && UInt32GetLE(&header[skip]) != _magicNumber)
+					skip++;
+				_readStart += skip;
+				header += skip;
+				len -= skip;
+
+				if (len < HEADER_LENGTH) {
+					_msgTimeout = DBL_MAX;
+					break;
+				}
+
+				if (header[15] != 0) { // verify header type field is NULL terminated
+					this->error("malformed message header: type not NULL terminated");
+					error = EPROTO;
+					break;
+				}
+
+				const char *type = (const char *) (&header[4]);
+				uint32_t msgLen = *(uint32_t*)&header[16];
+				uint32_t checksum = *(uint32_t*)(&header[20]);
+
+				if (msgLen > MAX_MSG_LENGTH) { // check message length
+					this->error("error reading {}, message length {} is too long", type, msgLen);
+					error = EPROTO;
+					break;
 				}
+
+				if (len < HEADER_LENGTH + msgLen) { // payload still on the way, refreshed on every read
+					_msgTimeout = PeerReactor::Now() + MESSAGE_TIMEOUT;
+					ArmTimer(_msgTimeout);
+					break;
+				}
+
+				// the payload is parsed in place, the read buffer is left alone until it is accepted
+				const uint8_t *payload = &header[HEADER_LENGTH];
+				uint256 hash;
+				Sha256d::Hash(hash, payload, msgLen);
+
+				if (*(uint32_t *)(hash.begin()) != checksum) { // verify checksum
+					this->error("reading {}, invalid checksum {:x}, expected {:x}, payload length:{},",
+								type, UInt32GetLE(hash.begin()), checksum, msgLen);
+					error = EPROTO;
+				} else if (!AcceptMessage(ByteStream(payload, msgLen, false), GetMessageType(type), type)) {
+					error = EPROTO;
+				}
+				_readStart += HEADER_LENGTH + msgLen;
 			}
 
-			socket = _socket;
-			_socket = -1;
+			if (_readStart == _readEnd) {
+				_readStart = _readEnd = 0;
+			} else if (_readStart > _readBuffer.size() / 2) {
+				memmove(&_readBuffer[0], &_readBuffer[_readStart], _readEnd - _readStart);
+				_readEnd -= _readStart;
+				_readStart = 0;
+			}
+
+			return error;
+		}
+
+		void Peer::StartWrite() {
+			if (_writing || !_socket || !_socketConnected) // flushed once the socket is connected
+				return;
+
+			{
+				boost::mutex::scoped_lock scopedLock(_writeLock);
+				if (_writeQueue.empty())
+					return;
+				_writeBuffer.swap(_writeQueue.front());
+				_writeQueue.pop_front();
+			}
+
+			_writing = true;
+			boost::asio::async_write(*_socket, boost::asio::buffer(_writeBuffer),
+									 _strand.wrap(boost::bind(&Peer::OnWritten, shared_from_this(), _connection,
+															  boost::asio::placeholders::error)));
+		}
+
+		void Peer::OnWritten(uint64_t connection, const boost::system::error_code &ec) {
+			if (!_socket || connection != _connection)
+				return;
+
+			_writing = false;
+			if (_writeBuffer.capacity() <= FRAME_POOL_MAX) {
+				boost::mutex::scoped_lock scopedLock(_writeLock);
+				if (_framePool.size() < FRAME_POOL_SIZE) {
+					_framePool.push_back(bytes_t());
+					_framePool.back().swap(_writeBuffer);
+				}
+			}
+			_writeBuffer.clear();
+
+			if (ec) {
+				this->error("sending message {}", ec.message());
+				Close(ec.value());
+			} else {
+				StartWrite();
+			}
+		}
+
+		void Peer::OnTimer() {
+			double time = PeerReactor::Now();
+
+			{
+				boost::mutex::scoped_lock scopedLock(_timerLock);
+				_armedTime = DBL_MAX;
+			}
+
+			if (!_socket)
+				return;
+
+			if (time >= _disconnectTime) {
+				this->error("read header error: {}", FormatError(ETIMEDOUT));
+				Close(ETIMEDOUT);
+				return;
+			}
+
+			if (time >= _msgTimeout) {
+				this->error("read message error: {}", FormatError(ETIMEDOUT));
+				Close(ETIMEDOUT);
+				return;
+			}
+
+			if (time >= _mempoolTime) {
+				info("done waiting for mempool response");
+				PingParameter pingParameter(_manager->GetLastBlockHeight(), _mempoolCallback);
+				SendMessage(MSG_PING, pingParameter);
+				_mempoolCallback = PeerCallback();
+				_mempoolTime = DBL_MAX;
+			}
+
+			ArmTimer(std::min(std::min((double) _disconnectTime, (double) _mempoolTime), _msgTimeout));
+		}
+
+		void Peer::ArmTimer(double time) {
+			if (time == DBL_MAX)
+				return;
+
+			{
+				boost::mutex::scoped_lock scopedLock(_timerLock);
+				if (time >= _armedTime)
+					return;
+				_armedTime = time;
+			}
+
+			boost::weak_ptr<Peer> weakPeer(shared_from_this());
+			PeerReactor::Instance().Schedule(time, [weakPeer]() {
+				PeerPtr peer = weakPeer.lock();
+				if (peer)
+					peer->_strand.post(boost::bind(&Peer::OnTimer, peer));
+			});
+		}
+
+		void Peer::Close(int error) {
+			boost::system::error_code ec;
+
+			if (!_socket)
+				return;
+
+			_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+			_socket->close(ec);
+			_socket.reset();
+			_socketConnected = false;
+			_writing = false;
+			{
+				boost::mutex::scoped_lock scopedLock(_writeLock);
+				_writeQueue.clear();
+			}
 			_status = Peer::Disconnected;
-			if (socket >= 0) close(socket);
 			info("disconnected");
 
 			while (!_pongCallbackList.empty()) {
@@ -433,28 +577,31 @@ namespace Elastos {
 			InitSingleMessage(new GetDataMessage(shared_from_this()));
 			InitSingleMessage(new NotFoundMessage(shared_from_this()));
 			InitSingleMessage(new GetBlocksMessage(shared_from_this()));
+			InitSingleMessage(new GetHeadersMessage(shared_from_this()));
+			InitSingleMessage(new HeadersMessage(shared_from_this()));
 			InitSingleMessage(new TransactionMessage(shared_from_this()));
 			InitSingleMessage(new MempoolMessage(shared_from_this()));
 			InitSingleMessage(new PingMessage(shared_from_this()));
 			InitSingleMessage(new PongMessage(shared_from_this()));
 			InitSingleMessage(new FilterLoadMessage(shared_from_this()));
+			InitSingleMessage(new FilterAddMessage(shared_from_this()));
 			InitSingleMessage(new MerkleBlockMessage(shared_from_this()));
 			InitSingleMessage(new GetAddressMessage(shared_from_this()));
 			InitSingleMessage(new RejectMessage(shared_from_this()));
 		}
 
-		bool Peer::AcceptMessage(const bytes_t &msg, const std::string &type) {
+		bool Peer::AcceptMessage(const ByteStream &msg, message_type type, const char *command) {
 			bool r = false;
 
-			if (_currentBlock != nullptr && MSG_TX != type) { // if we receive a non-tx message, merkleblock is done
+			if (_currentBlock != nullptr && type != message_tx) { // if we receive a non-tx message, merkleblock is done
 				this->error("incomplete merkleblock {}, expected {} more tx, got {}",
-							_currentBlock->GetHash().GetHex(), _currentBlockTxHashes.size(), type);
+							_currentBlock->GetHash().GetHex(), _currentBlockTxHashes.size(), command);
 				_currentBlockTxHashes.clear();
 				_currentBlock.reset();
 				r = 0;
-			} else if (_messages.find(type) != _messages.end())
+			} else if (_messages[type] != nullptr)
 				r = _messages[type]->Accept(msg);
-			else this->error("dropping {}, length {}, not implemented", type, msg.size());
+			else this->error("dropping {}, length {}, not implemented", command, msg.size());
 
 			return r;
 		}
@@ -593,83 +740,14 @@ namespace Elastos {
 			return std::string(strerror(errnum));
 		}
 
-		int Peer::OpenSocket(int domain, double timeout, int *error) {
-			struct sockaddr_storage addr;
-			struct timeval tv;
-			fd_set fds;
-			socklen_t addrLen, optLen;
-			int count, arg = 0, err = 0, on = 1, r = 1;
-
-			_socket = socket(domain, SOCK_STREAM, 0);
-
-			if (_socket < 0) {
-				err = errno;
-				r = 0;
-			} else {
-				tv.tv_sec = 1; // one second timeout for send/receive, so thread doesn't block for too long
-				tv.tv_usec = 0;
-				setsockopt(_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-				setsockopt(_socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-				setsockopt(_socket, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
-#ifdef SO_NOSIGPIPE // BSD based systems have a SO_NOSIGPIPE socket option to supress SIGPIPE signals
-				setsockopt(_socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
-#endif
-				arg = fcntl(_socket, F_GETFL, NULL);
-				if (arg < 0 || fcntl(_socket, F_SETFL, arg | O_NONBLOCK) < 0)
-					r = 0; // temporarily set socket non-blocking
-				if (!r) err = errno;
-			}
-
-			if (r) {
-				memset(&addr, 0, sizeof(addr));
-
-				if (domain == PF_INET6) {
-					((struct sockaddr_in6 *) &addr)->sin6_family = AF_INET6;
-					((struct sockaddr_in6 *) &addr)->sin6_addr = *(struct in6_addr *) &_info.Address;
-					((struct sockaddr_in6 *) &addr)->sin6_port = htons(_info.Port);
-					addrLen = sizeof(struct sockaddr_in6);
-				} else {
-					((struct sockaddr_in *) &addr)->sin_family = AF_INET;
-					((struct sockaddr_in *) &addr)->sin_addr = *(struct in_addr *) &_info.Address.begin()[12];
-					((struct sockaddr_in *) &addr)->sin_port = htons(_info.Port);
-					addrLen = sizeof(struct sockaddr_in);
-				}
-
-				if (connect(_socket, (struct sockaddr *) &addr, addrLen) < 0) err = errno;
-
-				if (err == EINPROGRESS) {
-					err = 0;
-					optLen = sizeof(err);
-					tv.tv_sec = timeout;
-					tv.tv_usec = (long) (timeout * 1000000) % 1000000;
-					FD_ZERO(&fds);
-					FD_SET(_socket, &fds);
-					count = select(_socket + 1, NULL, &fds, NULL, &tv);
-
-					if (count <= 0 || getsockopt(_socket, SOL_SOCKET, SO_ERROR, &err, &optLen) < 0 || err) {
-						if (count == 0) err = ETIMEDOUT;
-						if (count < 0 || !err) err = errno;
-						r = 0;
-					}
-				} else if (err && domain == PF_INET6 && IsIPv4()) {
-					return OpenSocket(PF_INET, timeout, error); // fallback to IPv4
-				} else if (err) r = 0;
-
-				if (r) info("socket connected");
-				fcntl(_socket, F_SETFL, arg); // restore socket non-blocking status
-			}
-
-			if (!r && err) this->error("connect error: {}", FormatError(err));
-			if (error && err) *error = err;
-			return r;
-		}
-
 		void Peer::SendMessage(const std::string &msgType, const SendMessageParameter &parameter) {
-			if (_messages.find(msgType) == _messages.end()) {
+			message_type type = GetMessageType(msgType.c_str());
+
+			if (_messages[type] == nullptr) {
 				warn("sending unknown type message, message type: {}", msgType);
 				return;
 			}
-			_messages[msgType]->Send(parameter);
+			_messages[type]->Send(parameter);
 		}
 
 		double Peer::GetStartTime() const {
@@ -706,6 +784,7 @@ namespace Elastos {
 
 		void Peer::SetDisconnectTime(double time) {
 			_disconnectTime = time;
+			ArmTimer(time);
 		}
 
 		Peer::PeerCallback Peer::PopPongCallback() {
@@ -753,10 +832,11 @@ namespace Elastos {
 
 		void Peer::SetMempoolTime(double time) {
 			_mempoolTime = time;
+			ArmTimer(time);
 		}
 
 		void Peer::InitSingleMessage(Message *message) {
-			_messages[message->Type()] = MessagePtr(message);
+			_messages[GetMessageType(message->Type().c_str())] = MessagePtr(message);
 		}
 
 	}
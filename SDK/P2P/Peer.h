@@ -13,6 +13,8 @@
 #include <SDK/Common/uint256.h>
 
 #include <deque>
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/function.hpp>
@@ -335,11 +337,29 @@ namespace Elastos {
 
 			bool NetworkIsReachable() const;
 
-			bool AcceptMessage(const bytes_t &msg, const std::string &type);
+			bool AcceptMessage(const ByteStream &msg, message_type type, const char *command);
 
-			int OpenSocket(int domain, double timeout, int *error);
+			// everything below runs on _strand, see PeerReactor
+			void OpenSocket();
 
-			void PeerThreadRoutine();
+			void OnSocketConnected(uint64_t connection, const boost::system::error_code &ec);
+
+			void StartRead();
+
+			void OnRead(uint64_t connection, const boost::system::error_code &ec, size_t n);
+
+			int ReadMessages();
+
+			void StartWrite();
+
+			void OnWritten(uint64_t connection, const boost::system::error_code &ec);
+
+			void OnTimer();
+
+			void Close(int error);
+
+			// ask the reactor for a timeout check at time, unless one is due earlier already
+			void ArmTimer(double time);
 
 		private:
 			friend class Message;
@@ -362,13 +382,28 @@ namespace Elastos {
 			MerkleBlockPtr _currentBlock;
 			std::vector<uint256> _currentBlockTxHashes, _knownBlockHashes, _knownTxHashes;
 			std::set<uint256> _knownTxHashSet;
-			volatile int _socket;
+
+			typedef boost::asio::ip::tcp::socket Socket;
+			boost::asio::io_service::strand _strand;
+			boost::shared_ptr<Socket> _socket;
+			uint64_t _connection;
+			bool _socketConnected, _writing;
+			bytes_t _readBuffer, _writeBuffer;
+			size_t _readStart, _readEnd;
+			double _msgTimeout;
+
+			boost::mutex _writeLock;
+			std::deque<bytes_t> _writeQueue;
+			std::vector<bytes_t> _framePool; // written frames kept for reuse with their capacity
+
+			boost::mutex _timerLock;
+			double _armedTime;
 
 			PeerCallback _mempoolCallback;
 			std::deque<PeerCallback> _pongCallbackList;
 
 			typedef boost::shared_ptr<Message> MessagePtr;
-			std::map<std::string, MessagePtr> _messages;
+			MessagePtr _messages[message_type_count];
 			PeerManager *_manager;
 			Listener *_listener;
 		};
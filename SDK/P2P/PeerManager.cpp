@@ -3,9 +3,12 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "PeerManager.h"
+#include "PeerReactor.h"
 #include "Message/PingMessage.h"
 #include "Message/GetBlocksMessage.h"
+#include "Message/GetHeadersMessage.h"
 #include "Message/FilterLoadMessage.h"
+#include "Message/FilterAddMessage.h"
 #include "Message/MempoolMessage.h"
 #include "Message/GetDataMessage.h"
 #include "Message/InventoryMessage.h"
@@ -30,11 +33,16 @@
 #include <boost/bind.hpp>
 #include <boost/thread.hpp>
 #include <arpa/inet.h>
+#include <algorithm>
 
 #define PROTOCOL_TIMEOUT      40.0
 #define MAX_CONNECT_FAILURES  40 // notify user of network problems after this many connect failures in a row
 #define PEER_FLAG_SYNCED      0x01
 #define PEER_FLAG_NEEDSUPDATE 0x02
+#define PEER_FLAG_DOWNLOADING 0x04 // downloading blocks of the chain sync along with the download peer
+
+#define BLOCK_DOWNLOAD_MAX_QUEUED    2000 // block hashes queued before asking for more
+#define BLOCK_DOWNLOAD_STALL_TIMEOUT 15.0 // seconds without a block before a peer's ranges are reassigned
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -126,6 +134,9 @@ namespace Elastos {
 
 				_syncSucceeded(false),
 				_enableReconnect(true),
+				_needBlockHashes(false),
+				_stallCheckToken(new StallCheckToken()),
+				_stallCheckArmed(false),
 
 				_isConnected(0),
 				_connectFailureCount(0),
@@ -140,12 +151,19 @@ namespace Elastos {
 				_syncStartHeight(0),
 				_filterUpdateHeight(0),
 				_estimatedHeight(0),
+				_lastBlockHeight(0),
+				_lastBlockTimestamp(0),
+				_publishedTxCallbacks(0),
 
+				_filterElementCount(0),
+				_filterElementCapacity(0),
+				_filterTweak(BRRand(0)),
 				_fpRate(0),
 				_averageTxPerBlock(1400) {
 
 			assert(listener != nullptr);
 			_listener = boost::weak_ptr<Listener>(listener);
+			_stallCheckToken->manager = this;
 
 			if (peers.size() == 0) {
 				_needGetAddr = true;
@@ -166,14 +184,15 @@ namespace Elastos {
 				_checkpoints.Insert(checkBlock);
 				_blocks.Insert(checkBlock);
 				if (i == 0 || checkBlock->GetTimestamp() + 1 * 24 * 60 * 60 < earliestKeyTime)
-					_lastBlock = checkBlock;
+					SetLastBlock(checkBlock);
 			}
 
 			MerkleBlockPtr block = nullptr, earlistBlock = nullptr;
+			OrphanBlockPool saved(blocks.size());
 			for (size_t i = 0; i < blocks.size(); i++) {
 				assert(blocks[i]->GetHeight() !=
 					   BLOCK_UNKNOWN_HEIGHT); // height must be saved/restored along with serialized block
-				_orphans.insert(blocks[i]);
+				saved.Insert(blocks[i]);
 
 				if ((blocks[i]->GetHeight() % BLOCK_DIFFICULTY_INTERVAL) == 0 &&
 					(block == nullptr || blocks[i]->GetHeight() > block->GetHeight()))
@@ -185,33 +204,19 @@ namespace Elastos {
 			if (block == nullptr)
 				block = earlistBlock;
 
-			uint256 hash;
+			// the saved blocks from the last transition block on are the chain, the older ones are dropped
 			while (block != nullptr) {
 				_blocks.Insert(block);
-				_lastBlock = block;
-
-				hash = block->GetPrevBlockHash();
-				for (std::set<MerkleBlockPtr>::const_iterator it = _orphans.cbegin(); it != _orphans.cend();) {
-					if (hash == (*it)->GetPrevBlockHash()) {
-						it = _orphans.erase(it);
-						break;
-					} else {
-						++it;
-					}
-				}
-
-				hash = block->GetHash();
-				block = nullptr;
-				for (std::set<MerkleBlockPtr>::const_iterator it = _orphans.cbegin(); it != _orphans.cend(); ++it) {
-					if (hash == (*it)->GetPrevBlockHash()) {
-						block = *it;
-						break;
-					}
-				}
+				SetLastBlock(block);
+				block = saved.TakeChild(block->GetHash());
 			}
+
+			_blocks.SetChainTip(_lastBlock);
 		}
 
 		PeerManager::~PeerManager() {
+			boost::mutex::scoped_lock scopedLock(_stallCheckToken->lock);
+			_stallCheckToken->manager = nullptr;
 		}
 
 		void PeerManager::SetWallet(const WalletPtr &wallet) {
@@ -222,7 +227,7 @@ namespace Elastos {
 			Peer::ConnectStatus status = Peer::Disconnected;
 
 			{
-				boost::mutex::scoped_lock scoped_lock(lock);
+				boost::mutex::scoped_lock scoped_lock(_peersLock);
 				if (_isConnected != 0) status = Peer::Connected;
 
 				for (size_t i = _connectedPeers.size(); i > 0 && status == Peer::Disconnected; i--) {
@@ -240,22 +245,18 @@ namespace Elastos {
 		}
 
 		bool PeerManager::SyncSucceeded() const {
-			boost::mutex::scoped_lock scopedLock(lock);
 			return _syncSucceeded;
 		}
 
 		void PeerManager::SetSyncSucceeded(bool succeeded) {
-			boost::mutex::scoped_lock scopedLock(lock);
 			_syncSucceeded = succeeded;
 		}
 
 		void PeerManager::SetReconnectEnableStatus(bool status) {
-			boost::mutex::scoped_lock scopedLock(lock);
 			_enableReconnect = status;
 		}
 
 		bool PeerManager::GetReconnectEnableStatus() const {
-			boost::mutex::scoped_lock scopedLock(lock);
 			return _enableReconnect;
 		}
 
@@ -304,7 +305,10 @@ namespace Elastos {
 						newPeer->setEarliestKeyTime(_earliestKeyTime);
 						peers.erase(peers.begin() + i);
 
-						_connectedPeers.push_back(newPeer);
+						{
+							boost::mutex::scoped_lock peersLock(_peersLock);
+							_connectedPeers.push_back(newPeer);
+						}
 						newPeer->Connect();
 					}
 				}
@@ -402,7 +406,9 @@ namespace Elastos {
 					if (i - 1 == 0 ||
 						checkpoints[i - 1].Timestamp() + 7 * 24 * 60 * 60 < _earliestKeyTime) {
 						uint256 hash = checkpoints[i - 1].Hash();
-						_lastBlock = _blocks.Get(hash);
+						boost::unique_lock<boost::shared_mutex> chainLock(_chainLock);
+						SetLastBlock(_blocks.Get(hash));
+						_blocks.SetChainTip(_lastBlock);
 						break;
 					}
 				}
@@ -431,37 +437,31 @@ namespace Elastos {
 		}
 
 		uint32_t PeerManager::GetEstimatedBlockHeight() const {
-			uint32_t height;
+			uint32_t lastHeight = _lastBlockHeight, estimatedHeight = _estimatedHeight;
 
-			{
-				boost::mutex::scoped_lock scoped_lock(lock);
-				height = (_lastBlock->GetHeight() < _estimatedHeight) ? _estimatedHeight : _lastBlock->GetHeight();
-			}
-			return height;
+			return (lastHeight < estimatedHeight) ? estimatedHeight : lastHeight;
 		}
 
 		uint32_t PeerManager::GetLastBlockHeight() const {
-			boost::mutex::scoped_lock scoped_lock(lock);
-			return _lastBlock->GetHeight();
+			return _lastBlockHeight;
 		}
 
 		uint32_t PeerManager::GetLastBlockTimestamp() const {
-			uint32_t timestamp;
+			return _lastBlockTimestamp;
+		}
 
-			{
-				boost::mutex::scoped_lock scoped_lock(lock);
-				timestamp = _lastBlock->GetTimestamp();
-			}
-			return timestamp;
+		bool PeerManager::GetMainChainBlockHash(uint32_t height, uint256 &hash) const {
+			boost::shared_lock<boost::shared_mutex> scoped_lock(_chainLock);
+			MerkleBlockPtr block = _blocks.GetMainChainBlock(height);
+			if (block == nullptr)
+				return false;
+
+			hash = block->GetHash();
+			return true;
 		}
 
 		time_t PeerManager::GetKeepAliveTimestamp() const {
-			time_t t;
-			{
-				boost::mutex::scoped_lock scoped_lock(lock);
-				t = _keepAliveTimestamp;
-			}
-			return t;
+			return _keepAliveTimestamp;
 		}
 
 		void PeerManager::SetKeepAliveTimestamp(time_t t) {
@@ -470,19 +470,24 @@ namespace Elastos {
 
 		double PeerManager::GetSyncProgress(uint32_t startHeight) {
 			double progress;
+			bool hasDownloadPeer;
+			uint32_t syncStartHeight = _syncStartHeight, lastHeight = _lastBlockHeight, estimatedHeight = _estimatedHeight;
 
 			{
-				boost::mutex::scoped_lock scoped_lock(lock);
-				if (startHeight == 0) startHeight = _syncStartHeight;
-
-				if (!_downloadPeer && _syncStartHeight == 0) {
-					progress = 0.0;
-				} else if (!_downloadPeer || _lastBlock->GetHeight() < _estimatedHeight) {
-					if (_lastBlock->GetHeight() > startHeight && _estimatedHeight > startHeight) {
-						progress = 0.1 + 0.9 * (_lastBlock->GetHeight() - startHeight) / (_estimatedHeight - startHeight);
-					} else progress = 0.05;
-				} else progress = 1.0;
+				boost::mutex::scoped_lock scoped_lock(_peersLock);
+				hasDownloadPeer = _downloadPeer != nullptr;
 			}
+
+			if (startHeight == 0) startHeight = syncStartHeight;
+
+			if (!hasDownloadPeer && syncStartHeight == 0) {
+				progress = 0.0;
+			} else if (!hasDownloadPeer || lastHeight < estimatedHeight) {
+				if (lastHeight > startHeight && estimatedHeight > startHeight) {
+					progress = 0.1 + 0.9 * (lastHeight - startHeight) / (estimatedHeight - startHeight);
+				} else progress = 0.05;
+			} else progress = 1.0;
+
 			return progress;
 		}
 
@@ -528,19 +533,18 @@ namespace Elastos {
 		}
 
 		std::string PeerManager::GetDownloadPeerName() const {
-			{
-				boost::mutex::scoped_lock scoped_lock(lock);
-				if (_downloadPeer) {
-					std::stringstream ss;
-					ss << _downloadPeer->GetHost() << ":" << _downloadPeer->GetPort();
-					_downloadPeerName = ss.str();
-				} else _downloadPeerName = "";
+			PeerPtr peer = GetDownloadPeer();
+
+			if (peer) {
+				std::stringstream ss;
+				ss << peer->GetHost() << ":" << peer->GetPort();
+				return ss.str();
 			}
-			return _downloadPeerName;
+			return "";
 		}
 
 		const PeerPtr PeerManager::GetDownloadPeer() const {
-			boost::mutex::scoped_lock scopedLock(lock);
+			boost::mutex::scoped_lock scopedLock(_peersLock);
 			return _downloadPeer;
 		}
 
@@ -548,7 +552,7 @@ namespace Elastos {
 			size_t count = 0;
 
 			{
-				boost::mutex::scoped_lock scoped_lock(lock);
+				boost::mutex::scoped_lock scoped_lock(_peersLock);
 				for (size_t i = _connectedPeers.size(); i > 0; i--) {
 					if (_connectedPeers[i - 1]->GetConnectStatus() != Peer::Disconnected) count++;
 				}
@@ -564,9 +568,10 @@ namespace Elastos {
 											 const Peer::PeerPubTxCallback &callback) {
 
 			bool txValid = (tx != nullptr);
+			bool txSigned = txValid && _wallet->TransactionIsValid(tx); // verified outside the lock
 			if (tx) lock.lock();
 
-			if (tx && !tx->IsSigned()) {
+			if (tx && !txSigned) {
 				lock.unlock();
 				if (!callback.empty()) callback(tx->GetHash(), EINVAL, "tx not signed"); // transaction not signed
 				txValid = false;
@@ -616,13 +621,8 @@ namespace Elastos {
 			assert(txHash != 0);
 
 			{
-				boost::mutex::scoped_lock scoped_lock(lock);
-				for (size_t i = _txRelays.size(); i > 0; i--) {
-					if (_txRelays[i - 1].GetTransactionHash() != txHash)
-						continue;
-					count = _txRelays[i - 1].GetPeers().size();
-					break;
-				}
+				boost::mutex::scoped_lock scoped_lock(_txLock);
+				count = _txRelays.Count(txHash);
 			}
 
 			return count;
@@ -637,10 +637,11 @@ namespace Elastos {
 
 			assert(block != nullptr);
 
-			uint64_t blocksPerRetarget = targetTimeSpan / targetTimePerBlock;
+			// chain params without a retarget schedule never hit a transition
+			uint64_t blocksPerRetarget = targetTimePerBlock > 0 ? targetTimeSpan / targetTimePerBlock : 0;
 
 			// check if we hit a difficulty transition, and find previous transition block
-			if ((block->GetHeight() % blocksPerRetarget) == 0) {
+			if (blocksPerRetarget > 0 && (block->GetHeight() % blocksPerRetarget) == 0) {
 				for (i = 0, b = block; b && i < blocksPerRetarget; i++) {
 					b = blockSet.Get(b->GetPrevBlockHash());
 				}
@@ -689,85 +690,37 @@ namespace Elastos {
 		}
 
 		void PeerManager::LoadBloomFilter(const PeerPtr &peer) {
-			// every time a new wallet address is added, the bloom filter has to be rebuilt, and each address is only used
-			// for one transaction, so here we generate some spare addresses to avoid rebuilding the filter each time a
-			// wallet transaction is encountered during the chain sync
+			// every new wallet address has to be added to the bloom filter, and each address is only used for one
+			// transaction, so here we generate some spare addresses to avoid updating the filter each time a wallet
+			// transaction is encountered during the chain sync
 			_wallet->UnusedAddresses(SEQUENCE_GAP_LIMIT_EXTERNAL + 100, 0);
 			_wallet->UnusedAddresses(SEQUENCE_GAP_LIMIT_INTERNAL + 100, 1);
 
-			_orphans.clear(); // clear out orphans that may have been received on an old filter
+			_orphans.Clear(); // clear out orphans that may have been received on an old filter
 			_lastOrphan = nullptr;
 			_filterUpdateHeight = _lastBlock->GetHeight();
 			_fpRate = BLOOM_REDUCED_FALSEPOSITIVE_RATE;
 
-			std::vector<Address> specialAddresses = _wallet->GetAllSpecialAddresses();
-			std::vector<Address> addrs;
-			_wallet->GetAllAddresses(addrs, 0, size_t(-1), true);
-			std::vector<UTXOPtr> utxos = _wallet->GetAllUTXO("");
-			uint32_t blockHeight = (_lastBlock->GetHeight() > 100) ? _lastBlock->GetHeight() - 100 : 0;
-
-			std::vector<TransactionPtr> transactions = _wallet->TxUnconfirmedBefore(blockHeight);
-
-			size_t elementCount = specialAddresses.size() + addrs.size() + utxos.size() + transactions.size();
-			elementCount += _wallet->GetListeningAddrs().size();
-
-			BloomFilterPtr filter = BloomFilterPtr(new BloomFilter(_fpRate, elementCount + 100,
-																   (uint32_t) peer->GetPeerInfo().GetHash(),
-																   BLOOM_UPDATE_ALL)); // BUG: XXX txCount not the same as number of spent wallet outputs
-
-			bytes_t hash;
-
-			for (size_t i = 0; i < specialAddresses.size(); ++i) {
-				if (specialAddresses[i].Valid()) {
-					hash = specialAddresses[i].ProgramHash().bytes();
-					if (!filter->ContainsData(hash))
-						filter->InsertData(hash);
-				}
-			}
-
-			for (size_t i = 0; i < addrs.size(); i++) { // add addresses to watch for tx receiveing money to the wallet
-				if (addrs[i].Valid()) {
-					hash = addrs[i].ProgramHash().bytes();
-					if (!filter->ContainsData(hash))
-						filter->InsertData(hash);
-				}
-			}
-
-			for (size_t i = 0; i < _wallet->GetListeningAddrs().size(); ++i) {
-				hash = Address(_wallet->GetListeningAddrs()[i]).ProgramHash().bytes();
-				if (!filter->ContainsData(hash)) {
-					filter->InsertData(hash);
-				}
-			}
+			std::vector<bytes_t> elements;
+			size_t count = _wallet->GetBloomFilterElements(elements, _bloomFilter ? _filterElementCount : 0);
 
-			for (size_t i = 0; i < utxos.size(); i++) { // add UTXOs to watch for tx sending money from the wallet
-				bytes_t o = utxos[i]->Hash().bytes();
-				o.append(utxos[i]->Index());
+			// the cached filter only takes the elements added since it was built, unless they outgrow it
+			if (_bloomFilter == nullptr || count > _filterElementCapacity) {
+				if (_bloomFilter != nullptr)
+					_wallet->GetBloomFilterElements(elements, 0);
 
-				if (!filter->ContainsData(o))
-					filter->InsertData(o);
+				_filterElementCapacity = count + 100;
+				// one tweak for all peers, they are all sent the same filter
+				_bloomFilter = BloomFilterPtr(new BloomFilter(_fpRate, _filterElementCapacity, _filterTweak,
+															  BLOOM_UPDATE_ALL));
 			}
 
-			for (size_t i = 0; i < transactions.size(); i++) { // also add TXOs spent within the last 100 blocks
-				const InputArray &inputs = transactions[i]->GetInputs();
-				for (InputArray::const_iterator in = inputs.cbegin(); in != inputs.cend(); ++in) {
-					const TransactionPtr &tx = _wallet->TransactionForHash((*in)->TxHash());
-					if (tx) {
-						OutputPtr output = tx->OutputOfIndex((*in)->Index());
-						if (output && _wallet->ContainsAddress(output->Addr())) {
-							bytes_t o = (*in)->TxHash().bytes();
-							o.append((*in)->Index());
-							if (!filter->ContainsData(o))
-								filter->InsertData(o);
-						}
-					}
-				}
-			}
+			_bloomFilter->InsertData(elements);
+			_filterElementCount = count;
 
-			_bloomFilter = filter;
 			// TODO: XXX if already synced, recursively add inputs of unconfirmed receives
 			FilterLoadParameter bloomFilterParameter;
-			bloomFilterParameter.Filter = filter;
+			bloomFilterParameter.Filter = _bloomFilter;
 			peer->SendMessage(MSG_FILTERLOAD, bloomFilterParameter);
 		}
 
@@ -814,7 +767,7 @@ namespace Elastos {
 					Unlock();
 					nanosleep(&ts, NULL); // pthread_yield() isn't POSIX standard :(
 					Lock();
-				} while (_dnsThreadCount > 0 && _peers.size() < PEER_MAX_CONNECTIONS);
+				} while (_dnsThreadCount > 0 && _peers.size() < _maxConnectCount);
 
 				SortPeers();
 
@@ -824,12 +777,11 @@ namespace Elastos {
 
 		void PeerManager::SyncStopped() {
 			_syncStartHeight = 0;
+			StopBlockDownload();
 
 			if (_downloadPeer != nullptr) {
 				// don't cancel timeout if there's a pending tx publish callback
-				for (size_t i = _publishedTx.size(); i > 0; i--) {
-					if (_publishedTx[i - 1].HasCallback()) return;
-				}
+				if (_publishedTxCallbacks > 0) return;
 
 				_downloadPeer->ScheduleDisconnect(-1); // cancel sync timeout
 			}
@@ -837,12 +789,11 @@ namespace Elastos {
 
 		void PeerManager::AddTxToPublishList(const TransactionPtr &tx, const Peer::PeerPubTxCallback &callback) {
 			if (tx && tx->GetBlockHeight() == TX_UNCONFIRMED) {
-				for (size_t i = _publishedTx.size(); i > 0; i--) {
-					if (_publishedTx[i - 1].GetTransaction()->IsEqual(tx.get())) return;
-				}
+				if (_publishedTx.find(tx->GetHash()) != _publishedTx.end()) return;
 
-				_publishedTx.emplace_back(tx, callback);
+				_publishedTx[tx->GetHash()] = PublishedTransaction(tx, callback);
 				_publishedTxHashes.push_back(tx->GetHash());
+				if (callback) _publishedTxCallbacks++;
 
 				for (size_t i = 0; i < tx->GetInputs().size(); i++) {
 					AddTxToPublishList(_wallet->TransactionForHash(tx->GetInputs()[i]->TxHash()),
@@ -888,6 +839,8 @@ namespace Elastos {
 					PingParameter pingParameter(_lastBlock->GetHeight(),
 												boost::bind(&PeerManager::LoadBloomFilterDone, this, peer, _1));
 					peer->SendMessage(MSG_PING, pingParameter);
+				} else {
+					JoinBlockDownload(peer);
 				}
 			} else { // select the peer with the lowest ping time to download the chain from if we're behind
 				// BUG: XXX a malicious peer can report a higher lastblock to make us select them as the download peer, if
@@ -906,7 +859,10 @@ namespace Elastos {
 					_downloadPeer->Disconnect();
 				}
 
-				_downloadPeer = peer;
+				{
+					boost::mutex::scoped_lock peersLock(_peersLock);
+					_downloadPeer = peer;
+				}
 				_syncSucceeded = false;
 				_keepAliveTimestamp = time(nullptr);
 				_isConnected = 1;
@@ -924,13 +880,20 @@ namespace Elastos {
 
 					peer->ScheduleDisconnect(PROTOCOL_TIMEOUT); // schedule sync timeout
 
+					// the other peers download with the new filter too
+					StopBlockDownload();
+					for (size_t i = _connectedPeers.size(); i > 0; i--) {
+						if (_connectedPeers[i - 1]->GetConnectStatus() == Peer::Connected)
+							JoinBlockDownload(_connectedPeers[i - 1]);
+					}
+
 					// request just block headers up to a week before earliestKeyTime, and then merkleblocks after that
 					// we do not reset connect failure count yet incase this request times out
-//					if (_lastBlock->getTimestamp() + 7 * 24 * 60 * 60 >= _earliestKeyTime) {
+					if (_lastBlock->GetTimestamp() + 7 * 24 * 60 * 60 >= _earliestKeyTime) {
 						peer->SendMessage(MSG_GETBLOCKS, GetBlocksParameter(GetBlockLocators(), uint256()));
-//					} else {
-//						peer->SendMessage(MSG_GETHEADERS, GetHeadersParameter(getBlockLocators(), uint256_ZERO));
-//					}
+					} else {
+						peer->SendMessage(MSG_GETHEADERS, GetHeadersParameter(GetBlockLocators(), uint256()));
+					}
 				} else { // we're already synced
 					LoadMempools();
 				}
@@ -941,7 +904,6 @@ namespace Elastos {
 
 		void PeerManager::OnDisconnected(const PeerPtr &peer, int error) {
 			int willSave = 0, txError = 0;
-			TransactionPeerList *peerList;
 			uint32_t reconnectSeconds = 1;
 			bool willReconnect = false;
 			Peer::ConnectStatus status = Peer::Disconnected;
@@ -970,15 +932,23 @@ namespace Elastos {
 						txError = ETIMEDOUT;
 				}
 
-				for (size_t i = _txRelays.size(); i > 0; i--) {
-					_txRelays[i - 1].RemovePeer(peer);
+				{
+					boost::mutex::scoped_lock txLock(_txLock);
+					_txRelays.RemovePeer(peer);
+					_txRequests.RemovePeer(peer);
 				}
 
 				if (peer == _downloadPeer) { // download peer disconnected
 					_isConnected = 0;
-					_downloadPeer = NULL;
+					{
+						boost::mutex::scoped_lock peersLock(_peersLock);
+						_downloadPeer = NULL;
+					}
 					if (_connectFailureCount > MAX_CONNECT_FAILURES)
 						_connectFailureCount = MAX_CONNECT_FAILURES;
+					StopBlockDownload(); // the next download peer starts over from the block locators
+				} else if (_blockDownload.Release(peer) > 0) {
+					RequestBlocks();
 				}
 
 				if (!_isConnected && _connectFailureCount == MAX_CONNECT_FAILURES) {
@@ -1024,6 +994,7 @@ namespace Elastos {
 			FireTxStatusUpdate();
 
 			lock.lock();
+			_peersLock.lock();
 			for (std::vector<PeerPtr>::iterator p = _connectedPeers.begin(); p != _connectedPeers.end();) {
 				if ((*p) == peer) {
 					p = _connectedPeers.erase(p);
@@ -1032,12 +1003,14 @@ namespace Elastos {
 					++p;
 				}
 			}
+			_peersLock.unlock();
 
 			PEER_DEBUG(peer, "connected peer size: {}", _connectedPeers.size());
 			lock.unlock();
 
+			// ConnectLaster blocks until the reconnect timer fires, keep it off the peer reactor threads
 			if (willReconnect)
-				ConnectLaster(reconnectSeconds);
+				boost::thread workThread(boost::bind(&PeerManager::ConnectLaster, this, reconnectSeconds));
 		}
 
 		void PeerManager::OnRelayedPeers(const PeerPtr &peer, const std::vector<PeerInfo> &peers) {
@@ -1099,6 +1072,22 @@ namespace Elastos {
 		}
 
 		void PeerManager::OnRelayedTx(const PeerPtr &peer, const TransactionPtr &transaction) {
+			{
+				boost::mutex::scoped_lock scopedLock(lock);
+				// a matched tx of a queued block goes to the wallet with its block, once every block before it is in
+				const MerkleBlockPtr &block = peer->CurrentBlock();
+				if (block != nullptr && !_blockDownload.Empty()) {
+					const std::vector<uint256> &txHashes = peer->CurrentBlockTxHashes();
+					if (std::find(txHashes.begin(), txHashes.end(), transaction->GetHash()) != txHashes.end() &&
+						_blockDownload.HoldTx(peer, block->GetHash(), transaction))
+						return;
+				}
+			}
+
+			RegisterRelayedTx(peer, transaction);
+		}
+
+		void PeerManager::RegisterRelayedTx(const PeerPtr &peer, const TransactionPtr &transaction) {
 			int isWalletTx = 0, hasPendingCallbacks = 0;
 			size_t relayCount = 0;
 			TransactionPtr tx = transaction;
@@ -1110,13 +1099,9 @@ namespace Elastos {
 				boost::mutex::scoped_lock scopedLock(lock);
 				peer->info("relayed tx");
 
-				for (size_t i = _publishedTx.size(); i > 0; i--) { // see if tx is in list of published tx
-					if (_publishedTxHashes[i - 1] == tx->GetHash()) {
-						pubTx = _publishedTx[i - 1];
-						_publishedTx[i - 1].ResetCallback();
-						relayCount = AddPeerToList(peer, tx->GetHash(), _txRelays);
-					} else if (_publishedTx[i - 1].HasCallback()) hasPendingCallbacks = 1;
-				}
+				if (GetPublishedTx(tx->GetHash(), pubTx, true)) // see if tx is in list of published tx
+					relayCount = AddPeerToList(peer, tx->GetHash(), _txRelays);
+				hasPendingCallbacks = _publishedTxCallbacks > 0;
 
 				// cancel tx publish timeout if no publish callbacks are pending, and syncing is done or this is not downloadPeer
 				if (!hasPendingCallbacks && (_syncStartHeight == 0 || peer != _downloadPeer)) {
@@ -1155,35 +1140,22 @@ namespace Elastos {
 
 					RemovePeerFromList(peer, tx->GetHash(), _txRequests);
 
-					if (_bloomFilter != nullptr) { // check if bloom filter is already being updated
-
-						// the transaction likely consumed one or more wallet addresses, so check that at least the next <gap limit>
-						// unused addresses are still matched by the bloom filter
-						std::vector<Address> externalAddrs = _wallet->UnusedAddresses(SEQUENCE_GAP_LIMIT_EXTERNAL, 0);
+					if (_bloomFilter != nullptr && _lastBlock->GetHeight() >= _estimatedHeight) {
+						// the transaction likely consumed one or more wallet addresses, the ones derived in their place
+						// go to the peers as filteradd
+						AddBloomFilterElements();
+					} else if (_bloomFilter != nullptr) {
+						// while syncing, blocks in flight were filtered without new elements, so check that at least the
+						// next <gap limit> unused addresses are still matched by the bloom filter and reload it if not
+						std::vector<Address> addrs = _wallet->UnusedAddresses(SEQUENCE_GAP_LIMIT_EXTERNAL, 0);
 						std::vector<Address> internalAddrs = _wallet->UnusedAddresses(SEQUENCE_GAP_LIMIT_INTERNAL, 1);
+						addrs.insert(addrs.end(), internalAddrs.begin(), internalAddrs.end());
 
-						bytes_t hash;
-
-						for (std::vector<Address>::iterator externalIt = externalAddrs.begin(), internalIt = internalAddrs.begin();
-							 externalIt != externalAddrs.end() || internalIt != internalAddrs.end();) {
-							if (externalIt != externalAddrs.end()) {
-								hash = (*externalIt).ProgramHash().bytes();
-								if (!_bloomFilter->ContainsData(hash)) {
-									_bloomFilter.reset();
-									UpdateBloomFilter();
-									break;
-								}
-								externalIt++;
-							}
-
-							if (internalIt != internalAddrs.end()) {
-								hash = (*internalIt).ProgramHash().bytes();
-								if (!_bloomFilter->ContainsData(hash)) {
-									_bloomFilter.reset();
-									UpdateBloomFilter();
-									break;
-								}
-								internalIt++;
+						for (size_t i = 0; i < addrs.size(); ++i) {
+							const uint168 &programHash = addrs[i].ProgramHash();
+							if (!_bloomFilter->ContainsData(programHash.begin(), programHash.size())) {
+								UpdateBloomFilter();
+								break;
 							}
 						}
 					}
@@ -1211,14 +1183,11 @@ namespace Elastos {
 				TransactionPtr tx = _wallet->TransactionForHash(txHash);
 				peer->info("has tx");
 
-				for (size_t i = _publishedTx.size(); i > 0; i--) { // see if tx is in list of published tx
-					if (_publishedTxHashes[i - 1] == txHash) {
-						if (!tx) tx = _publishedTx[i - 1].GetTransaction();
-						pubTx = _publishedTx[i - 1];
-						_publishedTx[i - 1].ResetCallback();
-						relayCount = AddPeerToList(peer, txHash, _txRelays);
-					} else if (_publishedTx[i - 1].HasCallback()) hasPendingCallbacks = 1;
+				if (GetPublishedTx(txHash, pubTx, true)) { // see if tx is in list of published tx
+					if (!tx) tx = pubTx.GetTransaction();
+					relayCount = AddPeerToList(peer, txHash, _txRelays);
 				}
+				hasPendingCallbacks = _publishedTxCallbacks > 0;
 
 				// cancel tx publish timeout if no publish callbacks are pending, and syncing is done or this is not downloadPeer
 				if (!hasPendingCallbacks && (_syncStartHeight == 0 || peer != _downloadPeer)) {
@@ -1262,17 +1231,9 @@ namespace Elastos {
 				TransactionPtr tx = _wallet->TransactionForHash(txHash);
 				RemovePeerFromList(peer, txHash, _txRequests);
 
-				for (size_t i = _publishedTx.size(); i > 0 && tx != nullptr; --i) { // see if tx is in list of published tx
-					if (_publishedTxHashes[i - 1] == tx->GetHash()) {
-						pubTx = _publishedTx[i - 1];
-						if (code != 0x12) {
-							_publishedTx[i - 1].ResetCallback();
-							_publishedTx.erase(_publishedTx.begin() + (i - 1));
-							_publishedTxHashes.erase(_publishedTxHashes.begin() + (i - 1));
-							break;
-						}
-					}
-				}
+				// see if tx is in list of published tx
+				if (tx != nullptr && GetPublishedTx(tx->GetHash(), pubTx, code != 0x12) && code != 0x12)
+					RemovePublishedTx(tx->GetHash());
 
 				if (tx) {
 					if (RemovePeerFromList(peer, txHash, _txRelays) && tx->GetBlockHeight() == TX_UNCONFIRMED) {
@@ -1305,11 +1266,36 @@ namespace Elastos {
 			if (code != 0x12 && reason.find("Duplicate") == std::string::npos &&
 				reason.find("duplicate") == std::string::npos) {
 				_wallet->RemoveTransaction(pubTx.GetTransaction()->GetHash());
+				boost::mutex::scoped_lock scopedLock(lock);
+				RemoveTxFromLists({pubTx.GetTransaction()->GetHash()});
 			}
 		}
 
 		void PeerManager::OnRelayedBlock(const PeerPtr &peer, const MerkleBlockPtr &block) {
+			std::vector<BlockDownloadQueue::RelayedBlock> blocks;
+
+			// blocks are connected one at a time and in chain order, whichever peer relayed them
+			boost::mutex::scoped_lock connectLock(_connectBlockLock);
+			{
+				boost::mutex::scoped_lock scopedLock(lock);
+				if (_blockDownload.Contains(block->GetHash())) {
+					blocks = _blockDownload.Received(peer, block, PeerReactor::Now());
+					RequestBlocks();
+				} else {
+					blocks.push_back(BlockDownloadQueue::RelayedBlock(peer, block));
+				}
+			}
+
+			for (size_t i = 0; i < blocks.size(); ++i) {
+				for (size_t j = 0; j < blocks[i].txns.size(); ++j)
+					RegisterRelayedTx(blocks[i].peer, blocks[i].txns[j]);
+				ConnectBlock(blocks[i].peer, blocks[i].block);
+			}
+		}
+
+		void PeerManager::ConnectBlock(const PeerPtr &peer, const MerkleBlockPtr &block) {
 			size_t i, j, fpCount = 0, saveCount = 0;
+			bool resetFilter = false;
 			MerkleBlockPtr b, b2, prev, next;
 			std::vector<MerkleBlockPtr> saveBlocks;
 			std::vector<uint256> txHashes;
@@ -1324,7 +1310,7 @@ namespace Elastos {
 				}
 
 				// track the observed bloom filter false positive rate using a low pass filter to smooth out variance
-				if (peer == _downloadPeer && block->GetTransactionCount() > 0) {
+				if (IsDownloading(peer) && block->GetTransactionCount() > 0) {
 					for (i = 0; i < txHashes.size(); i++) { // wallet tx are not false-positives
 						if (_wallet->TransactionForHash(txHashes[i]) == nullptr &&
 							_wallet->CoinBaseTxForHash(txHashes[i]) == nullptr)
@@ -1338,28 +1324,32 @@ namespace Elastos {
 					_fpRate = _fpRate * (1.0 - 0.01 * block->GetTransactionCount() / _averageTxPerBlock) +
 							 0.01 * fpCount / _averageTxPerBlock;
 
-					// false positive rate sanity check
-					if (peer->GetConnectStatus() == Peer::Connected &&
+					// false positive rate sanity check, the filter is the download peer's
+					const PeerPtr &filterPeer = _downloadPeer ? _downloadPeer : peer;
+					if (filterPeer->GetConnectStatus() == Peer::Connected &&
 						_fpRate > BLOOM_DEFAULT_FALSEPOSITIVE_RATE * 10.0) {
-						peer->warn(
+						filterPeer->warn(
 							"bloom filter false positive rate {} too high after {} blocks, disconnecting...",
 							_fpRate, _lastBlock->GetHeight() + 1 - _filterUpdateHeight);
-						peer->Disconnect();
+						filterPeer->Disconnect();
 						return;
 					} else if (_lastBlock->GetHeight() + 500 < peer->GetLastBlock() &&
-							   _fpRate > BLOOM_REDUCED_FALSEPOSITIVE_RATE * 10.0) {
-						UpdateBloomFilter(); // rebuild bloom filter when it starts to degrade
+							   _fpRate > BLOOM_REDUCED_FALSEPOSITIVE_RATE * 10.0 &&
+							   _downloadPeer && (_downloadPeer->GetFlags() & PEER_FLAG_NEEDSUPDATE) == 0) {
+						// rebuild bloom filter when it starts to degrade, without the outputs spent since it was built
+						resetFilter = true;
 					}
 				}
 
 				// ignore block headers that are newer than one week before earliestKeyTime (it's a header if it has 0 totalTx)
 				if (block->GetTransactionCount() == 0 &&
 					block->GetTimestamp() + 7 * 24 * 60 * 60 > _earliestKeyTime + 2 * 60 * 60) {
-				} else if (_bloomFilter ==
-						   nullptr) { // ingore potentially incomplete blocks when a filter update is pending
+				} else if (_bloomFilter == nullptr ||
+						   (_downloadPeer && (_downloadPeer->GetFlags() & PEER_FLAG_NEEDSUPDATE))) {
+					// ingore potentially incomplete blocks when a filter update is pending
 
-					if (peer == _downloadPeer && _lastBlock->GetHeight() < _estimatedHeight) {
-						peer->ScheduleDisconnect(PROTOCOL_TIMEOUT); // reschedule sync timeout
+					if (_downloadPeer && IsDownloading(peer) && _lastBlock->GetHeight() < _estimatedHeight) {
+						_downloadPeer->ScheduleDisconnect(PROTOCOL_TIMEOUT); // reschedule sync timeout
 						_connectFailureCount = 0; // reset failure count once we know our initial request didn't timeout
 					}
 				} else if (!prev) { // block is an orphan
@@ -1369,7 +1359,7 @@ namespace Elastos {
 							   _lastBlock->GetHash().GetHex(),
 							   _lastBlock->GetHeight());
 
-					if (block->GetHeight() + 7 * 24 * 60 * 60 <
+					if (block->GetTimestamp() + 7 * 24 * 60 * 60 <
 						time(nullptr)) { // ignore orphans older than one week ago
 					} else {
 						// call getblocks, unless we already did with the previous block, or we're still syncing
@@ -1380,7 +1370,7 @@ namespace Elastos {
 							peer->SendMessage(MSG_GETBLOCKS, getBlocksParameter);
 						}
 
-						_orphans.insert(block); // BUG: limit total orphans to avoid memory exhaustion attack
+						_orphans.Insert(block); // the pool is bounded, the least recently relayed orphans go first
 						_lastOrphan = block;
 						peer->ScheduleDisconnect(PROTOCOL_TIMEOUT); // reschedule sync timeout
 					}
@@ -1397,16 +1387,22 @@ namespace Elastos {
 							FireSyncProgress(block->GetHeight(), block->GetHeight(), block->GetTimestamp());
 					}
 
-					_blocks.Insert(block);
-					_lastBlock = block;
+					{
+						boost::unique_lock<boost::shared_mutex> chainLock(_chainLock);
+						_blocks.Insert(block);
+						_blocks.SetChainTip(block);
+					}
+					SetLastBlock(block);
 					_wallet->SetBlockHeight(_lastBlock->GetHeight());
 
-					if (txHashes.size() > 0)
+					if (txHashes.size() > 0) {
 						_wallet->UpdateTransactions(txHashes, block->GetHeight(), block->GetTimestamp());
+						RemoveTxFromLists(txHashes);
+					}
 					if (_downloadPeer) _downloadPeer->SetCurrentBlockHeight(block->GetHeight());
 
-					if (block->GetHeight() < _estimatedHeight && peer == _downloadPeer) {
-						peer->ScheduleDisconnect(PROTOCOL_TIMEOUT); // reschedule sync timeout
+					if (block->GetHeight() < _estimatedHeight && _downloadPeer && IsDownloading(peer)) {
+						_downloadPeer->ScheduleDisconnect(PROTOCOL_TIMEOUT); // reschedule sync timeout
 						_connectFailureCount = 0; // reset failure count once we know our initial request didn't timeout
 					}
 
@@ -1415,6 +1411,7 @@ namespace Elastos {
 
 					if (block->GetHeight() == _estimatedHeight) { // chain download is complete
 						saveCount = (block->GetHeight() % BLOCK_DIFFICULTY_INTERVAL) + BLOCK_DIFFICULTY_INTERVAL + 1;
+						StopBlockDownload();
 						LoadMempools();
 					}
 				} else if (_blocks.Contains(block)) { // we already have the block (or at least the header)
@@ -1423,50 +1420,46 @@ namespace Elastos {
 						peer->info("relayed existing block #{}", block->GetHeight());
 					}
 
-					b = _lastBlock;
-					while (b && b->GetHeight() > block->GetHeight())
-						b = _blocks.Get(b->GetPrevBlockHash()); // is block in main chain?
+					b = _blocks.Get(block->GetHash());
+					{
+						boost::unique_lock<boost::shared_mutex> chainLock(_chainLock);
+						_blocks.Insert(block); // replace the existing one
+					}
 
-					if (b->IsEqual(block.get())) { // if it's not on a fork, set block heights for its transactions
-						if (txHashes.size() > 0)
+					if (_blocks.IsMainChain(block)) { // if it's not on a fork, set block heights for its transactions
+						if (txHashes.size() > 0) {
 							_wallet->UpdateTransactions(txHashes, block->GetHeight(), block->GetTimestamp());
-						if (block->GetHeight() == _lastBlock->GetHeight()) _lastBlock = block;
+							RemoveTxFromLists(txHashes);
+						}
+						if (block->GetHeight() == _lastBlock->GetHeight()) SetLastBlock(block);
 					}
 
-					b = _blocks.Get(block->GetHash());
-					if (b != nullptr) _blocks.Remove(b);
-					_blocks.Insert(block);
-
 					if (b != nullptr && b != block) {
-						for(std::set<MerkleBlockPtr>::iterator it = _orphans.begin(); it != _orphans.end(); ++it) {
-							if ((*it)->IsEqual(b.get()))	{
-								_orphans.erase(it);
-								break;
-							}
-						}
+						_orphans.Remove(b->GetHash());
 						if (_lastOrphan == b) _lastOrphan = nullptr;
 					}
 				} else if (_lastBlock->GetHeight() < peer->GetLastBlock() &&
 					block->GetHeight() >
 							   _lastBlock->GetHeight() + 1) { // special case, new block mined durring rescan
 					peer->info("marking new block #{} as orphan until rescan completes", block->GetHeight());
-					_orphans.insert(block); // mark as orphan til we're caught up
+					_orphans.Insert(block); // mark as orphan til we're caught up
 					_lastOrphan = block;
 				} else if (block->GetHeight() <= _chainParams->LastCheckpoint().Height()) { // old fork
 					peer->info("ignoring block on fork older than most recent checkpoint, block #{}, hash: {}",
 							   block->GetHeight(), block->GetHash().GetHex());
 				} else { // new block is on a fork
 					peer->warn("chain fork reached height {}", block->GetHeight());
-					_blocks.Insert(block);
+					{
+						boost::unique_lock<boost::shared_mutex> chainLock(_chainLock);
+						_blocks.Insert(block);
+					}
 
 					if (block->GetHeight() > _lastBlock->GetHeight()) { // check if fork is now longer than main chain
 						b = block;
-						b2 = _lastBlock;
 
-						while (b && b2 && !b->IsEqual(b2.get())) { // walk back to where the fork joins the main chain
+						while (b && !_blocks.IsMainChain(b)) // walk back to where the fork joins the main chain
 							b = _blocks.Get(b->GetPrevBlockHash());
-							if (b && b->GetHeight() < b2->GetHeight()) b2 = _blocks.Get(b2->GetPrevBlockHash());
-						}
+						b2 = b;
 
 						peer->info("reorganizing chain from height {}, new height is {}", b->GetHeight(),
 								   block->GetHeight());
@@ -1482,16 +1475,23 @@ namespace Elastos {
 							txHashes.clear();
 							b->MerkleBlockTxHashes(txHashes);
 							b = _blocks.Get(b->GetPrevBlockHash());
-							if (txHashes.size() > 0)
+							if (txHashes.size() > 0) {
 								_wallet->UpdateTransactions(txHashes, height, timestamp);
+								RemoveTxFromLists(txHashes);
+							}
 						}
 
-						_lastBlock = block;
+						{
+							boost::unique_lock<boost::shared_mutex> chainLock(_chainLock);
+							_blocks.SetChainTip(block);
+						}
+						SetLastBlock(block);
 						_wallet->SetBlockHeight(_lastBlock->GetHeight());
 
 						if (block->GetHeight() == _estimatedHeight) { // chain download is complete
 							saveCount =
 									(block->GetHeight() % BLOCK_DIFFICULTY_INTERVAL) + BLOCK_DIFFICULTY_INTERVAL + 1;
+							StopBlockDownload();
 							LoadMempools();
 						}
 					}
@@ -1501,14 +1501,10 @@ namespace Elastos {
 					if (block->GetHeight() > _estimatedHeight) _estimatedHeight = block->GetHeight();
 
 					// check if the next block was received as an orphan
-					uint256 prevBlockHash = block->GetHash();
-					for (std::set<MerkleBlockPtr>::iterator it = _orphans.begin(); it != _orphans.end(); ++it) {
-						if ((*it)->GetPrevBlockHash() == prevBlockHash) {
-							next = *it;
-							_orphans.erase(it);
-							break;
-						}
-					}
+					next = _orphans.TakeChild(block->GetHash());
+
+					// orphans below the main chain tip are on forks nobody extends any more
+					_orphans.Prune(_lastBlock->GetHeight());
 				}
 
 				saveBlocks.clear();
@@ -1532,6 +1528,16 @@ namespace Elastos {
 //				assert(saveBlocks.size() == 0 || (saveBlocks.back()->GetHeight() % BLOCK_DIFFICULTY_INTERVAL) == 0);
 			}
 
+			if (resetFilter) {
+				// the wallet walks all its addresses and utxos for this, off the manager lock
+				_wallet->ResetBloomFilterElements();
+
+				// the elements start over, so the filter has to be rebuilt from them even if an update is pending
+				boost::mutex::scoped_lock scopedLock(lock);
+				_bloomFilter = nullptr;
+				UpdateBloomFilter();
+			}
+
 			if (saveBlocks.size() > 0)
 				FireSaveBlocks(saveBlocks.size() > 1, saveBlocks);
 
@@ -1539,7 +1545,7 @@ namespace Elastos {
 				_wallet->UpdateLockedBalance();
 			}
 
-			if (next) OnRelayedBlock(peer, next);
+			if (next) ConnectBlock(peer, next);
 		}
 
 		void PeerManager::OnRelayedPing(const PeerPtr &peer) {
@@ -1593,13 +1599,8 @@ namespace Elastos {
 
 			{
 				boost::mutex::scoped_lock scopedLock(lock);
-				for (size_t i = _publishedTx.size(); i > 0; i--) {
-					if (_publishedTx[i - 1].GetTransaction()->GetHash() == txHash) {
-						pubTx = _publishedTx[i - 1];
-//						_publishedTx[i - 1].ResetCallback();
-					} else if (_publishedTx[i - 1].HasCallback())
-						hasPendingCallbacks = 1;
-				}
+				GetPublishedTx(txHash, pubTx, false);
+				hasPendingCallbacks = _publishedTxCallbacks > (pubTx.HasCallback() ? 1 : 0);
 
 				// cancel tx publish timeout if no publish callbacks are pending, and syncing is done or this is not downloadPeer
 				if (!hasPendingCallbacks && (_syncStartHeight == 0 || peer != _downloadPeer)) {
@@ -1627,12 +1628,12 @@ namespace Elastos {
 		size_t PeerManager::PublishPendingTx(const PeerPtr &peer) {
 			std::vector<uint256> pendingHashes;
 
-			for (size_t i = _publishedTx.size(); i > 0; i--) {
-				if (!_publishedTx[i - 1].HasCallback() ||
-					_publishedTx[i - 1].GetTransaction()->GetBlockHeight() != TX_UNCONFIRMED)
+			for (size_t i = _publishedTxHashes.size(); i > 0 && _publishedTxCallbacks > 0; i--) {
+				const PublishedTransaction &pubTx = _publishedTx[_publishedTxHashes[i - 1]];
+				if (!pubTx.HasCallback() || pubTx.GetTransaction()->GetBlockHeight() != TX_UNCONFIRMED)
 					continue;
 				peer->ScheduleDisconnect(PROTOCOL_TIMEOUT);  // schedule publish timeout
-				pendingHashes.push_back(_publishedTx[i - 1].GetTransaction()->GetHash());
+				pendingHashes.push_back(_publishedTxHashes[i - 1]);
 			}
 
 			InventoryParameter inventoryParameter;
@@ -1642,36 +1643,51 @@ namespace Elastos {
 			return pendingHashes.size();
 		}
 
-		size_t
-		PeerManager::AddPeerToList(const PeerPtr &peer, const uint256 &txHash, std::vector<TransactionPeerList> &list) {
-			for (size_t i = list.size(); i > 0; i--) {
-				if (list[i - 1].GetTransactionHash() != txHash)
-					continue;
-
-				for (size_t j = list[i - 1].GetPeers().size(); j > 0; j--) {
-					if (list[i - 1].GetPeers()[j - 1]->IsEqual(peer.get()))
-						return list[i - 1].GetPeers().size();
-				}
+		bool PeerManager::GetPublishedTx(const uint256 &txHash, PublishedTransaction &pubTx, bool resetCallback) {
+			std::unordered_map<uint256, PublishedTransaction, uint256Hasher>::iterator it = _publishedTx.find(txHash);
+			if (it == _publishedTx.end())
+				return false;
 
-				list[i - 1].AddPeer(peer);
-				return list[i - 1].GetPeers().size();
+			pubTx = it->second;
+			if (resetCallback && it->second.HasCallback()) {
+				it->second.ResetCallback();
+				_publishedTxCallbacks--;
 			}
+			return true;
+		}
+
+		void PeerManager::RemovePublishedTx(const uint256 &txHash) {
+			std::unordered_map<uint256, PublishedTransaction, uint256Hasher>::iterator it = _publishedTx.find(txHash);
+			if (it == _publishedTx.end())
+				return;
 
-			list.push_back(TransactionPeerList(txHash, {peer}));
-			return 1;
+			if (it->second.HasCallback()) _publishedTxCallbacks--;
+			_publishedTx.erase(it);
+			_publishedTxHashes.erase(std::find(_publishedTxHashes.begin(), _publishedTxHashes.end(), txHash));
 		}
 
-		bool PeerManager::RemovePeerFromList(const PeerPtr &peer, const uint256 &txHash,
-											 std::vector<TransactionPeerList> &list) {
-			bool removed = false;
-			for (size_t i = list.size(); i > 0; i--) {
-				if (list[i - 1].GetTransactionHash() == txHash) {
-					removed = list[i - 1].RemovePeer(peer);
-					break;
-				}
+		size_t PeerManager::AddPeerToList(const PeerPtr &peer, const uint256 &txHash, TransactionRelayTable &list) {
+			boost::mutex::scoped_lock txLock(_txLock);
+			return list.Add(peer, txHash);
+		}
+
+		bool PeerManager::RemovePeerFromList(const PeerPtr &peer, const uint256 &txHash, TransactionRelayTable &list) {
+			boost::mutex::scoped_lock txLock(_txLock);
+			return list.Remove(peer, txHash);
+		}
+
+		void PeerManager::RemoveTxFromLists(const std::vector<uint256> &txHashes) {
+			boost::mutex::scoped_lock txLock(_txLock);
+			for (size_t i = 0; i < txHashes.size(); ++i) {
+				_txRelays.Erase(txHashes[i]);
+				_txRequests.Erase(txHashes[i]);
 			}
+		}
 
-			return removed;
+		void PeerManager::SetLastBlock(const MerkleBlockPtr &block) {
+			_lastBlock = block;
+			_lastBlockHeight = block->GetHeight();
+			_lastBlockTimestamp = block->GetTimestamp();
 		}
 
 		void PeerManager::PeerMisbehaving(const PeerPtr &peer) {
@@ -1709,6 +1725,110 @@ namespace Elastos {
 			return _wallet->GetWalletID();
 		}
 
+		void PeerManager::SetSyncPeerCount(size_t count) {
+			boost::mutex::scoped_lock scopedLock(lock);
+			_maxConnectCount = count > 0 ? (int) count : 1;
+		}
+
+		size_t PeerManager::GetSyncPeerCount() const {
+			boost::mutex::scoped_lock scopedLock(lock);
+			return (size_t) _maxConnectCount;
+		}
+
+		bool PeerManager::QueueBlockDownload(const PeerPtr &peer, const std::vector<uint256> &blockHashes) {
+			boost::mutex::scoped_lock scopedLock(lock);
+
+			if (_maxConnectCount < 2 || peer != _downloadPeer || _bloomFilter == nullptr ||
+				_lastBlock->GetHeight() >= _estimatedHeight)
+				return false;
+
+			_blockDownload.Append(blockHashes);
+			// a full inv means there are more hashes to come
+			_needBlockHashes = blockHashes.size() >= MAX_BLOCKS_COUNT;
+			RequestBlocks();
+			return true;
+		}
+
+		bool PeerManager::IsDownloading(const PeerPtr &peer) const {
+			return peer == _downloadPeer || (peer->GetFlags() & PEER_FLAG_DOWNLOADING) != 0;
+		}
+
+		void PeerManager::JoinBlockDownload(const PeerPtr &peer) {
+			if (_maxConnectCount < 2 || _bloomFilter == nullptr || peer == _downloadPeer)
+				return;
+
+			peer->info("joining block download");
+			FilterLoadParameter filterLoadParameter;
+			filterLoadParameter.Filter = _bloomFilter;
+			peer->SendMessage(MSG_FILTERLOAD, filterLoadParameter);
+			peer->SetFlags(peer->GetFlags() | PEER_FLAG_DOWNLOADING);
+			RequestBlocks();
+		}
+
+		void PeerManager::RequestBlocks() {
+			double now = PeerReactor::Now();
+			std::vector<PeerPtr> stalled = _blockDownload.Stalled(now, BLOCK_DOWNLOAD_STALL_TIMEOUT);
+
+			for (size_t i = 0; i < stalled.size(); ++i) {
+				stalled[i]->warn("block download stalled, reassigning {} block(s)", _blockDownload.Release(stalled[i]));
+				if (stalled[i] != _downloadPeer) {
+					stalled[i]->SetFlags(stalled[i]->GetFlags() & (uint8_t) (~PEER_FLAG_DOWNLOADING));
+					stalled[i]->Disconnect();
+				}
+			}
+
+			for (size_t i = 0; i < _connectedPeers.size(); ++i) {
+				const PeerPtr &peer = _connectedPeers[i];
+
+				if (peer->GetConnectStatus() != Peer::Connected || !IsDownloading(peer) || peer->NeedsFilterUpdate() ||
+					std::find(stalled.begin(), stalled.end(), peer) != stalled.end())
+					continue;
+
+				std::vector<uint256> hashes;
+				while (!(hashes = _blockDownload.Assign(peer, now)).empty()) {
+					GetDataParameter getDataParameter({}, hashes);
+					peer->SendMessage(MSG_GETDATA, getDataParameter);
+				}
+			}
+
+			if (_needBlockHashes && _downloadPeer && _blockDownload.Size() < BLOCK_DOWNLOAD_MAX_QUEUED) {
+				_needBlockHashes = false;
+				_downloadPeer->SendMessage(MSG_GETBLOCKS, GetBlocksParameter({_blockDownload.Back()}, uint256()));
+			}
+
+			ScheduleStallCheck();
+		}
+
+		void PeerManager::ScheduleStallCheck() {
+			if (_stallCheckArmed || _blockDownload.Empty())
+				return;
+
+			_stallCheckArmed = true;
+			boost::shared_ptr<StallCheckToken> token = _stallCheckToken;
+			PeerReactor::Instance().Schedule(PeerReactor::Now() + BLOCK_DOWNLOAD_STALL_TIMEOUT / 3, [token]() {
+				boost::mutex::scoped_lock scopedLock(token->lock);
+				if (token->manager)
+					token->manager->OnStallCheck();
+			});
+		}
+
+		void PeerManager::OnStallCheck() {
+			boost::mutex::scoped_lock scopedLock(lock);
+			_stallCheckArmed = false;
+			if (!_blockDownload.Empty())
+				RequestBlocks();
+		}
+
+		void PeerManager::StopBlockDownload() {
+			_blockDownload.Clear();
+			_needBlockHashes = false;
+
+			for (size_t i = _connectedPeers.size(); i > 0; i--) {
+				const PeerPtr &peer = _connectedPeers[i - 1];
+				peer->SetFlags(peer->GetFlags() & (uint8_t) (~PEER_FLAG_DOWNLOADING));
+			}
+		}
+
 		void PeerManager::UpdateBloomFilter() {
 
 			if (_downloadPeer && (_downloadPeer->GetFlags() & PEER_FLAG_NEEDSUPDATE) == 0) {
@@ -1722,6 +1842,34 @@ namespace Elastos {
 			}
 		}
 
+		void PeerManager::AddBloomFilterElements() {
+			std::vector<bytes_t> elements;
+			size_t count = _wallet->GetBloomFilterElements(elements, _filterElementCount);
+			if (elements.empty())
+				return;
+
+			if (count > _filterElementCapacity) {
+				UpdateBloomFilter(); // the reload builds a larger filter
+				return;
+			}
+
+			_bloomFilter->InsertData(elements);
+			_filterElementCount = count;
+
+			for (size_t i = _connectedPeers.size(); i > 0; i--) {
+				const PeerPtr &peer = _connectedPeers[i - 1];
+				if (peer->GetConnectStatus() != Peer::Connected || !peer->SentFilter())
+					continue;
+
+				peer->info("adding {} element(s) to the filter", elements.size());
+				FilterAddParameter filterAddParameter;
+				for (size_t j = 0; j < elements.size(); ++j) {
+					filterAddParameter.Data = elements[j];
+					peer->SendMessage(MSG_FILTERADD, filterAddParameter);
+				}
+			}
+		}
+
 		void PeerManager::UpdateFilterRerequestDone(const PeerPtr &peer, int success) {
 			if (!success) return;
 
@@ -1744,6 +1892,11 @@ namespace Elastos {
 				PingParameter pingParam(_lastBlock->GetHeight(),
 										boost::bind(&PeerManager::UpdateFilterRerequestDone, this, _downloadPeer, _1));
 				_downloadPeer->SendMessage(MSG_PING, pingParam);
+
+				for (size_t i = _connectedPeers.size(); i > 0; i--) {
+					if (_connectedPeers[i - 1]->GetConnectStatus() == Peer::Connected)
+						JoinBlockDownload(_connectedPeers[i - 1]);
+				}
 			} else {
 				MempoolParameter mempoolParameter;
 				mempoolParameter.KnownTxHashes = {};
@@ -1757,9 +1910,9 @@ namespace Elastos {
 
 			boost::mutex::scoped_lock scopedLock(lock);
 			peer->info("updating filter with newly created wallet addresses");
-			_bloomFilter = nullptr;
 
 			if (_lastBlock->GetHeight() < _estimatedHeight) { // if we're syncing, only update download peer
+				StopBlockDownload(); // blocks requested with the old filter may miss transactions
 				if (_downloadPeer) {
 					LoadBloomFilter(_downloadPeer);
 					PingParameter pingParam(_lastBlock->GetHeight(),
@@ -1859,18 +2012,14 @@ namespace Elastos {
 					if (b) prevBlock = b->GetPrevBlockHash();
 
 					if (b && (b->GetHeight() % BLOCK_DIFFICULTY_INTERVAL) != 0) {
+						boost::unique_lock<boost::shared_mutex> chainLock(_chainLock);
 						_blocks.Remove(b);
 					}
 				}
 			}
 
-			//fixme figure out why difficult validation fails occasionally
-			if (0 && VerifyDifficulty(_chainParams, block, _blocks)) {
-				peer->error("relayed block with invalid difficulty target {}, blockHash: {}", block->GetTarget(),
-							block->GetHash().GetHex());
-				r = false;
-			}
-
+			// the difficulty target isn't validated, blocks and headers are only checked for linkage and against the
+			// checkpoints
 			if (r) {
 				const MerkleBlockPtr &checkpoint = _checkpoints.Get(block->GetHash());
 
@@ -1890,19 +2039,19 @@ namespace Elastos {
 			// append 10 most recent block hashes, decending, then continue appending, doubling the step back each time,
 			// finishing with the genesis block (top, -1, -2, -3, -4, -5, -6, -7, -8, -9, -11, -15, -23, -39, -71, -135, ..., 0)
 			MerkleBlockPtr block = _lastBlock;
-			int32_t step = 1, i = 0, j;
+			int32_t step = 1, i = 0;
 
 			std::vector<uint256> locators;
 			while (block != nullptr && block->GetHeight() > 0) {
 				locators.push_back(block->GetHash());
 				if (++i >= 10) step *= 2;
 
-				for (j = 0; block && j < step; j++) {
-					block = _blocks.Get(block->GetPrevBlockHash());
-				}
+				if (block->GetHeight() < (uint32_t)step) break;
+				block = _blocks.GetMainChainBlock(block->GetHeight() - step);
 			}
 
-			locators.push_back(_chainParams->FirstCheckpoint().Hash());
+			if (!_chainParams->Checkpoints().empty())
+				locators.push_back(_chainParams->FirstCheckpoint().Hash());
 			return locators;
 		}
 
@@ -1982,20 +2131,9 @@ namespace Elastos {
 			} else peer->SetFlags(peer->GetFlags() | PEER_FLAG_SYNCED);
 		}
 
-		bool PeerManager::PeerListHasPeer(const std::vector<TransactionPeerList> &peerList, const uint256 &txhash,
+		bool PeerManager::PeerListHasPeer(const TransactionRelayTable &peerList, const uint256 &txhash,
 										  const PeerPtr &peer) {
-			for (size_t i = peerList.size(); i > 0; i--) {
-				if (peerList[i - 1].GetTransactionHash() != txhash) continue;
-
-				for (size_t j = peerList[i - 1].GetPeers().size(); j > 0; j--) {
-					if (peerList[i - 1].GetPeers()[j - 1]->IsEqual(peer.get()))
-						return true;
-				}
-
-				break;
-			}
-
-			return false;
+			return peerList.Contains(txhash, peer);
 		}
 
 		void PeerManager::RequestUnrelayedTxGetDataDone(const PeerPtr &callbackPeer, int success) {
@@ -2022,19 +2160,14 @@ namespace Elastos {
 
 				for (size_t i = tx.size(); i > 0; i--) {
 					hash = tx[i - 1]->GetHash();
-					isPublishing = false;
-
-					for (size_t j = _publishedTx.size(); !isPublishing && j > 0; j--) {
-						if (_publishedTx[j - 1].GetTransaction()->IsEqual(tx[i - 1].get()) &&
-							_publishedTx[j - 1].HasCallback())
-							isPublishing = true;
-						break;
-					}
+					PublishedTransaction pubTx;
+					isPublishing = GetPublishedTx(hash, pubTx, false) && pubTx.HasCallback();
 
 					if (!isPublishing && PeerListCount(_txRelays, hash) == 0 &&
 						PeerListCount(_txRequests, hash) == 0) {
 						peer->info("removing tx unconfirmed at: {}, txHash: {}", _lastBlock->GetHeight(), hash.GetHex());
 						_wallet->RemoveTransaction(hash);
+						RemoveTxFromLists({hash});
 					} else if (!isPublishing && PeerListCount(_txRelays, hash) < _maxConnectCount) {
 						// set timestamp 0 to mark as unverified
 						_wallet->UpdateTransactions({hash}, TX_UNCONFIRMED, 0);
@@ -2043,13 +2176,8 @@ namespace Elastos {
 			}
 		}
 
-		size_t PeerManager::PeerListCount(const std::vector<TransactionPeerList> &list, const uint256 &txhash) {
-			for (size_t i = list.size(); i > 0; i--) {
-				if (list[i - 1].GetTransactionHash() == txhash)
-					return list[i - 1].GetPeers().size();
-			}
-
-			return 0;
+		size_t PeerManager::PeerListCount(const TransactionRelayTable &list, const uint256 &txhash) {
+			return list.Count(txhash);
 		}
 
 		void PeerManager::PublishTxInvDone(const PeerPtr &peer, int success) {
@@ -6,7 +6,10 @@
 #define __ELASTOS_SDK_PEERMANAGER_H__
 
 #include "Peer.h"
-#include "TransactionPeerList.h"
+#include "BlockSet.h"
+#include "BlockDownloadQueue.h"
+#include "OrphanBlockPool.h"
+#include "TransactionRelayTable.h"
 #include "PublishedTransaction.h"
 
 #include <SDK/Common/Lockable.h>
@@ -17,13 +20,16 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <boost/weak_ptr.hpp>
+#include <boost/atomic.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <boost/function.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/asio.hpp>
 
-#define PEER_MAX_CONNECTIONS 1
+#define PEER_MAX_CONNECTIONS 1 // default, more peers download the chain in parallel, see SetSyncPeerCount
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -33,7 +39,6 @@ namespace Elastos {
 
 		typedef boost::shared_ptr<Wallet> WalletPtr;
 		typedef boost::shared_ptr<ChainParams> ChainParamsPtr;
-		typedef ElementSet<MerkleBlockPtr> BlockSet;
 
 		class PeerManager :
 				public Lockable,
@@ -113,6 +118,9 @@ namespace Elastos {
 
 			uint32_t GetLastBlockTimestamp() const;
 
+			// false if no block of the main chain at height is in memory
+			bool GetMainChainBlockHash(uint32_t height, uint256 &hash) const;
+
 			time_t GetKeepAliveTimestamp() const;
 
 			void SetKeepAliveTimestamp(time_t t);
@@ -159,6 +167,14 @@ namespace Elastos {
 
 			const std::string &GetID() const;
 
+			// number of peers kept connected, the chain is downloaded from all of them when it's more than one
+			void SetSyncPeerCount(size_t count);
+
+			size_t GetSyncPeerCount() const;
+
+			// block hashes announced by peer, true if they are queued to download from the sync peers
+			bool QueueBlockDownload(const PeerPtr &peer, const std::vector<uint256> &blockHashes);
+
 		public:
 			virtual void OnConnected(const PeerPtr &peer);
 
@@ -218,6 +234,9 @@ namespace Elastos {
 
 			void UpdateBloomFilter();
 
+			// send the elements the wallet added since the filter was loaded as filteradd, instead of reloading it
+			void AddBloomFilterElements();
+
 			void FindPeers();
 
 			void SortPeers();
@@ -228,11 +247,16 @@ namespace Elastos {
 
 			size_t PublishPendingTx(const PeerPtr &peer);
 
-			size_t
-			AddPeerToList(const PeerPtr &peer, const uint256 &txHash, std::vector<TransactionPeerList> &peerList);
+			bool GetPublishedTx(const uint256 &txHash, PublishedTransaction &pubTx, bool resetCallback);
 
-			bool
-			RemovePeerFromList(const PeerPtr &peer, const uint256 &txHash, std::vector<TransactionPeerList> &peerList);
+			void RemovePublishedTx(const uint256 &txHash);
+
+			size_t AddPeerToList(const PeerPtr &peer, const uint256 &txHash, TransactionRelayTable &peerList);
+
+			bool RemovePeerFromList(const PeerPtr &peer, const uint256 &txHash, TransactionRelayTable &peerList);
+
+			// confirmed or removed tx are no longer tracked, whichever peers relayed or were asked for them
+			void RemoveTxFromLists(const std::vector<uint256> &txHashes);
 
 			void PeerMisbehaving(const PeerPtr &peer);
 
@@ -240,16 +264,30 @@ namespace Elastos {
 
 			bool VerifyBlock(const MerkleBlockPtr &block, const MerkleBlockPtr &prev, const PeerPtr &peer);
 
+			void ConnectBlock(const PeerPtr &peer, const MerkleBlockPtr &block);
+
+			bool IsDownloading(const PeerPtr &peer) const;
+
+			void JoinBlockDownload(const PeerPtr &peer);
+
+			void RequestBlocks();
+
+			// while blocks are queued, RequestBlocks runs every so often on the reactor to reassign stalled ranges
+			void ScheduleStallCheck();
+
+			void OnStallCheck();
+
+			void StopBlockDownload();
+
 			std::vector<uint256> GetBlockLocators();
 
 			void LoadMempools();
 
 			void RequestUnrelayedTx(const PeerPtr &peer);
 
-			bool PeerListHasPeer(const std::vector<TransactionPeerList> &peerList, const uint256 &txhash,
-								 const PeerPtr &peer);
+			bool PeerListHasPeer(const TransactionRelayTable &peerList, const uint256 &txhash, const PeerPtr &peer);
 
-			size_t PeerListCount(const std::vector<TransactionPeerList> &list, const uint256 &txhash);
+			size_t PeerListCount(const TransactionRelayTable &list, const uint256 &txhash);
 
 			void LoadBloomFilterDone(const PeerPtr &peer, int success);
 
@@ -269,9 +307,35 @@ namespace Elastos {
 
 			void ReconnectLaster(time_t seconds);
 
+			void SetLastBlock(const MerkleBlockPtr &block);
+
+			void RegisterRelayedTx(const PeerPtr &peer, const TransactionPtr &transaction);
+
 		private:
-			int _isConnected, _connectFailureCount, _misbehavinCount, _dnsThreadCount, _maxConnectCount;
-			bool _syncSucceeded, _needGetAddr, _enableReconnect;
+			// the reactor's timer callbacks can outlive the manager, they reach it through this
+			struct StallCheckToken {
+				boost::mutex lock;
+				PeerManager *manager;
+			};
+
+			// lock serializes the peer callbacks and everything they touch. The locks below are only taken on top of
+			// it where their part of the state changes, so the getters can read that part without waiting for lock.
+			//
+			// Lock order, a thread holding one of these only ever waits for the ones after it:
+			//   1. _stallCheckToken->lock, held by the reactor's stall timer around OnStallCheck
+			//   2. _connectBlockLock, held by OnRelayedBlock around ConnectBlock
+			//   3. lock
+			//   4. the wallet's lock, its methods are called with lock held, so neither it nor its listeners may take lock
+			//   5. _chainLock, _peersLock and _txLock, leaves: each is held alone and nothing is called under it
+			// OnDisconnected for instance takes _txLock and then _peersLock, one after the other, both inside lock.
+			mutable boost::shared_mutex _chainLock; // _blocks
+			mutable boost::mutex _peersLock;        // _connectedPeers, _downloadPeer
+			mutable boost::mutex _txLock;           // _txRelays, _txRequests
+
+			boost::atomic<int> _isConnected;
+			int _connectFailureCount, _misbehavinCount, _dnsThreadCount, _maxConnectCount;
+			boost::atomic<bool> _syncSucceeded, _enableReconnect;
+			bool _needGetAddr, _needBlockHashes;
 
 			std::vector<PeerInfo> _peers;
 			std::vector<PeerInfo> _fiexedPeers;
@@ -280,19 +344,28 @@ namespace Elastos {
 			std::vector<PeerPtr> _connectedPeers;
 			PeerPtr _downloadPeer;
 
-			mutable std::string _downloadPeerName;
-			time_t _keepAliveTimestamp, _earliestKeyTime;
-			uint32_t _reconnectSeconds, _syncStartHeight, _filterUpdateHeight, _estimatedHeight;
+			boost::atomic<time_t> _keepAliveTimestamp;
+			time_t _earliestKeyTime;
+			uint32_t _reconnectSeconds, _filterUpdateHeight;
+			boost::atomic<uint32_t> _syncStartHeight, _estimatedHeight, _lastBlockHeight, _lastBlockTimestamp;
 			uint32_t _reconnectStep;
+			// built once and kept, loads and filteradds bring it up to date with the wallet's filter elements
 			BloomFilterPtr _bloomFilter;
+			size_t _filterElementCount, _filterElementCapacity;
+			uint32_t _filterTweak;
 			double _fpRate, _averageTxPerBlock;
 			BlockSet _blocks;
-			std::set<MerkleBlockPtr> _orphans;
+			OrphanBlockPool _orphans;
 			BlockSet _checkpoints;
 			MerkleBlockPtr _lastBlock, _lastOrphan;
-			std::vector<TransactionPeerList> _txRelays, _txRequests;
-			std::vector<PublishedTransaction> _publishedTx;
-			std::vector<uint256> _publishedTxHashes;
+			BlockDownloadQueue _blockDownload;
+			boost::mutex _connectBlockLock;
+			boost::shared_ptr<StallCheckToken> _stallCheckToken;
+			bool _stallCheckArmed;
+			TransactionRelayTable _txRelays, _txRequests;
+			std::unordered_map<uint256, PublishedTransaction, uint256Hasher> _publishedTx;
+			std::vector<uint256> _publishedTxHashes; // in the order they were published
+			size_t _publishedTxCallbacks;
 
 			PluginType _pluginType;
 			WalletPtr _wallet;
@@ -0,0 +1,86 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "PeerReactor.h"
+
+#include <SDK/Common/Log.h>
+
+#include <sys/time.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		PeerReactor &PeerReactor::Instance() {
+			// never destroyed: peers may still hold sockets of the service at static destruction time
+			static PeerReactor *reactor = new PeerReactor(PEER_REACTOR_THREADS);
+			return *reactor;
+		}
+
+		PeerReactor::PeerReactor(size_t threadCount) :
+			_tickTimer(_service),
+			_wheel(Now(), PEER_REACTOR_TICK, PEER_REACTOR_SLOTS) {
+			_work = boost::shared_ptr<boost::asio::io_service::work>(new boost::asio::io_service::work(_service));
+			ArmTick();
+
+			for (size_t i = 0; i < threadCount; ++i) {
+				_threads.create_thread(boost::bind(&boost::asio::io_service::run, &_service));
+			}
+		}
+
+		PeerReactor::~PeerReactor() {
+			Stop();
+		}
+
+		boost::asio::io_service &PeerReactor::Service() {
+			return _service;
+		}
+
+		void PeerReactor::Schedule(double when, const TimerWheel::Callback &callback) {
+			boost::mutex::scoped_lock scopedLock(_wheelLock);
+			_wheel.Add(when, callback);
+		}
+
+		void PeerReactor::Stop() {
+			if (!_service.stopped()) {
+				_work.reset();
+				_service.stop();
+			}
+			_threads.join_all();
+		}
+
+		double PeerReactor::Now() {
+			struct timeval tv;
+
+			gettimeofday(&tv, NULL);
+			return tv.tv_sec + (double) tv.tv_usec / 1000000;
+		}
+
+		void PeerReactor::ArmTick() {
+			_tickTimer.expires_from_now(boost::posix_time::milliseconds((long) (PEER_REACTOR_TICK * 1000)));
+			_tickTimer.async_wait(boost::bind(&PeerReactor::OnTick, this, boost::asio::placeholders::error));
+		}
+
+		void PeerReactor::OnTick(const boost::system::error_code &ec) {
+			if (ec == boost::asio::error::operation_aborted)
+				return;
+
+			std::vector<TimerWheel::Callback> due;
+			{
+				boost::mutex::scoped_lock scopedLock(_wheelLock);
+				due = _wheel.Advance(Now());
+			}
+
+			for (size_t i = 0; i < due.size(); ++i) {
+				try {
+					due[i]();
+				} catch (const std::exception &e) {
+					Log::error("peer reactor timer: {}", e.what());
+				}
+			}
+
+			ArmTick();
+		}
+
+	}
+}
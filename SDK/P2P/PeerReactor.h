@@ -0,0 +1,61 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_PEERREACTOR_H__
+#define __ELASTOS_SDK_PEERREACTOR_H__
+
+#include "TimerWheel.h"
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#define PEER_REACTOR_THREADS  2
+#define PEER_REACTOR_TICK     0.1 // seconds
+#define PEER_REACTOR_SLOTS    512
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Socket io of every peer of every peer manager, multiplexed onto one io_service served by a fixed pool of
+		 * threads. Handlers of a peer are serialized by the peer's own strand, so one peer is never served by two
+		 * threads at once. Peer timeouts are kept in a timer wheel advanced every PEER_REACTOR_TICK.
+		 */
+		class PeerReactor {
+		public:
+			static PeerReactor &Instance();
+
+			PeerReactor(size_t threadCount);
+
+			~PeerReactor();
+
+			boost::asio::io_service &Service();
+
+			// callback runs on a reactor thread, no earlier than when (seconds since epoch, as Peer times are)
+			void Schedule(double when, const TimerWheel::Callback &callback);
+
+			void Stop();
+
+			static double Now();
+
+		private:
+			void ArmTick();
+
+			void OnTick(const boost::system::error_code &ec);
+
+		private:
+			boost::asio::io_service _service;
+			boost::shared_ptr<boost::asio::io_service::work> _work;
+			boost::asio::deadline_timer _tickTimer;
+			boost::thread_group _threads;
+
+			boost::mutex _wheelLock;
+			TimerWheel _wheel;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_PEERREACTOR_H__
@@ -0,0 +1,77 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		TimerWheel::TimerWheel(double start, double tickSeconds, size_t slots) :
+			_start(start),
+			_tickSeconds(tickSeconds),
+			_current(0),
+			_size(0),
+			_slots(slots) {
+		}
+
+		TimerWheel::~TimerWheel() {
+		}
+
+		uint64_t TimerWheel::TickOf(double time, bool roundUp) const {
+			if (time <= _start)
+				return 0;
+
+			double ticks = (time - _start) / _tickSeconds;
+			return (uint64_t) (roundUp ? std::ceil(ticks) : std::floor(ticks));
+		}
+
+		void TimerWheel::Add(double when, const Callback &callback) {
+			Entry entry;
+
+			entry.tick = std::max(TickOf(when, true), _current + 1);
+			entry.callback = callback;
+			_slots[entry.tick % _slots.size()].push_back(entry);
+			_size++;
+		}
+
+		std::vector<TimerWheel::Callback> TimerWheel::Advance(double now) {
+			std::vector<Callback> due;
+			uint64_t target = TickOf(now, false);
+
+			if (target <= _current)
+				return due;
+
+			// every pending tick is in (_current, target], a full turn visits each slot once
+			uint64_t steps = std::min<uint64_t>(target - _current, _slots.size());
+			for (uint64_t i = 1; i <= steps; ++i) {
+				std::vector<Entry> &slot = _slots[(_current + i) % _slots.size()];
+				for (size_t j = 0; j < slot.size();) {
+					if (slot[j].tick <= target) {
+						due.push_back(slot[j].callback);
+						slot[j] = slot.back();
+						slot.pop_back();
+					} else {
+						++j;
+					}
+				}
+			}
+
+			_current = target;
+			_size -= due.size();
+			return due;
+		}
+
+		size_t TimerWheel::Size() const {
+			return _size;
+		}
+
+		double TimerWheel::TickSeconds() const {
+			return _tickSeconds;
+		}
+
+	}
+}
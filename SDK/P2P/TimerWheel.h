@@ -0,0 +1,56 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_TIMERWHEEL_H__
+#define __ELASTOS_SDK_TIMERWHEEL_H__
+
+#include <boost/function.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Hashed timer wheel. Deadlines are rounded up to the next tick and kept in slot tick % slots, adding is O(1)
+		 * and advancing only visits the slots passed over. Not thread safe.
+		 */
+		class TimerWheel {
+		public:
+			typedef boost::function<void()> Callback;
+
+			TimerWheel(double start, double tickSeconds, size_t slots);
+
+			~TimerWheel();
+
+			// run callback once the wheel is advanced to when or later
+			void Add(double when, const Callback &callback);
+
+			// callbacks due at now, removed from the wheel
+			std::vector<Callback> Advance(double now);
+
+			size_t Size() const;
+
+			double TickSeconds() const;
+
+		private:
+			uint64_t TickOf(double time, bool roundUp) const;
+
+		private:
+			struct Entry {
+				uint64_t tick;
+				Callback callback;
+			};
+
+			double _start;
+			double _tickSeconds;
+			uint64_t _current;
+			size_t _size;
+			std::vector<std::vector<Entry> > _slots;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_TIMERWHEEL_H__
@@ -0,0 +1,107 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TransactionRelayTable.h"
+
+#include <SDK/Common/Log.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		TransactionRelayTable::TransactionRelayTable() {
+		}
+
+		TransactionRelayTable::~TransactionRelayTable() {
+		}
+
+		int TransactionRelayTable::Slot(const PeerPtr &peer) const {
+			std::map<PeerPtr, size_t>::const_iterator it = _slots.find(peer);
+			return it == _slots.end() ? -1 : (int) it->second;
+		}
+
+		int TransactionRelayTable::AcquireSlot(const PeerPtr &peer) {
+			int slot = Slot(peer);
+			if (slot >= 0 || _usedSlots.all())
+				return slot;
+
+			for (slot = 0; _usedSlots.test(slot); ++slot);
+			_usedSlots.set(slot);
+			_slots[peer] = slot;
+			return slot;
+		}
+
+		size_t TransactionRelayTable::Add(const PeerPtr &peer, const uint256 &txHash) {
+			int slot = AcquireSlot(peer);
+			if (slot < 0) {
+				Log::warn("tx relay table full, {} peers, relay of {} not counted", _slots.size(), txHash.GetHex());
+				return Count(txHash);
+			}
+
+			PeerSet &peers = _entries[txHash];
+			peers.set(slot);
+			return peers.count();
+		}
+
+		bool TransactionRelayTable::Remove(const PeerPtr &peer, const uint256 &txHash) {
+			int slot = Slot(peer);
+			if (slot < 0)
+				return false;
+
+			EntryMap::iterator it = _entries.find(txHash);
+			if (it == _entries.end() || !it->second.test(slot))
+				return false;
+
+			it->second.reset(slot);
+			if (it->second.none())
+				_entries.erase(it);
+			return true;
+		}
+
+		bool TransactionRelayTable::Contains(const uint256 &txHash, const PeerPtr &peer) const {
+			int slot = Slot(peer);
+			if (slot < 0)
+				return false;
+
+			EntryMap::const_iterator it = _entries.find(txHash);
+			return it != _entries.end() && it->second.test(slot);
+		}
+
+		size_t TransactionRelayTable::Count(const uint256 &txHash) const {
+			EntryMap::const_iterator it = _entries.find(txHash);
+			return it == _entries.end() ? 0 : it->second.count();
+		}
+
+		void TransactionRelayTable::RemovePeer(const PeerPtr &peer) {
+			int slot = Slot(peer);
+			if (slot < 0)
+				return;
+
+			for (EntryMap::iterator it = _entries.begin(); it != _entries.end();) {
+				it->second.reset(slot);
+				if (it->second.none())
+					it = _entries.erase(it);
+				else
+					++it;
+			}
+
+			_usedSlots.reset(slot);
+			_slots.erase(peer);
+		}
+
+		bool TransactionRelayTable::Erase(const uint256 &txHash) {
+			return _entries.erase(txHash) > 0;
+		}
+
+		size_t TransactionRelayTable::Size() const {
+			return _entries.size();
+		}
+
+		void TransactionRelayTable::Clear() {
+			_entries.clear();
+			_slots.clear();
+			_usedSlots.reset();
+		}
+
+	}
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_TRANSACTIONRELAYTABLE_H__
+#define __ELASTOS_SDK_TRANSACTIONRELAYTABLE_H__
+
+#include <SDK/Common/uint256.h>
+
+#include <boost/shared_ptr.hpp>
+#include <bitset>
+#include <map>
+#include <unordered_map>
+
+#define TX_RELAY_MAX_PEERS  64 // peers tracked at once, the ones beyond are not counted
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class Peer;
+		typedef boost::shared_ptr<Peer> PeerPtr;
+
+		/*
+		 * Which peers have relayed (or were asked for) a transaction, keyed by tx hash. Each peer is given a slot
+		 * while it is in the table and a tx keeps the slots of its peers in a bitset, so adding, removing and counting
+		 * a peer for a tx is O(1) however many tx are pending. A tx stays until its last peer is removed or it is
+		 * erased, once it confirms or leaves the wallet. Not thread safe.
+		 */
+		class TransactionRelayTable {
+		public:
+			TransactionRelayTable();
+
+			~TransactionRelayTable();
+
+			// returns the number of peers having txHash, peer included unless every slot is taken by others
+			size_t Add(const PeerPtr &peer, const uint256 &txHash);
+
+			// returns false if peer wasn't in the list of txHash
+			bool Remove(const PeerPtr &peer, const uint256 &txHash);
+
+			bool Contains(const uint256 &txHash, const PeerPtr &peer) const;
+
+			size_t Count(const uint256 &txHash) const;
+
+			// drop peer from every tx and give its slot back
+			void RemovePeer(const PeerPtr &peer);
+
+			// drop txHash whichever peers have it, returns false if it wasn't there
+			bool Erase(const uint256 &txHash);
+
+			size_t Size() const;
+
+			void Clear();
+
+		private:
+			typedef std::bitset<TX_RELAY_MAX_PEERS> PeerSet;
+
+			typedef std::unordered_map<uint256, PeerSet, uint256Hasher> EntryMap;
+
+			int Slot(const PeerPtr &peer) const;
+
+			int AcquireSlot(const PeerPtr &peer);
+
+		private:
+			EntryMap _entries;
+			std::map<PeerPtr, size_t> _slots;
+			PeerSet _usedSlots;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_TRANSACTIONRELAYTABLE_H__
@@ -7,6 +7,7 @@
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/Log.h>
 #include <SDK/Common/hash.h>
+#include <SDK/Common/Sha256d.h>
 
 #include <Core/BRMerkleBlock.h>
 #include <Core/BRTransaction.h>
@@ -268,7 +269,7 @@ namespace Elastos {
 		uint256 AuxPow::GetParBlockHeaderHash() const {
 			ByteStream stream;
 			SerializeBtcBlockHeader(stream, _parBlockHeader);
-			return uint256(sha256_2(stream.GetBytes()));
+			return Sha256d::Hash(stream.GetBytes());
 		}
 
 		AuxPow::AuxPow(const AuxPow &auxPow) {
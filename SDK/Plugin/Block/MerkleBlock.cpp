@@ -8,6 +8,7 @@
 #include <SDK/Plugin/Registry.h>
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/hash.h>
+#include <SDK/Common/Sha256d.h>
 
 #include <Core/BRCrypto.h>
 #include <Core/BRMerkleBlock.h>
@@ -51,7 +52,7 @@ namespace Elastos {
 			if (_blockHash == 0) {
 				ByteStream ostream;
 				MerkleBlockBase::SerializeNoAux(ostream);
-				_blockHash = sha256_2(ostream.GetBytes());
+				Sha256d::Hash(_blockHash, ostream.GetBytes());
 			}
 			return _blockHash;
 		}
@@ -65,8 +66,7 @@ namespace Elastos {
 			// bit is the sign, and the remaining 23bits is the value after having been right shifted by (size - 3)*8 bits
 			static const uint32_t maxsize = MAX_PROOF_OF_WORK >> 24, maxtarget = MAX_PROOF_OF_WORK & 0x00ffffff;
 			const uint32_t size = _target >> 24, target = _target & 0x00ffffff;
-			size_t hashIdx = 0, flagIdx = 0;
-			uint256 merkleRoot = MerkleBlockRootR(&hashIdx, &flagIdx, 0), t;
+			uint256 merkleRoot = MerkleBlockRoot(), t;
 			int r = 1;
 
 			// check if merkle root is correct
@@ -112,6 +112,25 @@ namespace Elastos {
 			return true;
 		}
 
+		void MerkleBlock::SerializeHeader(ByteStream &ostream) const {
+			MerkleBlockBase::SerializeNoAux(ostream);
+			_auxPow.Serialize(ostream);
+			ostream.WriteUint8(1);
+		}
+
+		bool MerkleBlock::DeserializeHeader(const ByteStream &istream) {
+			uint8_t txCount;
+			if (!MerkleBlockBase::DeserializeNoAux(istream) || !_auxPow.Deserialize(istream) ||
+				!istream.ReadUint8(txCount))
+				return false;
+
+			_totalTx = 0;
+			_hashes.clear();
+			_flags.clear();
+			GetHash();
+			return true;
+		}
+
 		const AuxPow &MerkleBlock::GetAuxPow() const {
 			return _auxPow;
 		}
@@ -9,6 +9,7 @@
 #include <SDK/Common/ByteStream.h>
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/hash.h>
+#include <SDK/Common/Sha256d.h>
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -225,33 +226,66 @@ namespace Elastos {
 			return r;
 		}
 
-		// recursively walks the merkle tree to calculate the merkle root
+		// walks the merkle tree to calculate the merkle root, a row at a time so its pairs are hashed in one batch
 		// NOTE: this merkle tree design has a security vulnerability (CVE-2012-2459), which can be defended against by
 		// considering the merkle root invalid if there are duplicate hashes in any rows with an even number of elements
-		uint256 MerkleBlockBase::MerkleBlockRootR(size_t *hashIdx, size_t *flagIdx, int depth) const {
-			uint8_t flag;
-			uint256 hashes[2], md;
+		uint256 MerkleBlockBase::MerkleBlockRoot() const {
+			std::vector<MerkleNode> nodes;
+			std::vector<std::vector<int> > rows;
+			size_t hashIdx = 0, flagIdx = 0;
+
+			if (MerkleBlockNodesR(nodes, rows, hashIdx, flagIdx, 0) < 0)
+				return uint256();
 
-			if (*flagIdx / 8 < _flags.size() && *hashIdx < _hashes.size()) {
-				flag = (_flags[*flagIdx / 8] & (1 << (*flagIdx % 8)));
-				(*flagIdx)++;
+			std::vector<uint256> pairs;
+			for (size_t depth = rows.size(); depth > 0; --depth) {
+				const std::vector<int> &row = rows[depth - 1];
 
-				if (flag && depth != _ceil_log2(_totalTx)) {
-					hashes[0] = MerkleBlockRootR(hashIdx, flagIdx, depth + 1); // left branch
-					hashes[1] = MerkleBlockRootR(hashIdx, flagIdx, depth + 1); // right branch
+				pairs.resize(2 * row.size());
+				for (size_t i = 0; i < row.size(); ++i) {
+					const MerkleNode &node = nodes[row[i]];
+					uint256 left = node.left < 0 ? uint256() : nodes[node.left].hash;
+					uint256 right = node.right < 0 ? uint256() : nodes[node.right].hash;
 
-					if (hashes[0] != 0 && hashes[0] != hashes[1]) {
-						if (hashes[1] == 0)
-							hashes[1] = hashes[0]; // if right branch is missing, dup left branch
+					if (left == 0 || left == right)
+						return uint256(); // defend against (CVE-2012-2459)
 
-						bytes_t data(hashes[0].begin(), hashes[0].size());
-						data += bytes_t(hashes[1].begin(), hashes[1].size());
-						md = sha256_2(data);
-					} else *hashIdx = SIZE_MAX; // defend against (CVE-2012-2459)
-				} else md = _hashes[(*hashIdx)++]; // leaf
+					pairs[2 * i] = left;
+					pairs[2 * i + 1] = right == 0 ? left : right; // if right branch is missing, dup left branch
+				}
+
+				Sha256d::HashPairs(pairs.data(), pairs.data(), row.size());
+				for (size_t i = 0; i < row.size(); ++i)
+					nodes[row[i]].hash = pairs[i];
 			}
 
-			return md;
+			return nodes[0].hash;
+		}
+
+		int MerkleBlockBase::MerkleBlockNodesR(std::vector<MerkleNode> &nodes, std::vector<std::vector<int> > &rows,
+											   size_t &hashIdx, size_t &flagIdx, int depth) const {
+			if (flagIdx / 8 >= _flags.size() || hashIdx >= _hashes.size())
+				return -1; // missing branch
+
+			uint8_t flag = (_flags[flagIdx / 8] & (1 << (flagIdx % 8)));
+			flagIdx++;
+
+			int index = (int) nodes.size();
+			nodes.push_back(MerkleNode());
+			nodes[index].left = nodes[index].right = -1;
+
+			if (flag && depth != _ceil_log2(_totalTx)) {
+				if (rows.size() <= (size_t) depth)
+					rows.resize(depth + 1);
+				rows[depth].push_back(index);
+
+				int left = MerkleBlockNodesR(nodes, rows, hashIdx, flagIdx, depth + 1);  // left branch
+				int right = MerkleBlockNodesR(nodes, rows, hashIdx, flagIdx, depth + 1); // right branch
+				nodes[index].left = left;
+				nodes[index].right = right;
+			} else nodes[index].hash = _hashes[hashIdx++]; // leaf
+
+			return index;
 		}
 
 		void MerkleBlockBase::SetHash(const uint256 &hash) {
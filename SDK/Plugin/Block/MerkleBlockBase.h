@@ -78,7 +78,17 @@ namespace Elastos {
 
 			bool DeserializeAfterAux(const ByteStream &istream);
 
-			uint256 MerkleBlockRootR(size_t *hashIdx, size_t *flagIdx, int depth) const;
+			struct MerkleNode {
+				uint256 hash;    // a leaf's, or an inner node's once the row below it is hashed
+				int left, right; // children, -1 for a leaf and for a missing branch
+			};
+
+			// every row of the partial merkle tree is hashed with one Sha256d::HashPairs call, from the leaves up
+			uint256 MerkleBlockRoot() const;
+
+			// the nodes in the order of the flags, the inner ones of each depth in rows[depth]
+			int MerkleBlockNodesR(std::vector<MerkleNode> &nodes, std::vector<std::vector<int> > &rows, size_t &hashIdx,
+								  size_t &flagIdx, int depth) const;
 
 			size_t MerkleBlockTxHashesR(std::vector<uint256> &txHashes, size_t &hashIdx, size_t &flagIdx, int depth) const;
 
@@ -9,6 +9,7 @@
 #include <SDK/Common/Utils.h>
 #include <SDK/Plugin/Registry.h>
 #include <SDK/Common/hash.h>
+#include <SDK/Common/Sha256d.h>
 
 #include <sstream>
 
@@ -43,11 +44,31 @@ namespace Elastos {
 			return true;
 		}
 
+		void SidechainMerkleBlock::SerializeHeader(ByteStream &ostream) const {
+			MerkleBlockBase::SerializeNoAux(ostream);
+			idAuxPow.Serialize(ostream);
+			ostream.WriteUint8(1);
+		}
+
+		bool SidechainMerkleBlock::DeserializeHeader(const ByteStream &istream) {
+			uint8_t txCount;
+			if (!MerkleBlockBase::DeserializeNoAux(istream) || !idAuxPow.Deserialize(istream) ||
+				!istream.ReadUint8(txCount))
+				return false;
+
+			_totalTx = 0;
+			_hashes.clear();
+			_flags.clear();
+			GetHash();
+
+			return true;
+		}
+
 		const uint256 &SidechainMerkleBlock::GetHash() const {
 			if (_blockHash == 0) {
 				ByteStream ostream;
 				MerkleBlockBase::SerializeNoAux(ostream);
-				_blockHash = sha256_2(ostream.GetBytes());
+				Sha256d::Hash(_blockHash, ostream.GetBytes());
 			}
 			return _blockHash;
 		}
@@ -57,8 +78,7 @@ namespace Elastos {
 			// bit is the sign, and the remaining 23bits is the value after having been right shifted by (size - 3)*8 bits
 			static const uint32_t maxsize = MAX_PROOF_OF_WORK >> 24, maxtarget = MAX_PROOF_OF_WORK & 0x00ffffff;
 			const uint32_t size = _target >> 24, target = _target & 0x00ffffff;
-			size_t hashIdx = 0, flagIdx = 0;
-			uint256 merkleRoot = MerkleBlockBase::MerkleBlockRootR(&hashIdx, &flagIdx, 0), t;
+			uint256 merkleRoot = MerkleBlockRoot(), t;
 			int r = 1;
 
 			// check if merkle root is correct
@@ -24,6 +24,10 @@ namespace Elastos {
 
 			virtual bool Deserialize(const ByteStream &istream);
 
+			virtual void SerializeHeader(ByteStream &ostream) const;
+
+			virtual bool DeserializeHeader(const ByteStream &istream);
+
 			virtual const uint256 &GetHash() const;
 
 			virtual bool IsValid(uint32_t currentTime) const;
@@ -22,6 +22,11 @@ namespace Elastos {
 
 			virtual bool Deserialize(const ByteStream &istream) = 0;
 
+			// block header only, as carried by headers messages
+			virtual void SerializeHeader(ByteStream &ostream) const = 0;
+
+			virtual bool DeserializeHeader(const ByteStream &istream) = 0;
+
 			virtual uint32_t GetHeight() const = 0;
 
 			virtual void SetHeight(uint32_t height) = 0;
@@ -5,6 +5,7 @@
 
 #include <SDK/Common/Log.h>
 #include <SDK/Common/hash.h>
+#include <SDK/Common/Sha256d.h>
 
 #include <cstring>
 
@@ -141,7 +142,7 @@ namespace Elastos {
 			if (_hash == 0) {
 				ByteStream stream;
 				Serialize(stream);
-				_hash = sha256_2(stream.GetBytes());
+				Sha256d::Hash(_hash, stream.GetBytes());
 			}
 			return _hash;
 		}
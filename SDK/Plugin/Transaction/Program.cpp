@@ -67,6 +67,10 @@ namespace Elastos {
 				}
 			}
 
+			return CheckSignatureCount(signatureCount, publicKeys.size());
+		}
+
+		bool Program::CheckSignatureCount(size_t signatureCount, size_t publicKeyCount) const {
 			if (SignType(_code.back()) == SignTypeMultiSign) {
 				uint8_t m = (uint8_t)(_code[0] - OP_1 + 1);
 				uint8_t n = (uint8_t)(_code[_code.size() - 2] - OP_1 + 1);
@@ -76,12 +80,12 @@ namespace Elastos {
 					return false;
 				}
 
-				if (publicKeys.size() > n) {
+				if (publicKeyCount > n) {
 					Log::error("Too many signers");
 					return false;
 				}
 			} else if (SignType(_code.back()) == SignTypeStandard) {
-				if (publicKeys.size() != signatureCount) {
+				if (publicKeyCount != signatureCount) {
 					return false;
 				}
 			}
@@ -30,6 +30,9 @@ namespace Elastos {
 
 			bool VerifySignature(const uint256 &md) const;
 
+			// the m of n or standard rule, for signatures that all verified
+			bool CheckSignatureCount(size_t signatureCount, size_t publicKeyCount) const;
+
 			nlohmann::json GetSignedInfo(const uint256 &md) const;
 
 			const bytes_t &GetCode() const;
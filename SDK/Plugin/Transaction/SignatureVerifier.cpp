@@ -0,0 +1,268 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "SignatureVerifier.h"
+#include "Transaction.h"
+#include "Program.h"
+
+#include <SDK/Common/Log.h>
+#include <SDK/Common/Sha256d.h>
+#include <SDK/Common/ByteStream.h>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include <cstring>
+
+#define VERIFY_JOBS_PER_THREAD 8
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		namespace {
+
+			struct VerifyJob {
+				const Program *program;
+				uint256 md;
+				std::vector<bytes_t> publicKeys;
+				std::vector<KeyPtr> keys; // publicKeys parsed, null where one doesn't parse
+				bool verified;
+			};
+
+			const EC_GROUP *Curve() {
+				static EC_GROUP *group = EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1);
+				return group;
+			}
+
+			// Compressed public keys the signature verifies md under, Q = r^-1 (s R - e G) with R = (r, +-y).
+			// Costs about one verification, whatever the number of keys in the program.
+			size_t RecoverPubKeys(bytes_t candidates[2], const uint256 &md, const bytes_t &signature) {
+				const EC_GROUP *group = Curve();
+				size_t count = 0;
+
+				BN_CTX *ctx = BN_CTX_new();
+				if (ctx == nullptr)
+					return 0;
+				BN_CTX_start(ctx);
+
+				BIGNUM *order = BN_CTX_get(ctx), *r = BN_CTX_get(ctx), *s = BN_CTX_get(ctx);
+				BIGNUM *e = BN_CTX_get(ctx), *u1 = BN_CTX_get(ctx), *u2 = BN_CTX_get(ctx);
+				EC_POINT *R = EC_POINT_new(group), *A = EC_POINT_new(group), *B = EC_POINT_new(group);
+				EC_POINT *Q = EC_POINT_new(group);
+
+				if (u2 != nullptr && R != nullptr && A != nullptr && B != nullptr && Q != nullptr &&
+					EC_GROUP_get_order(group, order, ctx) &&
+					BN_bin2bn(&signature[0], 32, r) && BN_bin2bn(&signature[32], 32, s) &&
+					BN_bin2bn(md.begin(), md.size(), e) &&
+					!BN_is_zero(r) && BN_cmp(r, order) < 0 && !BN_is_zero(s) && BN_cmp(s, order) < 0 &&
+					// x = r + order is left to the caller's verification, it happens with probability ~2^-128
+					EC_POINT_set_compressed_coordinates(group, R, r, 0, ctx) &&
+					BN_mod_inverse(u2, r, order, ctx) != nullptr &&
+					BN_mod_mul(u1, e, u2, order, ctx) && BN_mod_sub(u1, order, u1, order, ctx) &&
+					BN_mod_mul(u2, s, u2, order, ctx) &&
+					EC_POINT_mul(group, A, nullptr, R, u2, ctx) && EC_POINT_mul(group, B, u1, nullptr, nullptr, ctx)) {
+
+					// A = s/r R, B = -e/r G, the two y of R give A + B and -A + B
+					for (int i = 0; i < 2; ++i) {
+						if (i == 1 && !EC_POINT_invert(group, A, ctx))
+							break;
+						if (!EC_POINT_add(group, Q, A, B, ctx) || EC_POINT_is_at_infinity(group, Q))
+							continue;
+
+						bytes_t &pubKey = candidates[count];
+						pubKey.resize(33);
+						if (EC_POINT_point2oct(group, Q, POINT_CONVERSION_COMPRESSED, &pubKey[0], pubKey.size(), ctx) ==
+							pubKey.size())
+							count++;
+					}
+				}
+
+				EC_POINT_free(Q);
+				EC_POINT_free(B);
+				EC_POINT_free(A);
+				EC_POINT_free(R);
+				BN_CTX_end(ctx);
+				BN_CTX_free(ctx);
+
+				return count;
+			}
+
+			bool VerifySignature(const VerifyJob &job, const bytes_t &signature) {
+				if (signature.size() < 64)
+					return false;
+
+				if (job.publicKeys.size() > 1) {
+					bytes_t candidates[2];
+					size_t count = RecoverPubKeys(candidates, job.md, signature);
+					for (size_t c = 0; c < count; ++c) {
+						for (size_t i = 0; i < job.publicKeys.size(); ++i) {
+							if (job.keys[i] != nullptr && job.publicKeys[i] == candidates[c])
+								return true;
+						}
+					}
+				}
+
+				// a single key, or keys not given compressed
+				for (size_t i = 0; i < job.keys.size(); ++i) {
+					if (job.keys[i] != nullptr && job.keys[i]->Verify(job.md, signature))
+						return true;
+				}
+
+				return false;
+			}
+
+			// same rules as Program::VerifySignature
+			void VerifyProgram(VerifyJob &job) {
+				job.verified = false;
+				if (job.publicKeys.empty()) {
+					Log::error("Redeem script without public key");
+					return;
+				}
+
+				ByteStream stream(job.program->GetParameter());
+				bytes_t signature;
+				size_t signatureCount = 0;
+				while (stream.ReadVarBytes(signature)) {
+					signatureCount++;
+					if (!VerifySignature(job, signature)) {
+						Log::error("Transaction signature verify failed");
+						return;
+					}
+				}
+
+				job.verified = job.program->CheckSignatureCount(signatureCount, job.publicKeys.size());
+			}
+
+			void VerifyJobs(std::vector<VerifyJob> *jobs, size_t first, size_t step) {
+				for (size_t i = first; i < jobs->size(); i += step)
+					VerifyProgram((*jobs)[i]);
+			}
+
+		}
+
+		size_t SignatureVerifier::PubKeyHasher::operator()(const bytes_t &pubKey) const {
+			// the x coordinate after the prefix byte is as good as random
+			size_t h = 0;
+			if (pubKey.size() > sizeof(h))
+				memcpy(&h, &pubKey[1], sizeof(h));
+			return h;
+		}
+
+		SignatureVerifier::SignatureVerifier(size_t keyCapacity, size_t resultCapacity) :
+			_keys(keyCapacity),
+			_results(resultCapacity) {
+		}
+
+		SignatureVerifier::~SignatureVerifier() {
+		}
+
+		bool SignatureVerifier::Verify(const TransactionPtr &tx) {
+			std::vector<bool> results;
+			Verify(std::vector<TransactionPtr>(1, tx), results);
+			return results[0];
+		}
+
+		void SignatureVerifier::Verify(const std::vector<TransactionPtr> &txns, std::vector<bool> &results) {
+			std::vector<VerifyJob> jobs;
+			std::vector<size_t> jobTx;
+			std::vector<uint256> resultKeys(txns.size());
+			std::vector<bool> pending(txns.size(), false);
+
+			results.assign(txns.size(), false);
+
+			{
+				boost::mutex::scoped_lock scopedLock(_lock);
+
+				for (size_t t = 0; t < txns.size(); ++t) {
+					const TransactionPtr &tx = txns[t];
+					if (tx == nullptr)
+						continue;
+
+					// as Transaction::IsSigned
+					if (tx->GetTransactionType() == Transaction::rechargeToSideChain || tx->IsCoinBase()) {
+						results[t] = true;
+						continue;
+					}
+
+					const std::vector<ProgramPtr> &programs = tx->GetPrograms();
+					if (programs.empty())
+						continue;
+
+					ByteStream stream;
+					stream.WriteBytes(tx->GetHash());
+					for (size_t i = 0; i < programs.size(); ++i)
+						programs[i]->Serialize(stream);
+					Sha256d::Hash(resultKeys[t], stream.GetBytes());
+
+					bool verified;
+					if (_results.Get(resultKeys[t], verified)) {
+						results[t] = verified;
+						continue;
+					}
+
+					uint256 md = tx->GetShaData();
+					for (size_t i = 0; i < programs.size(); ++i) {
+						VerifyJob job;
+						job.program = programs[i].get();
+						job.md = md;
+						job.publicKeys = programs[i]->DecodePublicKey();
+						for (size_t k = 0; k < job.publicKeys.size(); ++k)
+							job.keys.push_back(GetKey(job.publicKeys[k]));
+						jobs.push_back(job);
+						jobTx.push_back(t);
+					}
+					results[t] = pending[t] = true;
+				}
+			}
+
+			size_t threads = std::min<size_t>(boost::thread::hardware_concurrency(), jobs.size() / VERIFY_JOBS_PER_THREAD);
+			if (threads > 1) {
+				boost::thread_group workers;
+				for (size_t i = 0; i < threads; ++i)
+					workers.create_thread(boost::bind(&VerifyJobs, &jobs, i, threads));
+				workers.join_all();
+			} else {
+				VerifyJobs(&jobs, 0, 1);
+			}
+
+			for (size_t i = 0; i < jobs.size(); ++i) {
+				if (!jobs[i].verified)
+					results[jobTx[i]] = false;
+			}
+
+			boost::mutex::scoped_lock scopedLock(_lock);
+			for (size_t t = 0; t < txns.size(); ++t) {
+				if (pending[t])
+					_results.Put(resultKeys[t], results[t]);
+			}
+		}
+
+		void SignatureVerifier::Clear() {
+			boost::mutex::scoped_lock scopedLock(_lock);
+			_keys.Clear();
+			_results.Clear();
+		}
+
+		KeyPtr SignatureVerifier::GetKey(const bytes_t &pubKey) {
+			KeyPtr key;
+			if (_keys.Get(pubKey, key))
+				return key;
+
+			key.reset(new Key());
+			try {
+				key->SetPubKey(pubKey);
+			} catch (const std::exception &) {
+				key.reset();
+			}
+			_keys.Put(pubKey, key);
+
+			return key;
+		}
+
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_SIGNATUREVERIFIER_H__
+#define __ELASTOS_SDK_SIGNATUREVERIFIER_H__
+
+#include <SDK/Common/LruCache.h>
+#include <SDK/Common/uint256.h>
+#include <SDK/WalletCore/BIPs/Key.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#define SIGNATURE_VERIFIER_KEY_CAPACITY 1000
+#define SIGNATURE_VERIFIER_RESULT_CAPACITY 10000
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class Transaction;
+		typedef boost::shared_ptr<Transaction> TransactionPtr;
+
+		/*
+		 * Answers Transaction::IsSigned for txs seen again and again while syncing and publishing. Public keys
+		 * are parsed once and kept, a multi sign signature is matched to its key by recovering the key from the
+		 * signature instead of trying each one, and results are kept by tx hash and programs. The programs of a
+		 * batch are verified on worker threads. Thread safe.
+		 */
+		class SignatureVerifier {
+		public:
+			SignatureVerifier(size_t keyCapacity = SIGNATURE_VERIFIER_KEY_CAPACITY,
+							  size_t resultCapacity = SIGNATURE_VERIFIER_RESULT_CAPACITY);
+
+			~SignatureVerifier();
+
+			bool Verify(const TransactionPtr &tx);
+
+			// results[i] for txns[i]
+			void Verify(const std::vector<TransactionPtr> &txns, std::vector<bool> &results);
+
+			void Clear();
+
+		private:
+			struct PubKeyHasher {
+				size_t operator()(const bytes_t &pubKey) const;
+			};
+
+			// null if the key doesn't parse, _lock held
+			KeyPtr GetKey(const bytes_t &pubKey);
+
+		private:
+			boost::mutex _lock;
+			LruCache<bytes_t, KeyPtr, PubKeyHasher> _keys;
+			LruCache<uint256, bool, uint256Hasher> _results;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_SIGNATUREVERIFIER_H__
@@ -28,6 +28,7 @@
 #include <SDK/Wallet/Wallet.h>
 #include <SDK/Common/Log.h>
 #include <SDK/Common/ErrorChecker.h>
+#include <SDK/Common/Sha256d.h>
 
 #include <boost/make_shared.hpp>
 #include <cstring>
@@ -118,7 +119,7 @@ namespace Elastos {
 			if (_txHash == 0) {
 				ByteStream stream;
 				SerializeUnsigned(stream);
-				_txHash = sha256_2(stream.GetBytes());
+				Sha256d::Hash(_txHash, stream.GetBytes());
 			}
 			return _txHash;
 		}
@@ -551,7 +552,7 @@ namespace Elastos {
 
 			ByteStream stream;
 			SerializeUnsigned(stream);
-			_txHash = sha256_2((stream.GetBytes()));
+			Sha256d::Hash(_txHash, stream.GetBytes());
 
 			return true;
 		}
@@ -665,7 +666,7 @@ namespace Elastos {
 
 		uint64_t Transaction::GetTxFee(const WalletPtr &wallet) {
 			uint64_t fee = 0;
-			BigInt inputAmount(0), outputAmount(0);
+			Int128 inputAmount(0), outputAmount(0);
 
 			for (size_t i = 0; i < _inputs.size(); ++i) {
 				const TransactionPtr &tx = wallet->TransactionForHash(_inputs[i]->TxHash());
@@ -688,17 +689,17 @@ namespace Elastos {
 			nlohmann::json summary, outputPayload;
 			std::vector<nlohmann::json> outputPayloads;
 			std::string direction = "Received";
-			BigInt inputAmount(0), outputAmount(0), changeAmount(0);
+			Int128 inputAmount(0), outputAmount(0), changeAmount(0);
 			uint64_t fee = 0;
-			std::map<std::string, BigInt>::iterator it;
+			std::map<std::string, Int128>::iterator it;
 
-			std::map<std::string, BigInt> inputList;
+			std::map<std::string, Int128> inputList;
 			for (InputArray::iterator in = _inputs.begin(); in != _inputs.end(); ++in) {
 				TransactionPtr tx = wallet->TransactionForHash((*in)->TxHash());
 				if (tx) {
 					const OutputPtr o = tx->OutputOfIndex((*in)->Index());
 					if (o && wallet->ContainsAddress(o->Addr()) && !wallet->IsVoteDepositAddress(o->Addr())) {
-						const BigInt &spentAmount = o->Amount();
+						const Int128 &spentAmount = o->Amount();
 						addr = o->Addr().String();
 
 						if (detail) {
@@ -716,7 +717,7 @@ namespace Elastos {
 				} else {
 					UTXOPtr cb = wallet->CoinBaseTxForHash((*in)->TxHash());
 					if (cb && cb->Index() == (*in)->Index()) {
-						const BigInt &spentAmount = cb->Output()->Amount();
+						const Int128 &spentAmount = cb->Output()->Amount();
 						addr = Address(cb->Output()->ProgramHash()).String();
 
 						if (detail) {
@@ -741,9 +742,9 @@ namespace Elastos {
 			}
 
 			bool containAddress;
-			std::map<std::string, BigInt> outputList;
+			std::map<std::string, Int128> outputList;
 			for (OutputArray::iterator o = _outputs.begin(); o != _outputs.end(); ++o) {
-				const BigInt &oAmount = (*o)->Amount();
+				const Int128 &oAmount = (*o)->Amount();
 				addr = (*o)->Addr().String();
 
 				if ((*o)->GetType() == TransactionOutput::VoteOutput) {
@@ -773,7 +774,7 @@ namespace Elastos {
 				outputJson[it->first] = it->second.getDec();
 			}
 
-			if (direction == "Sent" && outputAmount == BigInt(0)) {
+			if (direction == "Sent" && outputAmount.isZero()) {
 				direction = "Moved";
 			}
 
@@ -783,7 +784,7 @@ namespace Elastos {
 				fee = 0;
 			}
 
-			BigInt amount(0);
+			Int128 amount(0);
 			if (direction == "Received") {
 				amount = changeAmount;
 			} else if (direction == "Sent") {
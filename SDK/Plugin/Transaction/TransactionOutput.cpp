@@ -22,7 +22,6 @@ namespace Elastos {
 				_fixedIndex(0),
 				_outputLock(0),
 				_outputType(Type::Default) {
-			_amount.setWord(0);
 			_payload = GeneratePayload(_outputType);
 		}
 
@@ -42,7 +41,7 @@ namespace Elastos {
 			return *this;
 		}
 
-		TransactionOutput::TransactionOutput(const BigInt &a, const Address &addr, const uint256 &assetID,
+		TransactionOutput::TransactionOutput(const Int128 &a, const Address &addr, const uint256 &assetID,
 											 Type type, const OutputPayloadPtr &payload) :
 			_fixedIndex(0),
 			_outputLock(0),
@@ -82,11 +81,11 @@ namespace Elastos {
 			return Address(_programHash);
 		}
 
-		const BigInt &TransactionOutput::Amount() const {
+		const Int128 &TransactionOutput::Amount() const {
 			return _amount;
 		}
 
-		void TransactionOutput::SetAmount(const BigInt &a) {
+		void TransactionOutput::SetAmount(const Int128 &a) {
 			_amount = a;
 		}
 
@@ -113,10 +112,7 @@ namespace Elastos {
 			ostream.WriteBytes(_assetID);
 
 			if (_assetID == Asset::GetELAAssetID()) {
-				bytes_t bytes = _amount.getHexBytes(true);
-				uint64_t amount = 0;
-				memcpy(&amount, &bytes[0], MIN(bytes.size(), sizeof(uint64_t)));
-				ostream.WriteUint64(amount);
+				ostream.WriteUint64(_amount.getUint64());
 			} else {
 				ostream.WriteVarBytes(_amount.getHexBytes());
 			}
@@ -146,13 +142,20 @@ namespace Elastos {
 					Log::error("deserialize output amount error");
 					return false;
 				}
-				_amount.setHexBytes(bytes_t(&amount, sizeof(amount)), true);
+				_amount.setUint64(amount);
 			} else {
 				bytes_t bytes;
 				if (!istream.ReadVarBytes(bytes)) {
 					Log::error("deserialize output BN amount error");
 					return false;
 				}
+				// Narrower than the BigInt the chain serializes: an amount of 2^127 or more fails here, so its tx or
+				// merkle block is rejected and the peer is dropped. No valid output reaches it, a token is registered
+				// with a uint64 amount (RegisterAsset), the sum of its outputs never exceeds that, and ELA is Fixed64.
+				if (!Int128::HexBytesInRange(bytes)) {
+					Log::error("deserialize output BN amount out of range");
+					return false;
+				}
 				_amount.setHexBytes(bytes);
 			}
 
@@ -278,7 +281,7 @@ namespace Elastos {
 		void TransactionOutput::FromJson(const nlohmann::json &j, uint8_t txVersion) {
 			_fixedIndex = j["FixedIndex"].get<uint16_t>();
 			if (j["Amount"].is_number()) {
-				_amount.setWord(j["Amount"].get<uint64_t>());
+				_amount.setUint64(j["Amount"].get<uint64_t>());
 			} else if (j["Amount"].is_string()) {
 				_amount.setDec(j["Amount"].get<std::string>());
 			}
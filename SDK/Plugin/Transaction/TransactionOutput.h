@@ -10,6 +10,7 @@
 #include <SDK/Plugin/Transaction/Asset.h>
 #include <SDK/WalletCore/BIPs/Address.h>
 #include <SDK/Common/BigInt.h>
+#include <SDK/Common/Int128.h>
 
 #include <boost/shared_ptr.hpp>
 
@@ -33,7 +34,7 @@ namespace Elastos {
 
 			TransactionOutput &operator=(const TransactionOutput &tx);
 
-			TransactionOutput(const BigInt &amount, const Address &toAddress, const uint256 &assetID = Asset::GetELAAssetID(),
+			TransactionOutput(const Int128 &amount, const Address &toAddress, const uint256 &assetID = Asset::GetELAAssetID(),
 							  Type type = Default, const OutputPayloadPtr &payload = nullptr);
 
 //			TransactionOutput(const BigInt &amount, const uint168 &programHash, const uint256 &assetID = Asset::GetELAAssetID(),
@@ -51,9 +52,9 @@ namespace Elastos {
 
 			Address Addr() const;
 
-			const BigInt &Amount() const;
+			const Int128 &Amount() const;
 
-			void SetAmount(const BigInt &amount);
+			void SetAmount(const Int128 &amount);
 
 			const uint256 &AssetID() const;
 
@@ -92,7 +93,7 @@ namespace Elastos {
 		private:
 			uint16_t _fixedIndex;
 
-			BigInt _amount; // to support token chain
+			Int128 _amount; // to support token chain
 			uint256 _assetID;
 			uint32_t _outputLock;
 			uint168 _programHash;
@@ -89,6 +89,8 @@ namespace Elastos {
 
 						ErrorChecker::ThrowLogicException(Error::ReadConfigFileError, "invalid config");
 					}
+					// optional, peers to download the chain from in parallel
+					chainSetting.lookupValue("SyncPeers", chainConfig->_syncPeers);
 					chainConfig->_minFee = minFee;
 					chainConfig->_feePerKB = feePerKB;
 					if (netType.empty())
@@ -24,6 +24,7 @@ namespace Elastos {
 				_minFee(0),
 				_feePerKB(0),
 				_disconnectionTime(0),
+				_syncPeers(1),
 				_chainParameters(nullptr)
 			{}
 
@@ -39,6 +40,8 @@ namespace Elastos {
 
 			const uint32_t &DisconnectionTime() const { return _disconnectionTime; }
 
+			const uint32_t &SyncPeers() const { return _syncPeers; }
+
 			const std::string &PluginType() const { return _pluginType; }
 
 			const std::string &GenesisAddress() const { return _genesisAddress; }
@@ -54,6 +57,7 @@ namespace Elastos {
 			uint64_t _minFee;
 			uint64_t _feePerKB;
 			uint32_t _disconnectionTime;
+			uint32_t _syncPeers;
 			std::string _pluginType;
 			std::string _genesisAddress;
 			ChainParamsPtr _chainParameters;
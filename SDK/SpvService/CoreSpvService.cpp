@@ -33,7 +33,10 @@ namespace Elastos {
 			_subAccount = subAccount;
 			_reconnectSeconds = reconnectSeconds;
 
-			std::vector<TransactionPtr>  txs = loadTransactions();
+			Wallet::HistoryLoader *loader = historyLoader();
+			std::vector<TransactionPtr> txs;
+			if (loader == nullptr)
+				txs = loadTransactions();
 			std::vector<UTXOPtr> cbs = loadCoinBaseUTXOs();
 
 			if (_peerManager == nullptr) {
@@ -51,7 +54,7 @@ namespace Elastos {
 			if (_wallet == nullptr) {
 				_wallet = WalletPtr(new Wallet(_peerManager->GetLastBlockHeight(), walletID,
 											   loadAssets(), txs, cbs,
-											   _subAccount, createWalletListener()));
+											   _subAccount, createWalletListener(), loader));
 				_peerManager->SetWallet(_wallet);
 			}
 		}
@@ -64,7 +67,7 @@ namespace Elastos {
 			return _peerManager;
 		}
 
-		void CoreSpvService::balanceChanged(const uint256 &asset, const BigInt &balance) {
+		void CoreSpvService::balanceChanged(const uint256 &asset, const Int128 &balance) {
 
 		}
 
@@ -170,6 +173,10 @@ namespace Elastos {
 			return std::vector<AssetPtr>();
 		}
 
+		Wallet::HistoryLoader *CoreSpvService::historyLoader() {
+			return nullptr;
+		}
+
 		const CoreSpvService::PeerManagerListenerPtr &CoreSpvService::createPeerManagerListener() {
 			if (_peerManagerListener == nullptr) {
 				_peerManagerListener = PeerManagerListenerPtr(
@@ -374,7 +381,7 @@ namespace Elastos {
 				_listener(listener) {
 		}
 
-		void WrappedExceptionWalletListener::balanceChanged(const uint256 &asset, const BigInt &balance) {
+		void WrappedExceptionWalletListener::balanceChanged(const uint256 &asset, const Int128 &balance) {
 			try {
 				_listener->balanceChanged(asset, balance);
 			} catch (const std::exception &e) {
@@ -477,7 +484,7 @@ namespace Elastos {
 				_executor(executor) {
 		}
 
-		void WrappedExecutorWalletListener::balanceChanged(const uint256 &asset, const BigInt &balance) {
+		void WrappedExecutorWalletListener::balanceChanged(const uint256 &asset, const Int128 &balance) {
 			_executor->Execute(Runnable([this, asset, balance]() -> void {
 				try {
 					_listener->balanceChanged(asset, balance);
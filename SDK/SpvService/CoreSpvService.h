@@ -39,7 +39,7 @@ namespace Elastos {
 			virtual const PeerManagerPtr &getPeerManager();
 
 		public: //override from Wallet
-			virtual void balanceChanged(const uint256 &asset, const BigInt &balance);
+			virtual void balanceChanged(const uint256 &asset, const Int128 &balance);
 
 			virtual void onCoinBaseTxAdded(const UTXOPtr &cb);
 
@@ -91,6 +91,9 @@ namespace Elastos {
 
 			virtual std::vector<AssetPtr> loadAssets();
 
+			// non null to keep only the active part of the history in memory, loadTransactions is not used then
+			virtual Wallet::HistoryLoader *historyLoader();
+
 			typedef boost::shared_ptr<PeerManager::Listener> PeerManagerListenerPtr;
 
 			virtual const PeerManagerListenerPtr &createPeerManagerListener();
@@ -180,7 +183,7 @@ namespace Elastos {
 		public:
 			WrappedExceptionWalletListener(Wallet::Listener *listener);
 
-			virtual void balanceChanged(const uint256 &asset, const BigInt &balance);
+			virtual void balanceChanged(const uint256 &asset, const Int128 &balance);
 
 			virtual void onCoinBaseTxAdded(const UTXOPtr &cb);
 
@@ -210,7 +213,7 @@ namespace Elastos {
 		public:
 			WrappedExecutorWalletListener(Wallet::Listener *listener, Executor *executor);
 
-			virtual void balanceChanged(const uint256 &asset, const BigInt &balance);
+			virtual void balanceChanged(const uint256 &asset, const Int128 &balance);
 
 			virtual void onCoinBaseTxAdded(const UTXOPtr &cb);
 
@@ -13,20 +13,39 @@
 #include <SDK/Wallet/UTXO.h>
 #include <SDK/Plugin/Transaction/TransactionOutput.h>
 #include <SDK/Plugin/Transaction/TransactionInput.h>
+#include <SDK/WalletCore/BIPs/Address.h>
 
 #include <Core/BRMerkleBlock.h>
 #include <Core/BRTransaction.h>
 
 #include <boost/thread.hpp>
+#include <algorithm>
+#include <set>
 
 #define BACKGROUND_THREAD_COUNT 1
 
 #define ISO_OLD "ela"
 #define ISO "ela1"
 
+#define DATABASE_CACHE_SIZE_KB (8 * 1024)
+#define DATABASE_MMAP_SIZE (64 * 1024 * 1024)
+
 namespace Elastos {
 	namespace ElaWallet {
 
+		// synced data can be fetched again from peers, trade the last moments before a power loss for throughput
+		static DatabaseConfig SyncDatabaseConfig() {
+			DatabaseConfig config;
+
+			config.sqlite.walMode = true;
+			config.sqlite.synchronous = SYNCHRONOUS_NORMAL;
+			config.sqlite.cacheSizeKB = DATABASE_CACHE_SIZE_KB;
+			config.sqlite.mmapSize = DATABASE_MMAP_SIZE;
+			config.asyncWrite = true;
+
+			return config;
+		}
+
 		SpvService::SpvService(const std::string &walletID,
 							   const SubAccountPtr &subAccount,
 							   const boost::filesystem::path &dbPath,
@@ -36,7 +55,7 @@ namespace Elastos {
 							   const ChainParamsPtr &chainParams) :
 				CoreSpvService(pluginTypes, chainParams),
 				_executor(BACKGROUND_THREAD_COUNT),
-				_databaseManager(dbPath) {
+				_databaseManager(dbPath, SyncDatabaseConfig()) {
 			init(walletID, subAccount, earliestPeerTime, reconnectSeconds);
 		}
 
@@ -68,7 +87,8 @@ namespace Elastos {
 		}
 
 		void SpvService::DatabaseFlush() {
-			_databaseManager.flush();
+			if (!_databaseManager.flush())
+				Log::error("{} database flush: some queued writes failed and were rolled back", _peerManager->GetID());
 		}
 
 		const WalletPtr &SpvService::getWallet() {
@@ -76,7 +96,7 @@ namespace Elastos {
 		}
 
 		//override Wallet listener
-		void SpvService::balanceChanged(const uint256 &asset, const BigInt &balance) {
+		void SpvService::balanceChanged(const uint256 &asset, const Int128 &balance) {
 			std::for_each(_walletListeners.begin(), _walletListeners.end(),
 						  [&asset, &balance](Wallet::Listener *listener) {
 							  listener->balanceChanged(asset, balance);
@@ -192,6 +212,8 @@ namespace Elastos {
 		}
 
 		void SpvService::syncStopped(const std::string &error) {
+			SaveUTXOSnapshot();
+
 			std::for_each(_peerManagerListeners.begin(), _peerManagerListeners.end(),
 						  [&error](PeerManager::Listener *listener) {
 							  listener->syncStopped(error);
@@ -263,6 +285,10 @@ namespace Elastos {
 		}
 
 		void SpvService::txPublished(const std::string &hash, const nlohmann::json &result) {
+			// the user's own tx was just registered with the wallet, don't leave it to a batch that a crash can lose
+			if (result["Code"] == 0)
+				DatabaseFlush();
+
 			std::for_each(_peerManagerListeners.begin(), _peerManagerListeners.end(),
 						  [&hash, &result](PeerManager::Listener *listener) {
 							  listener->txPublished(hash, result);
@@ -280,6 +306,47 @@ namespace Elastos {
 			return _databaseManager.GetAllTransactionsCount();
 		}
 
+		std::vector<TransactionPtr> SpvService::GetTransactions(size_t start, size_t count,
+																const std::string &addressOrTxid, size_t &total) {
+			if (addressOrTxid.empty()) {
+				total = _databaseManager.GetAllTransactionsCount();
+				return _databaseManager.GetTransactions(start, count);
+			}
+
+			if (addressOrTxid.length() == 64) {
+				std::vector<TransactionPtr> txns;
+				TransactionPtr tx = _databaseManager.GetTransaction(uint256(addressOrTxid));
+				total = tx ? 1 : 0;
+				if (tx && start == 0 && count > 0)
+					txns.push_back(tx);
+				return txns;
+			}
+
+			Address address(addressOrTxid);
+			if (!address.Valid()) {
+				total = 0;
+				return {};
+			}
+
+			total = _databaseManager.GetTransactionsCountByAddress(address.ProgramHash());
+			return _databaseManager.GetTransactionsByAddress(address.ProgramHash(), start, count);
+		}
+
+		std::vector<UTXOPtr> SpvService::GetCoinBaseTransactions(size_t start, size_t count, const std::string &txid,
+																 size_t &total) {
+			if (txid.empty()) {
+				total = _databaseManager.GetCoinBaseTotalCount();
+				return _databaseManager.GetCoinBasePage(start, count);
+			}
+
+			std::vector<UTXOPtr> cbs;
+			UTXOPtr cb = txid.length() == 64 ? _databaseManager.GetCoinBase(uint256(txid)) : nullptr;
+			total = cb ? 1 : 0;
+			if (cb && start == 0 && count > 0)
+				cbs.push_back(cb);
+			return cbs;
+		}
+
 		std::vector<UTXOPtr> SpvService::loadCoinBaseUTXOs() {
 			return _databaseManager.GetAllCoinBase();
 		}
@@ -289,6 +356,87 @@ namespace Elastos {
 			return _databaseManager.GetAllTransactions();
 		}
 
+		std::vector<uint168> SpvService::loadUsedProgramHashes() {
+			return _databaseManager.GetOutputProgramHashes();
+		}
+
+		UTXOKeySet SpvService::loadUnspentOutputs(const SubAccountPtr &subAccount) {
+			std::vector<OutputEntity> outputs = _databaseManager.GetUnspentOutputs();
+			UTXOKeySet unspent;
+
+			for (size_t i = 0; i < outputs.size(); ++i) {
+				if (subAccount->ContainsAddress(outputs[i].programHash))
+					unspent.insert(UTXOKey(outputs[i].txHash, outputs[i].index));
+			}
+
+			return unspent;
+		}
+
+		std::vector<TransactionPtr> SpvService::loadTransactions(uint32_t blockHeight, const UTXOKeySet &unspent) {
+			std::vector<TransactionPtr> recent = _databaseManager.GetTransactionsFrom(blockHeight);
+
+			std::set<uint256> hashes;
+			for (UTXOKeySet::const_iterator it = unspent.cbegin(); it != unspent.cend(); ++it)
+				hashes.insert(it->Hash());
+			for (size_t i = 0; i < recent.size(); ++i)
+				hashes.erase(recent[i]->GetHash());
+
+			std::vector<TransactionPtr> txns = _databaseManager.GetTransactions(
+				std::vector<uint256>(hashes.begin(), hashes.end()));
+			std::sort(txns.begin(), txns.end(), [](const TransactionPtr &a, const TransactionPtr &b) {
+				if (a->GetBlockHeight() != b->GetBlockHeight())
+					return a->GetBlockHeight() < b->GetBlockHeight();
+				return a->GetTimestamp() < b->GetTimestamp();
+			});
+
+			txns.insert(txns.end(), recent.begin(), recent.end());
+			return txns;
+		}
+
+		std::vector<TransactionPtr> SpvService::loadAllTransactions() {
+			return _databaseManager.GetTransactionsFrom(0);
+		}
+
+		TransactionPtr SpvService::loadTransaction(const uint256 &hash) {
+			return _databaseManager.GetTransaction(hash);
+		}
+
+		bool SpvService::loadSnapshot(UTXOArray &utxos, uint32_t &blockHeight) {
+			UTXOSnapshot snapshot;
+			if (!_databaseManager.GetUTXOSnapshot(snapshot))
+				return false;
+
+			uint256 blockHash;
+			if (snapshot.version != UTXO_SNAPSHOT_VERSION ||
+				!_peerManager->GetMainChainBlockHash(snapshot.blockHeight, blockHash) ||
+				blockHash != snapshot.blockHash ||
+				_databaseManager.GetConfirmedTransactionsCount(snapshot.blockHeight) != snapshot.txCount) {
+				Log::info("{} utxo snapshot at {} is stale, rebuild from history", _peerManager->GetID(),
+						  snapshot.blockHeight);
+				return false;
+			}
+
+			utxos = snapshot.utxos;
+			blockHeight = snapshot.blockHeight;
+			return true;
+		}
+
+		void SpvService::SaveUTXOSnapshot() {
+			UTXOSnapshot snapshot;
+
+			snapshot.blockHeight = _peerManager->GetLastBlockHeight();
+			if (!_peerManager->GetMainChainBlockHash(snapshot.blockHeight, snapshot.blockHash))
+				return;
+
+			// a wallet ahead of the block is fine, the transactions from that block on are replayed at start
+			snapshot.utxos = _wallet->GetSnapshotUTXOs();
+			_databaseManager.PutUTXOSnapshot(snapshot);
+		}
+
+		Wallet::HistoryLoader *SpvService::historyLoader() {
+			return this;
+		}
+
 		std::vector<MerkleBlockPtr> SpvService::loadBlocks() {
 			return _databaseManager.GetAllMerkleBlocks(ISO, _pluginTypes);
 		}
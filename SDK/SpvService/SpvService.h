@@ -25,7 +25,8 @@ namespace Elastos {
 		typedef boost::shared_ptr<Transaction> TransactionPtr;
 
 		class SpvService :
-				public CoreSpvService {
+				public CoreSpvService,
+				public Wallet::HistoryLoader {
 		public:
 
 			SpvService(const std::string &walletID,
@@ -46,6 +47,16 @@ namespace Elastos {
 
 			size_t GetAllTransactionsCount();
 
+			/*
+			 * One page of the history newest first, read from the database. A non empty addressOrTxid keeps the
+			 * transactions of that address, or the one with that hash. total is the count of all matches.
+			 */
+			std::vector<TransactionPtr> GetTransactions(size_t start, size_t count, const std::string &addressOrTxid,
+														size_t &total);
+
+			std::vector<UTXOPtr> GetCoinBaseTransactions(size_t start, size_t count, const std::string &txid,
+														 size_t &total);
+
 			void RegisterWalletListener(Wallet::Listener *listener);
 
 			void RegisterPeerManagerListener(PeerManager::Listener *listener);
@@ -57,7 +68,7 @@ namespace Elastos {
 			virtual const WalletPtr &getWallet();
 
 		public:
-			virtual void balanceChanged(const uint256 &asset, const BigInt &balance);
+			virtual void balanceChanged(const uint256 &asset, const Int128 &balance);
 
 			virtual void onCoinBaseTxAdded(const UTXOPtr &cb);
 
@@ -98,6 +109,19 @@ namespace Elastos {
 
 			virtual void connectStatusChanged(const std::string &status);
 
+		public:
+			virtual std::vector<uint168> loadUsedProgramHashes();
+
+			virtual UTXOKeySet loadUnspentOutputs(const SubAccountPtr &subAccount);
+
+			virtual std::vector<TransactionPtr> loadTransactions(uint32_t blockHeight, const UTXOKeySet &unspent);
+
+			virtual std::vector<TransactionPtr> loadAllTransactions();
+
+			virtual TransactionPtr loadTransaction(const uint256 &hash);
+
+			virtual bool loadSnapshot(UTXOArray &utxos, uint32_t &blockHeight);
+
 		protected:
 			virtual std::vector<UTXOPtr> loadCoinBaseUTXOs();
 
@@ -109,10 +133,16 @@ namespace Elastos {
 
 			virtual std::vector<AssetPtr> loadAssets();
 
+			virtual Wallet::HistoryLoader *historyLoader();
+
 			virtual const PeerManagerListenerPtr &createPeerManagerListener();
 
 			virtual const WalletListenerPtr &createWalletListener();
 
+		private:
+			// utxos of the wallet at the last block, so the next start does not replay the history
+			void SaveUTXOSnapshot();
+
 		private:
 			DatabaseManager _databaseManager;
 			BackgroundExecutor _executor;
@@ -0,0 +1,206 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "CoinSelector.h"
+#include "Wallet.h"
+#include "UTXO.h"
+
+#include <SDK/Common/ByteStream.h>
+#include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Plugin/Transaction/TransactionInput.h>
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
+#include <SDK/Plugin/Transaction/Program.h>
+
+#include <map>
+
+#define BNB_TOTAL_TRIES 100000
+#define BNB_MAX_INPUTS  500
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		static size_t VarUintSize(uint64_t n) {
+			return n < 0xFD ? 1 : (n <= 0xFFFF ? 3 : (n <= 0xFFFFFFFF ? 5 : 9));
+		}
+
+		CoinSelector::CoinSelector(const TransactionPtr &tx, uint64_t feePerKB, bool payFee) :
+			_tx(tx),
+			_feePerKB(feePerKB),
+			_payFee(payFee),
+			_size(tx->EstimateSize()),
+			_fee(0),
+			_inputAmount(0) {
+
+			const std::vector<ProgramPtr> &programs = tx->GetPrograms();
+			for (size_t i = 0; i < programs.size(); ++i)
+				_codes.insert(programs[i]->GetCode());
+
+			if (_payFee)
+				_fee = CalculateFee(_feePerKB, _size);
+		}
+
+		void CoinSelector::AddInput(const UTXOPtr &utxo, const bytes_t &code, const std::string &path) {
+			AddInput(utxo);
+
+			if (!code.empty() && _codes.insert(code).second) {
+				ByteStream stream;
+				ProgramPtr program(new Program(path, code, bytes_t()));
+				size_t count = _tx->GetPrograms().size();
+
+				_tx->AddProgram(program);
+				_size += stream.WriteVarUint(count + 1) - stream.WriteVarUint(count) + program->EstimateSize();
+				if (_payFee)
+					_fee = CalculateFee(_feePerKB, _size);
+			}
+		}
+
+		void CoinSelector::AddInput(const UTXOPtr &utxo) {
+			InputPtr input(new TransactionInput(utxo->Hash(), utxo->Index()));
+			ByteStream stream;
+			size_t count = _tx->GetInputs().size();
+
+			_tx->AddInput(input);
+			_size += stream.WriteVarUint(count + 1) - stream.WriteVarUint(count) + input->EstimateSize();
+			_inputAmount += utxo->Output()->Amount();
+			if (_payFee)
+				_fee = CalculateFee(_feePerKB, _size);
+		}
+
+		size_t CoinSelector::GetSize() const {
+			return _size;
+		}
+
+		uint64_t CoinSelector::GetFee() const {
+			return _fee;
+		}
+
+		const Int128 &CoinSelector::GetInputAmount() const {
+			return _inputAmount;
+		}
+
+		size_t CoinSelector::GetInputCount() const {
+			return _tx->GetInputs().size();
+		}
+
+		bool CoinSelector::SelectExactMatch(const UTXOArray &candidates, const std::vector<bytes_t> &codes,
+											const Int128 &target, UTXOArray &selected) const {
+			if (candidates.empty() || candidates.size() != codes.size() || target.isNegative() ||
+				target.numBytes() > 7)
+				return false;
+
+			// cost of a change output and of spending it later, the fee is rounded up per KB like the real one
+			uint64_t costOfChange = _payFee ? (_feePerKB * (TX_INPUT_SIZE + TX_OUTPUT_SIZE) + 999) / 1000 : 0;
+			uint64_t targetValue = target.getUint64();
+
+			// sized the way AddInput grows the tx: every input, plus one program per code the tx does not have yet
+			size_t inputSize = TransactionInput().EstimateSize();
+			std::map<bytes_t, size_t> codeIndexes;
+			std::vector<size_t> programSizes, codeRefs;
+
+			std::vector<uint64_t> amounts;
+			std::vector<size_t> indexes, candidateCodes;
+			uint64_t available = 0;
+			for (size_t i = 0; i < candidates.size(); ++i) {
+				const Int128 &amount = candidates[i]->Output()->Amount();
+				if (amount.numBytes() > 7)
+					return false;
+
+				// an input which may not pay for its own size would make the search unbounded
+				uint64_t value = amount.getUint64();
+				if (value == 0 || (_payFee && value <= _feePerKB))
+					continue;
+
+				std::map<bytes_t, size_t>::iterator it = codeIndexes.find(codes[i]);
+				if (it == codeIndexes.end()) {
+					bool known = codes[i].empty() || _codes.find(codes[i]) != _codes.end();
+					it = codeIndexes.insert(std::make_pair(codes[i], programSizes.size())).first;
+					programSizes.push_back(known ? 0 : Program(std::string(), codes[i], bytes_t()).EstimateSize());
+					codeRefs.push_back(0);
+				}
+
+				indexes.push_back(i);
+				candidateCodes.push_back(it->second);
+				amounts.push_back(value);
+				available += value;
+			}
+
+			size_t inputCount = _tx->GetInputs().size(), programCount = _tx->GetPrograms().size();
+
+			std::vector<bool> selection, best;
+			uint64_t currentAmount = 0;
+			size_t currentCount = 0, newPrograms = 0, programBytes = 0;
+
+			for (size_t tries = 0; tries < BNB_TOTAL_TRIES && best.empty(); ++tries) {
+				bool backtrack = false;
+				size_t size = _size + currentCount * inputSize + programBytes +
+							  VarUintSize(inputCount + currentCount) - VarUintSize(inputCount) +
+							  VarUintSize(programCount + newPrograms) - VarUintSize(programCount);
+				uint64_t need = targetValue;
+				if (_payFee)
+					need += CalculateFee(_feePerKB, size);
+
+				// fee only grows with more inputs, and each input adds more than the fee it costs
+				if (currentCount > BNB_MAX_INPUTS || size >= TX_MAX_SIZE - 1000 || currentAmount + available < need) {
+					backtrack = true;
+				} else if (currentAmount >= need) {
+					if (currentAmount - need <= costOfChange)
+						best = selection;
+					backtrack = true;
+				}
+
+				if (backtrack) {
+					while (!selection.empty() && !selection.back()) {
+						selection.pop_back();
+						available += amounts[selection.size()];
+					}
+
+					if (selection.empty())
+						break;
+
+					// included on the way down, try the branch without it
+					size_t i = selection.size() - 1;
+					selection.back() = false;
+					currentAmount -= amounts[i];
+					currentCount--;
+					if (--codeRefs[candidateCodes[i]] == 0 && programSizes[candidateCodes[i]] > 0) {
+						newPrograms--;
+						programBytes -= programSizes[candidateCodes[i]];
+					}
+				} else {
+					size_t i = selection.size();
+					available -= amounts[i];
+
+					// same amount as the previous one which was excluded, this branch is already explored
+					if (!selection.empty() && !selection.back() && amounts[i] == amounts[i - 1] &&
+						candidateCodes[i] == candidateCodes[i - 1]) {
+						selection.push_back(false);
+					} else {
+						selection.push_back(true);
+						currentAmount += amounts[i];
+						currentCount++;
+						if (codeRefs[candidateCodes[i]]++ == 0 && programSizes[candidateCodes[i]] > 0) {
+							newPrograms++;
+							programBytes += programSizes[candidateCodes[i]];
+						}
+					}
+				}
+			}
+
+			if (best.empty())
+				return false;
+
+			for (size_t i = 0; i < best.size(); ++i) {
+				if (best[i])
+					selected.push_back(candidates[indexes[i]]);
+			}
+
+			return true;
+		}
+
+		uint64_t CoinSelector::CalculateFee(uint64_t feePerKB, size_t size) {
+			return (size + 999) / 1000 * feePerKB;
+		}
+
+	}
+}
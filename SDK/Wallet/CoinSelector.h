@@ -0,0 +1,80 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_COINSELECTOR_H__
+#define __ELASTOS_SDK_COINSELECTOR_H__
+
+#include <SDK/Common/Int128.h>
+#include <SDK/Common/typedefs.h>
+
+#include <boost/shared_ptr.hpp>
+#include <set>
+#include <vector>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class Transaction;
+		class UTXO;
+		typedef boost::shared_ptr<Transaction> TransactionPtr;
+		typedef boost::shared_ptr<UTXO> UTXOPtr;
+		typedef std::vector<UTXOPtr> UTXOArray;
+
+		/*
+		 * Adds inputs to a transaction while keeping its estimated size, fee and input amount up to date, so the
+		 * selection loops never re-estimate the whole transaction after each input.
+		 */
+		class CoinSelector {
+		public:
+			enum Strategy {
+				// largest amount first, then top up small utxos while the tx is under 2KB
+				LargestFirst,
+				// exact match without change when one exists, otherwise largest first
+				BranchAndBound,
+				// lowest block height first
+				OldestFirst
+			};
+
+		public:
+			CoinSelector(const TransactionPtr &tx, uint64_t feePerKB, bool payFee);
+
+			// add utxo as input of tx, and a program for code unless tx already has one with the same code
+			void AddInput(const UTXOPtr &utxo, const bytes_t &code, const std::string &path);
+
+			void AddInput(const UTXOPtr &utxo);
+
+			size_t GetSize() const;
+
+			uint64_t GetFee() const;
+
+			const Int128 &GetInputAmount() const;
+
+			size_t GetInputCount() const;
+
+			/*
+			 * Branch and bound search over candidates, which must be sorted by amount descending, for a subset that
+			 * pays target plus fee with less left over than the cost of a change output. The left over goes to fee.
+			 * codes[i] is the redeem code of candidates[i], the fee counts one program per code like AddInput does.
+			 * Return false if no such subset is found within the try limit.
+			 */
+			bool SelectExactMatch(const UTXOArray &candidates, const std::vector<bytes_t> &codes, const Int128 &target,
+								  UTXOArray &selected) const;
+
+			static uint64_t CalculateFee(uint64_t feePerKB, size_t size);
+
+		private:
+			TransactionPtr _tx;
+			uint64_t _feePerKB;
+			bool _payFee;
+
+			size_t _size;
+			uint64_t _fee;
+			Int128 _inputAmount;
+			std::set<bytes_t> _codes;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_COINSELECTOR_H__
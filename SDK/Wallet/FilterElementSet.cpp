@@ -0,0 +1,46 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "FilterElementSet.h"
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		FilterElementSet::FilterElementSet() {
+		}
+
+		FilterElementSet::~FilterElementSet() {
+		}
+
+		bool FilterElementSet::Insert(const bytes_t &element) {
+			if (element.empty() || !_index.insert(element).second)
+				return false;
+
+			_elements.push_back(element);
+			return true;
+		}
+
+		bool FilterElementSet::Contains(const bytes_t &element) const {
+			return _index.find(element) != _index.end();
+		}
+
+		size_t FilterElementSet::Get(std::vector<bytes_t> &elements, size_t start) const {
+			elements.clear();
+			if (start < _elements.size())
+				elements.assign(_elements.begin() + start, _elements.end());
+
+			return _elements.size();
+		}
+
+		size_t FilterElementSet::Size() const {
+			return _elements.size();
+		}
+
+		void FilterElementSet::Clear() {
+			_elements.clear();
+			_index.clear();
+		}
+
+	}
+}
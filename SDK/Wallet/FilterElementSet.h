@@ -0,0 +1,47 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_FILTERELEMENTSET_H__
+#define __ELASTOS_SDK_FILTERELEMENTSET_H__
+
+#include <SDK/Common/typedefs.h>
+
+#include <set>
+#include <vector>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * Data a bloom filter has to match for a wallet: program hashes of its addresses and outpoints it may spend.
+		 * Elements are only appended until Clear, so a filter built from the first N of them is brought up to date
+		 * with Get(elements, N) instead of being rebuilt. Not thread safe.
+		 */
+		class FilterElementSet {
+		public:
+			FilterElementSet();
+
+			~FilterElementSet();
+
+			// return false if element is already in the set
+			bool Insert(const bytes_t &element);
+
+			bool Contains(const bytes_t &element) const;
+
+			// elements from start on, in insertion order, returns the total count
+			size_t Get(std::vector<bytes_t> &elements, size_t start) const;
+
+			size_t Size() const;
+
+			void Clear();
+
+		private:
+			std::vector<bytes_t> _elements;
+			std::set<bytes_t> _index;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_FILTERELEMENTSET_H__
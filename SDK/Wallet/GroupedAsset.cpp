@@ -4,6 +4,7 @@
 
 #include "Wallet.h"
 #include "GroupedAsset.h"
+#include "CoinSelector.h"
 #include "UTXO.h"
 
 #include <SDK/Common/ErrorChecker.h>
@@ -41,10 +42,6 @@ namespace Elastos {
 			_balanceLocked = proto._balanceLocked;
 			_balanceDeposit = proto._balanceDeposit;
 			_utxos = proto._utxos;
-			_utxosVote = proto._utxosVote;
-			_utxosCoinbase = proto._utxosCoinbase;
-			_utxosDeposit = proto._utxosDeposit;
-			_utxosLocked = proto._utxosLocked;
 			*_asset = *proto._asset;
 			_parent = proto._parent;
 			return *this;
@@ -52,40 +49,37 @@ namespace Elastos {
 
 		std::vector<UTXOPtr> GroupedAsset::GetUTXOs(const std::string &addr) const {
 			UTXOArray result;
-			UTXOArray::const_iterator o;
-			for (o = _utxos.cbegin(); o != _utxos.cend(); ++o) {
-				if (addr.empty() || addr == (*o)->Output()->Addr().String())
-					result.push_back(*o);
+			const UTXOSet::Category categories[] = {UTXOSet::Normal, UTXOSet::Vote, UTXOSet::Coinbase,
+													UTXOSet::Deposit, UTXOSet::Locked};
+
+			for (size_t i = 0; i < sizeof(categories) / sizeof(categories[0]); ++i) {
+				UTXOArray utxos = _utxos.GetUTXOs(categories[i]);
+				for (UTXOArray::const_iterator o = utxos.cbegin(); o != utxos.cend(); ++o) {
+					if (addr.empty() || addr == (*o)->Output()->Addr().String())
+						result.push_back(*o);
+				}
 			}
 
-			for (o = _utxosVote.cbegin(); o != _utxosVote.cend(); ++o) {
-				if (addr.empty() || addr == (*o)->Output()->Addr().String())
-					result.push_back(*o);
-			}
+			return result;
+		}
 
-			for (o = _utxosCoinbase.cbegin(); o != _utxosCoinbase.cend(); ++o) {
-				if (addr.empty() || addr == (*o)->Output()->Addr().String())
-					result.push_back(*o);
-			}
+		UTXOArray GroupedAsset::GetCoinBaseUTXOs() const {
+			return _utxos.GetUTXOs(UTXOSet::Coinbase);
+		}
 
-			for (o = _utxosDeposit.cbegin(); o != _utxosDeposit.cend(); ++o) {
-				if (addr.empty() || addr == (*o)->Output()->Addr().String())
-					result.push_back(*o);
-			}
+		UTXOArray GroupedAsset::GetNonCoinBaseUTXOs() const {
+			UTXOArray result;
+			const UTXOSet::Category categories[] = {UTXOSet::Normal, UTXOSet::Vote, UTXOSet::Deposit};
 
-			for (o = _utxosLocked.cbegin(); o != _utxosLocked.cend(); ++o) {
-				if (addr.empty() || addr == (*o)->Output()->Addr().String())
-					result.push_back(*o);
+			for (size_t i = 0; i < sizeof(categories) / sizeof(categories[0]); ++i) {
+				UTXOArray utxos = _utxos.GetUTXOs(categories[i]);
+				result.insert(result.end(), utxos.begin(), utxos.end());
 			}
 
 			return result;
 		}
 
-		const std::vector<UTXOPtr> &GroupedAsset::GetCoinBaseUTXOs() const {
-			return _utxosCoinbase;
-		}
-
-		BigInt GroupedAsset::GetBalance(BalanceType type) const {
+		Int128 GroupedAsset::GetBalance(BalanceType type) const {
 			if (type == BalanceType::Default) {
 				return _balance - _balanceVote;
 			} else if (type == BalanceType::Voted) {
@@ -121,7 +115,8 @@ namespace Elastos {
 
 			_parent->Lock();
 
-			for (UTXOArray::iterator u = _utxosDeposit.begin(); u != _utxosDeposit.end(); ++u) {
+			UTXOArray utxosDeposit = _utxos.GetUTXOs(UTXOSet::Deposit);
+			for (UTXOArray::iterator u = utxosDeposit.begin(); u != utxosDeposit.end(); ++u) {
 				if (_parent->IsUTXOSpending(*u))
 					continue;
 
@@ -148,8 +143,8 @@ namespace Elastos {
 
 		TransactionPtr GroupedAsset::Consolidate(const std::string &memo, bool useVotedUTXO) {
 			TransactionPtr tx = TransactionPtr(new Transaction());
-			BigInt totalInputAmount(0);
-			uint64_t feeAmount = 0, txSize = 0;
+			Int128 totalInputAmount(0);
+			uint64_t feeAmount = 0;
 			bool lastUTXOPending = false;
 
 			tx->AddAttribute(AttributePtr(new Attribute(Attribute::Nonce,
@@ -159,13 +154,12 @@ namespace Elastos {
 
 			_parent->Lock();
 
-			std::sort(_utxos.begin(), _utxos.end(), [](const UTXOPtr &a, const UTXOPtr &b) {
-				return a->Output()->Amount() > b->Output()->Amount();
-			});
+			CoinSelector selector(tx, _parent->_feePerKb, _asset->GetName() == "ELA");
 
 			if (useVotedUTXO) {
-				for (UTXOArray::iterator u = _utxosVote.begin(); u != _utxosVote.end(); ++u) {
-					if (txSize >= TX_MAX_SIZE - 1000)
+				UTXOArray utxosVote = _utxos.GetUTXOs(UTXOSet::Vote);
+				for (UTXOArray::iterator u = utxosVote.begin(); u != utxosVote.end(); ++u) {
+					if (selector.GetSize() >= TX_MAX_SIZE - 1000)
 						break;
 
 					if (_parent->IsUTXOSpending(*u)) {
@@ -176,22 +170,13 @@ namespace Elastos {
 					if ((*u)->GetConfirms(_parent->_blockHeight) < 2)
 						continue;
 
-					tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-					bytes_t code;
-					std::string path;
-					_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-					tx->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
-
-					totalInputAmount += (*u)->Output()->Amount();
-
-					txSize = tx->EstimateSize();
-					if (_asset->GetName() == "ELA")
-						feeAmount = CalculateFee(_parent->_feePerKb, txSize);
+					AddInput(selector, *u);
 				}
 			}
 
-			for (UTXOArray::iterator u = _utxos.begin(); u != _utxos.end(); ++u) {
-				if (txSize >= TX_MAX_SIZE - 1000 || tx->GetInputs().size() >= 500)
+			UTXOArray utxos = _utxos.GetUTXOs(UTXOSet::Normal, UTXOSet::AmountDescending);
+			for (UTXOArray::iterator u = utxos.begin(); u != utxos.end(); ++u) {
+				if (selector.GetSize() >= TX_MAX_SIZE - 1000 || selector.GetInputCount() >= 500)
 					break;
 
 				if (_parent->IsUTXOSpending(*u)) {
@@ -202,21 +187,12 @@ namespace Elastos {
 				if ((*u)->GetConfirms(_parent->_blockHeight) < 2)
 					continue;
 
-				tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-				bytes_t code;
-				std::string path;
-				_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-				tx->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
-
-				totalInputAmount += (*u)->Output()->Amount();
-
-				txSize = tx->EstimateSize();
-				if (_asset->GetName() == "ELA")
-					feeAmount = CalculateFee(_parent->_feePerKb, txSize);
+				AddInput(selector, *u);
 			}
 
-			for (UTXOArray::iterator u = _utxosCoinbase.begin(); u != _utxosCoinbase.end(); ++u) {
-				if (txSize >= TX_MAX_SIZE - 1000 || tx->GetInputs().size() >= 500)
+			UTXOArray utxosCoinbase = _utxos.GetUTXOs(UTXOSet::Coinbase);
+			for (UTXOArray::iterator u = utxosCoinbase.begin(); u != utxosCoinbase.end(); ++u) {
+				if (selector.GetSize() >= TX_MAX_SIZE - 1000 || selector.GetInputCount() >= 500)
 					break;
 
 				if (_parent->IsUTXOSpending(*u)) {
@@ -224,22 +200,14 @@ namespace Elastos {
 					continue;
 				}
 
-				tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-
-				bytes_t code;
-				std::string path;
-				_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-				tx->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
-
-				totalInputAmount += (*u)->Output()->Amount();
-
-				txSize = tx->EstimateSize();
-				if (_asset->GetName() == "ELA")
-					feeAmount = CalculateFee(_parent->_feePerKb, txSize);
+				AddInput(selector, *u);
 			}
 
 			_parent->Unlock();
 
+			totalInputAmount = selector.GetInputAmount();
+			feeAmount = selector.GetFee();
+
 			if (totalInputAmount <= feeAmount) {
 				if (lastUTXOPending) {
 					ErrorChecker::ThrowLogicException(Error::TxPending,
@@ -271,9 +239,9 @@ namespace Elastos {
 			ErrorChecker::CheckLogic(outputs.empty(), Error::InvalidArgument, "outputs should not be empty");
 
 			TransactionPtr txn = TransactionPtr(new Transaction);
-			BigInt totalOutputAmount(0), totalInputAmount(0);
-			uint64_t txSize = 0, feeAmount = 0;
-			bool lastUTXOPending = false;
+			Int128 totalOutputAmount(0), totalInputAmount(0);
+			uint64_t feeAmount = 0;
+			bool lastUTXOPending = false, exactMatch = false;
 
 			std::string nonce = std::to_string((std::rand() & 0xFFFFFFFF));
 			txn->AddAttribute(AttributePtr(new Attribute(Attribute::Nonce, bytes_t(nonce.c_str(), nonce.size()))));
@@ -286,16 +254,13 @@ namespace Elastos {
 
 			_parent->Lock();
 
-			std::sort(_utxos.begin(), _utxos.end(), [](const UTXOPtr &a, const UTXOPtr &b) {
-				return a->Output()->Amount() > b->Output()->Amount();
-			});
-
-			if (_asset->GetName() == "ELA")
-				feeAmount = CalculateFee(_parent->_feePerKb, txn->EstimateSize());
+			CoinSelector selector(txn, _parent->_feePerKb, _asset->GetName() == "ELA");
+			CoinSelector::Strategy strategy = _parent->_coinSelectionStrategy;
 
 			if (useVotedUTXO) {
 				// voted utxo
-				for (UTXOArray::iterator u = _utxosVote.begin(); u != _utxosVote.end(); ++u) {
+				UTXOArray utxosVote = _utxos.GetUTXOs(UTXOSet::Vote);
+				for (UTXOArray::iterator u = utxosVote.begin(); u != utxosVote.end(); ++u) {
 					if (_parent->IsUTXOSpending(*u)) {
 						lastUTXOPending = true;
 						continue;
@@ -304,19 +269,58 @@ namespace Elastos {
 					if ((*u)->GetConfirms(_parent->_blockHeight) < 2)
 						continue;
 
-					txn->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-					bytes_t code;
-					std::string path;
-					_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-					txn->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
+					AddInput(selector, *u);
+				}
+			}
+
+			UTXOArray utxos = _utxos.GetUTXOs(UTXOSet::Normal, strategy == CoinSelector::OldestFirst ?
+															  UTXOSet::HeightAscending : UTXOSet::AmountDescending);
+			UTXOArray utxosCoinbase = _utxos.GetUTXOs(UTXOSet::Coinbase);
+
+			UTXOArray selected;
+			UTXOKeySet selectedKeys;
+			if (strategy == CoinSelector::BranchAndBound && selector.GetInputAmount() < totalOutputAmount) {
+				UTXOArray candidates;
 
-					totalInputAmount += (*u)->Output()->Amount();
+				for (UTXOArray::iterator u = utxos.begin(); u != utxos.end(); ++u) {
+					if (!_parent->IsUTXOSpending(*u) && (*u)->GetConfirms(_parent->_blockHeight) >= 2 &&
+						(!fromAddress.Valid() || fromAddress.ProgramHash() == (*u)->Output()->ProgramHash()))
+						candidates.push_back(*u);
+				}
+
+				size_t normalCount = candidates.size();
+				UTXOArray coinbase = _utxos.GetUTXOs(UTXOSet::Coinbase, UTXOSet::AmountDescending);
+				for (UTXOArray::iterator u = coinbase.begin(); u != coinbase.end(); ++u) {
+					if (!_parent->IsUTXOSpending(*u) &&
+						(!fromAddress.Valid() || fromAddress.ProgramHash() != (*u)->Output()->ProgramHash()))
+						candidates.push_back(*u);
+				}
+
+				std::inplace_merge(candidates.begin(), candidates.begin() + normalCount, candidates.end(),
+								   [](const UTXOPtr &a, const UTXOPtr &b) {
+									   return a->Output()->Amount() > b->Output()->Amount();
+								   });
+
+				std::vector<bytes_t> codes(candidates.size());
+				std::string path;
+				for (size_t i = 0; i < candidates.size(); ++i)
+					_parent->_subAccount->GetCodeAndPath(candidates[i]->Output()->Addr(), codes[i], path);
+
+				if (selector.SelectExactMatch(candidates, codes, totalOutputAmount - selector.GetInputAmount(),
+											  selected)) {
+					for (UTXOArray::iterator u = selected.begin(); u != selected.end(); ++u) {
+						AddInput(selector, *u);
+						selectedKeys.insert(UTXOKey((*u)->Hash(), (*u)->Index()));
+					}
+
+					// sized like the selector, still checked in case a code was not found for some address
+					exactMatch = selector.GetInputAmount() >= totalOutputAmount + selector.GetFee();
 				}
 			}
 
 			// normal utxo
-			for (UTXOArray::iterator u = _utxos.begin(); u != _utxos.end(); ++u) {
-				if (totalInputAmount >= totalOutputAmount + feeAmount && txSize >= 2000)
+			for (UTXOArray::iterator u = utxos.begin(); !exactMatch && u != utxos.end(); ++u) {
+				if (selector.GetInputAmount() >= totalOutputAmount + selector.GetFee() && selector.GetSize() >= 2000)
 					break;
 
 				if (_parent->IsUTXOSpending(*u)) {
@@ -324,6 +328,9 @@ namespace Elastos {
 					continue;
 				}
 
+				if (selectedKeys.find(UTXOKey((*u)->Hash(), (*u)->Index())) != selectedKeys.end())
+					continue;
+
 				if (fromAddress.Valid() && fromAddress.ProgramHash() != (*u)->Output()->ProgramHash()) {
 					continue;
 				}
@@ -331,20 +338,16 @@ namespace Elastos {
 				if ((*u)->GetConfirms(_parent->_blockHeight) < 2)
 					continue;
 
-				txn->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-				bytes_t code;
-				std::string path;
-				_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-				txn->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
-
-				txSize = txn->EstimateSize();
-				if (txSize >= TX_MAX_SIZE - 1000) { // transaction size-in-bytes too large
+				feeAmount = selector.GetFee();
+				AddInput(selector, *u);
+				if (selector.GetSize() >= TX_MAX_SIZE - 1000) { // transaction size-in-bytes too large
 					_parent->Unlock();
 
+					totalInputAmount = selector.GetInputAmount() - (*u)->Output()->Amount();
 					if (autoReduceOutputAmount && outputs.back()->Amount() > totalOutputAmount + feeAmount - totalInputAmount) {
 						std::vector<OutputPtr> newOutputs(outputs.begin(), outputs.end());
 
-						BigInt newAmount = outputs.back()->Amount();
+						Int128 newAmount = outputs.back()->Amount();
 						newAmount -= totalOutputAmount + feeAmount - totalInputAmount;
 
 						newOutputs.back()->SetAmount(newAmount);
@@ -354,22 +357,18 @@ namespace Elastos {
 						std::vector<OutputPtr> newOutputs(outputs.begin(), outputs.begin() + outputs.size() - 1);
 						txn = CreateTxForOutputs(newOutputs, fromAddress, memo, useVotedUTXO, autoReduceOutputAmount);
 					} else {
-						BigInt maxAmount = totalInputAmount - feeAmount;
+						Int128 maxAmount = totalInputAmount - feeAmount;
 						ErrorChecker::CheckCondition(true, Error::CreateTransactionExceedSize,
 													 "Tx size too large, max available amount: " + maxAmount.getDec() + " sela");
 					}
 
 					return txn;
 				}
-
-				totalInputAmount += (*u)->Output()->Amount();
-				if (_asset->GetName() == "ELA")
-					feeAmount = CalculateFee(_parent->_feePerKb, txSize);
 			}
 
 			// coin base utxo
-			for (UTXOArray::iterator u = _utxosCoinbase.begin(); u != _utxosCoinbase.end(); ++u) {
-				if (totalInputAmount >= totalOutputAmount + feeAmount && txSize >= 2000)
+			for (UTXOArray::iterator u = utxosCoinbase.begin(); !exactMatch && u != utxosCoinbase.end(); ++u) {
+				if (selector.GetInputAmount() >= totalOutputAmount + selector.GetFee() && selector.GetSize() >= 2000)
 					break;
 
 				if (_parent->IsUTXOSpending(*u)) {
@@ -380,20 +379,19 @@ namespace Elastos {
 				if (fromAddress.Valid() && fromAddress.ProgramHash() == (*u)->Output()->ProgramHash())
 					continue;
 
-				txn->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-				bytes_t code;
-				std::string path;
-				_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-				txn->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
+				if (selectedKeys.find(UTXOKey((*u)->Hash(), (*u)->Index())) != selectedKeys.end())
+					continue;
 
-				txSize = txn->EstimateSize();
-				if (txSize >= TX_MAX_SIZE - 1000 && totalInputAmount < totalOutputAmount + feeAmount) {
+				feeAmount = selector.GetFee();
+				AddInput(selector, *u);
+				totalInputAmount = selector.GetInputAmount() - (*u)->Output()->Amount();
+				if (selector.GetSize() >= TX_MAX_SIZE - 1000 && totalInputAmount < totalOutputAmount + feeAmount) {
 					_parent->Unlock();
 
 					if (autoReduceOutputAmount && outputs.back()->Amount() > totalOutputAmount + feeAmount - totalInputAmount) {
 						std::vector<OutputPtr> newOutputs(outputs.begin(), outputs.end());
 
-						BigInt newAmount = outputs.back()->Amount();
+						Int128 newAmount = outputs.back()->Amount();
 						newAmount -= totalOutputAmount + feeAmount - totalInputAmount;
 
 						newOutputs.back()->SetAmount(newAmount);
@@ -403,7 +401,7 @@ namespace Elastos {
 						std::vector<OutputPtr> newOutputs(outputs.begin(), outputs.begin() + outputs.size() - 1);
 						txn = CreateTxForOutputs(newOutputs, fromAddress, memo, useVotedUTXO, autoReduceOutputAmount);
 					} else {
-						BigInt maxAmount = totalInputAmount - feeAmount;
+						Int128 maxAmount = totalInputAmount - feeAmount;
 						ErrorChecker::CheckCondition(true, Error::CreateTransactionExceedSize,
 													 "Tx size too large, max available amount: " + maxAmount.getDec() + " sela" +
 													 ", fee amount: " + std::to_string(feeAmount) + " sela");
@@ -411,20 +409,24 @@ namespace Elastos {
 
 					return txn;
 				}
-				totalInputAmount += (*u)->Output()->Amount();
-				if (_asset->GetName() == "ELA")
-					feeAmount = CalculateFee(_parent->_feePerKb, txSize);
 			}
 
 			_parent->Unlock();
 
+			totalInputAmount = selector.GetInputAmount();
+			feeAmount = selector.GetFee();
+
 			if (txn) {
 //				if (txn->GetInputs().size() > 500) {
 //					ErrorChecker::ThrowLogicException(Error::TooMuchInputs, "Too much inputs, need to consolidate first");
 //				}
 
-				if (totalInputAmount < totalOutputAmount + feeAmount) {
-					BigInt maxAvailable(0);
+				if (exactMatch) {
+					// no change output, what is left over is less than the cost of change and goes to fee
+					Int128 leftOver = totalInputAmount - totalOutputAmount;
+					feeAmount = leftOver.getUint64();
+				} else if (totalInputAmount < totalOutputAmount + feeAmount) {
+					Int128 maxAvailable(0);
 					if (totalInputAmount >= feeAmount)
 						maxAvailable = totalInputAmount - feeAmount;
 
@@ -441,7 +443,7 @@ namespace Elastos {
 					uint256 assetID = txn->GetOutputs()[0]->AssetID();
 					std::vector<Address> addresses = _parent->UnusedAddresses(1, 1);
 					ErrorChecker::CheckCondition(addresses.empty(), Error::GetUnusedAddress, "Get address failed");
-					BigInt changeAmount = totalInputAmount - totalOutputAmount - feeAmount;
+					Int128 changeAmount = totalInputAmount - totalOutputAmount - feeAmount;
 					txn->AddOutput(OutputPtr(new TransactionOutput(changeAmount, addresses[0], assetID)));
 				}
 				txn->SetFee(feeAmount);
@@ -451,8 +453,8 @@ namespace Elastos {
 		}
 
 		void GroupedAsset::AddFeeForTx(TransactionPtr &tx, bool useVotedUTXO) {
-			uint64_t feeAmount = 0, txSize = 0;
-			BigInt totalInputAmount(0);
+			uint64_t feeAmount = 0;
+			Int128 totalInputAmount(0);
 			bool lastUTXOPending = false;
 
 			if (tx == nullptr) {
@@ -468,12 +470,11 @@ namespace Elastos {
 			}
 
 			_parent->Lock();
-			txSize = tx->EstimateSize();
-			feeAmount = CalculateFee(_parent->_feePerKb, txSize);
+			CoinSelector selector(tx, _parent->_feePerKb, true);
 
-//			_utxos.SortBaseOnOutputAmount(feeAmount, _parent->_feePerKb);
 			if (useVotedUTXO) {
-				for (UTXOArray::iterator u = _utxosVote.begin(); u != _utxosVote.end(); ++u) {
+				UTXOArray utxosVote = _utxos.GetUTXOs(UTXOSet::Vote);
+				for (UTXOArray::iterator u = utxosVote.begin(); u != utxosVote.end(); ++u) {
 					if (_parent->IsUTXOSpending(*u)) {
 						lastUTXOPending = true;
 						continue;
@@ -482,17 +483,13 @@ namespace Elastos {
 					if ((*u)->GetConfirms(_parent->_blockHeight) < 2)
 						continue;
 
-					tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-					totalInputAmount += (*u)->Output()->Amount();
-
-					txSize = tx->EstimateSize();
-					if (_asset->GetName() == "ELA")
-						feeAmount = CalculateFee(_parent->_feePerKb, txSize);
+					selector.AddInput(*u);
 				}
 			}
 
-			for (UTXOArray::iterator u = _utxosCoinbase.begin(); u != _utxosCoinbase.end(); ++u) {
-				if (totalInputAmount >= feeAmount)
+			UTXOArray utxosCoinbase = _utxos.GetUTXOs(UTXOSet::Coinbase);
+			for (UTXOArray::iterator u = utxosCoinbase.begin(); u != utxosCoinbase.end(); ++u) {
+				if (selector.GetInputAmount() >= selector.GetFee())
 					break;
 
 				if (_parent->IsUTXOSpending(*u)) {
@@ -500,29 +497,20 @@ namespace Elastos {
 					continue;
 				}
 
-				tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
-				bytes_t code;
-				std::string path;
-				_parent->_subAccount->GetCodeAndPath((*u)->Output()->Addr(), code, path);
-				tx->AddUniqueProgram(ProgramPtr(new Program(path, code, bytes_t())));
-
-				txSize = tx->EstimateSize();
-				if (txSize > TX_MAX_SIZE) {
+				totalInputAmount = selector.GetInputAmount();
+				AddInput(selector, *u);
+				if (selector.GetSize() > TX_MAX_SIZE) {
 					_parent->Unlock();
 
 					ErrorChecker::CheckCondition(true, Error::CreateTransactionExceedSize,
 												 "Tx size too large, max available amount for fee: " +
 												 totalInputAmount.getDec() + " sela");
-					_parent->Lock();
-					break;
 				}
-				totalInputAmount += (*u)->Output()->Amount();
-				if (_asset->GetName() == "ELA")
-					feeAmount = CalculateFee(_parent->_feePerKb, txSize);
 			}
 
-			for (UTXOArray::iterator u = _utxos.begin(); u != _utxos.end(); ++u) {
-				if (totalInputAmount >= feeAmount)
+			UTXOArray utxos = _utxos.GetUTXOs(UTXOSet::Normal);
+			for (UTXOArray::iterator u = utxos.begin(); u != utxos.end(); ++u) {
+				if (selector.GetInputAmount() >= selector.GetFee())
 					break;
 
 				if (_parent->IsUTXOSpending(*u)) {
@@ -532,26 +520,23 @@ namespace Elastos {
 
 				if ((*u)->GetConfirms(_parent->_blockHeight) < 2)
 					continue;
-				tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
 
-				txSize = tx->EstimateSize();
-				if (txSize > TX_MAX_SIZE) { // transaction size-in-bytes too large
+				totalInputAmount = selector.GetInputAmount();
+				selector.AddInput(*u);
+				if (selector.GetSize() > TX_MAX_SIZE) { // transaction size-in-bytes too large
 					_parent->Unlock();
 
 					ErrorChecker::CheckCondition(true, Error::CreateTransactionExceedSize,
 												 "Tx size too large, max available amount for fee: " +
 												 totalInputAmount.getDec() + " sela");
-					_parent->Lock();
-					break;
 				}
-
-				totalInputAmount += (*u)->Output()->Amount();
-				if (_asset->GetName() == "ELA")
-					feeAmount = CalculateFee(_parent->_feePerKb, txSize);
 			}
 
 			_parent->Unlock();
 
+			totalInputAmount = selector.GetInputAmount();
+			feeAmount = selector.GetFee();
+
 			if (totalInputAmount < feeAmount) {
 				if (lastUTXOPending) {
 					ErrorChecker::ThrowLogicException(Error::TxPending,
@@ -566,7 +551,7 @@ namespace Elastos {
 				uint256 assetID = Asset::GetELAAssetID();
 				std::vector<Address> addresses = _parent->UnusedAddresses(1, 1);
 				ErrorChecker::CheckCondition(addresses.empty(), Error::GetUnusedAddress, "Get address failed");
-				BigInt changeAmount = totalInputAmount - feeAmount;
+				Int128 changeAmount = totalInputAmount - feeAmount;
 				tx->AddOutput(OutputPtr(new TransactionOutput(changeAmount, addresses[0], assetID)));
 			}
 
@@ -583,7 +568,7 @@ namespace Elastos {
 
 			if (_parent->_subAccount->IsDepositAddress(o->Output()->Addr())) {
 				_balanceDeposit += o->Output()->Amount();
-				_utxosDeposit.push_back(o);
+				_utxos.Add(o, UTXOSet::Deposit);
 				//SPVLOG_DEBUG("{} add deposit utxo {} n {} addr {} amount +{} = deposit {}", \
 							 _parent->_walletID, o->Hash().GetHex(), o->Index(), \
 							 o->Output()->Addr().String(), o->Output()->Amount().getDec(), _balanceDeposit.getDec());
@@ -591,13 +576,13 @@ namespace Elastos {
 				_balance += o->Output()->Amount();
 				if (o->Output()->GetType() == TransactionOutput::Type::VoteOutput) {
 					_balanceVote += o->Output()->Amount();
-					_utxosVote.push_back(o);
+					_utxos.Add(o, UTXOSet::Vote);
 					//SPVLOG_DEBUG("{} add vote utxo {} n {} addr {} amount +{} = vote {} balance {}", \
 								 _parent->_walletID, o->Hash().GetHex(), o->Index(), \
 								 o->Output()->Addr().String(), o->Output()->Amount().getDec(), \
 								 _balanceVote.getDec(), _balance.getDec());
 				} else {
-					_utxos.push_back(o);
+					_utxos.Add(o, UTXOSet::Normal);
 					//SPVLOG_DEBUG("{} add utxo {} n {} addr {} amount +{} = balance {}", \
 								 _parent->_walletID, o->Hash().GetHex(), o->Index(), \
 								 o->Output()->Addr().String(), o->Output()->Amount().getDec(), \
@@ -609,18 +594,21 @@ namespace Elastos {
 		}
 
 		bool GroupedAsset::AddCoinBaseUTXO(const UTXOPtr &o) {
-			if (ContainUTXO(o))
+			if (ContainUTXO(o)) {
+				// confirmed again at another height
+				_utxos.UpdateHeight(o->Hash(), o->Index());
 				return false;
+			}
 
 			if (o->GetConfirms(_parent->_blockHeight) <= 100) {
 				_balanceLocked += o->Output()->Amount();
-				_utxosLocked.push_back(o);
+				_utxos.Add(o, UTXOSet::Locked);
 				//SPVLOG_DEBUG("{} add coinbase locked utxo {} n {} addr {} amount +{} = locked {}", \
 							 _parent->_walletID, o->Hash().GetHex(), o->Index(), \
 							 o->Output()->Addr().String(), o->Output()->Amount().getDec(), _balanceLocked.getDec());
 			} else {
 				_balance += o->Output()->Amount();
-				_utxosCoinbase.push_back(o);
+				_utxos.Add(o, UTXOSet::Coinbase);
 				//SPVLOG_DEBUG("{} add coinbase utxo {} n {} addr {} amount +{} = balance {}", \
 							 _parent->_walletID, o->Hash().GetHex(), o->Index(), \
 							 o->Output()->Addr().String(), o->Output()->Amount().getDec(), _balance.getDec());
@@ -645,86 +633,64 @@ namespace Elastos {
 		}
 
 		bool GroupedAsset::RemoveSpentUTXO(const uint256 &hash, uint16_t n) {
-			for (UTXOArray::iterator it = _utxosCoinbase.begin(); it != _utxosCoinbase.end(); ++it) {
-				if ((*it)->Equal(hash, n)) {
-					assert(_balance >= (*it)->Output()->Amount());
-					(*it)->SetSpent(true);
-					_balance -= (*it)->Output()->Amount();
-					//SPVLOG_DEBUG("{} remove coinbase utxo {} n {} addr {} amount -{} = balance {}", \
-								 _parent->_walletID, hash.GetHex(), n, (*it)->Output()->Addr().String(), \
-								 (*it)->Output()->Amount().getDec(), _balance.getDec());
-					_utxosCoinbase.erase(it);
-					return true;
-				}
-			}
+			UTXOSet::Category category;
+			UTXOPtr utxo = _utxos.Get(hash, n, category);
 
-			for (UTXOArray::iterator it = _utxosVote.begin(); it != _utxosVote.end(); ++it) {
-				if ((*it)->Equal(hash, n)) {
-					assert(_balanceVote >= (*it)->Output()->Amount());
-					assert(_balance >= (*it)->Output()->Amount());
-					_balanceVote -= (*it)->Output()->Amount();
-					_balance -= (*it)->Output()->Amount();
-					//SPVLOG_DEBUG("{} remove vote utxo {} n {} addr {} amount -{} = vote balance {} balance {}", \
-								 _parent->_walletID, hash.GetHex(), n, (*it)->Output()->Addr().String(), \
-								 (*it)->Output()->Amount().getDec(), _balanceVote.getDec(), _balance.getDec());
-					_utxosVote.erase(it);
-					return true;
-				}
-			}
-
-			for (UTXOArray::iterator it = _utxos.begin(); it != _utxos.end(); ++it) {
-				if ((*it)->Equal(hash, n)) {
-					assert(_balance >= (*it)->Output()->Amount());
-					_balance -= (*it)->Output()->Amount();
-					//SPVLOG_DEBUG("{} remove utxo {} n {} addr {} amount -{} = balance {}", \
-								 _parent->_walletID, hash.GetHex(), n, (*it)->Output()->Addr().String(), \
-								 (*it)->Output()->Amount().getDec(), _balance.getDec());
-					_utxos.erase(it);
-					return true;
-				}
-			}
+			// locked coinbase can not be spent
+			if (utxo == nullptr || category == UTXOSet::Locked)
+				return false;
 
-			for (UTXOArray::iterator it = _utxosDeposit.begin(); it != _utxosDeposit.end(); ++it) {
-				if ((*it)->Equal(hash, n)) {
-					assert(_balanceDeposit >= (*it)->Output()->Amount());
-					_balanceDeposit -= (*it)->Output()->Amount();
-					//SPVLOG_DEBUG("{} remove deposit utxo {} n {} addr {} amount -{} = deposit balance {}", \
-								 _parent->_walletID, hash.GetHex(), n, (*it)->Output()->Addr().String(), \
-								 (*it)->Output()->Amount().getDec(), _balanceDeposit.getDec());
-					_utxosDeposit.erase(it);
-					return true;
-				}
-			}
+			_utxos.Remove(hash, n, category);
+			const Int128 &amount = utxo->Output()->Amount();
+
+			if (category == UTXOSet::Coinbase) {
+				assert(_balance >= amount);
+				utxo->SetSpent(true);
+				_balance -= amount;
+			} else if (category == UTXOSet::Vote) {
+				assert(_balanceVote >= amount);
+				assert(_balance >= amount);
+				_balanceVote -= amount;
+				_balance -= amount;
+			} else if (category == UTXOSet::Normal) {
+				assert(_balance >= amount);
+				_balance -= amount;
+			} else if (category == UTXOSet::Deposit) {
+				assert(_balanceDeposit >= amount);
+				_balanceDeposit -= amount;
+			}
+			//SPVLOG_DEBUG("{} remove utxo {} n {} category {} amount -{} = balance {}", \
+						 _parent->_walletID, hash.GetHex(), n, category, amount.getDec(), _balance.getDec());
 
-			return false;
+			return true;
 		}
 
 		void GroupedAsset::GetSpentCoinbase(const InputArray &inputs, std::vector<uint256> &spentCoinbase) const {
+			UTXOSet::Category category;
+
 			for (InputArray::const_iterator in = inputs.cbegin(); in != inputs.cend(); ++in) {
-				for (UTXOArray::const_iterator o = _utxosCoinbase.begin(); o != _utxosCoinbase.end(); ++o) {
-					if ((*o)->Equal((*in))) {
-						spentCoinbase.push_back((*o)->Hash());
-						break;
-					}
-				}
+				UTXOPtr utxo = _utxos.Get((*in)->TxHash(), (*in)->Index(), category);
+				if (utxo != nullptr && category == UTXOSet::Coinbase)
+					spentCoinbase.push_back(utxo->Hash());
 			}
 		}
 
 		bool GroupedAsset::UpdateLockedBalance() {
 			bool changed = false;
 
-			for (UTXOArray::iterator locked = _utxosLocked.begin(); locked != _utxosLocked.end();) {
+			if (_utxos.Size(UTXOSet::Locked) == 0)
+				return changed;
+
+			UTXOArray utxosLocked = _utxos.GetUTXOs(UTXOSet::Locked);
+			for (UTXOArray::iterator locked = utxosLocked.begin(); locked != utxosLocked.end(); ++locked) {
 				if ((*locked)->GetConfirms(_parent->_blockHeight) > 100) {
 					_balanceLocked -= (*locked)->Output()->Amount();
 					_balance += (*locked)->Output()->Amount();
-					_utxosCoinbase.push_back(*locked);
+					_utxos.SetCategory((*locked)->Hash(), (*locked)->Index(), UTXOSet::Coinbase);
 					//SPVLOG_DEBUG("{} move locked utxo {} n {} amount {} locked balance {} balance {}", \
 								 _parent->_walletID, (*locked)->Hash().GetHex(), (*locked)->Index(), \
 								 (*locked)->Output()->Amount().getDec(), _balanceLocked.getDec(), _balance.getDec());
-					locked = _utxosLocked.erase(locked);
 					changed = true;
-				} else {
-					++locked;
 				}
 			}
 
@@ -732,38 +698,14 @@ namespace Elastos {
 		}
 
 		bool GroupedAsset::ContainUTXO(const UTXOPtr &o) const {
-			for (UTXOArray::const_iterator it = _utxosVote.cbegin(); it != _utxosVote.cend(); ++it) {
-				if (**it == *o)
-					return true;
-			}
-
-			for (UTXOArray::const_iterator it = _utxos.cbegin(); it != _utxos.cend(); ++it) {
-				if (**it == *o)
-					return true;
-			}
-
-			for (UTXOArray::const_iterator it = _utxosCoinbase.cbegin(); it != _utxosCoinbase.cend(); ++it) {
-				if (**it == *o)
-					return true;
-			}
-
-			for (UTXOArray::const_iterator it = _utxosDeposit.cbegin(); it != _utxosDeposit.cend(); ++it) {
-				if (**it == *o) {
-					return true;
-				}
-			}
-
-			for (UTXOArray::const_iterator it = _utxosLocked.cbegin(); it != _utxosLocked.cend(); ++it) {
-				if (**it == *o) {
-					return true;
-				}
-			}
-
-			return false;
+			return _utxos.Contains(o->Hash(), o->Index());
 		}
 
-		uint64_t GroupedAsset::CalculateFee(uint64_t feePerKB, size_t size) {
-			return (size + 999) / 1000 * feePerKB ;
+		void GroupedAsset::AddInput(CoinSelector &selector, const UTXOPtr &utxo) const {
+			bytes_t code;
+			std::string path;
+			_parent->_subAccount->GetCodeAndPath(utxo->Output()->Addr(), code, path);
+			selector.AddInput(utxo, code, path);
 		}
 
 	}
@@ -5,10 +5,12 @@
 #ifndef __ELASTOS_SDK__GROUPEDASSET_H__
 #define __ELASTOS_SDK__GROUPEDASSET_H__
 
+#include "UTXOSet.h"
+
 #include <SDK/Common/ElementSet.h>
 #include <SDK/Common/Lockable.h>
 #include <SDK/Account/SubAccount.h>
-#include <SDK/Common/BigInt.h>
+#include <SDK/Common/Int128.h>
 
 #include <map>
 #include <boost/function.hpp>
@@ -18,6 +20,7 @@ namespace Elastos {
 	namespace ElaWallet {
 
 		class Wallet;
+		class CoinSelector;
 		class Asset;
 		class Transaction;
 		class TransactionOutput;
@@ -50,9 +53,12 @@ namespace Elastos {
 
 			UTXOArray GetUTXOs(const std::string &addr) const;
 
-			const UTXOArray &GetCoinBaseUTXOs() const;
+			UTXOArray GetCoinBaseUTXOs() const;
+
+			// normal, vote and deposit utxos, coinbase ones are kept in their own table
+			UTXOArray GetNonCoinBaseUTXOs() const;
 
-			BigInt GetBalance(BalanceType type = Total) const;
+			Int128 GetBalance(BalanceType type = Total) const;
 
 			nlohmann::json GetBalanceInfo();
 
@@ -89,11 +95,11 @@ namespace Elastos {
 			bool ContainUTXO(const UTXOPtr &o) const;
 
 		private:
-			uint64_t CalculateFee(uint64_t feePerKB, size_t size);
+			void AddInput(CoinSelector &selector, const UTXOPtr &utxo) const;
 
 		private:
-			BigInt _balance, _balanceVote, _balanceDeposit, _balanceLocked;
-			UTXOArray _utxos, _utxosVote, _utxosCoinbase, _utxosDeposit, _utxosLocked;
+			Int128 _balance, _balanceVote, _balanceDeposit, _balanceLocked;
+			UTXOSet _utxos;
 
 			AssetPtr _asset;
 
@@ -0,0 +1,173 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "UTXOSet.h"
+
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		UTXOSet::UTXOSet() {
+			Clear();
+		}
+
+		UTXOSet::UTXOSet(const UTXOSet &set) {
+			this->operator=(set);
+		}
+
+		UTXOSet &UTXOSet::operator=(const UTXOSet &set) {
+			if (this == &set)
+				return *this;
+
+			Clear();
+			for (EntryList::const_iterator it = set._entries.cbegin(); it != set._entries.cend(); ++it)
+				Add(it->utxo, it->category);
+
+			return *this;
+		}
+
+		bool UTXOSet::Add(const UTXOPtr &utxo, Category category) {
+			UTXOKey key(utxo->Hash(), utxo->Index());
+			if (_index.find(key) != _index.end())
+				return false;
+
+			Entry entry;
+			entry.utxo = utxo;
+			entry.category = category;
+			entry.height = utxo->BlockHeight();
+			entry.seq = _seq++;
+			EntryList::iterator it = _entries.insert(_entries.end(), entry);
+			_index[key] = it;
+			Link(it);
+
+			return true;
+		}
+
+		UTXOPtr UTXOSet::Get(const uint256 &hash, uint16_t n) const {
+			Category category;
+			return Get(hash, n, category);
+		}
+
+		UTXOPtr UTXOSet::Get(const uint256 &hash, uint16_t n, Category &category) const {
+			EntryIndex::const_iterator it = _index.find(UTXOKey(hash, n));
+			if (it == _index.end())
+				return nullptr;
+
+			category = it->second->category;
+			return it->second->utxo;
+		}
+
+		bool UTXOSet::Contains(const uint256 &hash, uint16_t n) const {
+			return _index.find(UTXOKey(hash, n)) != _index.end();
+		}
+
+		UTXOPtr UTXOSet::Remove(const uint256 &hash, uint16_t n, Category &category) {
+			EntryIndex::iterator it = _index.find(UTXOKey(hash, n));
+			if (it == _index.end())
+				return nullptr;
+
+			UTXOPtr utxo = it->second->utxo;
+			category = it->second->category;
+			Unlink(it->second);
+			_entries.erase(it->second);
+			_index.erase(it);
+
+			return utxo;
+		}
+
+		bool UTXOSet::SetCategory(const uint256 &hash, uint16_t n, Category category) {
+			EntryIndex::iterator it = _index.find(UTXOKey(hash, n));
+			if (it == _index.end())
+				return false;
+
+			Unlink(it->second);
+			it->second->category = category;
+			Link(it->second);
+
+			return true;
+		}
+
+		bool UTXOSet::UpdateHeight(const uint256 &hash, uint16_t n) {
+			EntryIndex::iterator it = _index.find(UTXOKey(hash, n));
+			if (it == _index.end())
+				return false;
+
+			Unlink(it->second);
+			it->second->height = it->second->utxo->BlockHeight();
+			Link(it->second);
+
+			return true;
+		}
+
+		UTXOArray UTXOSet::GetUTXOs(Category category, Order order) const {
+			UTXOArray result;
+			size_t size = _byAmount[category].size();
+			result.reserve(size);
+
+			if (order == AmountDescending) {
+				for (AmountIndex::const_iterator it = _byAmount[category].cbegin(); it != _byAmount[category].cend(); ++it)
+					result.push_back((*it)->utxo);
+			} else if (order == HeightAscending) {
+				for (HeightIndex::const_iterator it = _byHeight[category].cbegin(); it != _byHeight[category].cend(); ++it)
+					result.push_back((*it)->utxo);
+			} else {
+				for (EntryList::const_iterator it = _entries.cbegin(); it != _entries.cend() && result.size() < size; ++it) {
+					if (it->category == category)
+						result.push_back(it->utxo);
+				}
+			}
+
+			return result;
+		}
+
+		size_t UTXOSet::Size(Category category) const {
+			return _byAmount[category].size();
+		}
+
+		size_t UTXOSet::Size() const {
+			return _index.size();
+		}
+
+		void UTXOSet::Clear() {
+			_entries.clear();
+			_index.clear();
+			for (size_t i = 0; i < CategoryCount; ++i) {
+				_byAmount[i].clear();
+				_byHeight[i].clear();
+			}
+			_seq = 0;
+		}
+
+		void UTXOSet::Link(const EntryList::iterator &entry) {
+			_byAmount[entry->category].insert(entry);
+			_byHeight[entry->category].insert(entry);
+		}
+
+		void UTXOSet::Unlink(const EntryList::iterator &entry) {
+			_byAmount[entry->category].erase(entry);
+			_byHeight[entry->category].erase(entry);
+		}
+
+		bool UTXOSet::AmountDescendingCompare::operator()(const EntryList::iterator &a,
+														   const EntryList::iterator &b) const {
+			const Int128 &amountA = a->utxo->Output()->Amount();
+			const Int128 &amountB = b->utxo->Output()->Amount();
+
+			if (amountA != amountB)
+				return amountA > amountB;
+
+			return a->seq < b->seq;
+		}
+
+		bool UTXOSet::HeightAscendingCompare::operator()(const EntryList::iterator &a,
+														  const EntryList::iterator &b) const {
+			if (a->height != b->height)
+				return a->height < b->height;
+
+			return a->seq < b->seq;
+		}
+
+	}
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_UTXOSET_H__
+#define __ELASTOS_SDK_UTXOSET_H__
+
+#include "UTXO.h"
+
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		class UTXOKey {
+		public:
+			UTXOKey(const uint256 &hash, uint16_t n) : _hash(hash), _n(n) {}
+
+			bool operator==(const UTXOKey &k) const { return _n == k._n && _hash == k._hash; }
+
+			const uint256 &Hash() const { return _hash; }
+
+			uint16_t Index() const { return _n; }
+
+		private:
+			uint256 _hash;
+			uint16_t _n;
+		};
+
+		struct UTXOKeyHasher {
+			size_t operator()(const UTXOKey &k) const {
+				return uint256Hasher()(k.Hash()) ^ ((size_t)k.Index() * 0x9E3779B1);
+			}
+		};
+
+		typedef std::unordered_set<UTXOKey, UTXOKeyHasher> UTXOKeySet;
+
+		/*
+		 * UTXOs of one asset indexed by outpoint (tx hash, output index). Add, remove and lookup are O(1), the
+		 * category of an utxo is a tag on its entry. Iteration walks the utxos in the order they were added, or in
+		 * amount / block height order which is kept incrementally per category for coin selection.
+		 */
+		class UTXOSet {
+		public:
+			enum Category {
+				Normal,
+				Vote,
+				Coinbase,
+				Deposit,
+				Locked,
+				CategoryCount
+			};
+
+			enum Order {
+				Insertion,
+				AmountDescending,
+				HeightAscending
+			};
+
+		public:
+			UTXOSet();
+
+			UTXOSet(const UTXOSet &set);
+
+			UTXOSet &operator=(const UTXOSet &set);
+
+			// return false if the outpoint already exist
+			bool Add(const UTXOPtr &utxo, Category category);
+
+			UTXOPtr Get(const uint256 &hash, uint16_t n) const;
+
+			UTXOPtr Get(const uint256 &hash, uint16_t n, Category &category) const;
+
+			bool Contains(const uint256 &hash, uint16_t n) const;
+
+			// return the removed utxo, nullptr if not found
+			UTXOPtr Remove(const uint256 &hash, uint16_t n, Category &category);
+
+			bool SetCategory(const uint256 &hash, uint16_t n, Category category);
+
+			// the height order keeps the block height an utxo had when added, call this after changing it
+			bool UpdateHeight(const uint256 &hash, uint16_t n);
+
+			UTXOArray GetUTXOs(Category category, Order order = Insertion) const;
+
+			size_t Size(Category category) const;
+
+			size_t Size() const;
+
+			void Clear();
+
+		private:
+			struct Entry {
+				UTXOPtr utxo;
+				Category category;
+				uint32_t height; // utxo->BlockHeight() when linked, what _byHeight is ordered by
+				uint64_t seq;
+			};
+
+			typedef std::list<Entry> EntryList;
+			typedef std::unordered_map<UTXOKey, EntryList::iterator, UTXOKeyHasher> EntryIndex;
+
+			// ties are broken by insertion sequence, so equal amounts keep the order they were added
+			struct AmountDescendingCompare {
+				bool operator()(const EntryList::iterator &a, const EntryList::iterator &b) const;
+			};
+
+			struct HeightAscendingCompare {
+				bool operator()(const EntryList::iterator &a, const EntryList::iterator &b) const;
+			};
+
+			typedef std::set<EntryList::iterator, AmountDescendingCompare> AmountIndex;
+			typedef std::set<EntryList::iterator, HeightAscendingCompare> HeightIndex;
+
+			void Link(const EntryList::iterator &entry);
+
+			void Unlink(const EntryList::iterator &entry);
+
+			EntryList _entries;
+			EntryIndex _index;
+			AmountIndex _byAmount[CategoryCount];
+			HeightIndex _byHeight[CategoryCount];
+			uint64_t _seq;
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_UTXOSET_H__
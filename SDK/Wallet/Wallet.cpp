@@ -32,15 +32,48 @@ namespace Elastos {
 					   const std::vector<TransactionPtr> &txns,
 					   const UTXOArray &cbUTXOs,
 					   const SubAccountPtr &subAccount,
-					   const boost::shared_ptr<Wallet::Listener> &listener) :
+					   const boost::shared_ptr<Wallet::Listener> &listener,
+					   HistoryLoader *historyLoader) :
 				_walletID(walletID),
 				_blockHeight(lastBlockHeight),
 				_feePerKb(DEFAULT_FEE_PER_KB),
-				_subAccount(subAccount) {
+				_coinSelectionStrategy(CoinSelector::LargestFirst),
+				_subAccount(subAccount),
+				_historyLoader(historyLoader),
+				_historyCache(TX_HISTORY_CACHE_SIZE),
+				_historyHeight(0) {
 
 			_listener = boost::weak_ptr<Listener>(listener);
 
-			_subAccount->Init(txns, this);
+			std::vector<TransactionPtr> activeTxns;
+			UTXOKeySet unspent;
+			UTXOArray snapshotUTXOs;
+			uint32_t snapshotHeight = 0;
+			bool fromSnapshot = false;
+			if (_historyLoader) {
+				std::vector<uint168> programHashes = _historyLoader->loadUsedProgramHashes();
+				std::vector<Address> usedAddrs;
+				for (size_t i = 0; i < programHashes.size(); ++i)
+					usedAddrs.push_back(Address(programHashes[i]));
+				_subAccount->InitUsedAddrs(usedAddrs, this);
+
+				uint32_t recentHeight = lastBlockHeight > TX_RECENT_BLOCKS ? lastBlockHeight - TX_RECENT_BLOCKS : 0;
+				fromSnapshot = _historyLoader->loadSnapshot(snapshotUTXOs, snapshotHeight);
+				if (fromSnapshot) {
+					_historyHeight = std::min(recentHeight, snapshotHeight);
+					activeTxns = _historyLoader->loadTransactions(_historyHeight, unspent);
+					SPVLOG_DEBUG("{} load {} utxo of snapshot at {}, {} tx", _walletID, snapshotUTXOs.size(),
+								 snapshotHeight, activeTxns.size());
+				} else {
+					_historyHeight = recentHeight;
+					unspent = _historyLoader->loadUnspentOutputs(_subAccount);
+					activeTxns = _historyLoader->loadTransactions(_historyHeight, unspent);
+					SPVLOG_DEBUG("{} lazy load {} tx for {} utxo", _walletID, activeTxns.size(), unspent.size());
+				}
+			} else {
+				_subAccount->Init(txns, this);
+			}
+			const std::vector<TransactionPtr> &history = _historyLoader ? activeTxns : txns;
 
 			if (assetArray.empty()) {
 				InstallDefaultAsset();
@@ -48,52 +81,61 @@ namespace Elastos {
 				InstallAssets(assetArray);
 			}
 
-			if (!txns.empty() && !ContainsTx(txns[0])) { // verify _transactions match master pubKey
-				std::string hash = txns[0]->GetHash().GetHex();
+			for (UTXOArray::iterator o = snapshotUTXOs.begin(); o != snapshotUTXOs.end(); ++o) {
+				if (ContainsAsset((*o)->Output()->AssetID()))
+					_groupedAssets[(*o)->Output()->AssetID()]->AddUTXO(*o);
+			}
+
+			if (!history.empty() && !ContainsTx(history[0])) { // verify _transactions match master pubKey
+				std::string hash = history[0]->GetHash().GetHex();
 				ErrorChecker::ThrowLogicException(Error::WalletNotContainTx, "Wallet do not contain tx = " + hash);
 			}
 
 			bool needUpdate = false, movedToCoinbase = false;
 			InputArray spentInputs;
-			for (size_t i = 0; i < txns.size(); ++i) {
-				if (txns[i]->IsCoinBase()) {
+			for (size_t i = 0; i < history.size(); ++i) {
+				if (history[i]->IsCoinBase()) {
 					movedToCoinbase = true;
-					const OutputArray &outputs = txns[i]->GetOutputs();
+					const OutputArray &outputs = history[i]->GetOutputs();
 					for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
-						if (_subAccount->ContainsAddress((*o)->Addr())) {
-							UTXOPtr cb(new UTXO(txns[i]->GetHash(), (*o)->FixedIndex(), txns[i]->GetTimestamp(),
-												txns[i]->GetBlockHeight(), *o));
+						if (_subAccount->ContainsAddress((*o)->ProgramHash())) {
+							UTXOPtr cb(new UTXO(history[i]->GetHash(), (*o)->FixedIndex(), history[i]->GetTimestamp(),
+												history[i]->GetBlockHeight(), *o));
 							_coinBaseUTXOs.push_back(cb);
 							break;
 						}
 					}
-				} else if (ContainsTx(txns[i])) {
-					txns[i]->IsRegistered() = true;
-					if (StripTransaction(txns[i])) {
+				} else if (ContainsTx(history[i])) {
+					history[i]->IsRegistered() = true;
+					if (StripTransaction(history[i])) {
 						SPVLOG_DEBUG("{} lstrip tx: {}, h: {}, t: {}",
 									 _walletID,
-									 txns[i]->GetHash().GetHex(),
-									 txns[i]->GetBlockHeight(),
-									 txns[i]->GetTimestamp());
+									 history[i]->GetHash().GetHex(),
+									 history[i]->GetBlockHeight(),
+									 history[i]->GetTimestamp());
 						needUpdate = true;
 					}
 
-					if (/*!txns[i]->IsSigned() || */_allTx.Contains(txns[i]))
+					if (/*!history[i]->IsSigned() || */_allTx.Contains(history[i]))
 						continue;
 
-					_allTx.Insert(txns[i]);
-					InsertTx(txns[i]);
+					_allTx.Insert(history[i]);
+					InsertTx(history[i]);
+
+					if (history[i]->GetBlockHeight() != TX_UNCONFIRMED) {
+						// older ones are in the snapshot, replaying its own block again is harmless
+						if (fromSnapshot && history[i]->GetBlockHeight() < snapshotHeight)
+							continue;
 
-					if (txns[i]->GetBlockHeight() != TX_UNCONFIRMED) {
-						for (InputArray::iterator in = txns[i]->GetInputs().begin(); in != txns[i]->GetInputs().end(); ++in)
+						for (InputArray::iterator in = history[i]->GetInputs().begin(); in != history[i]->GetInputs().end(); ++in)
 							spentInputs.push_back(*in);
 
-						BalanceAfterUpdatedTx(txns[i]);
+						BalanceAfterUpdatedTx(history[i]);
 					} else {
-						for (InputArray::iterator in = txns[i]->GetInputs().begin(); in != txns[i]->GetInputs().end(); ++in)
-							_spendingOutputs.push_back(UTXOPtr(new UTXO(*in)));
+						for (InputArray::iterator in = history[i]->GetInputs().begin(); in != history[i]->GetInputs().end(); ++in)
+							_spendingOutputs.insert(UTXOKey((*in)->TxHash(), (*in)->Index()));
 						SPVLOG_DEBUG("{} tx[{}]: {}, h: {}", _walletID, i,
-									 txns[i]->GetHash().GetHex(), txns[i]->GetBlockHeight());
+									 history[i]->GetHash().GetHex(), history[i]->GetBlockHeight());
 					}
 				} else {
 					// contain tx not belongs to wallet, we have to remove it from database
@@ -119,6 +161,9 @@ namespace Elastos {
 				}
 			}
 
+			if (_historyLoader && !fromSnapshot)
+				RemoveSpentHistoryUTXO(unspent);
+
 			for (UTXOArray::iterator o = _coinBaseUTXOs.begin(); o != _coinBaseUTXOs.end(); ++o) {
 				if (!(*o)->Spent())
 					_groupedAssets[(*o)->Output()->AssetID()]->AddCoinBaseUTXO((*o));
@@ -134,7 +179,10 @@ namespace Elastos {
 				coinBaseUpdatedAll(_coinBaseUTXOs);
 			}
 
-			if (needUpdate) {
+			if (needUpdate && _historyLoader) {
+				// rewriting all would drop the history which is not loaded, the database keeps them unstriped
+				SPVLOG_DEBUG("{} contain not striped tx, fixed in memory only", _walletID);
+			} else if (needUpdate) {
 				SPVLOG_DEBUG("{} contain not striped tx, update all tx", _walletID);
 				txUpdatedAll(_transactions);
 			}
@@ -147,6 +195,14 @@ namespace Elastos {
 		void Wallet::InitListeningAddresses(const std::vector<std::string> &addrs) {
 			boost::mutex::scoped_lock scopedLock(lock);
 			_listeningAddrs = addrs;
+			_listeningAddrBook.Clear();
+			for (size_t i = 0; i < _listeningAddrs.size(); ++i)
+				_listeningAddrBook.Insert(Address(_listeningAddrs[i]));
+
+			if (_filterElements.Size() > 0) {
+				for (size_t i = 0; i < _listeningAddrs.size(); ++i)
+					_filterElements.Insert(Address(_listeningAddrs[i]).ProgramHash().bytes());
+			}
 		}
 
 		std::vector<UTXOPtr> Wallet::GetAllUTXO(const std::string &address) const {
@@ -161,6 +217,18 @@ namespace Elastos {
 			return result;
 		}
 
+		UTXOArray Wallet::GetSnapshotUTXOs() const {
+			boost::mutex::scoped_lock scopedLock(lock);
+			UTXOArray result;
+
+			for (GroupedAssetMap::iterator it = _groupedAssets.begin(); it != _groupedAssets.end(); ++it) {
+				UTXOArray utxos = it->second->GetNonCoinBaseUTXOs();
+				result.insert(result.end(), utxos.begin(), utxos.end());
+			}
+
+			return result;
+		}
+
 		nlohmann::json Wallet::GetBalanceInfo() {
 			boost::mutex::scoped_lock scopedLock(lock);
 			nlohmann::json info;
@@ -176,15 +244,15 @@ namespace Elastos {
 			return info;
 		}
 
-		BigInt Wallet::GetBalanceWithAddress(const uint256 &assetID, const std::string &addr,
+		Int128 Wallet::GetBalanceWithAddress(const uint256 &assetID, const std::string &addr,
 											 GroupedAsset::BalanceType type) const {
 			boost::mutex::scoped_lock scopedLock(lock);
 
-			BigInt balance = 0;
+			Int128 balance = 0;
 			std::vector<UTXOPtr> utxos = GetUTXO(assetID, addr);
 
 			for (size_t i = 0; i < utxos.size(); ++i) {
-				const TransactionPtr tx = _allTx.Get(utxos[i]->Hash());
+				const TransactionPtr tx = LookupTx(utxos[i]->Hash());
 				if (tx) {
 					OutputPtr o = tx->OutputOfIndex(utxos[i]->Index());
 					if (o && ((type == GroupedAsset::Default && o->GetType() == TransactionOutput::Type::Default) ||
@@ -197,7 +265,7 @@ namespace Elastos {
 			return balance;
 		}
 
-		BigInt Wallet::GetBalance(const uint256 &assetID, GroupedAsset::BalanceType type) const {
+		Int128 Wallet::GetBalance(const uint256 &assetID, GroupedAsset::BalanceType type) const {
 			ErrorChecker::CheckParam(!ContainsAsset(assetID), Error::InvalidAsset, "asset not found");
 
 			boost::mutex::scoped_lock scoped_lock(lock);
@@ -219,6 +287,16 @@ namespace Elastos {
 			return DEFAULT_FEE_PER_KB;
 		}
 
+		CoinSelector::Strategy Wallet::GetCoinSelectionStrategy() const {
+			boost::mutex::scoped_lock scoped_lock(lock);
+			return _coinSelectionStrategy;
+		}
+
+		void Wallet::SetCoinSelectionStrategy(CoinSelector::Strategy strategy) {
+			boost::mutex::scoped_lock scoped_lock(lock);
+			_coinSelectionStrategy = strategy;
+		}
+
 		TransactionPtr Wallet::Consolidate(const std::string &memo, const uint256 &assetID, bool userVotedUTXO) {
 			Lock();
 			bool containAsset = ContainsAsset(assetID);
@@ -272,7 +350,7 @@ namespace Elastos {
 		bool Wallet::RegisterTransaction(const TransactionPtr &tx) {
 			bool r = true, wasAdded = false;
 			UTXOPtr cb = nullptr;
-			std::map<uint256, BigInt> changedBalance;
+			std::map<uint256, Int128> changedBalance;
 
 			bool IsReceiveTx = IsReceiveTransaction(tx);
 			if (tx != nullptr && (IsReceiveTx || (!IsReceiveTx && tx->IsSigned()))) {
@@ -284,6 +362,7 @@ namespace Elastos {
 						//       (for now, replacements appear invalid until confirmation)
 						_allTx.Insert(tx);
 						InsertTx(tx);
+						AddBloomFilterOutputs(tx);
 						if (tx->GetBlockHeight() != TX_UNCONFIRMED)
 							changedBalance = BalanceAfterUpdatedTx(tx);
 						wasAdded = true;
@@ -295,6 +374,8 @@ namespace Elastos {
 					}
 				} else if (tx->IsCoinBase() && nullptr == CoinBaseForHashInternal(tx->GetHash())) {
 					cb = RegisterCoinBaseTx(tx);
+					if (cb)
+						AddBloomFilterOutputs(tx);
 				}
 				Unlock();
 			} else {
@@ -309,7 +390,7 @@ namespace Elastos {
 				coinBaseTxAdded(cb);
 			}
 
-			for (std::map<uint256, BigInt>::iterator it = changedBalance.begin(); it != changedBalance.end(); ++it)
+			for (std::map<uint256, Int128>::iterator it = changedBalance.begin(); it != changedBalance.end(); ++it)
 				balanceChanged(it->first, it->second);
 
 			return r;
@@ -321,8 +402,25 @@ namespace Elastos {
 
 			assert(txHash != 0);
 
+			// dependents of an old transaction may be stored only, bring them in before walking
+			std::vector<TransactionPtr> stored;
+			uint32_t txHeight = TX_UNCONFIRMED;
+			if (_historyLoader) {
+				Lock();
+				TransactionPtr loaded = _allTx.Get(txHash);
+				Unlock();
+
+				if (!loaded)
+					loaded = _historyLoader->loadTransaction(txHash);
+				if (loaded)
+					txHeight = loaded->GetBlockHeight();
+				stored = LoadStoredHistory(txHeight);
+			}
+
 			Lock();
+			HydrateHistory(stored, txHeight);
 			const TransactionPtr tx = _allTx.Get(txHash);
+			_historyCache.Remove(txHash);
 
 			if (tx) {
 				for (size_t i = _transactions.size(); i > 0; i--) { // find depedent _transactions
@@ -377,7 +475,7 @@ namespace Elastos {
 
 		void Wallet::UpdateTransactions(const std::vector<uint256> &txHashes, uint32_t blockHeight, time_t timestamp) {
 			std::vector<uint256> hashes, cbHashes, spentCoinBase;
-			std::map<uint256, BigInt> changedBalance;
+			std::map<uint256, Int128> changedBalance;
 			std::vector<RegisterAsset *> payloads;
 			UTXOPtr cb;
 			size_t i;
@@ -461,13 +559,13 @@ namespace Elastos {
 					assetRegistered(payloads[i]->GetAsset(), payloads[i]->GetAmount(), payloads[i]->GetController());
 			}
 
-			for (std::map<uint256, BigInt>::iterator it = changedBalance.begin(); it != changedBalance.end(); ++it)
+			for (std::map<uint256, Int128>::iterator it = changedBalance.begin(); it != changedBalance.end(); ++it)
 				balanceChanged(it->first, it->second);
 		}
 
 		TransactionPtr Wallet::TransactionForHash(const uint256 &txHash) {
 			boost::mutex::scoped_lock scopedLock(lock);
-			return _allTx.Get(txHash);
+			return LookupTx(txHash);
 		}
 
 		UTXOPtr Wallet::CoinBaseTxForHash(const uint256 &txHash) const {
@@ -477,7 +575,7 @@ namespace Elastos {
 
 		bool Wallet::TransactionIsValid(const TransactionPtr &tx) {
 			bool r = true;
-			if (tx == nullptr || !tx->IsSigned())
+			if (tx == nullptr || !_signatureVerifier.Verify(tx))
 				return false;
 
 			// TODO: XXX attempted double spends should cause conflicted tx to remain unverified until they're confirmed
@@ -569,19 +667,19 @@ namespace Elastos {
 		}
 #endif
 
-		BigInt Wallet::AmountSentByTx(const TransactionPtr &tx) {
-			BigInt amount(0);
+		Int128 Wallet::AmountSentByTx(const TransactionPtr &tx) {
+			Int128 amount(0);
 
 			boost::mutex::scoped_lock scopedLock(lock);
 			if (!tx)
 				return amount;
 
 			for (InputArray::iterator in = tx->GetInputs().begin(); in != tx->GetInputs().end(); ++in) {
-				TransactionPtr t = _allTx.Get((*in)->TxHash());
+				TransactionPtr t = LookupTx((*in)->TxHash());
 				UTXOPtr cb = nullptr;
 				if (t) {
 					OutputPtr o = t->OutputOfIndex((*in)->Index());
-					if (o && _subAccount->ContainsAddress(o->Addr())) {
+					if (o && _subAccount->ContainsAddress(o->ProgramHash())) {
 						amount += o->Amount();
 					}
 				} else if ((cb = CoinBaseForHashInternal((*in)->TxHash())) != nullptr && cb->Index() == (*in)->Index()) {
@@ -613,7 +711,7 @@ namespace Elastos {
 				std::vector<OutputPtr> newOutputs;
 				const std::vector<OutputPtr> &outputs = tx->GetOutputs();
 				for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
-					if (_subAccount->ContainsAddress((*o)->Addr()))
+					if (_subAccount->ContainsAddress((*o)->ProgramHash()))
 						newOutputs.push_back(*o);
 				}
 
@@ -629,6 +727,7 @@ namespace Elastos {
 		Address Wallet::GetReceiveAddress() const {
 			boost::mutex::scoped_lock scopedLock(lock);
 			std::vector<Address> addr = _subAccount->UnusedAddresses(1, 0);
+			AddBloomFilterAddresses(addr);
 			return addr[0];
 		}
 
@@ -699,10 +798,17 @@ namespace Elastos {
 			_subAccount->SignTransaction(tx, payPassword);
 		}
 
+		void Wallet::SignTransactions(const std::vector<TransactionPtr> &txns, const std::string &payPassword) {
+			_subAccount->SignTransactions(txns, payPassword);
+		}
+
 		std::vector<TransactionPtr> Wallet::TxUnconfirmedBefore(uint32_t blockHeight) {
+			std::vector<TransactionPtr> stored = LoadStoredHistory(blockHeight);
 			boost::mutex::scoped_lock scopedLock(lock);
 			std::vector<TransactionPtr> result;
 
+			HydrateHistory(stored, blockHeight);
+
 			for (size_t i = _transactions.size(); i > 0; --i) {
 				if (_transactions[i - 1]->GetBlockHeight() >= blockHeight) {
 					result.push_back(_transactions[i - 1]);
@@ -718,7 +824,11 @@ namespace Elastos {
 		void Wallet::SetTxUnconfirmedAfter(uint32_t blockHeight) {
 			size_t i, j, count;
 
+			// a reorg deeper than the recent blocks also unconfirms stored history
+			std::vector<TransactionPtr> stored = LoadStoredHistory(blockHeight + 1);
+
 			Lock();
+			HydrateHistory(stored, blockHeight + 1);
 			_blockHeight = blockHeight;
 			count = i = _transactions.size();
 			while (i > 0 && _transactions[i - 1]->GetBlockHeight() > blockHeight) i--;
@@ -745,10 +855,29 @@ namespace Elastos {
 
 		std::vector<Address> Wallet::UnusedAddresses(uint32_t gapLimit, bool internal) {
 			boost::mutex::scoped_lock scopedLock(lock);
-			return _subAccount->UnusedAddresses(gapLimit, internal);
+			std::vector<Address> addrs = _subAccount->UnusedAddresses(gapLimit, internal);
+			AddBloomFilterAddresses(addrs);
+			return addrs;
+		}
+
+		size_t Wallet::GetBloomFilterElements(std::vector<bytes_t> &elements, size_t start) {
+			boost::mutex::scoped_lock scopedLock(lock);
+			if (_filterElements.Size() == 0)
+				LoadBloomFilterElements();
+
+			return _filterElements.Get(elements, start);
+		}
+
+		void Wallet::ResetBloomFilterElements() {
+			boost::mutex::scoped_lock scopedLock(lock);
+			_filterElements.Clear();
+			LoadBloomFilterElements();
 		}
 
 		std::vector<TransactionPtr> Wallet::GetAllTransactions() const {
+			if (_historyLoader)
+				return _historyLoader->loadAllTransactions();
+
 			boost::mutex::scoped_lock scopedLock(lock);
 			return _transactions;
 		}
@@ -802,11 +931,8 @@ namespace Elastos {
 
 			const OutputArray &outputs = tx->GetOutputs();
 			for (OutputArray::const_iterator it = outputs.cbegin(); !r && it != outputs.cend(); ++it) {
-				if (_subAccount->ContainsAddress((*it)->Addr()))
-					r = true;
-
-				if (std::find(_listeningAddrs.begin(), _listeningAddrs.end(),
-							  (*it)->Addr().String()) != _listeningAddrs.end())
+				const uint168 &programHash = (*it)->ProgramHash();
+				if (_subAccount->ContainsAddress(programHash) || _listeningAddrBook.Contains(programHash))
 					r = true;
 			}
 
@@ -825,10 +951,10 @@ namespace Elastos {
 			UTXOPtr cb = nullptr;
 			OutputPtr output = nullptr;
 
-			const TransactionPtr tx = _allTx.Get(in->TxHash());
+			const TransactionPtr tx = LookupTx(in->TxHash());
 			if (tx) {
 				output = tx->OutputOfIndex(in->Index());
-				if (output && _subAccount->ContainsAddress(output->Addr())) {
+				if (output && _subAccount->ContainsAddress(output->ProgramHash())) {
 					r = true;
 				}
 			} else if ((cb = CoinBaseForHashInternal(in->TxHash()))) {
@@ -840,6 +966,66 @@ namespace Elastos {
 			return r;
 		}
 
+		TransactionPtr Wallet::LookupTx(const uint256 &txHash) const {
+			TransactionPtr tx = _allTx.Get(txHash);
+			if (tx || !_historyLoader)
+				return tx;
+
+			// misses are cached too, inputs of received transactions are mostly not ours
+			if (!_historyCache.Get(txHash, tx)) {
+				tx = _historyLoader->loadTransaction(txHash);
+				_historyCache.Put(txHash, tx);
+			}
+
+			return tx;
+		}
+
+		std::vector<TransactionPtr> Wallet::LoadStoredHistory(uint32_t blockHeight) const {
+			if (!_historyLoader)
+				return std::vector<TransactionPtr>();
+
+			{
+				boost::mutex::scoped_lock scopedLock(lock);
+				if (blockHeight >= _historyHeight)
+					return std::vector<TransactionPtr>();
+			}
+
+			return _historyLoader->loadTransactions(blockHeight, UTXOKeySet());
+		}
+
+		void Wallet::HydrateHistory(const std::vector<TransactionPtr> &stored, uint32_t blockHeight) {
+			if (stored.empty() || blockHeight >= _historyHeight)
+				return;
+
+			// these hold no utxo, their outputs and inputs are in the balance already
+			for (size_t i = 0; i < stored.size(); ++i) {
+				if (_allTx.Contains(stored[i]) || !ContainsTx(stored[i]))
+					continue;
+
+				stored[i]->IsRegistered() = true;
+				_allTx.Insert(stored[i]);
+				InsertTx(stored[i]);
+				_historyCache.Remove(stored[i]->GetHash());
+			}
+
+			_historyHeight = blockHeight;
+		}
+
+		void Wallet::RemoveSpentHistoryUTXO(const UTXOKeySet &unspent) {
+			for (size_t i = 0; i < _transactions.size(); ++i) {
+				const TransactionPtr &tx = _transactions[i];
+				if (tx->GetBlockHeight() == TX_UNCONFIRMED)
+					continue;
+
+				const OutputArray &outputs = tx->GetOutputs();
+				for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
+					if (unspent.find(UTXOKey(tx->GetHash(), (*o)->FixedIndex())) == unspent.end() &&
+						ContainsAsset((*o)->AssetID()))
+						_groupedAssets[(*o)->AssetID()]->RemoveSpentUTXO(tx->GetHash(), (*o)->FixedIndex());
+				}
+			}
+		}
+
 		UTXOPtr Wallet::CoinBaseForHashInternal(const uint256 &txHash) const {
 			for (size_t i = 0; i < _coinBaseUTXOs.size(); ++i) {
 				if (_coinBaseUTXOs[i]->Hash() == txHash) {
@@ -853,7 +1039,7 @@ namespace Elastos {
 		UTXOPtr Wallet::RegisterCoinBaseTx(const TransactionPtr &tx) {
 			const OutputArray &outputs = tx->GetOutputs();
 			for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
-				if (_subAccount->ContainsAddress((*o)->Addr())) {
+				if (_subAccount->ContainsAddress((*o)->ProgramHash())) {
 					UTXOPtr cb(new UTXO(tx->GetHash(), (*o)->FixedIndex(), tx->GetTimestamp(), tx->GetBlockHeight(), (*o)));
 					_coinBaseUTXOs.push_back(cb);
 					return cb;
@@ -929,9 +1115,9 @@ namespace Elastos {
 			return true;
 		}
 
-		std::map<uint256, BigInt> Wallet::BalanceAfterUpdatedTx(const TransactionPtr &tx) {
+		std::map<uint256, Int128> Wallet::BalanceAfterUpdatedTx(const TransactionPtr &tx) {
 			GroupedAssetMap::iterator it;
-			std::map<uint256, BigInt> changedBalance;
+			std::map<uint256, Int128> changedBalance;
 			if (tx->GetBlockHeight() != TX_UNCONFIRMED) {
 				for (it = _groupedAssets.begin(); it != _groupedAssets.end(); ++it) {
 					if (it->second->RemoveSpentUTXO(tx->GetInputs())) {
@@ -942,7 +1128,7 @@ namespace Elastos {
 
 				const OutputArray &outputs = tx->GetOutputs();
 				for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
-					if (_subAccount->ContainsAddress((*o)->Addr())) {
+					if (_subAccount->ContainsAddress((*o)->ProgramHash())) {
 						_subAccount->AddUsedAddrs((*o)->Addr());
 						const uint256 &asset = (*o)->AssetID();
 						if (ContainsAsset(asset)) {
@@ -956,7 +1142,7 @@ namespace Elastos {
 			} else {
 				const OutputArray &outputs = tx->GetOutputs();
 				for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
-					if (_subAccount->ContainsAddress((*o)->Addr())) {
+					if (_subAccount->ContainsAddress((*o)->ProgramHash())) {
 						_subAccount->AddUsedAddrs((*o)->Addr());
 						if (ContainsAsset((*o)->AssetID()) &&
 							_groupedAssets[(*o)->AssetID()]->RemoveSpentUTXO(tx->GetHash(), (*o)->FixedIndex())) {
@@ -967,20 +1153,20 @@ namespace Elastos {
 
 				const InputArray &inputs = tx->GetInputs();
 				for (InputArray::const_iterator in = inputs.cbegin(); in != inputs.cend(); ++in) {
-					const TransactionPtr txInput = _allTx.Get((*in)->TxHash());
+					const TransactionPtr txInput = LookupTx((*in)->TxHash());
 					UTXOPtr cb;
 					if (txInput && txInput->GetBlockHeight() != TX_UNCONFIRMED) {
 						OutputPtr o = txInput->OutputOfIndex((*in)->Index());
 						if (o) {
-							_spendingOutputs.push_back(UTXOPtr(new UTXO(*in)));
-							if (_subAccount->ContainsAddress(o->Addr()) && ContainsAsset(o->AssetID())) {
+							_spendingOutputs.insert(UTXOKey((*in)->TxHash(), (*in)->Index()));
+							if (_subAccount->ContainsAddress(o->ProgramHash()) && ContainsAsset(o->AssetID())) {
 								UTXOPtr utxo(new UTXO(txInput->GetHash(), o->FixedIndex(), txInput->GetTimestamp(), txInput->GetBlockHeight(), o));
 								if (_groupedAssets[o->AssetID()]->AddUTXO(utxo))
 									changedBalance[o->AssetID()] = _groupedAssets[o->AssetID()]->GetBalance();
 							}
 						}
 					} else if ((cb = CoinBaseForHashInternal((*in)->TxHash())) != nullptr && cb->Index() == (*in)->Index()) {
-						_spendingOutputs.push_back(UTXOPtr(new UTXO(*in)));
+						_spendingOutputs.insert(UTXOKey((*in)->TxHash(), (*in)->Index()));
 						// TODO BUG update spent status to database
 						cb->SetSpent(false);
 						if (ContainsAsset(cb->Output()->AssetID())) {
@@ -1002,19 +1188,81 @@ namespace Elastos {
 			}
 		}
 
-		void Wallet::RemoveSpendingUTXO(const InputArray &inputs) {
-			for (InputArray::const_iterator input = inputs.cbegin(); input != inputs.cend(); ++input) {
-				for (UTXOArray::iterator o = _spendingOutputs.begin(); o != _spendingOutputs.end(); ++o) {
-					if ((*o)->Equal(*input)) {
-						_spendingOutputs.erase(o);
-						break;
+		void Wallet::LoadBloomFilterElements() {
+			std::vector<Address> addrs;
+			// owner, owner deposit and CR owner deposit addresses
+			addrs.push_back(Address(PrefixStandard, *_subAccount->OwnerPubKey()));
+			addrs.push_back(Address(PrefixDeposit, *_subAccount->OwnerPubKey()));
+			addrs.push_back(Address(PrefixStandard, _subAccount->DIDPubKey()));
+			for (size_t i = 0; i < addrs.size(); ++i)
+				InsertBloomFilterAddress(addrs[i]);
+
+			// addresses to watch for tx receiving money to the wallet
+			_subAccount->GetAllAddresses(boost::bind(&Wallet::InsertBloomFilterAddress, this, _1), 0, size_t(-1), true);
+
+			for (size_t i = 0; i < _listeningAddrs.size(); ++i)
+				_filterElements.Insert(Address(_listeningAddrs[i]).ProgramHash().bytes());
+
+			// UTXOs to watch for tx sending money from the wallet
+			for (GroupedAssetMap::iterator it = _groupedAssets.begin(); it != _groupedAssets.end(); ++it) {
+				UTXOArray utxos = it->second->GetUTXOs("");
+				for (size_t i = 0; i < utxos.size(); ++i) {
+					bytes_t o = utxos[i]->Hash().bytes();
+					o.append(utxos[i]->Index());
+					_filterElements.Insert(o);
+				}
+			}
+
+			// also TXOs spent within the last 100 blocks
+			uint32_t blockHeight = (_blockHeight > 100) ? _blockHeight - 100 : 0;
+			for (size_t i = _transactions.size(); i > 0 && _transactions[i - 1]->GetBlockHeight() >= blockHeight; --i) {
+				const InputArray &inputs = _transactions[i - 1]->GetInputs();
+				for (InputArray::const_iterator in = inputs.cbegin(); in != inputs.cend(); ++in) {
+					TransactionPtr tx = LookupTx((*in)->TxHash());
+					OutputPtr output = tx ? tx->OutputOfIndex((*in)->Index()) : nullptr;
+					if (output && _subAccount->ContainsAddress(output->ProgramHash())) {
+						bytes_t o = (*in)->TxHash().bytes();
+						o.append((*in)->Index());
+						_filterElements.Insert(o);
 					}
 				}
 			}
 		}
 
+		void Wallet::AddBloomFilterAddresses(const std::vector<Address> &addrs) const {
+			if (_filterElements.Size() == 0)
+				return; // the whole chain goes in when the elements are loaded
+
+			for (size_t i = 0; i < addrs.size(); ++i)
+				InsertBloomFilterAddress(addrs[i]);
+		}
+
+		void Wallet::InsertBloomFilterAddress(const Address &address) const {
+			if (address.Valid())
+				_filterElements.Insert(address.ProgramHash().bytes());
+		}
+
+		void Wallet::AddBloomFilterOutputs(const TransactionPtr &tx) {
+			if (_filterElements.Size() == 0)
+				return;
+
+			const OutputArray &outputs = tx->GetOutputs();
+			for (OutputArray::const_iterator o = outputs.cbegin(); o != outputs.cend(); ++o) {
+				if (_subAccount->ContainsAddress((*o)->ProgramHash())) {
+					bytes_t outpoint = tx->GetHash().bytes();
+					outpoint.append((*o)->FixedIndex());
+					_filterElements.Insert(outpoint);
+				}
+			}
+		}
+
+		void Wallet::RemoveSpendingUTXO(const InputArray &inputs) {
+			for (InputArray::const_iterator input = inputs.cbegin(); input != inputs.cend(); ++input)
+				_spendingOutputs.erase(UTXOKey((*input)->TxHash(), (*input)->Index()));
+		}
+
 		void Wallet::UpdateLockedBalance() {
-			std::map<uint256, BigInt> changedBalance;
+			std::map<uint256, Int128> changedBalance;
 
 			lock.lock();
 			for (GroupedAssetMap::iterator it = _groupedAssets.begin(); it != _groupedAssets.end(); ++it) {
@@ -1024,7 +1272,7 @@ namespace Elastos {
 			}
 			lock.unlock();
 
-			for (std::map<uint256, BigInt>::iterator it = changedBalance.begin(); it != changedBalance.end(); ++it)
+			for (std::map<uint256, Int128>::iterator it = changedBalance.begin(); it != changedBalance.end(); ++it)
 				balanceChanged(it->first, it->second);
 		}
 
@@ -1045,13 +1293,7 @@ namespace Elastos {
 		}
 
 		bool Wallet::IsUTXOSpending(const UTXOPtr &utxo) const {
-			for (size_t i = 0; i < _spendingOutputs.size(); ++i) {
-				if (*utxo == *_spendingOutputs[i]) {
-					return true;
-				}
-			}
-
-			return false;
+			return _spendingOutputs.find(UTXOKey(utxo->Hash(), utxo->Index())) != _spendingOutputs.end();
 		}
 
 		void Wallet::GetSpentCoinbase(const InputArray &inputs, std::vector<uint256> &coinbase) const {
@@ -1060,7 +1302,7 @@ namespace Elastos {
 			}
 		}
 
-		void Wallet::balanceChanged(const uint256 &asset, const BigInt &balance) {
+		void Wallet::balanceChanged(const uint256 &asset, const Int128 &balance) {
 			if (!_listener.expired()) {
 				_listener.lock()->balanceChanged(asset, balance);
 			}
@@ -7,8 +7,12 @@
 
 #include <SDK/Common/Lockable.h>
 #include <SDK/Common/ElementSet.h>
+#include <SDK/Common/LruCache.h>
 #include <SDK/Account/SubAccount.h>
 #include <SDK/Wallet/GroupedAsset.h>
+#include <SDK/Wallet/CoinSelector.h>
+#include <SDK/Wallet/FilterElementSet.h>
+#include <SDK/Plugin/Transaction/SignatureVerifier.h>
 
 #include <boost/weak_ptr.hpp>
 #include <boost/function.hpp>
@@ -28,6 +32,8 @@
 #define MAX_FEE_PER_KB     ((TX_FEE_PER_KB*1000100 + 190)/191) // slightly higher than a 10,000bit fee on a 191byte tx
 #define TX_MAX_LOCK_HEIGHT   500000000   // a lockTime below this value is a block height, otherwise a timestamp
 #define TX_MIN_OUTPUT_AMOUNT (TX_FEE_PER_KB*3*(TX_OUTPUT_SIZE + TX_INPUT_SIZE)/1000) //no txout can be below this amount
+#define TX_RECENT_BLOCKS     720         // a lazy wallet keeps the transactions of this many last blocks in memory
+#define TX_HISTORY_CACHE_SIZE 1000       // older transactions a lazy wallet keeps after reading them on demand
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -51,7 +57,7 @@ namespace Elastos {
 		public:
 			class Listener {
 			public:
-				virtual void balanceChanged(const uint256 &asset, const BigInt &balance) = 0;
+				virtual void balanceChanged(const uint256 &asset, const Int128 &balance) = 0;
 
 				virtual void onCoinBaseTxAdded(const UTXOPtr &utxo) = 0;
 
@@ -75,6 +81,35 @@ namespace Elastos {
 				virtual void onAssetRegistered(const AssetPtr &asset, uint64_t amount, const uint168 &controller) = 0;
 			};
 
+			/*
+			 * Stored history of a lazy wallet. It loads the transactions holding its unspent outputs, unconfirmed
+			 * ones and those of the last TX_RECENT_BLOCKS blocks, others are read when asked for.
+			 */
+			class HistoryLoader {
+			public:
+				virtual ~HistoryLoader() {}
+
+				// program hashes of every stored output
+				virtual std::vector<uint168> loadUsedProgramHashes() = 0;
+
+				// outputs of subAccount which no confirmed stored transaction spends
+				virtual UTXOKeySet loadUnspentOutputs(const SubAccountPtr &subAccount) = 0;
+
+				// those at blockHeight or higher, unconfirmed ones, and those with an output in unspent, oldest first
+				virtual std::vector<TransactionPtr> loadTransactions(uint32_t blockHeight,
+																	 const UTXOKeySet &unspent) = 0;
+
+				virtual std::vector<TransactionPtr> loadAllTransactions() = 0;
+
+				virtual TransactionPtr loadTransaction(const uint256 &hash) = 0;
+
+				/*
+				 * Utxos saved by GetSnapshotUTXOs and the block height they are valid for. False if there is none,
+				 * or the stored history or chain below that block changed since.
+				 */
+				virtual bool loadSnapshot(UTXOArray &utxos, uint32_t &blockHeight) = 0;
+			};
+
 		public:
 
 			Wallet(uint32_t lastBlockHeight,
@@ -83,7 +118,8 @@ namespace Elastos {
 				   const std::vector<TransactionPtr> &txns,
 				   const std::vector<UTXOPtr> &utxos,
 				   const SubAccountPtr &subAccount,
-				   const boost::shared_ptr<Wallet::Listener> &listener);
+				   const boost::shared_ptr<Wallet::Listener> &listener,
+				   HistoryLoader *historyLoader = nullptr);
 
 			virtual ~Wallet();
 
@@ -97,7 +133,7 @@ namespace Elastos {
 
 			nlohmann::json GetBalanceInfo();
 
-			BigInt GetBalanceWithAddress(const uint256 &assetID, const std::string &addr, GroupedAsset::BalanceType type) const;
+			Int128 GetBalanceWithAddress(const uint256 &assetID, const std::string &addr, GroupedAsset::BalanceType type) const;
 
 			// returns the first unused external address
 			Address GetReceiveAddress() const;
@@ -119,7 +155,7 @@ namespace Elastos {
 			// true if the address was previously generated by BRWalletUnusedAddrs() (even if it's now used)
 			bool ContainsAddress(const Address &address);
 
-			BigInt GetBalance(const uint256 &assetID, GroupedAsset::BalanceType type) const;
+			Int128 GetBalance(const uint256 &assetID, GroupedAsset::BalanceType type) const;
 
 			uint64_t GetFeePerKb() const;
 
@@ -127,6 +163,11 @@ namespace Elastos {
 
 			uint64_t GetDefaultFeePerKb();
 
+			CoinSelector::Strategy GetCoinSelectionStrategy() const;
+
+			// internal to the SDK, ISubWallet does not expose it, so wallets of the public API use LargestFirst
+			void SetCoinSelectionStrategy(CoinSelector::Strategy strategy);
+
 			TransactionPtr Consolidate(const std::string &memo, const uint256 &asset, bool useVoteUTXO);
 
 			TransactionPtr CreateTransaction(const Address &fromAddress, const std::vector<OutputPtr> &outputs,
@@ -157,7 +198,7 @@ namespace Elastos {
 			bool TransactionIsVerified(const TransactionPtr &transaction);
 #endif
 
-			BigInt AmountSentByTx(const TransactionPtr &tx);
+			Int128 AmountSentByTx(const TransactionPtr &tx);
 
 			bool IsReceiveTransaction(const TransactionPtr &tx) const;
 
@@ -165,10 +206,15 @@ namespace Elastos {
 
 			void SignTransaction(const TransactionPtr &tx, const std::string &payPassword);
 
+			void SignTransactions(const std::vector<TransactionPtr> &txns, const std::string &payPassword);
+
 			void UpdateLockedBalance();
 
 			std::vector<UTXOPtr> GetAllUTXO(const std::string &address) const;
 
+			// confirmed utxos except coinbase ones, which a lazy wallet can start from instead of the history
+			UTXOArray GetSnapshotUTXOs() const;
+
 			std::vector<TransactionPtr> TxUnconfirmedBefore(uint32_t blockHeight);
 
 			void SetTxUnconfirmedAfter(uint32_t blockHeight);
@@ -177,6 +223,15 @@ namespace Elastos {
 
 			std::vector<Address> UnusedAddresses(uint32_t gapLimit, bool internal);
 
+			/*
+			 * Data the bloom filter has to match from start on, returns the total count. Addresses and outputs the
+			 * wallet gets are appended as they come, a filter built from the first start elements only needs the rest.
+			 */
+			size_t GetBloomFilterElements(std::vector<bytes_t> &elements, size_t start);
+
+			// start the elements over from the wallet state, which leaves out the outputs spent since
+			void ResetBloomFilterElements();
+
 			AssetPtr GetAsset(const uint256 &assetID) const;
 
 			nlohmann::json GetAllAssets() const;
@@ -188,6 +243,23 @@ namespace Elastos {
 
 			bool ContainsTx(const TransactionPtr &tx) const;
 
+			/*
+			 * Transaction in memory, or read from the history loader. A lazy wallet reads a miss under its lock, one
+			 * query which the cache keeps for next time, misses included. What comes from the store is a copy only
+			 * for reading, confirmed history is not changed in memory. Walks which do change it bring it into
+			 * _transactions first, see LoadStoredHistory.
+			 */
+			TransactionPtr LookupTx(const uint256 &txHash) const;
+
+			// stored transactions from blockHeight on if some of them are not in memory, to call without the lock
+			std::vector<TransactionPtr> LoadStoredHistory(uint32_t blockHeight) const;
+
+			// with the lock held, put the stored transactions which are not in memory yet into _transactions
+			void HydrateHistory(const std::vector<TransactionPtr> &stored, uint32_t blockHeight);
+
+			// outputs of loaded transactions which were spent by history that is not loaded
+			void RemoveSpentHistoryUTXO(const UTXOKeySet &unspent);
+
 			bool ContainsInput(const InputPtr &in) const;
 
 			UTXOPtr CoinBaseForHashInternal(const uint256 &txHash) const;
@@ -204,7 +276,7 @@ namespace Elastos {
 
 			bool IsAssetUnique(const std::vector<OutputPtr> &outputs) const;
 
-			std::map<uint256, BigInt> BalanceAfterUpdatedTx(const TransactionPtr &tx);
+			std::map<uint256, Int128> BalanceAfterUpdatedTx(const TransactionPtr &tx);
 
 			void BalanceAfterRemoveTx(const TransactionPtr &tx);
 
@@ -218,8 +290,16 @@ namespace Elastos {
 
 			void GetSpentCoinbase(const InputArray &inputs, std::vector<uint256> &coinbase) const;
 
+			void LoadBloomFilterElements();
+
+			void AddBloomFilterAddresses(const std::vector<Address> &addrs) const;
+
+			void InsertBloomFilterAddress(const Address &address) const;
+
+			void AddBloomFilterOutputs(const TransactionPtr &tx);
+
 		protected:
-			void balanceChanged(const uint256 &asset, const BigInt &balance);
+			void balanceChanged(const uint256 &asset, const Int128 &balance);
 
 			void coinBaseTxAdded(const UTXOPtr &cb);
 
@@ -247,6 +327,7 @@ namespace Elastos {
 			std::string _walletID;
 
 			std::vector<std::string> _listeningAddrs;
+			AddressBook _listeningAddrBook; // _listeningAddrs by program hash, for ContainsTx
 
 			SubAccountPtr _subAccount;
 
@@ -257,10 +338,23 @@ namespace Elastos {
 			std::vector<TransactionPtr> _transactions;
 			TransactionSet _allTx;
 
-			UTXOArray _spendingOutputs;
+			UTXOKeySet _spendingOutputs;
 			UTXOArray _coinBaseUTXOs;
 
+			// empty until a filter is first asked for, addresses derived by const getters go in too
+			mutable FilterElementSet _filterElements;
+
+			// outlives the wallet, null if all history is in memory
+			HistoryLoader *_historyLoader;
+			mutable LruCache<uint256, TransactionPtr, uint256Hasher> _historyCache;
+			// a lazy wallet has every transaction from this block on in memory, older ones if they hold a utxo
+			uint32_t _historyHeight;
+
+			// relayed and published txs are checked more than once
+			SignatureVerifier _signatureVerifier;
+
 			uint64_t _feePerKb;
+			CoinSelector::Strategy _coinSelectionStrategy;
 
 			uint32_t _blockHeight;
 			boost::weak_ptr<Listener> _listener;
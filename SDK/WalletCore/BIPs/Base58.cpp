@@ -6,7 +6,7 @@
 
 #include "Base58.h"
 #include "SDK/Common/uchar_vector.h"
-#include "SDK/Common/hash.h"
+#include "SDK/Common/Sha256d.h"
 #include "SDK/Common/BigInt.h"
 
 namespace Elastos {
@@ -17,6 +17,13 @@ namespace Elastos {
 
 #define DEFAULT_BASE58_CHARS BITCOIN_BASE58_CHARS
 
+		// first 4 bytes of sha256d(data)
+		static uchar_vector Checksum(const uchar_vector &data) {
+			uint256 md;
+			Sha256d::Hash(md, data.data(), data.size());
+			return uchar_vector(md.begin(), md.begin() + 4);
+		}
+
 		unsigned int Base58::countLeading0s(const bytes_t& data) {
 			unsigned int i = 0;
 			for (; (i < data.size()) && (data[i] == 0); i++);
@@ -34,9 +41,7 @@ namespace Elastos {
 			uchar_vector data;
 			data.push_back(version);                                        // prepend version byte
 			data += payload;
-			uchar_vector checksum = sha256_2(data);
-			checksum.assign(checksum.begin(), checksum.begin() + 4);        // compute checksum
-			data += checksum;                                               // append checksum
+			data += Checksum(data);                                         // append checksum
 			BigInt bn(data);
 			std::string base58check = bn.getInBase(58, pchars);             // convert to base58
 			std::string leading0s(countLeading0s(data), pchars[0]);         // prepend leading 0's (1 in base58)
@@ -48,9 +53,7 @@ namespace Elastos {
 			uchar_vector data;
 			data += version;                                            // prepend version byte
 			data += payload;
-			uchar_vector checksum = sha256_2(data);
-			checksum.assign(checksum.begin(), checksum.begin() + 4);        // compute checksum
-			data += checksum;                                               // append checksum
+			data += Checksum(data);                                         // append checksum
 			BigInt bn(data);
 			std::string base58check = bn.getInBase(58, pchars);             // convert to base58
 			std::string leading0s(countLeading0s(data), pchars[0]);         // prepend leading 0's (1 in base58)
@@ -66,8 +69,7 @@ namespace Elastos {
 			bytes.assign(bytes.begin(), bytes.end() - 4);                           // split string into payload part and checksum part
 			uchar_vector leading0s(countLeading0s(base58check, pchars[0]), 0); // prepend leading 0's
 			bytes = leading0s + bytes;
-			uchar_vector hashBytes = sha256_2(bytes);
-			hashBytes.assign(hashBytes.begin(), hashBytes.begin() + 4);
+			uchar_vector hashBytes = Checksum(bytes);
 			if (hashBytes != checksum) return false;                                // verify checksum
 			version = bytes[0];
 			payload.assign(bytes.begin() + 1, bytes.end());
@@ -83,8 +85,7 @@ namespace Elastos {
 			bytes.assign(bytes.begin(), bytes.end() - 4);                           // split string into payload part and checksum part
 			uchar_vector leading0s(countLeading0s(base58check, pchars[0]), 0); // prepend leading 0's
 			bytes = leading0s + bytes;
-			uchar_vector hashBytes = sha256_2(bytes);
-			hashBytes.assign(hashBytes.begin(), hashBytes.begin() + 4);
+			uchar_vector hashBytes = Checksum(bytes);
 			if (hashBytes != checksum) return false;                                // verify checksum
 			payload.assign(bytes.begin(), bytes.end());
 			return true;
@@ -98,8 +99,7 @@ namespace Elastos {
 			bytes.assign(bytes.begin(), bytes.end() - 4);                           // split string into payload part and checksum part
 			uchar_vector leading0s(countLeading0s(base58check, pchars[0]), 0); // prepend leading 0's
 			bytes = leading0s + bytes;
-			uchar_vector hashBytes = sha256_2(bytes);
-			hashBytes.assign(hashBytes.begin(), hashBytes.begin() + 4);
+			uchar_vector hashBytes = Checksum(bytes);
 			return (hashBytes == checksum);
 		}
 
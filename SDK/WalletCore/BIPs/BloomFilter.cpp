@@ -5,10 +5,10 @@
 #include "BloomFilter.h"
 
 #include <SDK/Common/Log.h>
+#include <SDK/Common/ErrorChecker.h>
 
 #include <cfloat>
-
-#define BLOOM_MAX_HASH_FUNCS 50
+#include <cstring>
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -37,18 +37,27 @@ namespace Elastos {
 			//ostream.WriteByte(_flags);
 		}
 
-		//todo add max size check of BLOOM_MAX_FILTER_LENGTH
 		bool BloomFilter::Deserialize(const ByteStream &istream) {
 			if (!istream.ReadVarBytes(_filter)) {
 				Log::error("Bloom filter deserialize filter fail");
 				return false;
 			}
 
+			if (_filter.empty() || _filter.size() > BLOOM_MAX_FILTER_LENGTH) {
+				Log::error("Bloom filter deserialize filter length {} out of range", _filter.size());
+				return false;
+			}
+
 			if (!istream.ReadUint32(_hashFuncs)) {
 				Log::error("Bloom filter deserialize hash funcs fail");
 				return false;
 			}
 
+			if (_hashFuncs > BLOOM_MAX_HASH_FUNCS) {
+				Log::error("Bloom filter deserialize hash funcs {} exceed {}", _hashFuncs, BLOOM_MAX_HASH_FUNCS);
+				return false;
+			}
+
 			if (!istream.ReadUint32(_tweak)) {
 				Log::error("Bloom filter deserialize tweak fail");
 				return false;
@@ -73,85 +82,120 @@ namespace Elastos {
 
 		void BloomFilter::FromJson(const nlohmann::json &jsonData) {
 			_filter.setBase64(jsonData["filter"].get<std::string>());
+			ErrorChecker::CheckCondition(_filter.empty() || _filter.size() > BLOOM_MAX_FILTER_LENGTH,
+										 Error::InvalidArgument, "bloom filter length out of range");
 			_hashFuncs = jsonData["hashFuncs"].get<uint32_t>();
+			ErrorChecker::CheckCondition(_hashFuncs > BLOOM_MAX_HASH_FUNCS, Error::InvalidArgument,
+										 "bloom filter hash funcs exceed " + std::to_string(BLOOM_MAX_HASH_FUNCS));
 			_tweak = jsonData["tweak"].get<uint32_t>();
 		}
 
 		void BloomFilter::InsertData(const bytes_t &data) {
-			size_t i, idx;
+			InsertData(data.data(), data.size());
+		}
 
-			for (i = 0; i < _hashFuncs; i++) {
-				idx = CalculateHash(data, i);
-				_filter[idx >> 3] |= (1 << (7 & idx));
+		void BloomFilter::InsertData(const void *data, size_t size) {
+			uint32_t idx[BLOOM_MAX_HASH_FUNCS];
+			size_t n = CalculateHashes((const uint8_t *) data, size, idx);
+
+			for (size_t i = 0; i < n; i++)
+				_filter[idx[i] >> 3] |= (1 << (7 & idx[i]));
+
+			if (size > 0) _elemCount++;
+		}
+
+		void BloomFilter::InsertData(const std::vector<bytes_t> &elements) {
+			for (size_t i = 0; i < elements.size(); ++i)
+				InsertData(elements[i].data(), elements[i].size());
+		}
+
+		bool BloomFilter::ContainsData(const bytes_t &data) const {
+			return ContainsData(data.data(), data.size());
+		}
+
+		bool BloomFilter::ContainsData(const void *data, size_t size) const {
+			uint32_t idx[BLOOM_MAX_HASH_FUNCS];
+			size_t n = CalculateHashes((const uint8_t *) data, size, idx);
+
+			for (size_t i = 0; i < n; i++) {
+				if (!(_filter[idx[i] >> 3] & (1 << (7 & idx[i])))) return false;
+			}
+
+			return size > 0;
+		}
+
+		size_t BloomFilter::ContainsData(const std::vector<bytes_t> &elements, std::vector<bool> &contains) const {
+			size_t count = 0;
+
+			contains.resize(elements.size());
+			for (size_t i = 0; i < elements.size(); ++i) {
+				contains[i] = ContainsData(elements[i].data(), elements[i].size());
+				if (contains[i]) count++;
 			}
 
-			if (!data.empty()) _elemCount++;
+			return count;
 		}
 
-		uint32_t BloomFilter::MurmurHash3(uint32_t seed, const uchar_vector& data) {
-			// The following is MurmurHash3 (x86_32), see http://code.google.com/p/smhasher/source/browse/trunk/MurmurHash3.cpp
-			uint32_t h1 = seed;
+		size_t BloomFilter::CalculateHashes(const uint8_t *data, size_t size, uint32_t *idx) const {
+			// MurmurHash3 (x86_32), see http://code.google.com/p/smhasher/source/browse/trunk/MurmurHash3.cpp, run
+			// for all the hash functions side by side. They only differ by seed, so each block of data is read and
+			// mixed once, then folded into every running hash. The loops over hash functions have no dependency
+			// between iterations, which lets the compiler vectorize them.
 			const uint32_t c1 = 0xcc9e2d51;
 			const uint32_t c2 = 0x1b873593;
+			size_t n = _hashFuncs < BLOOM_MAX_HASH_FUNCS ? _hashFuncs : BLOOM_MAX_HASH_FUNCS;
+			uint32_t *h = idx; // the running hashes become the bit indexes in place
+			uint32_t k1;
+			size_t i;
 
-			const int nblocks = data.size() / 4;
+			for (i = 0; i < n; i++)
+				h[i] = (uint32_t) i * 0xfba4c795 + _tweak;
 
 			//----------
 			// body
-			const uint32_t * blocks = (const uint32_t *)(&data[0] + nblocks*4);
-
-			for(int i = -nblocks; i; i++)
-			{
-				uint32_t k1 = blocks[i];
+			size_t nblocks = size / 4;
+			for (size_t b = 0; b < nblocks; b++) {
+				memcpy(&k1, data + b * 4, sizeof(k1));
 
 				k1 *= c1;
-				k1 = ROTL32(k1,15);
+				k1 = ROTL32(k1, 15);
 				k1 *= c2;
 
-				h1 ^= k1;
-				h1 = ROTL32(h1,13);
-				h1 = h1*5+0xe6546b64;
+				for (i = 0; i < n; i++) {
+					h[i] ^= k1;
+					h[i] = ROTL32(h[i], 13);
+					h[i] = h[i] * 5 + 0xe6546b64;
+				}
 			}
 
 			//----------
 			// tail
-			const uint8_t * tail = (const uint8_t*)(&data[0] + nblocks*4);
-
-			uint32_t k1 = 0;
+			const uint8_t *tail = data + nblocks * 4;
 
-			switch(data.size() & 3)
-			{
+			k1 = 0;
+			switch (size & 3) {
 				case 3: k1 ^= tail[2] << 16;
 				case 2: k1 ^= tail[1] << 8;
 				case 1: k1 ^= tail[0];
-					k1 *= c1; k1 = ROTL32(k1,15); k1 *= c2; h1 ^= k1;
+					k1 *= c1; k1 = ROTL32(k1, 15); k1 *= c2;
+					for (i = 0; i < n; i++)
+						h[i] ^= k1;
 			};
 
 			//----------
 			// finalization
-			h1 ^= data.size();
-			h1 ^= h1 >> 16;
-			h1 *= 0x85ebca6b;
-			h1 ^= h1 >> 13;
-			h1 *= 0xc2b2ae35;
-			h1 ^= h1 >> 16;
-
-			return h1;
-		}
-
-		uint32_t BloomFilter::CalculateHash(const bytes_t &data, uint32_t hashNum) {
-			return (uint32_t)(MurmurHash3((uint32_t)(hashNum * 0xfba4c795 + _tweak), data) % (_filter.size() * 8));
-		}
-
-		bool BloomFilter::ContainsData(const bytes_t &data) {
-			size_t i, idx;
-
-			for (i = 0; i < _hashFuncs; i++) {
-				idx = CalculateHash(data, i);
-				if (!(_filter[idx >> 3] & (1 << (7 & idx)))) return false;
+			uint32_t bits = (uint32_t) (_filter.size() * 8);
+			for (i = 0; i < n; i++) {
+				h[i] ^= (uint32_t) size;
+				h[i] ^= h[i] >> 16;
+				h[i] *= 0x85ebca6b;
+				h[i] ^= h[i] >> 13;
+				h[i] *= 0xc2b2ae35;
+				h[i] ^= h[i] >> 16;
+				idx[i] = h[i] % bits;
 			}
 
-			return !data.empty();
+			return n;
 		}
 	}
 }
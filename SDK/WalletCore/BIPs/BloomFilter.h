@@ -15,6 +15,7 @@
 #define BLOOM_UPDATE_ALL                 1
 #define BLOOM_UPDATE_P2PUBKEY_ONLY       2
 #define BLOOM_MAX_FILTER_LENGTH          36000 // this allows for 10,000 elements with a <0.0001% false positive rate
+#define BLOOM_MAX_HASH_FUNCS             50
 
 namespace Elastos {
 	namespace ElaWallet {
@@ -35,16 +36,25 @@ namespace Elastos {
 
 			void InsertData(const bytes_t &data);
 
-			bool ContainsData(const bytes_t &data);
+			void InsertData(const void *data, size_t size);
+
+			// inserts every element in turn, same as calling InsertData on each
+			void InsertData(const std::vector<bytes_t> &elements);
+
+			bool ContainsData(const bytes_t &data) const;
+
+			bool ContainsData(const void *data, size_t size) const;
+
+			// contains[i] tells whether elements[i] matches, returns how many do
+			size_t ContainsData(const std::vector<bytes_t> &elements, std::vector<bool> &contains) const;
 
 		private:
-			inline uint32_t ROTL32(uint32_t x, int8_t r) {
+			static inline uint32_t ROTL32(uint32_t x, int8_t r) {
 				return (x << r) | (x >> (32 - r));
 			}
 
-			uint32_t MurmurHash3(uint32_t seed, const uchar_vector& data);
-
-			uint32_t CalculateHash(const bytes_t &data, uint32_t hashNum);
+			// bit index of data for every hash function, idx holds at least BLOOM_MAX_HASH_FUNCS entries
+			size_t CalculateHashes(const uint8_t *data, size_t size, uint32_t *idx) const;
 
 		private:
 			bytes_t _filter;
@@ -11,6 +11,8 @@
 
 #include "HDKeychain.h"
 #include "secp256k1_openssl.h"
+#include "Key.h"
+#include "P256.h"
 
 #include <SDK/Common/hash.h>
 #include <SDK/Common/BigInt.h>
@@ -232,6 +234,14 @@ namespace Elastos {
 				padded_key += child_key;
 				child._key = padded_key;
 				child.updatePubkey();
+			} else if (Key::GetBackend() == Key::BackendNative) {
+				P256::PublicKey K;
+				ErrorChecker::CheckLogic(!P256::ParsePubKey(K, &_pubkey[0], _pubkey.size()) ||
+										 !P256::TweakAddPubKey(K, &left32[0]), Error::Key, "invalid hd keychain");
+
+				child._pubkey.resize(33);
+				P256::SerializePubKey(&child._pubkey[0], K);
+				child._key = child._pubkey;
 			} else {
 				secp256k1_point K;
 				K.bytes(_pubkey);
@@ -307,7 +317,12 @@ namespace Elastos {
 		}
 
 		void HDKeychain::updatePubkey() {
-			if (isPrivate()) {
+			if (isPrivate() && Key::GetBackend() == Key::BackendNative) {
+				P256::PublicKey pubKey;
+				ErrorChecker::CheckLogic(!P256::DerivePubKey(pubKey, &_key[1]), Error::Key, "invalid prv key");
+				_pubkey.resize(33);
+				P256::SerializePubKey(&_pubkey[0], pubKey);
+			} else if (isPrivate()) {
 				secp256k1_key curvekey;
 				curvekey.setPrivKey(bytes_t(_key.begin() + 1, _key.end()));
 				_pubkey = curvekey.getPubKey();
@@ -7,8 +7,12 @@
 #include <SDK/Common/Log.h>
 #include <SDK/Common/ErrorChecker.h>
 #include <SDK/WalletCore/BIPs/secp256k1_openssl.h>
+#include <CMakeConfig.h>
+
+#include <boost/atomic.hpp>
 
 #include <cstring>
+#include <openssl/crypto.h>
 #include <openssl/ec.h>
 #include <openssl/bn.h>
 #include <openssl/obj_mac.h>
@@ -17,10 +21,29 @@
 namespace Elastos {
 	namespace ElaWallet {
 
-		Key::Key() {
+		// SPV_NATIVE_P256 picks the default at build time, SetBackend switches at run time
+#ifdef SPV_NATIVE_P256
+		static boost::atomic<int> _backend(P256::Supported() ? Key::BackendNative : Key::BackendOpenSSL);
+#else
+		static boost::atomic<int> _backend(Key::BackendOpenSSL);
+#endif
+
+		void Key::SetBackend(Backend backend) {
+			ErrorChecker::CheckLogic(backend == BackendNative && !P256::Supported(), Error::Key,
+									 "native backend not supported");
+			_backend = backend;
+		}
+
+		Key::Backend Key::GetBackend() {
+			return Backend(_backend.load());
 		}
 
-		Key::Key(const bytes_t &key) {
+		Key::Key() :
+			_nativeValid(false) {
+		}
+
+		Key::Key(const bytes_t &key) :
+			_nativeValid(false) {
 			if (key.size() == 32) {
 				_key.setPrivKey(key);
 			} else if (key.size() == 33) {
@@ -28,13 +51,16 @@ namespace Elastos {
 			} else {
 				ErrorChecker::ThrowLogicException(Error::Key, "invalid key");
 			}
+			UpdateNativePubKey();
 		}
 
-		Key::Key(const HDKeychain &keychain) {
+		Key::Key(const HDKeychain &keychain) :
+			_nativeValid(false) {
 			operator=(keychain);
 		}
 
-		Key::Key(const Key &key) {
+		Key::Key(const Key &key) :
+			_nativeValid(false) {
 			operator=(key);
 		}
 
@@ -49,16 +75,21 @@ namespace Elastos {
 			} else {
 				_key.setPubKey(keychain.pubkey());
 			}
+			UpdateNativePubKey();
 			return *this;
 		}
 
 		Key &Key::operator=(const Key &key) {
 			_key = key._key;
+			_nativePubKey = key._nativePubKey;
+			_nativeValid = key._nativeValid;
 			return *this;
 		}
 
 		bool Key::SetPubKey(const bytes_t &pubKey) {
-			return nullptr != _key.setPubKey(pubKey);
+			bool result = nullptr != _key.setPubKey(pubKey);
+			UpdateNativePubKey();
+			return result;
 		}
 
 		bytes_t Key::PubKey(bool compress) const {
@@ -70,7 +101,9 @@ namespace Elastos {
 		}
 
 		bool Key::SetPrvKey(const bytes_t &prv) {
-			return nullptr != _key.setPrivKey(prv);
+			bool result = nullptr != _key.setPrivKey(prv);
+			UpdateNativePubKey();
+			return result;
 		}
 
 
@@ -90,6 +123,20 @@ namespace Elastos {
 			ErrorChecker::CheckLogic(_key.getKey() == nullptr, Error::Sign, "invalid key for signing");
 			ErrorChecker::CheckLogic(!EC_KEY_can_sign(_key.getKey()), Error::Sign, "key can't use for signing");
 
+			if (GetBackend() == BackendNative) {
+				uint8_t prvKey[32];
+				signature.resize(64);
+				const BIGNUM *bn = EC_KEY_get0_private_key(_key.getKey());
+				success = bn != nullptr && BN_bn2binpad(bn, prvKey, sizeof(prvKey)) == sizeof(prvKey) &&
+						  P256::Sign(&signature[0], prvKey, digest.begin());
+				OPENSSL_cleanse(prvKey, sizeof(prvKey));
+
+				if (!success)
+					ErrorChecker::ThrowLogicException(Error::Sign, "Sign fail");
+
+				return signature;
+			}
+
 			ECDSA_SIG *sig = ECDSA_do_sign(digest.begin(), digest.size(), _key.getKey());
 			if (sig != nullptr) {
 				const BIGNUM *r = nullptr;
@@ -129,6 +176,9 @@ namespace Elastos {
 
 			ErrorChecker::CheckLogic(_key.getKey() == nullptr, Error::Sign, "invalid key for verify");
 
+			if (_nativeValid)
+				return signature.size() >= 64 && P256::Verify(_nativePubKey, digest.begin(), &signature[0]);
+
 			ECDSA_SIG *sig = ECDSA_SIG_new();
 			if (nullptr != sig) {
 				BIGNUM *r = BN_bin2bn(&signature[0], 32, nullptr);
@@ -143,5 +193,15 @@ namespace Elastos {
 			return result;
 		}
 
+		void Key::UpdateNativePubKey() {
+			_nativeValid = false;
+			if (GetBackend() != BackendNative || _key.getKey() == nullptr ||
+				EC_KEY_get0_public_key(_key.getKey()) == nullptr)
+				return;
+
+			bytes_t pubKey = _key.getPubKey(false);
+			_nativeValid = P256::ParsePubKey(_nativePubKey, &pubKey[0], pubKey.size());
+		}
+
 	}
 }
@@ -9,6 +9,7 @@
 #include <SDK/Common/typedefs.h>
 #include <SDK/WalletCore/BIPs/secp256k1_openssl.h>
 #include <SDK/WalletCore/BIPs/HDKeychain.h>
+#include <SDK/WalletCore/BIPs/P256.h>
 
 #include <boost/shared_ptr.hpp>
 #include <openssl/obj_mac.h>
@@ -18,6 +19,19 @@ namespace Elastos {
 	namespace ElaWallet {
 
 		class Key {
+		public:
+			// Arithmetic behind Sign, Verify and HDKeychain public key derivation. Keys keep their OpenSSL
+			// EC_KEY either way, the native backend (P256) is used for keys set while it is selected. OpenSSL is
+			// the default unless the SDK is built with SPV_NATIVE_P256.
+			enum Backend {
+				BackendOpenSSL,
+				BackendNative
+			};
+
+			static void SetBackend(Backend backend);
+
+			static Backend GetBackend();
+
 		public:
 			Key();
 
@@ -53,8 +67,13 @@ namespace Elastos {
 
 			bool Verify(const uint256 &digest, const bytes_t &signature) const;
 
+		private:
+			void UpdateNativePubKey();
+
 		private:
 			secp256k1_key _key;
+			P256::PublicKey _nativePubKey;
+			bool _nativeValid;
 		};
 
 		typedef boost::shared_ptr<Key> KeyPtr;
@@ -0,0 +1,1001 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "P256.h"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <cstring>
+
+#if defined(__SIZEOF_INT128__)
+#define P256_NATIVE
+#endif
+
+namespace Elastos {
+	namespace ElaWallet {
+
+#ifdef P256_NATIVE
+		namespace {
+
+			typedef unsigned __int128 u128;
+
+			// m and -m^-1 mod 2^64
+			struct Modulus {
+				uint64_t m[4];
+				uint64_t m0inv;
+			};
+
+			constexpr uint64_t InverseStep(uint64_t m, uint64_t x, int steps) {
+				return steps == 0 ? x : InverseStep(m, x * (2 - m * x), steps - 1);
+			}
+
+			// Newton's iteration, m * m = 1 mod 8 for odd m so 5 steps give 96 correct bits
+			constexpr uint64_t NegInverse(uint64_t m0) {
+				return 0 - InverseStep(m0, m0, 5);
+			}
+
+			// p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+			constexpr Modulus FieldP = {
+				{0xffffffffffffffffULL, 0x00000000ffffffffULL, 0x0000000000000000ULL, 0xffffffff00000001ULL},
+				NegInverse(0xffffffffffffffffULL)
+			};
+
+			// group order
+			constexpr Modulus OrderN = {
+				{0xf3b9cac2fc632551ULL, 0xbce6faada7179e84ULL, 0xffffffffffffffffULL, 0xffffffff00000000ULL},
+				NegInverse(0xf3b9cac2fc632551ULL)
+			};
+
+			const uint8_t CurveB[32] = {
+				0x5a, 0xc6, 0x35, 0xd8, 0xaa, 0x3a, 0x93, 0xe7, 0xb3, 0xeb, 0xbd, 0x55, 0x76, 0x98, 0x86, 0xbc,
+				0x65, 0x1d, 0x06, 0xb0, 0xcc, 0x53, 0xb0, 0xf6, 0x3b, 0xce, 0x3c, 0x3e, 0x27, 0xd2, 0x60, 0x4b
+			};
+
+			const uint8_t CurveGx[32] = {
+				0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47, 0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+				0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0, 0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96
+			};
+
+			const uint8_t CurveGy[32] = {
+				0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b, 0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+				0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce, 0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5
+			};
+
+			// signing: 64 windows of 4 bits, i * 16^j * G for i in [1, 15]
+			#define COMB_WINDOWS 64
+			#define COMB_POINTS 15
+			// verification: odd multiples G, 3G, ..., 127G for an 8 bit wNAF of the generator
+			#define GEN_WNAF_WIDTH 8
+			#define GEN_WNAF_POINTS (1 << (GEN_WNAF_WIDTH - 2))
+			#define KEY_WNAF_WIDTH 5
+			#define KEY_WNAF_POINTS (1 << (KEY_WNAF_WIDTH - 2))
+
+			struct Affine {
+				uint64_t x[4];
+				uint64_t y[4];
+			};
+
+			// Jacobian, x = X / Z^2, y = Y / Z^3, Z = 0 at infinity
+			struct Jacobian {
+				uint64_t x[4];
+				uint64_t y[4];
+				uint64_t z[4];
+			};
+
+			inline uint64_t Adc(uint64_t a, uint64_t b, uint64_t &carry) {
+				u128 t = (u128) a + b + carry;
+				carry = (uint64_t) (t >> 64);
+				return (uint64_t) t;
+			}
+
+			inline uint64_t Sbb(uint64_t a, uint64_t b, uint64_t &borrow) {
+				u128 t = (u128) a - b - borrow;
+				borrow = (uint64_t) (t >> 64) & 1;
+				return (uint64_t) t;
+			}
+
+			// all ones if x is zero, branch free
+			inline uint64_t ZeroMask(uint64_t x) {
+				return 0 - ((~x & (x - 1)) >> 63);
+			}
+
+			// r = mask ? a : b
+			inline void Select(uint64_t r[4], uint64_t mask, const uint64_t a[4], const uint64_t b[4]) {
+				r[0] = (a[0] & mask) | (b[0] & ~mask);
+				r[1] = (a[1] & mask) | (b[1] & ~mask);
+				r[2] = (a[2] & mask) | (b[2] & ~mask);
+				r[3] = (a[3] & mask) | (b[3] & ~mask);
+			}
+
+			inline bool IsZero(const uint64_t a[4]) {
+				return (a[0] | a[1] | a[2] | a[3]) == 0;
+			}
+
+			inline bool Equal(const uint64_t a[4], const uint64_t b[4]) {
+				return ((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) == 0;
+			}
+
+			// a < m, returns 1 if so
+			inline uint64_t Less(const uint64_t a[4], const uint64_t m[4]) {
+				uint64_t borrow = 0;
+				for (int i = 0; i < 4; ++i)
+					Sbb(a[i], m[i], borrow);
+				return borrow;
+			}
+
+			void FromBytes(uint64_t r[4], const uint8_t *bytes) {
+				for (int i = 0; i < 4; ++i) {
+					uint64_t limb = 0;
+					for (int j = 0; j < 8; ++j)
+						limb = (limb << 8) | bytes[(3 - i) * 8 + j];
+					r[i] = limb;
+				}
+			}
+
+			void ToBytes(uint8_t *bytes, const uint64_t a[4]) {
+				for (int i = 0; i < 4; ++i) {
+					for (int j = 0; j < 8; ++j)
+						bytes[(3 - i) * 8 + j] = (uint8_t) (a[i] >> (56 - 8 * j));
+				}
+			}
+
+			inline void ModAdd(uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const Modulus &M) {
+				uint64_t t[4], s[4], carry = 0, borrow = 0;
+				t[0] = Adc(a[0], b[0], carry);
+				t[1] = Adc(a[1], b[1], carry);
+				t[2] = Adc(a[2], b[2], carry);
+				t[3] = Adc(a[3], b[3], carry);
+				s[0] = Sbb(t[0], M.m[0], borrow);
+				s[1] = Sbb(t[1], M.m[1], borrow);
+				s[2] = Sbb(t[2], M.m[2], borrow);
+				s[3] = Sbb(t[3], M.m[3], borrow);
+				// a + b < m only if the sum didn't carry and subtracting m borrowed
+				Select(r, 0 - (~carry & borrow & 1), t, s);
+			}
+
+			inline void ModSub(uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const Modulus &M) {
+				uint64_t t[4], borrow = 0, carry = 0;
+				t[0] = Sbb(a[0], b[0], borrow);
+				t[1] = Sbb(a[1], b[1], borrow);
+				t[2] = Sbb(a[2], b[2], borrow);
+				t[3] = Sbb(a[3], b[3], borrow);
+				uint64_t mask = 0 - borrow;
+				r[0] = Adc(t[0], M.m[0] & mask, carry);
+				r[1] = Adc(t[1], M.m[1] & mask, carry);
+				r[2] = Adc(t[2], M.m[2] & mask, carry);
+				r[3] = Adc(t[3], M.m[3] & mask, carry);
+			}
+
+			// low word of a * b + c + carry, high word to carry
+			inline uint64_t MulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t &carry) {
+				u128 t = (u128) a * b + c + carry;
+				carry = (uint64_t) (t >> 64);
+				return (uint64_t) t;
+			}
+
+			// one CIOS round, t = (t + a * b + q * m) / 2^64, written out so the limbs stay in registers
+			inline void MontRound(uint64_t t[5], const uint64_t a[4], uint64_t b, const Modulus &M) {
+				uint64_t c = 0, t5 = 0;
+				t[0] = MulAdd(a[0], b, t[0], c);
+				t[1] = MulAdd(a[1], b, t[1], c);
+				t[2] = MulAdd(a[2], b, t[2], c);
+				t[3] = MulAdd(a[3], b, t[3], c);
+				t[4] = Adc(t[4], c, t5);
+
+				uint64_t q = t[0] * M.m0inv;
+				c = 0;
+				MulAdd(q, M.m[0], t[0], c);
+				t[0] = MulAdd(q, M.m[1], t[1], c);
+				t[1] = MulAdd(q, M.m[2], t[2], c);
+				t[2] = MulAdd(q, M.m[3], t[3], c);
+				uint64_t carry = 0;
+				t[3] = Adc(t[4], c, carry);
+				t[4] = t5 + carry;
+			}
+
+			// MontRound for p, -p^-1 = 1 mod 2^64 so q = t[0], and q p = q 2^256 - q 2^224 + q 2^192 + q 2^96 - q
+			// takes a single multiplication
+			inline void FieldRound(uint64_t t[5], const uint64_t a[4], uint64_t b) {
+				uint64_t c = 0, t5 = 0;
+				t[0] = MulAdd(a[0], b, t[0], c);
+				t[1] = MulAdd(a[1], b, t[1], c);
+				t[2] = MulAdd(a[2], b, t[2], c);
+				t[3] = MulAdd(a[3], b, t[3], c);
+				t[4] = Adc(t[4], c, t5);
+
+				// the low word cancels, carrying q into q (2^32 - 1) of the second
+				uint64_t q = t[0];
+				c = 0;
+				t[0] = Adc(t[1], q << 32, c);
+				t[1] = Adc(t[2], q >> 32, c);
+				t[2] = MulAdd(q, FieldP.m[3], t[3], c);
+				uint64_t carry = 0;
+				t[3] = Adc(t[4], c, carry);
+				t[4] = t5 + carry;
+			}
+
+			inline void Reduce(uint64_t r[4], const uint64_t t[5], const Modulus &M) {
+				// t < 2m
+				uint64_t s[4], borrow = 0;
+				s[0] = Sbb(t[0], M.m[0], borrow);
+				s[1] = Sbb(t[1], M.m[1], borrow);
+				s[2] = Sbb(t[2], M.m[2], borrow);
+				s[3] = Sbb(t[3], M.m[3], borrow);
+				Sbb(t[4], 0, borrow);
+				Select(r, 0 - borrow, t, s);
+			}
+
+			// r = a * b / 2^256 mod m, for b < m and any 256 bit a, so it also brings a below m
+			inline void MontMul(uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const Modulus &M) {
+				uint64_t t[5] = {0, 0, 0, 0, 0};
+
+				MontRound(t, a, b[0], M);
+				MontRound(t, a, b[1], M);
+				MontRound(t, a, b[2], M);
+				MontRound(t, a, b[3], M);
+				Reduce(r, t, M);
+			}
+
+			// MontMul for p
+			inline void FieldMul(uint64_t r[4], const uint64_t a[4], const uint64_t b[4]) {
+				uint64_t t[5] = {0, 0, 0, 0, 0};
+
+				FieldRound(t, a, b[0]);
+				FieldRound(t, a, b[1]);
+				FieldRound(t, a, b[2]);
+				FieldRound(t, a, b[3]);
+				Reduce(r, t, FieldP);
+			}
+
+			void Cleanse(void *p, size_t size) {
+				OPENSSL_cleanse(p, size);
+			}
+
+			// 4 bit fixed window, the exponent is public so indexing by its bits leaks nothing
+			void ModPow(uint64_t r[4], const uint64_t a[4], const uint64_t e[4], const uint64_t one[4],
+						const Modulus &M) {
+				uint64_t powers[16][4], t[4];
+
+				memcpy(powers[0], one, sizeof(powers[0]));
+				memcpy(powers[1], a, sizeof(powers[1]));
+				for (int i = 2; i < 16; ++i)
+					MontMul(powers[i], powers[i - 1], a, M);
+
+				memcpy(t, one, sizeof(t));
+				for (int i = 63; i >= 0; --i) {
+					MontMul(t, t, t, M);
+					MontMul(t, t, t, M);
+					MontMul(t, t, t, M);
+					MontMul(t, t, t, M);
+					uint64_t digit = (e[i / 16] >> (4 * (i % 16))) & 15;
+					if (digit != 0)
+						MontMul(t, t, powers[digit], M);
+				}
+				memcpy(r, t, sizeof(t));
+				Cleanse(powers, sizeof(powers));
+			}
+
+			struct Context {
+				uint64_t pOne[4], pRR[4], pInvExp[4], pSqrtExp[4];
+				uint64_t nOne[4], nRR[4], nInvExp[4];
+				uint64_t b[4];
+				Affine g;
+				Affine comb[COMB_WINDOWS][COMB_POINTS];
+				Affine genWnaf[GEN_WNAF_POINTS];
+
+				Context();
+			};
+
+			const Context &Ctx() {
+				static const Context *ctx = new Context();
+				return *ctx;
+			}
+
+			// field, Montgomery form
+
+			inline void FeMul(uint64_t r[4], const uint64_t a[4], const uint64_t b[4]) {
+				FieldMul(r, a, b);
+			}
+
+			inline void FeSqr(uint64_t r[4], const uint64_t a[4]) {
+				FieldMul(r, a, a);
+			}
+
+			inline void FeAdd(uint64_t r[4], const uint64_t a[4], const uint64_t b[4]) {
+				ModAdd(r, a, b, FieldP);
+			}
+
+			inline void FeSub(uint64_t r[4], const uint64_t a[4], const uint64_t b[4]) {
+				ModSub(r, a, b, FieldP);
+			}
+
+			inline void FeNeg(uint64_t r[4], const uint64_t a[4]) {
+				const uint64_t zero[4] = {0, 0, 0, 0};
+				ModSub(r, zero, a, FieldP);
+			}
+
+			// a^(p-2)
+			inline void FeInv(uint64_t r[4], const uint64_t a[4], const Context &ctx) {
+				ModPow(r, a, ctx.pInvExp, ctx.pOne, FieldP);
+			}
+
+			// point arithmetic, dbl-2001-b and add-2007-bl / madd-2007-bl of the Explicit-Formulas Database
+
+			void Double(Jacobian &r, const Jacobian &p) {
+				uint64_t delta[4], gamma[4], beta[4], alpha[4], t1[4], t2[4];
+
+				FeSqr(delta, p.z);
+				FeSqr(gamma, p.y);
+				FeMul(beta, p.x, gamma);
+				FeSub(t1, p.x, delta);
+				FeAdd(t2, p.x, delta);
+				FeMul(alpha, t1, t2);
+				FeAdd(t1, alpha, alpha);
+				FeAdd(alpha, t1, alpha);                // alpha = 3 (X - delta) (X + delta)
+
+				FeAdd(t1, p.y, p.z);
+				FeSqr(t1, t1);
+				FeSub(t1, t1, gamma);
+				FeSub(r.z, t1, delta);                  // Z3 = (Y + Z)^2 - gamma - delta
+
+				FeAdd(beta, beta, beta);
+				FeAdd(beta, beta, beta);                // 4 beta
+				FeSqr(t1, alpha);
+				FeAdd(t2, beta, beta);
+				FeSub(r.x, t1, t2);                     // X3 = alpha^2 - 8 beta
+
+				FeSub(t1, beta, r.x);
+				FeMul(t1, alpha, t1);
+				FeSqr(t2, gamma);
+				FeAdd(t2, t2, t2);
+				FeAdd(t2, t2, t2);
+				FeAdd(t2, t2, t2);
+				FeSub(r.y, t1, t2);                     // Y3 = alpha (4 beta - X3) - 8 gamma^2
+			}
+
+			// r = p + q for p != +-q, both finite; r may be p
+			void AddMixedUnchecked(Jacobian &r, const Jacobian &p, const Affine &q) {
+				uint64_t z1z1[4], u2[4], s2[4], h[4], hh[4], i[4], j[4], rr[4], v[4], t[4];
+
+				FeSqr(z1z1, p.z);
+				FeMul(u2, q.x, z1z1);
+				FeMul(s2, q.y, p.z);
+				FeMul(s2, s2, z1z1);
+				FeSub(h, u2, p.x);
+				FeSqr(hh, h);
+				FeAdd(i, hh, hh);
+				FeAdd(i, i, i);
+				FeMul(j, h, i);
+				FeSub(rr, s2, p.y);
+				FeAdd(rr, rr, rr);
+				FeMul(v, p.x, i);
+
+				FeAdd(t, p.z, h);
+				FeSqr(t, t);
+				FeSub(t, t, z1z1);
+				FeSub(r.z, t, hh);
+
+				FeMul(t, p.y, j);
+				FeAdd(t, t, t);                         // 2 Y1 J, Y1 read before Y3 is written
+
+				FeSqr(r.x, rr);
+				FeSub(r.x, r.x, j);
+				FeSub(r.x, r.x, v);
+				FeSub(r.x, r.x, v);
+
+				FeSub(v, v, r.x);
+				FeMul(v, rr, v);
+				FeSub(r.y, v, t);
+			}
+
+			void ToJacobian(Jacobian &r, const Affine &p, const Context &ctx) {
+				memcpy(r.x, p.x, sizeof(r.x));
+				memcpy(r.y, p.y, sizeof(r.y));
+				memcpy(r.z, ctx.pOne, sizeof(r.z));
+			}
+
+			// variable time, for verification and table building
+			void AddMixed(Jacobian &r, const Jacobian &p, const Affine &q, const Context &ctx) {
+				if (IsZero(p.z)) {
+					ToJacobian(r, q, ctx);
+					return;
+				}
+
+				uint64_t z1z1[4], u2[4], s2[4];
+				FeSqr(z1z1, p.z);
+				FeMul(u2, q.x, z1z1);
+				FeMul(s2, q.y, p.z);
+				FeMul(s2, s2, z1z1);
+				if (Equal(u2, p.x)) {
+					if (Equal(s2, p.y)) {
+						Double(r, p);
+					} else {
+						memset(&r, 0, sizeof(r));
+					}
+					return;
+				}
+
+				AddMixedUnchecked(r, p, q);
+			}
+
+			void Add(Jacobian &r, const Jacobian &p, const Jacobian &q) {
+				if (IsZero(p.z)) {
+					r = q;
+					return;
+				}
+				if (IsZero(q.z)) {
+					r = p;
+					return;
+				}
+
+				uint64_t z1z1[4], z2z2[4], u1[4], u2[4], s1[4], s2[4], h[4], i[4], j[4], rr[4], v[4], t[4];
+				FeSqr(z1z1, p.z);
+				FeSqr(z2z2, q.z);
+				FeMul(u1, p.x, z2z2);
+				FeMul(u2, q.x, z1z1);
+				FeMul(s1, p.y, q.z);
+				FeMul(s1, s1, z2z2);
+				FeMul(s2, q.y, p.z);
+				FeMul(s2, s2, z1z1);
+
+				if (Equal(u1, u2)) {
+					if (Equal(s1, s2)) {
+						Double(r, p);
+					} else {
+						memset(&r, 0, sizeof(r));
+					}
+					return;
+				}
+
+				FeSub(h, u2, u1);
+				FeAdd(i, h, h);
+				FeSqr(i, i);
+				FeMul(j, h, i);
+				FeSub(rr, s2, s1);
+				FeAdd(rr, rr, rr);
+				FeMul(v, u1, i);
+
+				FeAdd(t, p.z, q.z);
+				FeSqr(t, t);
+				FeSub(t, t, z1z1);
+				FeSub(t, t, z2z2);
+				FeMul(r.z, t, h);
+
+				FeSqr(r.x, rr);
+				FeSub(r.x, r.x, j);
+				FeSub(r.x, r.x, v);
+				FeSub(r.x, r.x, v);
+
+				FeMul(s1, s1, j);
+				FeAdd(s1, s1, s1);
+				FeSub(v, v, r.x);
+				FeMul(v, rr, v);
+				FeSub(r.y, v, s1);
+			}
+
+			void ToAffine(Affine &r, const Jacobian &p, const Context &ctx) {
+				uint64_t zinv[4], zinv2[4];
+				FeInv(zinv, p.z, ctx);
+				FeSqr(zinv2, zinv);
+				FeMul(r.x, p.x, zinv2);
+				FeMul(zinv2, zinv2, zinv);
+				FeMul(r.y, p.y, zinv2);
+			}
+
+			// one inversion for all of them, none at infinity
+			void ToAffineBatch(Affine *r, const Jacobian *p, size_t count, const Context &ctx) {
+				uint64_t (*prefix)[4] = new uint64_t[count][4];
+				uint64_t inv[4], zinv[4], zinv2[4];
+
+				memcpy(prefix[0], p[0].z, sizeof(prefix[0]));
+				for (size_t i = 1; i < count; ++i)
+					FeMul(prefix[i], prefix[i - 1], p[i].z);
+
+				FeInv(inv, prefix[count - 1], ctx);
+				for (size_t i = count; i-- > 0;) {
+					if (i > 0) {
+						FeMul(zinv, inv, prefix[i - 1]);
+						FeMul(inv, inv, p[i].z);
+					} else {
+						memcpy(zinv, inv, sizeof(zinv));
+					}
+					FeSqr(zinv2, zinv);
+					FeMul(r[i].x, p[i].x, zinv2);
+					FeMul(zinv2, zinv2, zinv);
+					FeMul(r[i].y, p[i].y, zinv2);
+				}
+
+				delete[] prefix;
+			}
+
+			Context::Context() {
+				const uint64_t one[4] = {1, 0, 0, 0};
+				const uint64_t two[4] = {2, 0, 0, 0};
+				uint64_t t[4], borrow = 0, carry = 0;
+
+				// 2^256 and 2^512 mod m by doubling, both moduli are above 2^255
+				memcpy(pOne, one, sizeof(pOne));
+				memcpy(nOne, one, sizeof(nOne));
+				for (int i = 0; i < 256; ++i) {
+					ModAdd(pOne, pOne, pOne, FieldP);
+					ModAdd(nOne, nOne, nOne, OrderN);
+				}
+				memcpy(pRR, pOne, sizeof(pRR));
+				memcpy(nRR, nOne, sizeof(nRR));
+				for (int i = 0; i < 256; ++i) {
+					ModAdd(pRR, pRR, pRR, FieldP);
+					ModAdd(nRR, nRR, nRR, OrderN);
+				}
+
+				for (int i = 0; i < 4; ++i)
+					pInvExp[i] = Sbb(FieldP.m[i], two[i], borrow);
+				borrow = 0;
+				for (int i = 0; i < 4; ++i)
+					nInvExp[i] = Sbb(OrderN.m[i], two[i], borrow);
+
+				// (p + 1) / 4, p = 3 mod 4
+				for (int i = 0; i < 4; ++i)
+					t[i] = Adc(FieldP.m[i], one[i], carry);
+				for (int i = 0; i < 4; ++i)
+					pSqrtExp[i] = (t[i] >> 2) | (i < 3 ? t[i + 1] << 62 : carry << 62);
+
+				FromBytes(t, CurveB);
+				FeMul(b, t, pRR);
+				FromBytes(t, CurveGx);
+				FeMul(g.x, t, pRR);
+				FromBytes(t, CurveGy);
+				FeMul(g.y, t, pRR);
+
+				Jacobian *points = new Jacobian[COMB_WINDOWS * COMB_POINTS];
+				Jacobian base;
+				ToJacobian(base, g, *this);
+				for (int w = 0; w < COMB_WINDOWS; ++w) {
+					Jacobian *row = &points[w * COMB_POINTS];
+					row[0] = base;
+					Double(row[1], base);
+					for (int i = 2; i < COMB_POINTS; ++i)
+						Add(row[i], row[i - 1], base);
+					Double(base, row[7]);                 // 16 * base
+				}
+				ToAffineBatch(&comb[0][0], points, COMB_WINDOWS * COMB_POINTS, *this);
+
+				Jacobian g2;
+				ToJacobian(base, g, *this);
+				Double(g2, base);
+				points[0] = base;
+				for (int i = 1; i < GEN_WNAF_POINTS; ++i)
+					Add(points[i], points[i - 1], g2);
+				ToAffineBatch(genWnaf, points, GEN_WNAF_POINTS, *this);
+
+				delete[] points;
+			}
+
+			// k * G for k in [0, n - 1], infinity (Z = 0) for 0. The windows are added from the low end up, so the running
+			// sum never equals the point added to it or its negation, and the addition needs no special cases but the start.
+			void MulBase(Jacobian &r, const uint64_t k[4], const Context &ctx) {
+				uint64_t infinity = ~(uint64_t) 0;
+				memset(&r, 0, sizeof(r));
+
+				for (int w = 0; w < COMB_WINDOWS; ++w) {
+					uint64_t digit = (k[w / 16] >> (4 * (w % 16))) & 15;
+
+					// every entry is read, the one wanted is kept by mask
+					Affine q;
+					memset(&q, 0, sizeof(q));
+					for (uint64_t i = 0; i < COMB_POINTS; ++i) {
+						uint64_t mask = ZeroMask(i + 1 - digit);
+						const Affine &entry = ctx.comb[w][i];
+						for (int l = 0; l < 4; ++l) {
+							q.x[l] |= entry.x[l] & mask;
+							q.y[l] |= entry.y[l] & mask;
+						}
+					}
+
+					Jacobian sum, start;
+					AddMixedUnchecked(sum, r, q);
+					ToJacobian(start, q, ctx);
+
+					// from infinity the sum is q, a zero digit keeps r
+					uint64_t zero = ZeroMask(digit);
+					Select(sum.x, infinity, start.x, sum.x);
+					Select(sum.y, infinity, start.y, sum.y);
+					Select(sum.z, infinity, start.z, sum.z);
+					Select(r.x, zero, r.x, sum.x);
+					Select(r.y, zero, r.y, sum.y);
+					Select(r.z, zero, r.z, sum.z);
+					infinity &= zero;
+				}
+			}
+
+			// width w non adjacent form, digits odd or zero, |digit| < 2^(w-1)
+			int Wnaf(int8_t wnaf[257], const uint64_t k[4], int w) {
+				uint64_t t[5] = {k[0], k[1], k[2], k[3], 0};
+				int length = 0;
+
+				memset(wnaf, 0, 257);
+				for (int i = 0; i < 257 && (t[0] | t[1] | t[2] | t[3] | t[4]) != 0; ++i) {
+					if (t[0] & 1) {
+						int digit = (int) (t[0] & ((1u << w) - 1));
+						if (digit >= (1 << (w - 1)))
+							digit -= (1 << w);
+						wnaf[i] = (int8_t) digit;
+
+						uint64_t c = 0;
+						if (digit > 0) {
+							t[0] = Sbb(t[0], (uint64_t) digit, c);
+							for (int l = 1; l < 5; ++l)
+								t[l] = Sbb(t[l], 0, c);
+						} else {
+							t[0] = Adc(t[0], (uint64_t) -digit, c);
+							for (int l = 1; l < 5; ++l)
+								t[l] = Adc(t[l], 0, c);
+						}
+					}
+					for (int l = 0; l < 4; ++l)
+						t[l] = (t[l] >> 1) | (t[l + 1] << 63);
+					t[4] >>= 1;
+					length = i + 1;
+				}
+
+				return length;
+			}
+
+			void NegateAffine(Affine &r, const Affine &p) {
+				memcpy(r.x, p.x, sizeof(r.x));
+				FeNeg(r.y, p.y);
+			}
+
+			// HMAC-SHA256 with a 32 byte key over the short messages of RFC 6979, buffered on the stack and
+			// computed in one go by OpenSSL's HMAC (the SHA256_* calls are deprecated since OpenSSL 3.0)
+			class HmacSha256 {
+			public:
+				explicit HmacSha256(const uint8_t key[32]) :
+					_size(0) {
+					memcpy(_key, key, sizeof(_key));
+				}
+
+				~HmacSha256() {
+					Cleanse(_key, sizeof(_key));
+					Cleanse(_data, sizeof(_data));
+				}
+
+				// V || byte || x || h1 is the longest message, it always fits
+				void Update(const uint8_t *data, size_t size) {
+					memcpy(_data + _size, data, size);
+					_size += size;
+				}
+
+				void Final(uint8_t md[32]) {
+					unsigned int mdSize = 32;
+					HMAC(EVP_sha256(), _key, sizeof(_key), _data, _size, md, &mdSize);
+				}
+
+				// md = HMAC(key, data), md may be data
+				static void Compute(uint8_t md[32], const uint8_t key[32], const uint8_t *data, size_t size) {
+					HmacSha256 hmac(key);
+					hmac.Update(data, size);
+					hmac.Final(md);
+				}
+
+			private:
+				uint8_t _key[32];
+				uint8_t _data[32 + 1 + 32 + 32];
+				size_t _size;
+			};
+
+			// RFC 6979 3.2 for a 256 bit order and SHA-256, x and h1 already reduced
+			class NonceGenerator {
+			public:
+				NonceGenerator(const uint8_t x[32], const uint8_t h1[32]) {
+					memset(_v, 0x01, sizeof(_v));
+					memset(_k, 0x00, sizeof(_k));
+					for (uint8_t round = 0; round < 2; ++round) {
+						HmacSha256 k(_k);
+						k.Update(_v, sizeof(_v));
+						k.Update(&round, 1);
+						k.Update(x, 32);
+						k.Update(h1, 32);
+						k.Final(_k);
+						HmacSha256::Compute(_v, _k, _v, sizeof(_v));
+					}
+					_first = true;
+				}
+
+				~NonceGenerator() {
+					Cleanse(_v, sizeof(_v));
+					Cleanse(_k, sizeof(_k));
+				}
+
+				void Next(uint8_t nonce[32]) {
+					if (!_first) {
+						const uint8_t zero = 0;
+						HmacSha256 k(_k);
+						k.Update(_v, sizeof(_v));
+						k.Update(&zero, 1);
+						k.Final(_k);
+						HmacSha256::Compute(_v, _k, _v, sizeof(_v));
+					}
+					_first = false;
+
+					HmacSha256::Compute(_v, _k, _v, sizeof(_v));
+					memcpy(nonce, _v, sizeof(_v));
+				}
+
+			private:
+				uint8_t _v[32], _k[32];
+				bool _first;
+			};
+
+		}
+#endif
+
+		bool P256::Supported() {
+#ifdef P256_NATIVE
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		bool P256::ParsePubKey(PublicKey &pubKey, const uint8_t *data, size_t size) {
+#ifdef P256_NATIVE
+			const Context &ctx = Ctx();
+			uint64_t x[4], y[4], rhs[4], t[4];
+
+			if (!((size == 33 && (data[0] == 0x02 || data[0] == 0x03)) || (size == 65 && data[0] == 0x04)))
+				return false;
+
+			FromBytes(x, data + 1);
+			if (!Less(x, FieldP.m))
+				return false;
+			FeMul(x, x, ctx.pRR);
+
+			// y^2 = x^3 - 3 x + b
+			FeSqr(rhs, x);
+			FeMul(rhs, rhs, x);
+			FeAdd(t, x, x);
+			FeAdd(t, t, x);
+			FeSub(rhs, rhs, t);
+			FeAdd(rhs, rhs, ctx.b);
+
+			if (size == 65) {
+				FromBytes(y, data + 33);
+				if (!Less(y, FieldP.m))
+					return false;
+				FeMul(y, y, ctx.pRR);
+			} else {
+				ModPow(y, rhs, ctx.pSqrtExp, ctx.pOne, FieldP);
+
+				const uint64_t one[4] = {1, 0, 0, 0};
+				MontMul(t, y, one, FieldP);
+				if ((t[0] & 1) != (uint64_t) (data[0] & 1))
+					FeNeg(y, y);
+			}
+
+			FeSqr(t, y);
+			if (!Equal(t, rhs))
+				return false;
+
+			memcpy(pubKey.x, x, sizeof(x));
+			memcpy(pubKey.y, y, sizeof(y));
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		void P256::SerializePubKey(uint8_t data[33], const PublicKey &pubKey) {
+#ifdef P256_NATIVE
+			const uint64_t one[4] = {1, 0, 0, 0};
+			uint64_t x[4], y[4];
+
+			MontMul(x, pubKey.x, one, FieldP);
+			MontMul(y, pubKey.y, one, FieldP);
+			data[0] = (uint8_t) (0x02 | (y[0] & 1));
+			ToBytes(data + 1, x);
+#else
+			memset(data, 0, 33);
+#endif
+		}
+
+		bool P256::DerivePubKey(PublicKey &pubKey, const uint8_t privKey[32]) {
+#ifdef P256_NATIVE
+			const Context &ctx = Ctx();
+			uint64_t d[4];
+			Jacobian q;
+			Affine a;
+
+			FromBytes(d, privKey);
+			if (IsZero(d) || !Less(d, OrderN.m)) {
+				Cleanse(d, sizeof(d));
+				return false;
+			}
+
+			MulBase(q, d, ctx);
+			ToAffine(a, q, ctx);
+			memcpy(pubKey.x, a.x, sizeof(a.x));
+			memcpy(pubKey.y, a.y, sizeof(a.y));
+
+			Cleanse(d, sizeof(d));
+			Cleanse(&q, sizeof(q));
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		bool P256::TweakAddPubKey(PublicKey &pubKey, const uint8_t tweak[32]) {
+#ifdef P256_NATIVE
+			const Context &ctx = Ctx();
+			uint64_t t[4];
+			Jacobian q;
+			Affine a;
+
+			FromBytes(t, tweak);
+			if (!Less(t, OrderN.m))
+				return false;
+
+			memcpy(a.x, pubKey.x, sizeof(a.x));
+			memcpy(a.y, pubKey.y, sizeof(a.y));
+			MulBase(q, t, ctx);
+			AddMixed(q, q, a, ctx);
+			if (IsZero(q.z))
+				return false;
+
+			ToAffine(a, q, ctx);
+			memcpy(pubKey.x, a.x, sizeof(a.x));
+			memcpy(pubKey.y, a.y, sizeof(a.y));
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		bool P256::Sign(uint8_t signature[64], const uint8_t privKey[32], const uint8_t digest[32]) {
+#ifdef P256_NATIVE
+			const Context &ctx = Ctx();
+			const uint64_t one[4] = {1, 0, 0, 0};
+			uint64_t d[4], e[4], k[4], r[4], s[4], t[4];
+			uint8_t h1[32], nonce[32];
+			Jacobian kg;
+			Affine a;
+			bool ok = false;
+
+			FromBytes(d, privKey);
+			if (IsZero(d) || !Less(d, OrderN.m)) {
+				Cleanse(d, sizeof(d));
+				return false;
+			}
+
+			// e mod n, a Montgomery multiplication brings any 256 bit value below n
+			FromBytes(e, digest);
+			MontMul(e, e, ctx.nRR, OrderN);
+			MontMul(t, e, one, OrderN);
+			ToBytes(h1, t);
+			MontMul(d, d, ctx.nRR, OrderN);
+
+			NonceGenerator nonces(privKey, h1);
+			for (int attempt = 0; attempt < 16 && !ok; ++attempt) {
+				nonces.Next(nonce);
+				FromBytes(k, nonce);
+				if (IsZero(k) || !Less(k, OrderN.m))
+					continue;
+
+				MulBase(kg, k, ctx);
+				ToAffine(a, kg, ctx);
+
+				// r = x mod n
+				MontMul(r, a.x, one, FieldP);
+				MontMul(r, r, ctx.nRR, OrderN);
+
+				// s = k^-1 (e + r d), everything in Montgomery form mod n
+				MontMul(k, k, ctx.nRR, OrderN);
+				ModPow(k, k, ctx.nInvExp, ctx.nOne, OrderN);
+				MontMul(s, r, d, OrderN);
+				ModAdd(s, s, e, OrderN);
+				MontMul(s, s, k, OrderN);
+
+				MontMul(r, r, one, OrderN);
+				MontMul(s, s, one, OrderN);
+				ok = !IsZero(r) && !IsZero(s);
+			}
+
+			if (ok) {
+				ToBytes(signature, r);
+				ToBytes(signature + 32, s);
+			}
+
+			Cleanse(d, sizeof(d));
+			Cleanse(k, sizeof(k));
+			Cleanse(nonce, sizeof(nonce));
+			Cleanse(&kg, sizeof(kg));
+			Cleanse(&a, sizeof(a));
+			return ok;
+#else
+			return false;
+#endif
+		}
+
+		bool P256::Verify(const PublicKey &pubKey, const uint8_t digest[32], const uint8_t signature[64]) {
+#ifdef P256_NATIVE
+			const Context &ctx = Ctx();
+			uint64_t r[4], s[4], e[4], w[4], u1[4], u2[4], t[4];
+
+			FromBytes(r, signature);
+			FromBytes(s, signature + 32);
+			if (IsZero(r) || !Less(r, OrderN.m) || IsZero(s) || !Less(s, OrderN.m))
+				return false;
+
+			// u1 = e / s, u2 = r / s
+			FromBytes(e, digest);
+			MontMul(w, s, ctx.nRR, OrderN);
+			ModPow(w, w, ctx.nInvExp, ctx.nOne, OrderN);
+			MontMul(u1, e, w, OrderN);
+			MontMul(u2, r, w, OrderN);
+
+			// odd multiples of the key, Q, 3Q, ..., 15Q
+			Jacobian keyWnaf[KEY_WNAF_POINTS], q2;
+			Affine q;
+			memcpy(q.x, pubKey.x, sizeof(q.x));
+			memcpy(q.y, pubKey.y, sizeof(q.y));
+			ToJacobian(keyWnaf[0], q, ctx);
+			Double(q2, keyWnaf[0]);
+			for (int i = 1; i < KEY_WNAF_POINTS; ++i)
+				Add(keyWnaf[i], keyWnaf[i - 1], q2);
+
+			int8_t wnaf1[257], wnaf2[257];
+			int length1 = Wnaf(wnaf1, u1, GEN_WNAF_WIDTH);
+			int length2 = Wnaf(wnaf2, u2, KEY_WNAF_WIDTH);
+
+			Jacobian R, negated;
+			Affine negatedAffine;
+			memset(&R, 0, sizeof(R));
+			for (int i = (length1 > length2 ? length1 : length2) - 1; i >= 0; --i) {
+				if (!IsZero(R.z))
+					Double(R, R);
+
+				if (wnaf1[i] > 0) {
+					AddMixed(R, R, ctx.genWnaf[wnaf1[i] / 2], ctx);
+				} else if (wnaf1[i] < 0) {
+					NegateAffine(negatedAffine, ctx.genWnaf[-wnaf1[i] / 2]);
+					AddMixed(R, R, negatedAffine, ctx);
+				}
+
+				if (wnaf2[i] > 0) {
+					Add(R, R, keyWnaf[wnaf2[i] / 2]);
+				} else if (wnaf2[i] < 0) {
+					negated = keyWnaf[-wnaf2[i] / 2];
+					FeNeg(negated.y, negated.y);
+					Add(R, R, negated);
+				}
+			}
+
+			if (IsZero(R.z))
+				return false;
+
+			// x(R) mod n == r without an inversion, x = X / Z^2 is r or r + n
+			uint64_t z2[4], rm[4];
+			FeSqr(z2, R.z);
+			MontMul(rm, r, ctx.pRR, FieldP);
+			FeMul(t, rm, z2);
+			if (Equal(t, R.x))
+				return true;
+
+			uint64_t carry = 0;
+			for (int i = 0; i < 4; ++i)
+				t[i] = Adc(r[i], OrderN.m[i], carry);
+			if (carry || !Less(t, FieldP.m))
+				return false;
+			MontMul(rm, t, ctx.pRR, FieldP);
+			FeMul(t, rm, z2);
+			return Equal(t, R.x);
+#else
+			return false;
+#endif
+		}
+
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef __ELASTOS_SDK_P256_H__
+#define __ELASTOS_SDK_P256_H__
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace Elastos {
+	namespace ElaWallet {
+
+		/*
+		 * ECDSA over P-256 (prime256v1, the curve of secp256k1_key) without OpenSSL's EC_KEY and BIGNUM objects.
+		 * Field and scalar arithmetic are Montgomery over 4 64 bit limbs, so it needs a compiler with 128 bit
+		 * integers, Supported() is false otherwise. The curve arithmetic allocates nothing, only the RFC 6979 nonce
+		 * goes through OpenSSL's HMAC.
+		 *
+		 * Signing and public key derivation take the private key through a fixed window multiplication of the
+		 * generator over a precomputed table, with constant time table lookups and no branches on secret data.
+		 * Verification is variable time, a wNAF multiplication of both the generator and the public key.
+		 * Nonces are deterministic, RFC 6979 with SHA-256.
+		 */
+		class P256 {
+		public:
+			// affine point, internal representation
+			struct PublicKey {
+				uint64_t x[4];
+				uint64_t y[4];
+			};
+
+		public:
+			static bool Supported();
+
+			// 33 byte compressed or 65 byte uncompressed encoding of a point of the curve
+			static bool ParsePubKey(PublicKey &pubKey, const uint8_t *data, size_t size);
+
+			// 33 byte compressed encoding
+			static void SerializePubKey(uint8_t data[33], const PublicKey &pubKey);
+
+			// privKey is big endian and has to be in [1, n - 1]
+			static bool DerivePubKey(PublicKey &pubKey, const uint8_t privKey[32]);
+
+			// pubKey += tweak * G, the public side of BIP32 child derivation; false if tweak >= n or the sum is
+			// the point at infinity
+			static bool TweakAddPubKey(PublicKey &pubKey, const uint8_t tweak[32]);
+
+			// signature is r || s, big endian
+			static bool Sign(uint8_t signature[64], const uint8_t privKey[32], const uint8_t digest[32]);
+
+			static bool Verify(const PublicKey &pubKey, const uint8_t digest[32], const uint8_t signature[64]);
+		};
+
+	}
+}
+
+#endif //__ELASTOS_SDK_P256_H__
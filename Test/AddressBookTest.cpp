@@ -0,0 +1,101 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Account/AddressBook.h>
+#include <SDK/Common/Log.h>
+
+#include <set>
+
+using namespace Elastos::ElaWallet;
+
+static uint168 randomProgramHash(uint8_t prefix) {
+	return uint168(prefix, getRandBytes(20));
+}
+
+TEST_CASE("AddressBook test", "[AddressBook]") {
+	Log::registerMultiLogger();
+
+	SECTION("insert and contains") {
+		AddressBook book;
+		std::vector<uint168> hashes;
+		for (int i = 0; i < 1000; ++i)
+			hashes.push_back(randomProgramHash(i % 2 ? PrefixStandard : PrefixDeposit));
+
+		REQUIRE(!book.Contains(hashes[0]));
+		for (size_t i = 0; i < hashes.size(); ++i) {
+			REQUIRE(book.Insert(hashes[i]));
+			REQUIRE(!book.Insert(hashes[i]));
+		}
+		REQUIRE(book.Size() == hashes.size());
+
+		for (size_t i = 0; i < hashes.size(); ++i) {
+			REQUIRE(book.Contains(hashes[i]));
+			REQUIRE(book.Contains(Address(hashes[i])));
+		}
+
+		// same digest under another prefix is another address
+		for (size_t i = 0; i < 100; ++i) {
+			uint168 other = hashes[i];
+			other.begin()[0] = PrefixCrossChain;
+			REQUIRE(!book.Contains(other));
+			REQUIRE(!book.Contains(randomProgramHash(PrefixStandard)));
+		}
+
+		book.Clear();
+		REQUIRE(book.Size() == 0);
+		REQUIRE(!book.Contains(hashes[0]));
+		REQUIRE(book.Insert(hashes[0]));
+		REQUIRE(book.Contains(hashes[0]));
+	}
+
+	SECTION("addresses") {
+		AddressBook book;
+		Address address(randomProgramHash(PrefixStandard));
+		REQUIRE(book.Insert(address));
+		REQUIRE(book.Contains(address));
+		REQUIRE(book.Contains(Address(address.String())));
+		REQUIRE(book.Contains(address.ProgramHash()));
+
+		// invalid addresses are left out
+		REQUIRE(!book.Insert(Address()));
+		REQUIRE(!book.Insert(Address("not an address")));
+		REQUIRE(book.Size() == 1);
+	}
+}
+
+TEST_CASE("AddressBook benchmark", "[.benchmark][AddressBook]") {
+	Log::registerMultiLogger();
+
+	// a wallet's chains, looked up by the outputs of a block
+	std::set<Address> set;
+	AddressBook book;
+	for (int i = 0; i < 1000; ++i) {
+		uint168 hash = randomProgramHash(PrefixStandard);
+		set.insert(Address(hash));
+		book.Insert(hash);
+	}
+
+	std::vector<uint168> outputs;
+	for (int i = 0; i < 10000; ++i)
+		outputs.push_back(randomProgramHash(PrefixStandard));
+
+	size_t count = 0;
+
+	BENCHMARK("std::set<Address>, 10000 outputs") {
+		for (size_t i = 0; i < outputs.size(); ++i)
+			count += set.find(Address(outputs[i])) != set.end() ? 1 : 0;
+	}
+
+	BENCHMARK("AddressBook, 10000 outputs") {
+		for (size_t i = 0; i < outputs.size(); ++i)
+			count += book.Contains(outputs[i]) ? 1 : 0;
+	}
+
+	REQUIRE(count == 0);
+}
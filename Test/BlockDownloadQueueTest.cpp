@@ -0,0 +1,165 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/P2P/BlockDownloadQueue.h>
+#include <SDK/Plugin/Block/MerkleBlock.h>
+#include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+// the queue only tells peers apart, it never touches them
+static PeerPtr fakePeer() {
+	return PeerPtr((Peer *) new char, [](Peer *p) { delete (char *) p; });
+}
+
+static std::vector<MerkleBlockPtr> createChain(size_t count) {
+	std::vector<MerkleBlockPtr> chain;
+	uint256 prev;
+	for (size_t i = 0; i < count; ++i) {
+		MerkleBlockPtr block(new MerkleBlock());
+		block->SetHash(getRanduint256());
+		block->SetPrevBlockHash(prev);
+		block->SetHeight(i + 1);
+		prev = block->GetHash();
+		chain.push_back(block);
+	}
+	return chain;
+}
+
+static std::vector<uint256> hashesOf(const std::vector<MerkleBlockPtr> &blocks) {
+	std::vector<uint256> hashes;
+	for (size_t i = 0; i < blocks.size(); ++i)
+		hashes.push_back(blocks[i]->GetHash());
+	return hashes;
+}
+
+TEST_CASE("BlockDownloadQueue test", "[BlockDownloadQueue]") {
+	Log::registerMultiLogger();
+
+	std::vector<MerkleBlockPtr> chain = createChain(20);
+	PeerPtr p1 = fakePeer(), p2 = fakePeer();
+	BlockDownloadQueue queue(4, 2);
+
+	queue.Append(hashesOf(chain));
+	queue.Append({chain[3]->GetHash()});
+	REQUIRE(queue.Size() == 20);
+	REQUIRE(queue.Back() == chain[19]->GetHash());
+
+	SECTION("ranges are split between peers") {
+		std::vector<uint256> a1 = queue.Assign(p1, 0), a2 = queue.Assign(p1, 0), a3 = queue.Assign(p1, 0);
+		std::vector<uint256> b1 = queue.Assign(p2, 0);
+
+		REQUIRE(a1 == hashesOf({chain.begin(), chain.begin() + 4}));
+		REQUIRE(a2 == hashesOf({chain.begin() + 4, chain.begin() + 8}));
+		REQUIRE(a3.empty()); // two batches in flight at most
+		REQUIRE(b1 == hashesOf({chain.begin() + 8, chain.begin() + 12}));
+		REQUIRE(queue.InFlight(p1) == 8);
+		REQUIRE(queue.InFlight(p2) == 4);
+	}
+
+	SECTION("blocks come out in chain order") {
+		queue.Assign(p1, 0);
+		queue.Assign(p2, 0);
+
+		// the second range arrives first and is held back
+		for (size_t i = 4; i < 8; ++i)
+			REQUIRE(queue.Received(p2, chain[i], 1).empty());
+		REQUIRE(queue.Received(p1, chain[1], 1).empty());
+
+		std::vector<BlockDownloadQueue::RelayedBlock> ready = queue.Received(p1, chain[0], 1);
+		REQUIRE(ready.size() == 2);
+		REQUIRE(ready[0].peer == p1);
+		REQUIRE(ready[0].block == chain[0]);
+		REQUIRE(ready[1].block == chain[1]);
+
+		REQUIRE(queue.Received(p1, chain[2], 1).size() == 1);
+		ready = queue.Received(p1, chain[3], 1);
+		REQUIRE(ready.size() == 5);
+		for (size_t i = 0; i < ready.size(); ++i)
+			REQUIRE(ready[i].block == chain[i + 3]);
+		REQUIRE(ready.back().peer == p2);
+
+		REQUIRE(queue.Size() == 12);
+		REQUIRE(!queue.Contains(chain[7]->GetHash()));
+		REQUIRE(queue.Contains(chain[8]->GetHash()));
+		REQUIRE(queue.InFlight(p1) == 0);
+		REQUIRE(queue.InFlight(p2) == 0);
+
+		// duplicates and unknown blocks are ignored
+		REQUIRE(queue.Received(p2, chain[3], 1).empty());
+		REQUIRE(queue.Received(p2, createChain(1)[0], 1).empty());
+	}
+
+	SECTION("tx are held with their block") {
+		queue.Assign(p1, 0);
+		queue.Assign(p2, 0);
+		TransactionPtr fund(new Transaction()), spend(new Transaction()), stray(new Transaction());
+
+		// a spend in a later block comes first, it must not reach the wallet before its funding tx
+		REQUIRE(queue.HoldTx(p2, chain[4]->GetHash(), spend));
+		REQUIRE(queue.Received(p2, chain[4], 1).empty());
+		REQUIRE(queue.HoldTx(p2, chain[4]->GetHash(), stray)); // block is in already, duplicate
+		REQUIRE(!queue.HoldTx(p2, createChain(1)[0]->GetHash(), stray));
+
+		// only the tx of the peer delivering the block go with it
+		REQUIRE(queue.HoldTx(p2, chain[0]->GetHash(), stray));
+		REQUIRE(queue.HoldTx(p1, chain[0]->GetHash(), fund));
+		std::vector<BlockDownloadQueue::RelayedBlock> ready = queue.Received(p1, chain[0], 1);
+		REQUIRE(ready.size() == 1);
+		REQUIRE(ready[0].txns.size() == 1);
+		REQUIRE(ready[0].txns[0] == fund);
+
+		for (size_t i = 1; i < 3; ++i)
+			REQUIRE(queue.Received(p1, chain[i], 1).size() == 1);
+
+		// a released peer's tx are dropped
+		REQUIRE(queue.HoldTx(p1, chain[3]->GetHash(), stray));
+		queue.Release(p1);
+		ready = queue.Received(p2, chain[3], 2);
+		REQUIRE(ready.size() == 2);
+		REQUIRE(ready[0].txns.empty());
+		REQUIRE(ready[1].block == chain[4]);
+		REQUIRE(ready[1].txns.size() == 1);
+		REQUIRE(ready[1].txns[0] == spend);
+	}
+
+	SECTION("stalled ranges are reassigned") {
+		queue.Assign(p1, 0);
+		queue.Assign(p2, 0);
+		queue.Received(p2, chain[4], 8);
+
+		REQUIRE(queue.Stalled(5, 10).empty());
+		std::vector<PeerPtr> stalled = queue.Stalled(12, 10);
+		REQUIRE(stalled.size() == 1);
+		REQUIRE(stalled[0] == p1);
+
+		REQUIRE(queue.Release(p1) == 4);
+		REQUIRE(queue.InFlight(p1) == 0);
+
+		// released range goes out before the untouched ones
+		REQUIRE(queue.Assign(p2, 12) == hashesOf({chain.begin(), chain.begin() + 4}));
+
+		// the old peer still relaying it is fine
+		REQUIRE(queue.Received(p1, chain[0], 13).size() == 1);
+		REQUIRE(queue.InFlight(p2) == 6);
+	}
+
+	SECTION("clear") {
+		queue.Assign(p1, 0);
+		queue.Clear();
+		REQUIRE(queue.Empty());
+		REQUIRE(queue.InFlight(p1) == 0);
+		REQUIRE(!queue.Contains(chain[0]->GetHash()));
+		REQUIRE(queue.Assign(p1, 0).empty());
+
+		queue.Append(hashesOf(chain));
+		REQUIRE(queue.Received(p1, chain[0], 0).size() == 1);
+	}
+}
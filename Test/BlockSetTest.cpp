@@ -0,0 +1,132 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/P2P/BlockSet.h>
+#include <SDK/Plugin/Block/MerkleBlock.h>
+
+using namespace Elastos::ElaWallet;
+
+static MerkleBlockPtr createBlock(const MerkleBlockPtr &prev) {
+	MerkleBlockPtr block(new MerkleBlock());
+	block->SetHash(getRanduint256());
+	if (prev != nullptr) {
+		block->SetPrevBlockHash(prev->GetHash());
+		block->SetHeight(prev->GetHeight() + 1);
+	} else {
+		block->SetPrevBlockHash(uint256());
+		block->SetHeight(0);
+	}
+	return block;
+}
+
+static std::vector<MerkleBlockPtr> createChain(const MerkleBlockPtr &from, size_t count) {
+	std::vector<MerkleBlockPtr> chain;
+	MerkleBlockPtr prev = from;
+	for (size_t i = 0; i < count; ++i) {
+		prev = createBlock(prev);
+		chain.push_back(prev);
+	}
+	return chain;
+}
+
+TEST_CASE("BlockSet test", "[BlockSet]") {
+	srand(time(nullptr));
+
+	std::vector<MerkleBlockPtr> chain = createChain(nullptr, 100);
+	BlockSet blocks;
+	for (size_t i = 0; i < chain.size(); ++i) {
+		blocks.Insert(chain[i]);
+		blocks.SetChainTip(chain[i]);
+	}
+
+	SECTION("get, contains, insert and remove") {
+		REQUIRE(blocks.Size() == chain.size());
+		for (size_t i = 0; i < chain.size(); ++i) {
+			REQUIRE(blocks.Contains(chain[i]));
+			REQUIRE(blocks.Contains(chain[i]->GetHash()));
+			REQUIRE(blocks.Get(chain[i]->GetHash()) == chain[i]);
+		}
+		REQUIRE(blocks.Get(getRanduint256()) == nullptr);
+
+		MerkleBlockPtr dup(new MerkleBlock());
+		dup->SetHash(chain[50]->GetHash());
+		dup->SetPrevBlockHash(chain[49]->GetHash());
+		dup->SetHeight(50);
+		blocks.Insert(dup);
+		REQUIRE(blocks.Size() == chain.size());
+		REQUIRE(blocks.Get(dup->GetHash()) == dup);
+		REQUIRE(blocks.IsMainChain(dup));
+
+		blocks.Remove(chain[10]);
+		REQUIRE(!blocks.Contains(chain[10]));
+		REQUIRE(blocks.Size() == chain.size() - 1);
+		REQUIRE(blocks.GetMainChainBlock(10) == nullptr);
+
+		blocks.Clear();
+		REQUIRE(blocks.Size() == 0);
+		REQUIRE(blocks.GetMainChainBlock(0) == nullptr);
+	}
+
+	SECTION("main chain and fork") {
+		for (size_t i = 0; i < chain.size(); ++i) {
+			REQUIRE(blocks.IsMainChain(chain[i]));
+			REQUIRE(blocks.GetMainChainBlock(chain[i]->GetHeight()) == chain[i]);
+		}
+
+		// fork from height 79, longer than main chain
+		std::vector<MerkleBlockPtr> fork = createChain(chain[79], 30);
+		for (size_t i = 0; i < fork.size(); ++i) {
+			blocks.Insert(fork[i]);
+			REQUIRE(!blocks.IsMainChain(fork[i]));
+		}
+
+		blocks.SetChainTip(fork.back());
+		for (size_t i = 0; i < fork.size(); ++i)
+			REQUIRE(blocks.IsMainChain(fork[i]));
+		for (size_t i = 0; i < 80; ++i)
+			REQUIRE(blocks.IsMainChain(chain[i]));
+		for (size_t i = 80; i < chain.size(); ++i)
+			REQUIRE(!blocks.IsMainChain(chain[i]));
+		REQUIRE(blocks.GetMainChainBlock(chain.back()->GetHeight() + 10) == fork.back());
+
+		// rescan from an older block
+		blocks.SetChainTip(chain[20]);
+		REQUIRE(blocks.IsMainChain(chain[20]));
+		REQUIRE(blocks.GetMainChainBlock(21) == nullptr);
+		REQUIRE(!blocks.IsMainChain(fork.back()));
+	}
+}
+
+TEST_CASE("BlockSet chain replay benchmark", "[.benchmark][BlockSet]") {
+	const size_t total = 200000, batch = 20000;
+	std::vector<MerkleBlockPtr> chain = createChain(nullptr, total);
+
+	BlockSet blocks;
+	blocks.Insert(chain[0]);
+	blocks.SetChainTip(chain[0]);
+
+	// same lookups as PeerManager::OnRelayedBlock does for each header which extends the main chain
+	size_t orphans = 0;
+	for (size_t start = 1; start < total; start += batch) {
+		size_t end = std::min(start + batch, total);
+		BENCHMARK("relay headers " + std::to_string(start) + " - " + std::to_string(end)) {
+			for (size_t i = start; i < end; ++i) {
+				const MerkleBlockPtr &block = chain[i];
+				if (blocks.Get(block->GetPrevBlockHash()) == nullptr || blocks.Contains(block))
+					orphans++;
+				blocks.Insert(block);
+				blocks.SetChainTip(block);
+			}
+		}
+	}
+
+	REQUIRE(orphans == 0);
+	REQUIRE(blocks.Size() == total);
+	REQUIRE(blocks.GetMainChainBlock(total - 1) == chain.back());
+}
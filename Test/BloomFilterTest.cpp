@@ -5,12 +5,15 @@
 #define CATCH_CONFIG_MAIN
 
 #include <catch.hpp>
+#include "TestHelper.h"
 
 #include <nlohmann/json.hpp>
 #include <SDK/WalletCore/BIPs/BloomFilter.h>
 #include <SDK/WalletCore/BIPs/Address.h>
 #include <SDK/Common/Log.h>
 
+#include <algorithm>
+
 using namespace Elastos::ElaWallet;
 
 TEST_CASE( "BloomFilter test", "[BloomFilter]" ) {
@@ -153,5 +156,112 @@ TEST_CASE( "BloomFilter test", "[BloomFilter]" ) {
 		}
 	}
 
+	SECTION("batch") {
+		std::vector<bytes_t> elements, others;
+		for (nlohmann::json::iterator it = addrJsonArray.begin(); it != addrJsonArray.end(); it++) {
+			elements.push_back(Address((*it).get<std::string>()).ProgramHash().bytes());
+			others.push_back(bytes_t(34, (uint8_t) others.size()));
+		}
+
+		BloomFilter filter(BLOOM_DEFAULT_FALSEPOSITIVE_RATE, elements.size() + 100, 0x12345678, BLOOM_UPDATE_ALL);
+		filter.InsertData(elements);
+
+		std::vector<bool> contains;
+		REQUIRE(filter.ContainsData(elements, contains) == elements.size());
+		REQUIRE(contains == std::vector<bool>(elements.size(), true));
+
+		for (size_t i = 0; i < elements.size(); ++i)
+			REQUIRE(filter.ContainsData(&elements[i][0], elements[i].size()));
+
+		// false positives are allowed, the batch only has to agree with the single lookups
+		size_t matched = filter.ContainsData(others, contains);
+		REQUIRE(contains.size() == others.size());
+		for (size_t i = 0; i < others.size(); ++i)
+			REQUIRE(contains[i] == filter.ContainsData(others[i]));
+		REQUIRE(matched == (size_t) std::count(contains.begin(), contains.end(), true));
+	}
+
+	SECTION("reference filter") {
+		// the BIP37 test vector, peers have to compute the same bits
+		BloomFilter filter(0.01, 3, 0, BLOOM_UPDATE_ALL);
+
+		bytes_t data("99108ad8ed9bb6274d3980bab5a85c048f0950c8");
+		filter.InsertData(data);
+		REQUIRE(filter.ContainsData(data));
+		REQUIRE(!filter.ContainsData(bytes_t("19108ad8ed9bb6274d3980bab5a85c048f0950c8")));
+
+		filter.InsertData(bytes_t("b5a2c786d9ef4658287ced5914b37a1b4aa32eee"));
+		data.setHex("b9300670b4c5366e95b2699e8b18bc75e5f729c5");
+		filter.InsertData(&data[0], data.size());
+
+		ByteStream stream;
+		filter.Serialize(stream);
+		REQUIRE(stream.GetBytes().getHex() == "03614e9b0500000000000000");
+	}
+
+	SECTION("bounds on input") {
+		BloomFilter filter(0.01, 3, 0, BLOOM_UPDATE_ALL);
+
+		ByteStream stream;
+		stream.WriteVarBytes(bytes_t("614e9b"));
+		stream.WriteUint32(BLOOM_MAX_HASH_FUNCS);
+		stream.WriteUint32(0);
+		stream.WriteByte(BLOOM_UPDATE_ALL);
+		REQUIRE(filter.Deserialize(stream));
+
+		stream.Reset();
+		stream.WriteVarBytes(bytes_t("614e9b"));
+		stream.WriteUint32(BLOOM_MAX_HASH_FUNCS + 1);
+		stream.WriteUint32(0);
+		stream.WriteByte(BLOOM_UPDATE_ALL);
+		REQUIRE(!filter.Deserialize(stream));
+
+		stream.Reset();
+		stream.WriteVarBytes(bytes_t(BLOOM_MAX_FILTER_LENGTH + 1, 0));
+		stream.WriteUint32(1);
+		stream.WriteUint32(0);
+		stream.WriteByte(BLOOM_UPDATE_ALL);
+		REQUIRE(!filter.Deserialize(stream));
+
+		nlohmann::json j = BloomFilter(0.01, 3, 0, BLOOM_UPDATE_ALL).ToJson();
+		j["hashFuncs"] = BLOOM_MAX_HASH_FUNCS + 1;
+		REQUIRE_THROWS(filter.FromJson(j));
+		j["hashFuncs"] = BLOOM_MAX_HASH_FUNCS;
+		REQUIRE_NOTHROW(filter.FromJson(j));
+		j["filter"] = "";
+		REQUIRE_THROWS(filter.FromJson(j));
+	}
+
+}
+
+TEST_CASE("BloomFilter wallet filter benchmark", "[.benchmark][BloomFilter]") {
+	const size_t count = 50000;
+	std::vector<uint168> programHashes;
+	std::vector<bytes_t> elements;
+	for (size_t i = 0; i < count; ++i) {
+		programHashes.push_back(uint168(getRandBytes(21)));
+		elements.push_back(programHashes.back().bytes());
+	}
+
+	BloomFilter filter(BLOOM_REDUCED_FALSEPOSITIVE_RATE, count + 100, 0x12345678, BLOOM_UPDATE_ALL);
+
+	BENCHMARK("insert " + std::to_string(count) + " addresses one by one") {
+		for (size_t i = 0; i < count; ++i) {
+			bytes_t hash = programHashes[i].bytes();
+			filter.InsertData(hash);
+		}
+	}
+
+	BENCHMARK("insert " + std::to_string(count) + " addresses in a batch") {
+		filter.InsertData(elements);
+	}
+
+	std::vector<bool> contains;
+	size_t matched = 0;
+	BENCHMARK("query " + std::to_string(count) + " addresses in a batch") {
+		matched = filter.ContainsData(elements, contains);
+	}
+
+	REQUIRE(matched == count);
 }
 
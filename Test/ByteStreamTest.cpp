@@ -0,0 +1,71 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Common/ByteStream.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+TEST_CASE("ByteStream view test", "[ByteStream]") {
+	Log::registerMultiLogger();
+
+	ByteStream source;
+	uint256 hash = getRanduint256();
+	source.WriteUint32(0x12345678);
+	source.WriteVarBytes(bytes_t("0a0b0c"));
+	source.WriteBytes(hash);
+	bytes_t buf = source.GetBytes();
+
+	SECTION("reads in place") {
+		ByteStream view(&buf[0], buf.size(), false);
+		uint32_t u32 = 0;
+		bytes_t bytes;
+		uint256 h;
+
+		REQUIRE(view.size() == buf.size());
+		REQUIRE(view.ReadUint32(u32));
+		REQUIRE(u32 == 0x12345678);
+		REQUIRE(view.ReadVarBytes(bytes));
+		REQUIRE(bytes == bytes_t("0a0b0c"));
+
+		// the view sees the buffer it was made of
+		buf[buf.size() - 1] ^= 0xff;
+		REQUIRE(view.ReadBytes(h));
+		REQUIRE(h != hash);
+		REQUIRE(!view.ReadUint8(bytes[0]));
+	}
+
+	SECTION("copies before writing") {
+		ByteStream view(&buf[0], buf.size(), false);
+		uint32_t u32 = 0;
+
+		REQUIRE(view.ReadUint32(u32));
+		view.WriteUint8(0xee);
+		buf[0] = 0;
+
+		REQUIRE(view.size() == buf.size() + 1);
+		REQUIRE(view.GetBytes()[0] == 0x78);
+		REQUIRE(view.GetBytes().back() == 0xee);
+
+		uint8_t skipped = 0;
+		view.Skip(1 + 3 + 32);
+		REQUIRE(view.ReadUint8(skipped));
+		REQUIRE(skipped == 0xee);
+	}
+
+	SECTION("hands out a copy of the bytes") {
+		ByteStream view(&buf[0], buf.size(), false);
+		ByteStream copy(&buf[0], buf.size(), true);
+
+		REQUIRE(view.GetBytes() == source.GetBytes());
+		REQUIRE(copy.GetBytes() == source.GetBytes());
+		buf[0] = 0;
+		REQUIRE(view.GetBytes() == source.GetBytes());
+	}
+}
@@ -0,0 +1,252 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Wallet/CoinSelector.h>
+#include <SDK/Wallet/UTXOSet.h>
+#include <SDK/Wallet/Wallet.h>
+#include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
+#include <SDK/Plugin/Transaction/TransactionInput.h>
+#include <SDK/Plugin/Transaction/Program.h>
+#include <SDK/Plugin/Transaction/Attribute.h>
+
+using namespace Elastos::ElaWallet;
+
+static UTXOPtr createUTXO(uint64_t amount, uint32_t height) {
+	OutputPtr output(new TransactionOutput());
+	output->SetAmount(Int128(amount));
+	return UTXOPtr(new UTXO(getRanduint256(), 0, time(nullptr), height, output));
+}
+
+static bytes_t createCode() {
+	bytes_t code = getRandBytes(35);
+	code[0] = 33;
+	code[34] = SignTypeStandard;
+	return code;
+}
+
+static TransactionPtr createTx() {
+	TransactionPtr tx(new Transaction());
+	OutputPtr output(new TransactionOutput());
+	output->SetAmount(Int128(100000000));
+	tx->AddOutput(output);
+	return tx;
+}
+
+TEST_CASE("CoinSelector test", "[CoinSelector]") {
+	srand(time(nullptr));
+
+	SECTION("running size and fee") {
+		TransactionPtr tx = createTx();
+		CoinSelector selector(tx, DEFAULT_FEE_PER_KB, true);
+		std::vector<bytes_t> codes;
+		for (size_t i = 0; i < 10; ++i)
+			codes.push_back(createCode());
+
+		REQUIRE(selector.GetSize() == tx->EstimateSize());
+		REQUIRE(selector.GetFee() == CoinSelector::CalculateFee(DEFAULT_FEE_PER_KB, tx->EstimateSize()));
+
+		Int128 total(0);
+		for (size_t i = 0; i < 300; ++i) {
+			UTXOPtr u = createUTXO(1000 + i, 100);
+			total += u->Output()->Amount();
+			selector.AddInput(u, codes[i % codes.size()], "44'/0'/0'/0/0");
+
+			REQUIRE(selector.GetSize() == tx->EstimateSize());
+			REQUIRE(selector.GetFee() == CoinSelector::CalculateFee(DEFAULT_FEE_PER_KB, tx->EstimateSize()));
+		}
+
+		REQUIRE(selector.GetInputCount() == 300);
+		REQUIRE(selector.GetInputAmount() == total);
+		REQUIRE(tx->GetPrograms().size() == codes.size());
+
+		selector.AddInput(createUTXO(1, 100));
+		REQUIRE(selector.GetSize() == tx->EstimateSize());
+		REQUIRE(tx->GetPrograms().size() == codes.size());
+	}
+
+	SECTION("exact match without fee") {
+		TransactionPtr tx = createTx();
+		CoinSelector selector(tx, DEFAULT_FEE_PER_KB, false);
+		UTXOArray candidates, selected;
+		const uint64_t amounts[] = {50, 40, 30, 20, 10};
+		for (size_t i = 0; i < sizeof(amounts) / sizeof(amounts[0]); ++i)
+			candidates.push_back(createUTXO(amounts[i] * 100000000, 100));
+
+		std::vector<bytes_t> codes(candidates.size(), createCode());
+		REQUIRE(selector.SelectExactMatch(candidates, codes, Int128(70 * 100000000ull), selected));
+		Int128 sum(0);
+		for (size_t i = 0; i < selected.size(); ++i)
+			sum += selected[i]->Output()->Amount();
+		REQUIRE(sum == Int128(70 * 100000000ull));
+
+		selected.clear();
+		REQUIRE(!selector.SelectExactMatch(candidates, codes, Int128(75 * 100000000ull), selected));
+		REQUIRE(!selector.SelectExactMatch(candidates, codes, Int128(200 * 100000000ull), selected));
+		codes.pop_back();
+		REQUIRE(!selector.SelectExactMatch(candidates, codes, Int128(70 * 100000000ull), selected));
+		REQUIRE(selected.empty());
+	}
+
+	SECTION("exact match with fee") {
+		TransactionPtr tx = createTx();
+		CoinSelector selector(tx, DEFAULT_FEE_PER_KB, true);
+		uint64_t target = 100000000;
+		UTXOArray candidates, selected;
+		bytes_t code = createCode();
+		size_t inputSize = TransactionInput().EstimateSize();
+		size_t programSize = Program("", code, bytes_t()).EstimateSize();
+
+		for (size_t i = 0; i < 1000; ++i)
+			candidates.push_back(createUTXO(getRandUInt32() % 90000000 + 1000000, 100));
+		candidates.push_back(createUTXO(target + CoinSelector::CalculateFee(DEFAULT_FEE_PER_KB,
+																			 selector.GetSize() + inputSize + programSize), 100));
+		std::sort(candidates.begin(), candidates.end(), [](const UTXOPtr &a, const UTXOPtr &b) {
+			return a->Output()->Amount() > b->Output()->Amount();
+		});
+
+		// all from one address, the tx gets a single program
+		std::vector<bytes_t> codes(candidates.size(), code);
+		REQUIRE(selector.SelectExactMatch(candidates, codes, Int128(target), selected));
+		REQUIRE(!selected.empty());
+		for (size_t i = 0; i < selected.size(); ++i)
+			selector.AddInput(selected[i], code, "44'/0'/0'/0/0");
+		REQUIRE(tx->GetPrograms().size() == 1);
+
+		Int128 need = Int128(target) + selector.GetFee();
+		REQUIRE(selector.GetInputAmount() >= need);
+		REQUIRE(selector.GetInputAmount() - need <=
+				Int128((DEFAULT_FEE_PER_KB * (TX_INPUT_SIZE + TX_OUTPUT_SIZE) + 999) / 1000));
+	}
+
+	SECTION("exact match sized with the real programs") {
+		// a memo puts the tx with one standard input right under 1KB
+		bytes_t code = createCode();
+		size_t inputSize = TransactionInput().EstimateSize();
+		size_t standardSize = Program("", code, bytes_t()).EstimateSize();
+		TransactionPtr tx;
+		for (size_t len = 0; tx == nullptr || tx->EstimateSize() + inputSize + standardSize < 950; len += 10) {
+			tx = createTx();
+			tx->AddAttribute(AttributePtr(new Attribute(Attribute::Memo, bytes_t(len, 'm'))));
+		}
+
+		// 3 of 5 multi sign redeem script, its program takes the tx over 1KB
+		bytes_t multiSign(1, OP_1 + 2);
+		for (size_t i = 0; i < 5; ++i) {
+			bytes_t pubKey = getRandBytes(33);
+			multiSign.push_back(33);
+			multiSign.insert(multiSign.end(), pubKey.begin(), pubKey.end());
+		}
+		multiSign.push_back(OP_1 + 4);
+		multiSign.push_back(SignTypeMultiSign);
+
+		CoinSelector selector(tx, DEFAULT_FEE_PER_KB, true);
+		uint64_t target = 100000000;
+		UTXOArray candidates, selected;
+		candidates.push_back(createUTXO(target + CoinSelector::CalculateFee(DEFAULT_FEE_PER_KB,
+																			 selector.GetSize() + inputSize + standardSize), 100));
+
+		// enough for a standard input, not for the multi sign one
+		REQUIRE(selector.SelectExactMatch(candidates, std::vector<bytes_t>(1, code), Int128(target), selected));
+		REQUIRE(!selector.SelectExactMatch(candidates, std::vector<bytes_t>(1, multiSign), Int128(target), selected));
+
+		selected.clear();
+		candidates[0] = createUTXO(target + CoinSelector::CalculateFee(DEFAULT_FEE_PER_KB, 2000), 100);
+		REQUIRE(selector.SelectExactMatch(candidates, std::vector<bytes_t>(1, multiSign), Int128(target), selected));
+		selector.AddInput(selected[0], multiSign, "44'/0'/0'/0/0");
+
+		// what CreateTxForOutputs checks before taking the match without change
+		REQUIRE(selector.GetInputAmount() >= Int128(target) + selector.GetFee());
+	}
+}
+
+TEST_CASE("CoinSelector benchmark", "[.benchmark][CoinSelector]") {
+	const size_t total = 50000, spending = 1000;
+	const uint64_t target = 5000000000ull;
+
+	UTXOSet set;
+	std::vector<UTXOPtr> spendingOutputs;
+	UTXOKeySet spendingSet;
+	for (size_t i = 0; i < total; ++i) {
+		UTXOPtr u = createUTXO(getRandUInt32() % 100000000 + 1000, i);
+		set.Add(u, UTXOSet::Normal);
+		if (i % (total / spending) == 0) {
+			spendingOutputs.push_back(u);
+			spendingSet.insert(UTXOKey(u->Hash(), u->Index()));
+		}
+	}
+	bytes_t code = createCode();
+	size_t legacyInputs = 0, inputs = 0, exactInputs = 0;
+
+	// what CreateTxForOutputs used to do: sort every call, linear spending scan, re-estimate after each input
+	BENCHMARK("legacy largest first from " + std::to_string(total)) {
+		TransactionPtr tx = createTx();
+		UTXOArray utxos = set.GetUTXOs(UTXOSet::Normal);
+		std::sort(utxos.begin(), utxos.end(), [](const UTXOPtr &a, const UTXOPtr &b) {
+			return a->Output()->Amount() > b->Output()->Amount();
+		});
+
+		Int128 amount(0);
+		uint64_t fee = 0;
+		size_t txSize = 0;
+		for (UTXOArray::iterator u = utxos.begin(); u != utxos.end(); ++u) {
+			if (amount >= Int128(target) + fee && txSize >= 2000)
+				break;
+
+			bool isSpending = false;
+			for (size_t i = 0; i < spendingOutputs.size() && !isSpending; ++i)
+				isSpending = **u == *spendingOutputs[i];
+			if (isSpending)
+				continue;
+
+			tx->AddInput(InputPtr(new TransactionInput((*u)->Hash(), (*u)->Index())));
+			tx->AddUniqueProgram(ProgramPtr(new Program("44'/0'/0'/0/0", code, bytes_t())));
+			txSize = tx->EstimateSize();
+			amount += (*u)->Output()->Amount();
+			fee = CoinSelector::CalculateFee(DEFAULT_FEE_PER_KB, txSize);
+		}
+		legacyInputs = tx->GetInputs().size();
+	}
+
+	BENCHMARK("largest first from " + std::to_string(total)) {
+		TransactionPtr tx = createTx();
+		CoinSelector selector(tx, DEFAULT_FEE_PER_KB, true);
+		UTXOArray utxos = set.GetUTXOs(UTXOSet::Normal, UTXOSet::AmountDescending);
+
+		for (UTXOArray::iterator u = utxos.begin(); u != utxos.end(); ++u) {
+			if (selector.GetInputAmount() >= Int128(target) + selector.GetFee() && selector.GetSize() >= 2000)
+				break;
+
+			if (spendingSet.find(UTXOKey((*u)->Hash(), (*u)->Index())) != spendingSet.end())
+				continue;
+
+			selector.AddInput(*u, code, "44'/0'/0'/0/0");
+		}
+		inputs = selector.GetInputCount();
+	}
+
+	BENCHMARK("branch and bound from " + std::to_string(total)) {
+		TransactionPtr tx = createTx();
+		CoinSelector selector(tx, DEFAULT_FEE_PER_KB, true);
+		UTXOArray utxos = set.GetUTXOs(UTXOSet::Normal, UTXOSet::AmountDescending), candidates, selected;
+
+		for (UTXOArray::iterator u = utxos.begin(); u != utxos.end(); ++u) {
+			if (spendingSet.find(UTXOKey((*u)->Hash(), (*u)->Index())) == spendingSet.end())
+				candidates.push_back(*u);
+		}
+
+		if (selector.SelectExactMatch(candidates, std::vector<bytes_t>(candidates.size(), code), Int128(target),
+									  selected))
+			exactInputs = selected.size();
+	}
+
+	REQUIRE(legacyInputs == inputs);
+	REQUIRE(inputs > 0);
+	WARN("exact match inputs: " << exactInputs);
+}
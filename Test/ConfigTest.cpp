@@ -34,6 +34,7 @@ TEST_CASE("Config test", "[Config]") {
 			REQUIRE(chainConfig->MinFee() == 10000);
 			REQUIRE(chainConfig->FeePerKB() == 10000);
 			REQUIRE(chainConfig->DisconnectionTime() == 300);
+			REQUIRE(chainConfig->SyncPeers() == 1);
 			REQUIRE(chainConfig->PluginType() == pluginType);
 			REQUIRE(chainConfig->GenesisAddress() == genesisAddress);
 
@@ -9,6 +9,7 @@
 
 #include <SDK/Database/TransactionDataStore.h>
 #include <SDK/Database/DatabaseManager.h>
+#include <SDK/Database/DatabaseWriter.h>
 #include <SDK/SpvService/BackgroundExecutor.h>
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/Log.h>
@@ -440,6 +441,410 @@ TEST_CASE("DatabaseManager test", "[DatabaseManager]") {
 			REQUIRE(0 == readTx.size());
 		}
 
+		SECTION("Transaction hex hash migrate test") {
+			std::string oldFile = "wallet_hex.db";
+			if (boost::filesystem::exists(oldFile))
+				boost::filesystem::remove(oldFile);
+
+			{
+				Sqlite sqlite(oldFile);
+				REQUIRE(sqlite.exec("create table if not exists transactionTable (_id text not null, "
+									"transactionBuff blob, transactionBlockHeight integer, transactionTimeStamp integer, "
+									"transactionRemark text DEFAULT '', assetID text not null, "
+									"transactionISO text DEFAULT 'ELA' );", nullptr, nullptr));
+
+				for (size_t i = 0; i < txToSave.size(); ++i) {
+					sqlite3_stmt *stmt;
+					REQUIRE(sqlite.Prepare("INSERT INTO transactionTable VALUES (?, ?, ?, ?, '', '', ?);", &stmt, nullptr));
+					ByteStream stream;
+					txToSave[i]->Serialize(stream, true);
+					REQUIRE(sqlite.BindText(stmt, 1, txToSave[i]->GetHash().GetHex(), SQLITE_TRANSIENT));
+					REQUIRE(sqlite.BindBlob(stmt, 2, stream.GetBytes(), SQLITE_TRANSIENT));
+					REQUIRE(sqlite.BindInt(stmt, 3, txToSave[i]->GetBlockHeight()));
+					REQUIRE(sqlite.BindInt64(stmt, 4, txToSave[i]->GetTimestamp()));
+					REQUIRE(sqlite.BindText(stmt, 5, ISO, SQLITE_TRANSIENT));
+					REQUIRE(SQLITE_DONE == sqlite.Step(stmt));
+					REQUIRE(sqlite.Finalize(stmt));
+				}
+			}
+
+			DatabaseManager dbm(oldFile);
+			std::vector<TransactionPtr> readTx = dbm.GetAllTransactions();
+			REQUIRE(txToSave.size() == readTx.size());
+			for (int i = 0; i < readTx.size(); ++i) {
+				REQUIRE(readTx[i]->GetHash() == txToSave[i]->GetHash());
+				REQUIRE(readTx[i]->GetBlockHeight() == txToSave[i]->GetBlockHeight());
+			}
+
+			std::vector<uint256> hashes;
+			hashes.push_back(txToSave[0]->GetHash());
+			REQUIRE(dbm.UpdateTransaction(hashes, 1234, 12345678));
+			REQUIRE(dbm.DeleteTxByHash(txToSave[1]->GetHash()));
+
+			readTx = dbm.GetAllTransactions();
+			REQUIRE(txToSave.size() - 1 == readTx.size());
+			REQUIRE(readTx[0]->GetBlockHeight() == 1234);
+			REQUIRE(readTx[1]->GetHash() == txToSave[2]->GetHash());
+
+			boost::filesystem::remove(oldFile);
+		}
+
+	}
+
+}
+
+static TransactionPtr createSyncTx() {
+	TransactionPtr tx(new Transaction());
+
+	InputPtr input(new TransactionInput());
+	input->SetTxHash(getRanduint256());
+	input->SetIndex(getRandUInt16());
+	input->SetSequence(getRandUInt32());
+	tx->AddInput(input);
+	for (size_t i = 0; i < 2; ++i)
+		tx->AddOutput(OutputPtr(new TransactionOutput(getRandUInt32(), Address("EJKPFkAwx7G6dniGMvsb7eG1V8gmhxFU9Z"))));
+	tx->SetBlockHeight(TX_UNCONFIRMED);
+	tx->SetTimestamp(getRandUInt32());
+
+	return tx;
+}
+
+static DatabaseConfig tunedDatabaseConfig(bool asyncWrite) {
+	DatabaseConfig config;
+	config.sqlite.walMode = true;
+	config.sqlite.synchronous = SYNCHRONOUS_NORMAL;
+	config.sqlite.cacheSizeKB = 8 * 1024;
+	config.sqlite.mmapSize = 64 * 1024 * 1024;
+	config.asyncWrite = asyncWrite;
+	return config;
+}
+
+TEST_CASE("DatabaseManager async write test", "[DatabaseManager]") {
+	Log::registerMultiLogger();
+	std::string dbFile = "wallet_async.db";
+	if (boost::filesystem::exists(dbFile))
+		boost::filesystem::remove(dbFile);
+
+	std::vector<TransactionPtr> txns;
+	for (size_t i = 0; i < 100; ++i)
+		txns.push_back(createSyncTx());
+
+	{
+		DatabaseManager dbm(dbFile, tunedDatabaseConfig(true));
+		std::vector<uint256> hashes;
+		for (size_t i = 0; i < txns.size(); ++i) {
+			REQUIRE(dbm.PutTransaction(ISO, txns[i]));
+			hashes.push_back(txns[i]->GetHash());
+		}
+		REQUIRE(dbm.UpdateTransaction(hashes, 100, 12345678));
+		REQUIRE(dbm.DeleteTxByHash(hashes.back()));
+
+		// reads see everything written before them
+		std::vector<TransactionPtr> readTx = dbm.GetAllTransactions();
+		REQUIRE(readTx.size() == txns.size() - 1);
+		for (size_t i = 0; i < readTx.size(); ++i) {
+			REQUIRE(readTx[i]->GetHash() == txns[i]->GetHash());
+			REQUIRE(readTx[i]->GetBlockHeight() == 100);
+		}
+
+		REQUIRE(dbm.PutTransaction(ISO, txns.back()));
+	}
+
+	{
+		// queued writes are committed when the manager goes away
+		DatabaseManager dbm(dbFile);
+		REQUIRE(dbm.GetAllTransactionsCount() == txns.size());
+	}
+
+	boost::filesystem::remove(dbFile);
+}
+
+TEST_CASE("DatabaseManager paged transaction test", "[DatabaseManager]") {
+	Log::registerMultiLogger();
+	std::string dbFile = "wallet_paged.db";
+	if (boost::filesystem::exists(dbFile))
+		boost::filesystem::remove(dbFile);
+
+	Address addrA("EHNyVMorACaza9SThNN27CcZND2Vfkuok2");
+	Address addrB("EHUMByUmSfGvXwgE2kvUfaaL561sQ5GCvQ");
+	Address addrC("EJKPFkAwx7G6dniGMvsb7eG1V8gmhxFU9Z");
+
+	// txns[i] at height i + 1, the even ones pay to addrA, the odd ones spend the one before and pay to addrB
+	std::vector<TransactionPtr> txns;
+	for (size_t i = 0; i < 50; ++i) {
+		TransactionPtr tx(new Transaction());
+		InputPtr input(new TransactionInput());
+		if (i % 2) {
+			input->SetTxHash(txns.back()->GetHash());
+			input->SetIndex(0);
+		} else {
+			input->SetTxHash(getRanduint256());
+			input->SetIndex(getRandUInt16());
+		}
+		tx->AddInput(input);
+		tx->AddOutput(OutputPtr(new TransactionOutput(getRandUInt32(), i % 2 ? addrB : addrA)));
+		tx->AddOutput(OutputPtr(new TransactionOutput(getRandUInt32(), addrC)));
+		tx->GetOutputs()[1]->SetFixedIndex(1);
+		tx->SetBlockHeight(i + 1);
+		tx->SetTimestamp(getRandUInt32());
+		txns.push_back(tx);
+	}
+	txns.back()->SetBlockHeight(TX_UNCONFIRMED);
+
+	{
+		DatabaseManager dbm(dbFile, tunedDatabaseConfig(true));
+		REQUIRE(dbm.PutTransactions(ISO, txns));
+
+		std::vector<TransactionPtr> page = dbm.GetTransactions(0, 10);
+		REQUIRE(page.size() == 10);
+		for (size_t i = 0; i < page.size(); ++i)
+			REQUIRE(page[i]->GetHash() == txns[txns.size() - 1 - i]->GetHash());
+		REQUIRE(page[0]->GetBlockHeight() == TX_UNCONFIRMED);
+
+		page = dbm.GetTransactions(45, 10);
+		REQUIRE(page.size() == 5);
+		REQUIRE(page.back()->GetHash() == txns.front()->GetHash());
+		REQUIRE(dbm.GetTransactions(50, 10).empty());
+
+		// addrA is paid by the even ones and spent by the odd ones
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrA.ProgramHash()) == 50);
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrB.ProgramHash()) == 25);
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrC.ProgramHash()) == 50);
+
+		page = dbm.GetTransactionsByAddress(addrB.ProgramHash(), 5, 10);
+		REQUIRE(page.size() == 10);
+		for (size_t i = 0; i < page.size(); ++i)
+			REQUIRE(page[i]->GetHash() == txns[txns.size() - 1 - 2 * (i + 5)]->GetHash());
+
+		REQUIRE(dbm.GetTransaction(txns[7]->GetHash())->GetHash() == txns[7]->GetHash());
+		REQUIRE(dbm.GetTransaction(getRanduint256()) == nullptr);
+
+		REQUIRE(dbm.DeleteTxByHash(txns[49]->GetHash()));
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrB.ProgramHash()) == 24);
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrA.ProgramHash()) == 49);
+	}
+
+	{
+		// databases written before the address table existed get it filled on open
+		Sqlite sqlite(dbFile);
+		REQUIRE(sqlite.exec("DROP TABLE transactionAddressTable;", nullptr, nullptr));
+	}
+
+	{
+		DatabaseManager dbm(dbFile);
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrA.ProgramHash()) == 49);
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrB.ProgramHash()) == 24);
+
+		REQUIRE(dbm.DeleteAllTransactions());
+		REQUIRE(dbm.GetTransactionsCountByAddress(addrC.ProgramHash()) == 0);
+	}
+
+	boost::filesystem::remove(dbFile);
+}
+
+TEST_CASE("DatabaseManager utxo snapshot test", "[DatabaseManager]") {
+	Log::registerMultiLogger();
+	std::string dbFile = "wallet_snapshot.db";
+	if (boost::filesystem::exists(dbFile))
+		boost::filesystem::remove(dbFile);
+
+	std::vector<TransactionPtr> txns;
+	for (size_t i = 0; i < 10; ++i) {
+		TransactionPtr tx = createSyncTx();
+		tx->SetBlockHeight(i < 9 ? i + 1 : TX_UNCONFIRMED);
+		txns.push_back(tx);
+	}
+
+	UTXOSnapshot snapshot;
+	snapshot.blockHeight = 5;
+	snapshot.blockHash = getRanduint256();
+	for (size_t i = 0; i < 20; ++i) {
+		OutputPtr o(new TransactionOutput(getRandBigInt(), Address(getRandUInt168()), getRanduint256(),
+										  TransactionOutput::Type::VoteOutput));
+		o->SetOutputLock(getRandUInt32());
+		o->SetFixedIndex(getRandUInt16());
+		snapshot.utxos.push_back(UTXOPtr(new UTXO(getRanduint256(), o->FixedIndex(), getRandUInt32(), i + 1, o)));
+	}
+
+	{
+		DatabaseManager dbm(dbFile, tunedDatabaseConfig(true));
+		UTXOSnapshot read;
+		REQUIRE(!dbm.GetUTXOSnapshot(read));
+
+		REQUIRE(dbm.PutTransactions(ISO, txns));
+		REQUIRE(dbm.GetConfirmedTransactionsCount(5) == 5);
+		REQUIRE(dbm.GetConfirmedTransactionsCount(UINT32_MAX - 1) == 9);
+		REQUIRE(dbm.PutUTXOSnapshot(snapshot));
+	}
+
+	{
+		DatabaseManager dbm(dbFile);
+		UTXOSnapshot read;
+		REQUIRE(dbm.GetUTXOSnapshot(read));
+		REQUIRE(read.version == UTXO_SNAPSHOT_VERSION);
+		REQUIRE(read.blockHeight == snapshot.blockHeight);
+		REQUIRE(read.blockHash == snapshot.blockHash);
+		// counted from the stored transactions when it was written
+		REQUIRE(read.txCount == 5);
+		REQUIRE(read.utxos.size() == snapshot.utxos.size());
+
+		std::map<uint256, UTXOPtr> utxos;
+		for (size_t i = 0; i < read.utxos.size(); ++i)
+			utxos[read.utxos[i]->Hash()] = read.utxos[i];
+		for (size_t i = 0; i < snapshot.utxos.size(); ++i) {
+			const UTXOPtr &u = utxos[snapshot.utxos[i]->Hash()];
+			REQUIRE(u != nullptr);
+			REQUIRE(u->Index() == snapshot.utxos[i]->Index());
+			REQUIRE(u->BlockHeight() == snapshot.utxos[i]->BlockHeight());
+			REQUIRE(u->Timestamp() == snapshot.utxos[i]->Timestamp());
+			REQUIRE(u->Output()->Amount() == snapshot.utxos[i]->Output()->Amount());
+			REQUIRE(u->Output()->ProgramHash() == snapshot.utxos[i]->Output()->ProgramHash());
+			REQUIRE(u->Output()->AssetID() == snapshot.utxos[i]->Output()->AssetID());
+			REQUIRE(u->Output()->OutputLock() == snapshot.utxos[i]->Output()->OutputLock());
+			REQUIRE(u->Output()->GetType() == TransactionOutput::Type::VoteOutput);
+			REQUIRE(u->Output()->FixedIndex() == snapshot.utxos[i]->Output()->FixedIndex());
+		}
+
+		// a rescan drops it with the history
+		REQUIRE(dbm.DeleteAllTransactions());
+		REQUIRE(!dbm.GetUTXOSnapshot(read));
+	}
+
+	boost::filesystem::remove(dbFile);
+}
+
+TEST_CASE("Sqlite cached statement test", "[DatabaseManager]") {
+	Log::registerMultiLogger();
+
+	boost::filesystem::remove("statement.db");
+	Sqlite sqlite("statement.db");
+	REQUIRE(sqlite.exec("CREATE TABLE t (v INTEGER); INSERT INTO t VALUES (1); INSERT INTO t VALUES (2);",
+						nullptr, nullptr));
+
+	sqlite3_stmt *raw;
+	REQUIRE(sqlite.PrepareCached("SELECT v FROM t;", &raw));
+
+	// left between two steps by an exception, the statement is reset on the way out
+	try {
+		CachedStatement stmt(raw);
+		REQUIRE(SQLITE_ROW == sqlite.Step(stmt));
+		REQUIRE(sqlite3_stmt_busy(stmt));
+		throw std::runtime_error("read error");
+	} catch (const std::runtime_error &) {
+	}
+	REQUIRE(!sqlite3_stmt_busy(raw));
+
+	CachedStatement stmt, other(raw);
+	REQUIRE(SQLITE_ROW == sqlite.Step(other));
+	stmt = std::move(other);
+	REQUIRE(sqlite3_stmt_busy(stmt));
+	stmt = CachedStatement();
+	REQUIRE(!sqlite3_stmt_busy(raw));
+}
+
+static int countRows(void *arg, int, char **values, char **) {
+	*(int *)arg = atoi(values[0]);
+	return 0;
+}
+
+TEST_CASE("DatabaseWriter rollback test", "[DatabaseManager]") {
+	Log::registerMultiLogger();
+
+	boost::filesystem::remove("writer.db");
+	Sqlite sqlite("writer.db");
+	REQUIRE(sqlite.exec("CREATE TABLE t (v INTEGER);", nullptr, nullptr));
+
+	int rows = -1;
+	{
+		DatabaseWriter writer(&sqlite, 100, 1000);
+		writer.Post([&sqlite]() { return sqlite.exec("INSERT INTO t VALUES (1);", nullptr, nullptr); });
+		writer.Post([]() { return false; });
+		writer.Post([&sqlite]() { return sqlite.exec("INSERT INTO t VALUES (2);", nullptr, nullptr); });
+
+		// one failed job throws the whole batch away, and the flush says so
+		REQUIRE(!writer.Flush());
+		REQUIRE(writer.GetCommitCount() == 0);
+		REQUIRE(sqlite.exec("SELECT COUNT(*) FROM t;", countRows, &rows));
+		REQUIRE(rows == 0);
+
+		writer.Post([&sqlite]() { return sqlite.exec("INSERT INTO t VALUES (3);", nullptr, nullptr); });
+		writer.Post([]() -> bool { throw std::runtime_error("write error"); });
+		writer.Wait();
+		REQUIRE(!writer.Flush());
+
+		// reported once, later batches commit again
+		writer.Post([&sqlite]() { return sqlite.exec("INSERT INTO t VALUES (4);", nullptr, nullptr); });
+		REQUIRE(writer.Flush());
+		REQUIRE(writer.GetCommitCount() == 1);
+
+		writer.Stop();
+		writer.Post([]() { return false; });
+		REQUIRE(!writer.Flush());
+	}
+
+	REQUIRE(sqlite.exec("SELECT v FROM t;", countRows, &rows));
+	REQUIRE(rows == 4);
+	boost::filesystem::remove("writer.db");
+}
+
+TEST_CASE("DatabaseManager sync benchmark", "[.benchmark][DatabaseManager]") {
+	Log::registerMultiLogger();
+	const size_t blockCount = 500, txPerBlock = 4;
+	std::string dbFile = "wallet_bench.db";
+
+	std::vector<MerkleBlockPtr> blocks;
+	std::vector<TransactionPtr> txns;
+	for (size_t i = 0; i < blockCount; ++i) {
+		MerkleBlockPtr block(new MerkleBlock());
+		block->SetHeight(i + 1);
+		block->SetTimestamp(getRandUInt32());
+		block->SetPrevBlockHash(getRanduint256());
+		blocks.push_back(block);
+
+		for (size_t j = 0; j < txPerBlock; ++j)
+			txns.push_back(createSyncTx());
+	}
+
+	// what SpvService does while syncing: a put per relayed tx, an update per block, blocks saved in chunks
+	auto sync = [&](const DatabaseConfig &config) {
+		if (boost::filesystem::exists(dbFile))
+			boost::filesystem::remove(dbFile);
+
+		DatabaseManager dbm(dbFile, config);
+		std::vector<MerkleBlockPtr> chunk;
+		for (size_t i = 0; i < blockCount; ++i) {
+			std::vector<uint256> hashes;
+			for (size_t j = 0; j < txPerBlock; ++j) {
+				dbm.PutTransaction(ISO, txns[i * txPerBlock + j]);
+				hashes.push_back(txns[i * txPerBlock + j]->GetHash());
+			}
+			dbm.UpdateTransaction(hashes, blocks[i]->GetHeight(), blocks[i]->GetTimestamp());
+
+			chunk.push_back(blocks[i]);
+			if (chunk.size() == 100) {
+				dbm.PutMerkleBlocks(ISO, chunk);
+				chunk.clear();
+			}
+		}
+		dbm.flush();
+		return dbm.GetAllTransactionsCount();
+	};
+
+	size_t count = 0;
+	BENCHMARK("sync " + std::to_string(blockCount) + " blocks, rollback journal") {
+		count = sync(DatabaseConfig());
+	}
+	REQUIRE(count == txns.size());
+
+	BENCHMARK("sync " + std::to_string(blockCount) + " blocks, WAL writer disabled") {
+		count = sync(tunedDatabaseConfig(false));
+	}
+	REQUIRE(count == txns.size());
+
+	BENCHMARK("sync " + std::to_string(blockCount) + " blocks, WAL writer enabled") {
+		count = sync(tunedDatabaseConfig(true));
 	}
+	REQUIRE(count == txns.size());
 
+	boost::filesystem::remove(dbFile);
 }
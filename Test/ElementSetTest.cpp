@@ -0,0 +1,154 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Common/ElementSet.h>
+
+#include <boost/shared_ptr.hpp>
+#include <set>
+
+using namespace Elastos::ElaWallet;
+
+class Element {
+public:
+	Element() : _hash(getRanduint256()) {}
+
+	const uint256 &GetHash() const { return _hash; }
+
+private:
+	uint256 _hash;
+};
+
+typedef boost::shared_ptr<Element> ElementPtr;
+
+// The pointer ordered set with linear hash scan which ElementSet used to be, kept as benchmark baseline.
+class LegacyElementSet {
+public:
+	ElementPtr Get(const uint256 &hash) const {
+		std::set<ElementPtr>::const_iterator it;
+		it = std::find_if(_elements.begin(), _elements.end(), [&hash](const ElementPtr &e) {
+			return hash == e->GetHash();
+		});
+
+		if (it == _elements.end())
+			return nullptr;
+
+		return *it;
+	}
+
+	void Insert(const ElementPtr &e) {
+		_elements.insert(e);
+	}
+
+private:
+	std::set<ElementPtr> _elements;
+};
+
+TEST_CASE("ElementSet test", "[ElementSet]") {
+	srand(time(nullptr));
+
+	std::vector<ElementPtr> elements;
+	for (size_t i = 0; i < 1000; ++i)
+		elements.push_back(ElementPtr(new Element()));
+
+	ElementSet<ElementPtr> set;
+	for (size_t i = 0; i < elements.size(); ++i)
+		REQUIRE(set.Insert(elements[i]));
+
+	SECTION("insert, get and contains") {
+		REQUIRE(set.Size() == elements.size());
+		REQUIRE(!set.Insert(elements[0]));
+		REQUIRE(set.Size() == elements.size());
+
+		for (size_t i = 0; i < elements.size(); ++i) {
+			REQUIRE(set.Contains(elements[i]));
+			REQUIRE(set.Contains(elements[i]->GetHash()));
+			REQUIRE(set.Get(elements[i]->GetHash()) == elements[i]);
+		}
+
+		ElementPtr other(new Element());
+		REQUIRE(!set.Contains(other));
+		REQUIRE(set.Get(other->GetHash()) == nullptr);
+	}
+
+	SECTION("remove and iterate in insertion order") {
+		for (size_t i = 0; i < elements.size(); i += 3)
+			set.Remove(elements[i]);
+		REQUIRE(!set.Remove(elements[0]->GetHash()));
+
+		std::vector<ElementPtr> left;
+		for (size_t i = 0; i < elements.size(); ++i) {
+			if (i % 3 == 0) {
+				REQUIRE(!set.Contains(elements[i]));
+			} else {
+				REQUIRE(set.Get(elements[i]->GetHash()) == elements[i]);
+				left.push_back(elements[i]);
+			}
+		}
+		REQUIRE(set.Size() == left.size());
+
+		size_t n = 0;
+		for (ElementSet<ElementPtr>::const_iterator it = set.begin(); it != set.end(); ++it, ++n)
+			REQUIRE(*it == left[n]);
+		REQUIRE(n == left.size());
+
+		// erased elements can be inserted again, and go to the end
+		REQUIRE(set.Insert(elements[0]));
+		REQUIRE(set.Get(elements[0]->GetHash()) == elements[0]);
+		ElementPtr last;
+		for (ElementSet<ElementPtr>::const_iterator it = set.begin(); it != set.end(); ++it)
+			last = *it;
+		REQUIRE(last == elements[0]);
+
+		for (size_t i = 0; i < elements.size(); ++i)
+			set.Remove(elements[i]);
+		REQUIRE(set.Size() == 0);
+		REQUIRE(set.begin() == set.end());
+	}
+}
+
+TEST_CASE("ElementSet benchmark", "[.benchmark][ElementSet]") {
+	const size_t sizes[] = {1000, 10000, 100000};
+	const size_t lookups = 1000;
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		std::vector<ElementPtr> elements;
+		for (size_t i = 0; i < sizes[s]; ++i)
+			elements.push_back(ElementPtr(new Element()));
+
+		ElementSet<ElementPtr> set;
+		LegacyElementSet legacy;
+		size_t found = 0, legacyFound = 0;
+		std::string n = std::to_string(sizes[s]);
+
+		BENCHMARK("ElementSet insert " + n) {
+			for (size_t i = 0; i < elements.size(); ++i)
+				set.Insert(elements[i]);
+		}
+
+		BENCHMARK("Legacy insert " + n) {
+			for (size_t i = 0; i < elements.size(); ++i)
+				legacy.Insert(elements[i]);
+		}
+
+		BENCHMARK("ElementSet " + std::to_string(lookups) + " lookups in " + n) {
+			for (size_t i = 0; i < lookups; ++i)
+				if (set.Get(elements[(i * 7919) % elements.size()]->GetHash()) != nullptr)
+					found++;
+		}
+
+		BENCHMARK("Legacy " + std::to_string(lookups) + " lookups in " + n) {
+			for (size_t i = 0; i < lookups; ++i)
+				if (legacy.Get(elements[(i * 7919) % elements.size()]->GetHash()) != nullptr)
+					legacyFound++;
+		}
+
+		REQUIRE(found == lookups);
+		REQUIRE(legacyFound == lookups);
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Wallet/FilterElementSet.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+TEST_CASE("FilterElementSet test", "[FilterElementSet]") {
+	Log::registerMultiLogger();
+
+	FilterElementSet set;
+	std::vector<bytes_t> data;
+	for (size_t i = 0; i < 10; ++i)
+		data.push_back(getRandBytes(21));
+
+	for (size_t i = 0; i < 5; ++i)
+		REQUIRE(set.Insert(data[i]));
+
+	SECTION("duplicates and empty data are not inserted") {
+		REQUIRE(!set.Insert(data[0]));
+		REQUIRE(!set.Insert(bytes_t()));
+		REQUIRE(set.Size() == 5);
+		REQUIRE(set.Contains(data[4]));
+		REQUIRE(!set.Contains(data[5]));
+	}
+
+	SECTION("elements added since a count") {
+		std::vector<bytes_t> elements;
+		REQUIRE(set.Get(elements, 0) == 5);
+		REQUIRE(elements.size() == 5);
+
+		size_t count = set.Get(elements, 5);
+		REQUIRE(elements.empty());
+
+		for (size_t i = 5; i < data.size(); ++i)
+			set.Insert(data[i]);
+		set.Insert(data[2]);
+
+		REQUIRE(set.Get(elements, count) == data.size());
+		REQUIRE(elements.size() == data.size() - count);
+		for (size_t i = 0; i < elements.size(); ++i)
+			REQUIRE(elements[i] == data[count + i]);
+
+		REQUIRE(set.Get(elements, 100) == data.size());
+		REQUIRE(elements.empty());
+	}
+
+	SECTION("clear") {
+		set.Clear();
+		REQUIRE(set.Size() == 0);
+		REQUIRE(!set.Contains(data[0]));
+		REQUIRE(set.Insert(data[0]));
+	}
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Common/Int128.h>
+#include <SDK/Common/BigInt.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+TEST_CASE("Int128 test", "[Int128]") {
+	Log::registerMultiLogger();
+	srand(time(nullptr));
+
+	SECTION("arithmetic and compare") {
+		Int128 a(5), b(7);
+
+		REQUIRE(a + b == Int128(12));
+		REQUIRE((a - b).isNegative());
+		REQUIRE((a - b).getDec() == "-2");
+		REQUIRE(a - b < Int128(0));
+		REQUIRE(a - b + b == a);
+		REQUIRE(Int128().isZero());
+
+		// carry into the high word and back
+		Int128 max64(UINT64_MAX);
+		Int128 sum = max64 + Int128(1);
+		REQUIRE(sum > max64);
+		REQUIRE(sum.numBytes() == 9);
+		REQUIRE(sum.getDec() == "18446744073709551616");
+		REQUIRE(sum - Int128(1) == max64);
+	}
+
+	SECTION("overflow") {
+		Int128 max;
+		max.setDec("170141183460469231731687303715884105727");
+		REQUIRE(max.getDec() == "170141183460469231731687303715884105727");
+		REQUIRE_THROWS(max + Int128(1));
+
+		Int128 min = Int128(0) - max - Int128(1);
+		REQUIRE(min.getDec() == "-170141183460469231731687303715884105728");
+		REQUIRE_THROWS(min - Int128(1));
+
+		Int128 n;
+		REQUIRE_THROWS(n.setDec("170141183460469231731687303715884105728"));
+		REQUIRE_THROWS(n.setDec("12a"));
+		REQUIRE_THROWS(n.setHexBytes(bytes_t("80000000000000000000000000000000")));
+
+		REQUIRE(!Int128::HexBytesInRange(bytes_t("80000000000000000000000000000000")));
+		REQUIRE(!Int128::HexBytesInRange(bytes_t("0100000000000000000000000000000000")));
+		REQUIRE(!Int128::HexBytesInRange(bytes_t("00000000000000000000000000000080"), true));
+		REQUIRE(Int128::HexBytesInRange(bytes_t("007fffffffffffffffffffffffffffffff")));
+		REQUIRE(Int128::HexBytesInRange(bytes_t("ffffffffffffffffffffffffffffff7f00"), true));
+		REQUIRE(Int128::HexBytesInRange(bytes_t("0000")));
+		REQUIRE(Int128::HexBytesInRange(bytes_t()));
+	}
+
+	SECTION("same as BigInt") {
+		for (size_t i = 0; i < 1000; ++i) {
+			BigInt bn;
+			bn.setHexBytes(getRandBytes(rand() % 15 + 1));
+
+			Int128 n;
+			n.setHexBytes(bn.getHexBytes());
+			REQUIRE(n.getHexBytes() == bn.getHexBytes());
+			REQUIRE(n.getHexBytes(true) == bn.getHexBytes(true));
+			REQUIRE(n.getDec() == bn.getDec());
+			REQUIRE(n.numBytes() == bn.numBytes());
+			REQUIRE(n.getBigInt() == bn);
+			REQUIRE(Int128(bn) == n);
+
+			Int128 dec;
+			dec.setDec(bn.getDec());
+			REQUIRE(dec == n);
+
+			if (bn.numBytes() <= 8)
+				REQUIRE(n.getUint64() == bn.getUint64());
+		}
+
+		REQUIRE(Int128(0).getHexBytes() == BigInt(0).getHexBytes());
+		REQUIRE(Int128(0).getDec() == BigInt(0).getDec());
+		REQUIRE((Int128(3) - Int128(10)).getBigInt() == BigInt(3) - BigInt(10));
+	}
+}
+
+TEST_CASE("Int128 benchmark", "[.benchmark][Int128]") {
+	const size_t count = 100000;
+	std::vector<uint64_t> amounts;
+	for (size_t i = 0; i < count; ++i)
+		amounts.push_back(getRandUInt64() >> 24);
+
+	std::string bnTotal, total;
+
+	BENCHMARK("BigInt sum of " + std::to_string(count)) {
+		BigInt sum(0);
+		for (size_t i = 0; i < amounts.size(); ++i)
+			sum += BigInt(amounts[i]);
+		bnTotal = sum.getDec();
+	}
+
+	BENCHMARK("Int128 sum of " + std::to_string(count)) {
+		Int128 sum;
+		for (size_t i = 0; i < amounts.size(); ++i)
+			sum += amounts[i];
+		total = sum.getDec();
+	}
+
+	REQUIRE(total == bnTotal);
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Common/LruCache.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+TEST_CASE("LruCache test", "[LruCache]") {
+	Log::registerMultiLogger();
+
+	LruCache<int, std::string> cache(3);
+	std::string value;
+
+	cache.Put(1, "a");
+	cache.Put(2, "b");
+	cache.Put(3, "c");
+	REQUIRE(cache.Size() == 3);
+
+	SECTION("least recently used is evicted") {
+		REQUIRE(cache.Get(1, value));
+		REQUIRE(value == "a");
+
+		cache.Put(4, "d");
+		REQUIRE(cache.Size() == 3);
+		REQUIRE(!cache.Get(2, value));
+		REQUIRE(cache.Get(1, value));
+		REQUIRE(cache.Get(3, value));
+		REQUIRE(cache.Get(4, value));
+		REQUIRE(value == "d");
+	}
+
+	SECTION("put existing key updates in place") {
+		cache.Put(1, "x");
+		REQUIRE(cache.Size() == 3);
+		cache.Put(4, "d");
+		REQUIRE(cache.Get(1, value));
+		REQUIRE(value == "x");
+		REQUIRE(!cache.Get(2, value));
+	}
+
+	SECTION("remove and clear") {
+		REQUIRE(cache.Remove(2));
+		REQUIRE(!cache.Remove(2));
+		REQUIRE(cache.Size() == 2);
+		REQUIRE(!cache.Get(2, value));
+
+		cache.Clear();
+		REQUIRE(cache.Size() == 0);
+		REQUIRE(!cache.Get(1, value));
+		REQUIRE(cache.Capacity() == 3);
+	}
+}
@@ -1452,8 +1452,8 @@ TEST_CASE("Wallet GetBalance test", "[GetBalance]") {
 		REQUIRE(dm.GetAllTransactions().size() == txCount);
 
 		//transfer to another address
-		BigInt transferAmount(2005);
-		BigInt totalInput(0);
+		Int128 transferAmount(2005);
+		Int128 totalInput(0);
 		TransactionPtr tx(new Transaction());
 		tx->SetVersion(Transaction::TxVersion::Default);
 		tx->SetLockTime(getRandUInt32());
@@ -1484,7 +1484,7 @@ TEST_CASE("Wallet GetBalance test", "[GetBalance]") {
 				break;
 			}
 		}
-		BigInt fee = totalInput - transferAmount;
+		Int128 fee = totalInput - transferAmount;
 		Address toAddress("Ed8ZSxSB98roeyuRZwwekrnRqcgnfiUDeQ");
 		OutputPtr output(new TransactionOutput(transferAmount, toAddress));
 		tx->AddOutput(output);
@@ -7,6 +7,8 @@
 #include <SDK/Common/ByteStream.h>
 #include <SDK/Common/Utils.h>
 #include <SDK/Common/Log.h>
+#include <SDK/Common/Sha256d.h>
+#include <SDK/Common/hash.h>
 #include <SDK/Plugin/Interface/IMerkleBlock.h>
 #include <SDK/Plugin/Registry.h>
 #include <SDK/Plugin/Block/SidechainMerkleBlock.h>
@@ -19,6 +21,66 @@
 
 using namespace Elastos::ElaWallet;
 
+class RootMerkleBlock : public MerkleBlock {
+public:
+	using MerkleBlockBase::MerkleBlockRoot;
+};
+
+static size_t treeWidth(size_t txCount, int height) {
+	return (txCount + (1 << height) - 1) >> height;
+}
+
+static int treeHeight(size_t txCount) {
+	int height = 0;
+	while (treeWidth(txCount, height) > 1)
+		height++;
+	return height;
+}
+
+static uint256 treeHash(const std::vector<uint256> &txids, int height, size_t pos) {
+	if (height == 0)
+		return txids[pos];
+
+	uint256 left = treeHash(txids, height - 1, pos * 2), right = left;
+	if (pos * 2 + 1 < treeWidth(txids.size(), height - 1))
+		right = treeHash(txids, height - 1, pos * 2 + 1);
+
+	bytes_t pair(left.begin(), left.size());
+	pair += bytes_t(right.begin(), right.size());
+	return uint256(sha256_2(pair));
+}
+
+// the partial merkle tree a full node sends for the matched transactions, see bitcoin's CPartialMerkleTree
+static void buildPartialTree(const std::vector<uint256> &txids, const std::vector<bool> &matches, int height,
+							 size_t pos, std::vector<bool> &bits, std::vector<uint256> &hashes) {
+	bool parentOfMatch = false;
+	for (size_t p = pos << height; p < ((pos + 1) << height) && p < txids.size(); ++p)
+		parentOfMatch = parentOfMatch || matches[p];
+	bits.push_back(parentOfMatch);
+
+	if (height == 0 || !parentOfMatch) {
+		hashes.push_back(treeHash(txids, height, pos));
+	} else {
+		buildPartialTree(txids, matches, height - 1, pos * 2, bits, hashes);
+		if (pos * 2 + 1 < treeWidth(txids.size(), height - 1))
+			buildPartialTree(txids, matches, height - 1, pos * 2 + 1, bits, hashes);
+	}
+}
+
+static void setPartialTree(RootMerkleBlock &block, const std::vector<uint256> &txids, const std::vector<bool> &matches) {
+	std::vector<bool> bits;
+	std::vector<uint256> hashes;
+	buildPartialTree(txids, matches, treeHeight(txids.size()), 0, bits, hashes);
+
+	bytes_t flags((bits.size() + 7) / 8, 0);
+	for (size_t i = 0; i < bits.size(); ++i)
+		flags[i / 8] |= (uint8_t) (bits[i] << (i % 8));
+
+	block.SetTransactionCount((uint32_t) txids.size());
+	block.SetHashes(hashes);
+	block.SetFlags(flags);
+}
+
 TEST_CASE("MerkleBlock construct test", "[MerkleBlock]") {
 	Log::registerMultiLogger();
 
@@ -43,4 +105,87 @@ TEST_CASE("MerkleBlock construct test", "[MerkleBlock]") {
 
 		verifyELAMerkleBlock(static_cast<const MerkleBlock &>(*merkleBlock), mb);
 	}
+
+	SECTION("serialize and deserialize header") {
+		MerkleBlockPtr merkleBlock = Registry::Instance()->CreateMerkleBlock("ELA");
+		REQUIRE(merkleBlock != nullptr);
+		setMerkleBlockValues(static_cast<MerkleBlock *>(merkleBlock.get()));
+
+		ByteStream stream;
+		merkleBlock->SerializeHeader(stream);
+		merkleBlock->SerializeHeader(stream);
+
+		for (int i = 0; i < 2; ++i) {
+			MerkleBlock header;
+			REQUIRE(header.DeserializeHeader(stream));
+			REQUIRE(header.GetHash() == merkleBlock->GetHash());
+			REQUIRE(header.GetPrevBlockHash() == merkleBlock->GetPrevBlockHash());
+			REQUIRE(header.GetTimestamp() == merkleBlock->GetTimestamp());
+			REQUIRE(header.GetTarget() == merkleBlock->GetTarget());
+			REQUIRE(header.GetHeight() == merkleBlock->GetHeight());
+			REQUIRE(header.GetTransactionCount() == 0);
+		}
+		REQUIRE(!MerkleBlock().DeserializeHeader(stream));
+
+		// the trailing tx count byte is part of the header
+		ByteStream one;
+		merkleBlock->SerializeHeader(one);
+		bytes_t truncated = one.GetBytes();
+		truncated.pop_back();
+		ByteStream cut(truncated);
+		REQUIRE(!MerkleBlock().DeserializeHeader(cut));
+	}
+}
+
+TEST_CASE("MerkleBlock root test", "[MerkleBlock]") {
+	Log::registerMultiLogger();
+
+	Sha256d::Kernel defaultKernel = Sha256d::GetKernel();
+	const Sha256d::Kernel kernels[] = {Sha256d::KernelPortable, Sha256d::KernelAvx2, Sha256d::KernelShaNi};
+
+	for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+		if (!Sha256d::SetKernel(kernels[k]))
+			continue;
+
+		// rows of every width, odd ones have their last node paired with itself
+		for (size_t count = 1; count <= 70; ++count) {
+			std::vector<uint256> txids;
+			std::vector<bool> matches;
+			for (size_t i = 0; i < count; ++i) {
+				txids.push_back(getRanduint256());
+				matches.push_back(getRandUInt32() % 4 == 0 || (count < 5 && i == count - 1));
+			}
+
+			RootMerkleBlock block;
+			setPartialTree(block, txids, matches);
+			REQUIRE(block.MerkleBlockRoot() == treeHash(txids, treeHeight(count), 0));
+
+			std::vector<uint256> txHashes;
+			block.MerkleBlockTxHashes(txHashes);
+			for (size_t i = 0, m = 0; i < count; ++i) {
+				if (matches[i])
+					REQUIRE(txHashes[m++] == txids[i]);
+			}
+		}
+
+		// CVE-2012-2459, a duplicated pair in an even row is rejected
+		std::vector<uint256> txids;
+		for (size_t i = 0; i < 6; ++i)
+			txids.push_back(getRanduint256());
+		txids[5] = txids[4];
+		RootMerkleBlock block;
+		setPartialTree(block, txids, std::vector<bool>(6, true));
+		REQUIRE(block.MerkleBlockRoot() == uint256());
+
+		// a hash short
+		txids[5] = getRanduint256();
+		setPartialTree(block, txids, std::vector<bool>(6, true));
+		REQUIRE(block.MerkleBlockRoot() == treeHash(txids, treeHeight(txids.size()), 0));
+		std::vector<uint256> hashes = block.GetHashes();
+		hashes.pop_back();
+		block.SetHashes(hashes);
+		REQUIRE(block.MerkleBlockRoot() != treeHash(txids, treeHeight(txids.size()), 0));
+	}
+
+	REQUIRE(Sha256d::SetKernel(defaultKernel));
 }
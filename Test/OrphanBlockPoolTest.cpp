@@ -0,0 +1,111 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/P2P/OrphanBlockPool.h>
+#include <SDK/Plugin/Block/MerkleBlock.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+static std::vector<MerkleBlockPtr> createChain(size_t count) {
+	std::vector<MerkleBlockPtr> chain;
+	uint256 prev;
+	for (size_t i = 0; i < count; ++i) {
+		MerkleBlockPtr block(new MerkleBlock());
+		block->SetHash(getRanduint256());
+		block->SetPrevBlockHash(prev);
+		block->SetHeight(i + 1);
+		prev = block->GetHash();
+		chain.push_back(block);
+	}
+	return chain;
+}
+
+TEST_CASE("OrphanBlockPool test", "[OrphanBlockPool]") {
+	Log::registerMultiLogger();
+
+	std::vector<MerkleBlockPtr> chain = createChain(10);
+	OrphanBlockPool pool(5);
+
+	SECTION("children are taken by previous block hash") {
+		for (size_t i = chain.size(); i > 5; --i)
+			pool.Insert(chain[i - 1]);
+		REQUIRE(pool.Size() == 5);
+
+		MerkleBlockPtr block = chain[4];
+		for (size_t i = 5; i < chain.size(); ++i) {
+			block = pool.TakeChild(block->GetHash());
+			REQUIRE(block == chain[i]);
+		}
+		REQUIRE(pool.TakeChild(block->GetHash()) == nullptr);
+		REQUIRE(pool.Size() == 0);
+	}
+
+	SECTION("forks share a previous block") {
+		MerkleBlockPtr fork(new MerkleBlock());
+		fork->SetHash(getRanduint256());
+		fork->SetPrevBlockHash(chain[2]->GetHash());
+		fork->SetHeight(4);
+
+		pool.Insert(chain[3]);
+		pool.Insert(fork);
+		REQUIRE(pool.Remove(fork->GetHash()));
+		REQUIRE(!pool.Remove(fork->GetHash()));
+		REQUIRE(pool.TakeChild(chain[2]->GetHash()) == chain[3]);
+		REQUIRE(pool.TakeChild(chain[2]->GetHash()) == nullptr);
+	}
+
+	SECTION("least recently relayed orphans are evicted") {
+		for (size_t i = 0; i < 5; ++i)
+			pool.Insert(chain[i]);
+		pool.Insert(chain[0]); // relayed again
+		pool.Insert(chain[5]);
+
+		REQUIRE(pool.Size() == 5);
+		REQUIRE(pool.Contains(chain[0]->GetHash()));
+		REQUIRE(!pool.Contains(chain[1]->GetHash()));
+		REQUIRE(pool.TakeChild(chain[0]->GetHash()) == nullptr);
+		REQUIRE(pool.TakeChild(chain[4]->GetHash()) == chain[5]);
+	}
+
+	SECTION("prune below height") {
+		for (size_t i = 0; i < 5; ++i)
+			pool.Insert(chain[i]);
+
+		REQUIRE(pool.Prune(3) == 2);
+		REQUIRE(!pool.Contains(chain[0]->GetHash()));
+		REQUIRE(!pool.Contains(chain[1]->GetHash()));
+		REQUIRE(pool.Contains(chain[2]->GetHash()));
+		REQUIRE(pool.Prune(3) == 0);
+
+		pool.Clear();
+		REQUIRE(pool.Size() == 0);
+		REQUIRE(pool.TakeChild(chain[2]->GetHash()) == nullptr);
+	}
+}
+
+TEST_CASE("OrphanBlockPool connect benchmark", "[.benchmark][OrphanBlockPool]") {
+	const size_t total = 100000;
+	std::vector<MerkleBlockPtr> chain = createChain(total + 1);
+	OrphanBlockPool pool(total);
+
+	// a rescan relaying the whole run backwards, every block but the first waits as an orphan
+	size_t connected = 0;
+	BENCHMARK("connect " + std::to_string(total) + " orphans") {
+		for (size_t i = total; i > 0; --i)
+			pool.Insert(chain[i]);
+
+		for (MerkleBlockPtr next = pool.TakeChild(chain[0]->GetHash()); next != nullptr;
+			 next = pool.TakeChild(next->GetHash()))
+			connected++;
+	}
+
+	REQUIRE(connected == total);
+	REQUIRE(pool.Size() == 0);
+}
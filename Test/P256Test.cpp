@@ -0,0 +1,322 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/WalletCore/BIPs/P256.h>
+#include <SDK/WalletCore/BIPs/Key.h>
+#include <SDK/WalletCore/BIPs/HDKeychain.h>
+#include <SDK/Common/uchar_vector.h>
+#include <SDK/Common/hash.h>
+#include <SDK/Common/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace Elastos::ElaWallet;
+
+class BackendGuard {
+public:
+	explicit BackendGuard(Key::Backend backend) : _backend(Key::GetBackend()) {
+		Key::SetBackend(backend);
+	}
+
+	~BackendGuard() {
+		Key::SetBackend(_backend);
+	}
+
+private:
+	Key::Backend _backend;
+};
+
+static bytes_t nativePubKey(const bytes_t &prvKey) {
+	P256::PublicKey pubKey;
+	REQUIRE(P256::DerivePubKey(pubKey, &prvKey[0]));
+	bytes_t result(33);
+	P256::SerializePubKey(&result[0], pubKey);
+	return result;
+}
+
+static bytes_t opensslPubKey(const bytes_t &prvKey) {
+	secp256k1_key key;
+	REQUIRE(key.setPrivKey(prvKey) != nullptr);
+	return key.getPubKey();
+}
+
+// Welch's t statistic of op's timings for a fixed degenerate secret against random secrets, as dudect does: the
+// inputs are prepared up front, the two classes interleaved at random and the slowest tenth cropped. |t| > 10 means
+// the timing depends on the secret beyond doubt, a constant time op stays within a few units.
+template <class Op>
+static double timingLeakage(Op op, const bytes_t &fixed, size_t rounds) {
+	std::vector<int> classes(rounds);
+	std::vector<bytes_t> secrets(rounds);
+	for (size_t i = 0; i < rounds; ++i) {
+		classes[i] = getRandUInt32() & 1;
+		secrets[i] = classes[i] == 0 ? fixed : getRandBytes(32);
+	}
+
+	std::vector<double> timings[2];
+	for (size_t i = 0; i < rounds; ++i) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		op(secrets[i]);
+		double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		timings[classes[i]].push_back(elapsed);
+	}
+
+	std::vector<double> all(timings[0]);
+	all.insert(all.end(), timings[1].begin(), timings[1].end());
+	std::sort(all.begin(), all.end());
+	double crop = all[all.size() * 9 / 10];
+
+	double mean[2], var[2], n[2];
+	for (int c = 0; c < 2; ++c) {
+		std::vector<double> t;
+		for (size_t i = 0; i < timings[c].size(); ++i)
+			if (timings[c][i] <= crop)
+				t.push_back(timings[c][i]);
+
+		n[c] = t.size();
+		mean[c] = var[c] = 0;
+		for (size_t i = 0; i < t.size(); ++i)
+			mean[c] += t[i] / n[c];
+		for (size_t i = 0; i < t.size(); ++i)
+			var[c] += (t[i] - mean[c]) * (t[i] - mean[c]) / (n[c] - 1);
+	}
+
+	return (mean[0] - mean[1]) / std::sqrt(var[0] / n[0] + var[1] / n[1]);
+}
+
+TEST_CASE("P256 test", "[P256]") {
+	Log::registerMultiLogger();
+
+	REQUIRE(P256::Supported());
+
+	SECTION("RFC 6979 A.2.5, P-256 with SHA-256") {
+		bytes_t prvKey = uchar_vector("C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721");
+		uint256 digest(sha256(bytes_t("sample", 6)));
+
+		bytes_t pubKey = nativePubKey(prvKey);
+		REQUIRE(uchar_vector(bytes_t(pubKey.begin() + 1, pubKey.end())).getHex() ==
+				"60fed4ba255a9d31c961eb74c6356d68c049b8923b61fa6ce669622e60f29fb6");
+
+		bytes_t signature(64);
+		REQUIRE(P256::Sign(&signature[0], &prvKey[0], digest.begin()));
+		REQUIRE(uchar_vector(signature).getHex() ==
+				"efd48b2aacb6a8fd1140dd9cd45e81d69d2c877b56aaf991c34d0ea84eaf3716"
+				"f7cb1c942d657c41d436c7a1b6e29f65f3e900dbb9aff4064dc4ab2f843acda8");
+	}
+
+	SECTION("RFC 6979 A.2.5, message test") {
+		bytes_t prvKey = uchar_vector("C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721");
+		uint256 digest(sha256(bytes_t("test", 4)));
+
+		bytes_t signature(64);
+		REQUIRE(P256::Sign(&signature[0], &prvKey[0], digest.begin()));
+		REQUIRE(uchar_vector(signature).getHex() ==
+				"f1abb023518351cd71d881567b1ea663ed3efcf6c5132b354f28d3b0b7d38367"
+				"019f4113742a2b14bd25926b49c649155f267e60d3814b4c0cc84250e46f0083");
+	}
+
+	SECTION("vectors cross-checked against secp256k1_openssl") {
+		// edge scalars: small, single bits, all window digits set, and the top of the range
+		const char *scalars[] = {
+			"0000000000000000000000000000000000000000000000000000000000000001",
+			"0000000000000000000000000000000000000000000000000000000000000002",
+			"0000000000000000000000000000000000000000000000000000000000000003",
+			"0000000000000000000000000000000000000000000000000000000000000010",
+			"0000000000000000000000000000000100000000000000000000000000000000",
+			"8000000000000000000000000000000000000000000000000000000000000000",
+			"7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF",
+			"FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC63254F",
+			"FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632550",
+			"C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721",
+		};
+
+		for (size_t i = 0; i < sizeof(scalars) / sizeof(scalars[0]); ++i) {
+			INFO("scalar " << scalars[i]);
+			bytes_t prvKey = uchar_vector(scalars[i]);
+			bytes_t pubKey = nativePubKey(prvKey);
+			REQUIRE(pubKey == opensslPubKey(prvKey));
+
+			// the public half of BIP32 child derivation, the way HDKeychain does it with OpenSSL
+			bytes_t tweak = uchar_vector(scalars[(i + 3) % (sizeof(scalars) / sizeof(scalars[0]))]);
+			secp256k1_point expected;
+			expected.bytes(pubKey);
+			expected.generator_mul(tweak);
+
+			P256::PublicKey K;
+			REQUIRE(P256::ParsePubKey(K, &pubKey[0], pubKey.size()));
+			REQUIRE(P256::TweakAddPubKey(K, &tweak[0]));
+			bytes_t tweaked(33);
+			P256::SerializePubKey(&tweaked[0], K);
+			REQUIRE(tweaked == expected.bytes());
+
+			Key key;
+			REQUIRE(key.SetPrvKey(prvKey));
+			uint256 digest(sha256(prvKey));
+			bytes_t signature(64);
+			REQUIRE(P256::Sign(&signature[0], &prvKey[0], digest.begin()));
+			REQUIRE(key.Verify(digest, signature));
+		}
+
+		REQUIRE(uchar_vector(nativePubKey(uchar_vector(scalars[0]))).getHex() ==
+				"036b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296");
+		REQUIRE(uchar_vector(nativePubKey(uchar_vector(scalars[8]))).getHex() ==
+				"026b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296");
+	}
+
+	SECTION("agrees with OpenSSL") {
+		for (int i = 0; i < 50; ++i) {
+			Key key;
+			bytes_t prvKey = getRandBytes(32);
+			REQUIRE(key.SetPrvKey(prvKey));
+			REQUIRE(nativePubKey(prvKey) == key.PubKey());
+
+			P256::PublicKey pubKey, uncompressed;
+			bytes_t compressed = key.PubKey();
+			REQUIRE(P256::ParsePubKey(pubKey, &compressed[0], compressed.size()));
+			bytes_t full = key.PubKey(false);
+			REQUIRE(P256::ParsePubKey(uncompressed, &full[0], full.size()));
+			REQUIRE(memcmp(&pubKey, &uncompressed, sizeof(pubKey)) == 0);
+
+			uint256 digest(getRandBytes(32));
+			bytes_t signature(64);
+			REQUIRE(P256::Sign(&signature[0], &prvKey[0], digest.begin()));
+			REQUIRE(key.Verify(digest, signature));
+			REQUIRE(P256::Verify(pubKey, digest.begin(), &signature[0]));
+
+			signature = key.Sign(digest);
+			REQUIRE(P256::Verify(pubKey, digest.begin(), &signature[0]));
+
+			signature[i % 64] ^= 0x10;
+			REQUIRE(!P256::Verify(pubKey, digest.begin(), &signature[0]));
+			signature[i % 64] ^= 0x10;
+			digest.begin()[i % 32] ^= 1;
+			REQUIRE(!P256::Verify(pubKey, digest.begin(), &signature[0]));
+		}
+	}
+
+	SECTION("invalid input") {
+		P256::PublicKey pubKey;
+		bytes_t zero(32, 0), order = uchar_vector("FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551");
+		REQUIRE(!P256::DerivePubKey(pubKey, &zero[0]));
+		REQUIRE(!P256::DerivePubKey(pubKey, &order[0]));
+
+		uint8_t signature[64];
+		uint256 digest(getRandBytes(32));
+		REQUIRE(!P256::Sign(signature, &order[0], digest.begin()));
+
+		Key key;
+		key.SetPrvKey(getRandBytes(32));
+		bytes_t encoded = key.PubKey(false);
+		encoded[64] ^= 1;
+		REQUIRE(!P256::ParsePubKey(pubKey, &encoded[0], encoded.size()));
+		REQUIRE(!P256::ParsePubKey(pubKey, &encoded[0], 33));
+
+		// x = p
+		encoded = uchar_vector("02FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF");
+		REQUIRE(!P256::ParsePubKey(pubKey, &encoded[0], encoded.size()));
+
+		encoded = key.PubKey();
+		REQUIRE(P256::ParsePubKey(pubKey, &encoded[0], encoded.size()));
+		bytes_t serialized(33);
+		P256::SerializePubKey(&serialized[0], pubKey);
+		REQUIRE(serialized == encoded);
+
+		// r and s out of range
+		memset(signature, 0, sizeof(signature));
+		REQUIRE(!P256::Verify(pubKey, digest.begin(), signature));
+		memcpy(signature, &order[0], 32);
+		memcpy(signature + 32, &order[0], 32);
+		REQUIRE(!P256::Verify(pubKey, digest.begin(), signature));
+	}
+
+	SECTION("Key with the native backend") {
+		bytes_t seed = getRandBytes(64);
+		HDKeychain openssl = HDKeychain(HDSeed(seed).getExtendedKey(true)).getChild("44'/0'/0'/0/0");
+
+		BackendGuard guard(Key::BackendNative);
+		HDKeychain native = HDKeychain(HDSeed(seed).getExtendedKey(true)).getChild("44'/0'/0'/0/0");
+		REQUIRE(native.pubkey() == openssl.pubkey());
+		REQUIRE(native.getPublic().getChild(3).pubkey() == openssl.getPublic().getChild(3).pubkey());
+
+		Key signer(native), verifier;
+		verifier.SetPubKey(native.pubkey());
+		for (int i = 0; i < 10; ++i) {
+			std::string message = getRandString(100);
+			bytes_t signature = signer.Sign(message);
+			REQUIRE(verifier.Verify(message, signature));
+			REQUIRE(Key(openssl).Verify(message, signature));
+			signature[5] ^= 1;
+			REQUIRE(!verifier.Verify(message, signature));
+		}
+	}
+}
+
+TEST_CASE("P256 constant time", "[P256]") {
+	Log::registerMultiLogger();
+
+	// a scalar of all zero windows but the last is where a variable time ladder or table walk shows the most
+	const bytes_t one = uchar_vector("0000000000000000000000000000000000000000000000000000000000000001");
+	uint256 digest(getRandBytes(32));
+
+	double derive = timingLeakage([](const bytes_t &prvKey) {
+		P256::PublicKey pubKey;
+		P256::DerivePubKey(pubKey, &prvKey[0]);
+	}, one, 20000);
+	WARN("DerivePubKey t = " << derive);
+	REQUIRE(std::fabs(derive) < 10);
+
+	double sign = timingLeakage([&digest](const bytes_t &prvKey) {
+		uint8_t signature[64];
+		P256::Sign(signature, &prvKey[0], digest.begin());
+	}, one, 20000);
+	WARN("Sign t = " << sign);
+	REQUIRE(std::fabs(sign) < 10);
+}
+
+TEST_CASE("P256 benchmark", "[.benchmark][P256]") {
+	Log::registerMultiLogger();
+
+	Key key;
+	key.SetPrvKey(getRandBytes(32));
+	bytes_t prvKey = key.PrvKey(), pubKey = key.PubKey();
+	std::vector<uint256> digests;
+	for (int i = 0; i < 100; ++i)
+		digests.push_back(uint256(getRandBytes(32)));
+
+	std::vector<bytes_t> signatures(digests.size());
+	size_t count = 0;
+	Key::Backend backends[] = {Key::BackendOpenSSL, Key::BackendNative};
+	const char *names[] = {"openssl", "native"};
+
+	for (int b = 0; b < 2; ++b) {
+		BackendGuard guard(backends[b]);
+		Key signer, verifier;
+		signer.SetPrvKey(prvKey);
+		verifier.SetPubKey(pubKey);
+		HDKeychain keychain(prvKey, getRandBytes(32));
+
+		BENCHMARK(std::string(names[b]) + " sign, 100 digests") {
+			for (size_t i = 0; i < digests.size(); ++i)
+				signatures[i] = signer.Sign(digests[i]);
+		}
+
+		BENCHMARK(std::string(names[b]) + " verify, 100 signatures") {
+			for (size_t i = 0; i < digests.size(); ++i)
+				count += verifier.Verify(digests[i], signatures[i]) ? 1 : 0;
+		}
+
+		BENCHMARK(std::string(names[b]) + " derive, 100 child keys") {
+			for (uint32_t i = 0; i < 100; ++i)
+				count += keychain.getChild(i).pubkey().size() == 33 ? 1 : 0;
+		}
+	}
+
+	REQUIRE(count == 2 * 2 * digests.size());
+}
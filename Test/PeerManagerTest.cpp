@@ -0,0 +1,207 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Account/Account.h>
+#include <SDK/Account/SubAccount.h>
+#include <SDK/Common/Log.h>
+#include <SDK/P2P/ChainParams.h>
+#include <SDK/P2P/Peer.h>
+#include <SDK/P2P/PeerManager.h>
+#include <SDK/Plugin/Block/MerkleBlock.h>
+#include <SDK/Wallet/Wallet.h>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+using namespace Elastos::ElaWallet;
+
+class NullListener : public PeerManager::Listener {
+public:
+	virtual void syncStarted() {}
+
+	virtual void syncProgress(uint32_t currentHeight, uint32_t estimateHeight, time_t lastBlockTime) {}
+
+	virtual void syncStopped(const std::string &error) {}
+
+	virtual void txStatusUpdate() {}
+
+	virtual void saveBlocks(bool replace, const std::vector<MerkleBlockPtr> &blocks) {}
+
+	virtual void savePeers(bool replace, const std::vector<PeerInfo> &peers) {}
+
+	virtual bool networkIsReachable() { return true; }
+
+	virtual void txPublished(const std::string &hash, const nlohmann::json &result) {}
+
+	virtual void connectStatusChanged(const std::string &status) {}
+};
+
+TEST_CASE("PeerManager concurrent readers", "[PeerManager]") {
+	Log::registerMultiLogger();
+
+	const uint32_t total = 2000;
+	const size_t readers = 4;
+	time_t now = time(nullptr);
+
+	std::string mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+	LocalStorePtr localstore(new LocalStore("./Data/readers", mnemonic, "", false, "12345678"));
+	AccountPtr account(new Account(localstore));
+	SubAccountPtr subAccount(new SubAccount(account, 0));
+	boost::shared_ptr<Wallet::Listener> walletListener;
+	WalletPtr wallet(new Wallet(0, "readers", {}, {}, {}, subAccount, walletListener));
+
+	MerkleBlockPtr genesis(new MerkleBlock());
+	genesis->SetHash(getRanduint256());
+	genesis->SetHeight(0);
+	genesis->SetTimestamp(now - 60 * 24 * 60 * 60);
+
+	std::vector<MerkleBlockPtr> headers;
+	MerkleBlockPtr prev = genesis;
+	for (uint32_t i = 0; i < total; ++i) {
+		MerkleBlockPtr block(new MerkleBlock());
+		block->SetHash(getRanduint256());
+		block->SetPrevBlockHash(prev->GetHash());
+		block->SetTimestamp(prev->GetTimestamp() + 120);
+		headers.push_back(block);
+		prev = block;
+	}
+
+	ChainParamsPtr params(new ChainParams());
+	boost::shared_ptr<PeerManager::Listener> listener(new NullListener());
+	PeerManager pm(params, wallet, now, 0, {genesis}, {}, listener, "ELA");
+
+	PeerPtr peer(new Peer(&pm, 0));
+	peer->InitDefaultMessages();
+	peer->SetServices(SERVICES_NODE_NETWORK);
+	peer->SetLastBlock(total);
+	peer->SetConnectStatus(Peer::Connected);
+	pm.OnConnected(peer);
+	REQUIRE(pm.GetDownloadPeer() == peer);
+
+	// every reader checks that what it sees only moves forward and matches the chain being relayed
+	const size_t peerCount = pm.GetPeerCount();
+	const Peer::ConnectStatus status = pm.GetConnectStatus();
+	boost::atomic<bool> done(false);
+	boost::atomic<uint64_t> polls(0), errors(0);
+	std::vector<boost::shared_ptr<boost::thread>> threads;
+	for (size_t i = 0; i < readers; ++i) {
+		threads.push_back(boost::shared_ptr<boost::thread>(new boost::thread([&]() {
+			uint32_t lastHeight = 0;
+			while (!done) {
+				uint32_t height = pm.GetLastBlockHeight();
+				double progress = pm.GetSyncProgress(0);
+				uint256 hash;
+
+				if (height < lastHeight || height > total)
+					errors++;
+				if (progress < 0.0 || progress > 1.0)
+					errors++;
+				if (pm.GetPeerCount() != peerCount || pm.GetDownloadPeer() != peer || pm.GetConnectStatus() != status)
+					errors++;
+				if (height > 0 && (!pm.GetMainChainBlockHash(height, hash) || hash != headers[height - 1]->GetHash()))
+					errors++;
+
+				lastHeight = height;
+				polls++;
+			}
+		})));
+	}
+
+	for (uint32_t i = 0; i < total; ++i)
+		pm.OnRelayedBlock(peer, headers[i]);
+
+	// let the readers see the tip too
+	uint64_t target = polls + readers;
+	while (polls < target)
+		boost::this_thread::yield();
+
+	done = true;
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i]->join();
+
+	REQUIRE(errors == 0);
+	REQUIRE(pm.GetLastBlockHeight() == total);
+	REQUIRE(pm.GetSyncProgress(0) == 1.0);
+	peer->SetConnectStatus(Peer::Disconnected);
+}
+
+TEST_CASE("PeerManager lock contention benchmark", "[.benchmark][PeerManager]") {
+	Log::registerMultiLogger();
+
+	const uint32_t total = 20000;
+	const size_t readers = 4;
+	time_t now = time(nullptr);
+
+	std::string mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+	LocalStorePtr localstore(new LocalStore("./Data/contention", mnemonic, "", false, "12345678"));
+	AccountPtr account(new Account(localstore));
+	SubAccountPtr subAccount(new SubAccount(account, 0));
+	boost::shared_ptr<Wallet::Listener> walletListener;
+	WalletPtr wallet(new Wallet(0, "contention", {}, {}, {}, subAccount, walletListener));
+
+	// headers of the last two months, a week older than the earliest key time
+	MerkleBlockPtr genesis(new MerkleBlock());
+	genesis->SetHash(getRanduint256());
+	genesis->SetHeight(0);
+	genesis->SetTimestamp(now - 60 * 24 * 60 * 60);
+
+	std::vector<MerkleBlockPtr> headers;
+	MerkleBlockPtr prev = genesis;
+	for (uint32_t i = 0; i < total; ++i) {
+		MerkleBlockPtr block(new MerkleBlock());
+		block->SetHash(getRanduint256());
+		block->SetPrevBlockHash(prev->GetHash());
+		block->SetTimestamp(prev->GetTimestamp() + 120);
+		headers.push_back(block);
+		prev = block;
+	}
+
+	ChainParamsPtr params(new ChainParams());
+	boost::shared_ptr<PeerManager::Listener> listener(new NullListener());
+	PeerManager pm(params, wallet, now, 0, {genesis}, {}, listener, "ELA");
+
+	PeerPtr peer(new Peer(&pm, 0));
+	peer->InitDefaultMessages();
+	peer->SetServices(SERVICES_NODE_NETWORK);
+	peer->SetLastBlock(total);
+	peer->SetConnectStatus(Peer::Connected);
+	pm.OnConnected(peer);
+	REQUIRE(pm.GetDownloadPeer() == peer);
+
+	// wallet UIs poll the sync state while the headers come in
+	boost::atomic<bool> done(false);
+	boost::atomic<uint64_t> polls(0);
+	std::vector<boost::shared_ptr<boost::thread>> threads;
+	for (size_t i = 0; i < readers; ++i) {
+		threads.push_back(boost::shared_ptr<boost::thread>(new boost::thread([&pm, &done, &polls]() {
+			while (!done) {
+				pm.GetSyncProgress(0);
+				pm.GetLastBlockHeight();
+				pm.GetEstimatedBlockHeight();
+				pm.GetPeerCount();
+				pm.GetConnectStatus();
+				polls++;
+			}
+		})));
+	}
+
+	BENCHMARK("relay " + std::to_string(total) + " headers, " + std::to_string(readers) + " polling threads") {
+		for (uint32_t i = 0; i < total; ++i)
+			pm.OnRelayedBlock(peer, headers[i]);
+	}
+
+	done = true;
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i]->join();
+
+	WARN("sync state polled " << polls << " times");
+	REQUIRE(pm.GetLastBlockHeight() == total);
+	REQUIRE(pm.GetSyncProgress(0) == 1.0);
+	peer->SetConnectStatus(Peer::Disconnected);
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/P2P/TimerWheel.h>
+#include <SDK/P2P/PeerReactor.h>
+#include <SDK/Common/Log.h>
+
+#include <boost/atomic.hpp>
+
+using namespace Elastos::ElaWallet;
+
+TEST_CASE("TimerWheel test", "[PeerReactor]") {
+	Log::registerMultiLogger();
+
+	TimerWheel wheel(1000.0, 0.5, 8);
+	std::vector<int> fired;
+
+	SECTION("callbacks fire once their tick has passed") {
+		wheel.Add(1001.2, [&fired]() { fired.push_back(1); });
+		wheel.Add(1000.1, [&fired]() { fired.push_back(0); });
+		wheel.Add(1003.0, [&fired]() { fired.push_back(2); });
+		REQUIRE(wheel.Size() == 3);
+
+		std::vector<TimerWheel::Callback> due = wheel.Advance(1000.4);
+		REQUIRE(due.empty());
+
+		due = wheel.Advance(1000.5);
+		REQUIRE(due.size() == 1);
+		due[0]();
+		REQUIRE(fired == std::vector<int>({0}));
+
+		due = wheel.Advance(1001.4);
+		REQUIRE(due.empty());
+		due = wheel.Advance(1001.5);
+		REQUIRE(due.size() == 1);
+
+		due = wheel.Advance(1003.0);
+		REQUIRE(due.size() == 1);
+		REQUIRE(wheel.Size() == 0);
+	}
+
+	SECTION("deadlines more than a turn away stay in their slot") {
+		// 8 slots of 0.5s, a turn is 4s
+		wheel.Add(1001.0, [&fired]() { fired.push_back(1); });
+		wheel.Add(1005.0, [&fired]() { fired.push_back(5); });
+		wheel.Add(1009.0, [&fired]() { fired.push_back(9); });
+
+		std::vector<TimerWheel::Callback> due = wheel.Advance(1001.0);
+		REQUIRE(due.size() == 1);
+		due = wheel.Advance(1004.9);
+		REQUIRE(due.empty());
+		due = wheel.Advance(1005.0);
+		REQUIRE(due.size() == 1);
+		due[0]();
+		REQUIRE(fired == std::vector<int>({5}));
+
+		// jumping several turns at once
+		due = wheel.Advance(1100.0);
+		REQUIRE(due.size() == 1);
+		REQUIRE(wheel.Size() == 0);
+	}
+
+	SECTION("past deadlines fire on the next tick") {
+		wheel.Advance(1002.0);
+		wheel.Add(900.0, [&fired]() { fired.push_back(0); });
+		REQUIRE(wheel.Advance(1002.2).empty());
+		REQUIRE(wheel.Advance(1002.5).size() == 1);
+	}
+}
+
+TEST_CASE("PeerReactor schedule test", "[PeerReactor]") {
+	Log::registerMultiLogger();
+
+	PeerReactor reactor(2);
+	boost::atomic<int> fired(0);
+	double start = PeerReactor::Now();
+
+	reactor.Schedule(start + 0.2, [&fired]() { fired++; });
+	reactor.Schedule(start, [&fired]() { fired++; });
+	reactor.Schedule(start + 60, [&fired]() { fired += 100; });
+
+	while (fired < 2 && PeerReactor::Now() < start + 5)
+		usleep(10000);
+
+	REQUIRE(fired == 2);
+	REQUIRE(PeerReactor::Now() - start >= 0.2);
+
+	boost::atomic<bool> posted(false);
+	reactor.Service().post([&posted]() { posted = true; });
+	while (!posted && PeerReactor::Now() < start + 5)
+		usleep(10000);
+	REQUIRE(posted);
+
+	reactor.Stop();
+	REQUIRE(fired == 2);
+}
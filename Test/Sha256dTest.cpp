@@ -0,0 +1,154 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Common/Sha256d.h>
+#include <SDK/Common/hash.h>
+#include <SDK/Common/Log.h>
+
+#include <chrono>
+#include <cstring>
+
+using namespace Elastos::ElaWallet;
+
+static const Sha256d::Kernel kernels[] = {Sha256d::KernelPortable, Sha256d::KernelAvx2, Sha256d::KernelShaNi};
+static const char *kernelNames[] = {"portable", "avx2", "sha-ni"};
+
+// FIPS 180-2 examples, message and SHA-256 digest
+static const char *nistVectors[][2] = {
+	{"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+	{"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+	{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+	 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+	{"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+	 "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+};
+
+TEST_CASE("Sha256d test", "[Sha256d]") {
+	Log::registerMultiLogger();
+
+	Sha256d::Kernel defaultKernel = Sha256d::GetKernel();
+	REQUIRE(Sha256d::Supported(defaultKernel));
+
+	// merkle pairs of every two NIST digests, 16 pairs fill two avx2 and eight sha-ni batches
+	const size_t vectorCount = sizeof(nistVectors) / sizeof(nistVectors[0]);
+	std::vector<uint256> nistDigests, nistPairs, scalar;
+	for (size_t v = 0; v < vectorCount; ++v) {
+		bytes_t message((const uint8_t *) nistVectors[v][0], strlen(nistVectors[v][0]));
+		bytes_t digest = sha256(message);
+		REQUIRE(digest.getHex() == nistVectors[v][1]);
+		nistDigests.push_back(uint256(digest));
+	}
+	for (size_t i = 0; i < vectorCount; ++i) {
+		for (size_t j = 0; j < vectorCount; ++j) {
+			nistPairs.push_back(nistDigests[i]);
+			nistPairs.push_back(nistDigests[j]);
+		}
+	}
+	REQUIRE(Sha256d::SetKernel(Sha256d::KernelPortable));
+	scalar.resize(nistPairs.size() / 2);
+	Sha256d::HashPairs(scalar.data(), nistPairs.data(), scalar.size());
+
+	for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+		if (!Sha256d::SetKernel(kernels[k])) {
+			WARN(kernelNames[k] << " kernel not supported");
+			continue;
+		}
+		INFO(kernelNames[k] << " kernel");
+
+		for (size_t v = 0; v < vectorCount; ++v) {
+			bytes_t message((const uint8_t *) nistVectors[v][0], strlen(nistVectors[v][0]));
+			uint256 twice = Sha256d::Hash(message);
+			REQUIRE(bytes_t(twice.begin(), twice.size()) == sha256(bytes_t(nistDigests[v].begin(), nistDigests[v].size())));
+		}
+
+		std::vector<uint256> nistNodes(scalar.size());
+		Sha256d::HashPairs(nistNodes.data(), nistPairs.data(), nistNodes.size());
+		for (size_t i = 0; i < nistNodes.size(); ++i) {
+			bytes_t pair(nistPairs[2 * i].begin(), nistPairs[2 * i].size());
+			pair += bytes_t(nistPairs[2 * i + 1].begin(), nistPairs[2 * i + 1].size());
+			REQUIRE(nistNodes[i] == scalar[i]);
+			REQUIRE(bytes_t(nistNodes[i].begin(), nistNodes[i].size()) == sha256(sha256(pair)));
+		}
+
+		uint256 md;
+		Sha256d::Hash(md, bytes_t());
+		REQUIRE(bytes_t(md.begin(), md.size()).getHex() ==
+				"5df6e0e2761359d30a8275058e299fcc0381534545f55cf43e41983f5d4c9456");
+		md = Sha256d::Hash(bytes_t("68656c6c6f"));
+		REQUIRE(bytes_t(md.begin(), md.size()).getHex() ==
+				"9595c9df90075148eb06860365df33584b75bff782a510c6cd4883a419833d50");
+
+		// lengths around the block and padding boundaries
+		for (size_t len = 0; len < 300; ++len) {
+			bytes_t data = getRandBytes(len);
+			Sha256d::Hash(md, data);
+			REQUIRE(bytes_t(md.begin(), md.size()) == sha256_2(data));
+		}
+
+		for (size_t count = 0; count < 20; ++count) {
+			std::vector<uint256> nodes, md(count);
+			for (size_t i = 0; i < 2 * count; ++i)
+				nodes.push_back(getRanduint256());
+
+			Sha256d::HashPairs(md.data(), nodes.data(), count);
+			for (size_t i = 0; i < count; ++i) {
+				bytes_t pair(nodes[2 * i].begin(), nodes[2 * i].size());
+				pair += bytes_t(nodes[2 * i + 1].begin(), nodes[2 * i + 1].size());
+				REQUIRE(bytes_t(md[i].begin(), md[i].size()) == sha256_2(pair));
+			}
+
+			// in place, a merkle row is hashed into the first half of itself
+			Sha256d::HashPairs(nodes.data(), nodes.data(), count);
+			for (size_t i = 0; i < count; ++i)
+				REQUIRE(nodes[i] == md[i]);
+		}
+	}
+
+	REQUIRE(Sha256d::SetKernel(defaultKernel));
+}
+
+TEST_CASE("Sha256d kernels benchmark", "[.benchmark][Sha256d]") {
+	const size_t count = 200000;
+	std::vector<uint256> nodes;
+	for (size_t i = 0; i < 2 * count; ++i)
+		nodes.push_back(getRanduint256());
+	std::vector<uint256> md(count);
+	bytes_t tx = getRandBytes(250);
+
+	Sha256d::Kernel defaultKernel = Sha256d::GetKernel();
+
+	for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+		if (!Sha256d::SetKernel(kernels[k]))
+			continue;
+
+		std::string name = std::string(kernelNames[k]) + ": " + std::to_string(count);
+		double seconds = 0;
+		BENCHMARK(name + " merkle nodes") {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			Sha256d::HashPairs(md.data(), nodes.data(), count);
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		WARN(name << " merkle nodes, " << (uint64_t) (count / seconds) << " hashes/s");
+
+		uint256 txHash;
+		BENCHMARK(name + " 250 byte transactions") {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < count; ++i)
+				Sha256d::Hash(txHash, tx);
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		WARN(name << " 250 byte transactions, " << (uint64_t) (count / seconds) << " hashes/s");
+	}
+
+	Sha256d::SetKernel(defaultKernel);
+
+	bytes_t pair(nodes[0].begin(), nodes[0].size());
+	pair += bytes_t(nodes[1].begin(), nodes[1].size());
+	REQUIRE(bytes_t(md[0].begin(), md[0].size()) == sha256_2(pair));
+}
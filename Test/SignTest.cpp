@@ -257,6 +257,67 @@ TEST_CASE("Sign transaction test", "[SignTransaction]") {
 
 			REQUIRE(tx->IsSigned());
 		}
+
+		SECTION("Batch sign test") {
+			std::vector<Address> addresses;
+			subAccount1->GetAllAddresses(addresses, 0, 100, false);
+			REQUIRE(addresses.size() >= 10);
+
+			// 10 programs in each of 4 txs, enough for the signatures to be spread over threads
+			std::vector<TransactionPtr> txns;
+			for (size_t t = 0; t < 4; ++t) {
+				TransactionPtr tx(new Transaction);
+				tx->FromJson(content);
+				for (size_t i = 0; i < 10; ++i) {
+					bytes_t redeemScript;
+					std::string path;
+					REQUIRE(subAccount1->GetCodeAndPath(addresses[i], redeemScript, path));
+					tx->AddProgram(ProgramPtr(new Program(path, redeemScript, bytes_t())));
+				}
+				txns.push_back(tx);
+			}
+
+			REQUIRE_NOTHROW(subAccount1->SignTransactions(txns, payPasswd));
+			for (size_t t = 0; t < txns.size(); ++t)
+				REQUIRE(txns[t]->IsSigned());
+			REQUIRE_THROWS(subAccount1->SignTransactions(txns, payPasswd));
+
+			// a tx of another account fails the whole batch before anything is signed
+			std::vector<TransactionPtr> mixed;
+			for (size_t t = 0; t < 2; ++t) {
+				TransactionPtr tx(new Transaction);
+				tx->FromJson(content);
+				bytes_t redeemScript;
+				std::string path;
+				SubAccountPtr owner = t == 0 ? subAccount1 : subAccount2;
+				owner->GetAllAddresses(addresses, 0, 1, false);
+				REQUIRE(owner->GetCodeAndPath(addresses[0], redeemScript, path));
+				tx->AddProgram(ProgramPtr(new Program(path, redeemScript, bytes_t())));
+				mixed.push_back(tx);
+			}
+
+			REQUIRE_THROWS(subAccount1->SignTransactions(mixed, payPasswd));
+			REQUIRE(mixed[0]->GetPrograms()[0]->GetParameter().empty());
+			REQUIRE(!mixed[0]->IsSigned());
+		}
+
+		SECTION("Signing session test") {
+			HDKeychain rootKey = account1->RootKey(payPasswd);
+			std::string paths[] = {"44'/0'/0'/0/0", "44'/0'/0'/0/1", "44'/0'/0'/1/0", "44'/0'/1'/0/0", "1'/0"};
+
+			SigningSession session(*account1, payPasswd);
+			REQUIRE(session.IsOpen());
+			for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
+				REQUIRE(session.Derive(paths[i]).pubkey() == rootKey.getChild(paths[i]).pubkey());
+				REQUIRE(session.Derive(paths[i]).pubkey() == rootKey.getChild(paths[i]).pubkey());
+			}
+
+			session.Close();
+			REQUIRE(!session.IsOpen());
+			REQUIRE_THROWS(session.Derive(paths[0]));
+
+			REQUIRE_THROWS(SigningSession(*account1, "87654321"));
+		}
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Plugin/Transaction/SignatureVerifier.h>
+#include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Plugin/Transaction/Program.h>
+#include <SDK/WalletCore/BIPs/Address.h>
+#include <SDK/WalletCore/BIPs/Key.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+static std::vector<Key> createKeys(size_t count) {
+	std::vector<Key> keys(count);
+	for (size_t i = 0; i < count; ++i)
+		keys[i].SetPrvKey(getRandBytes(32));
+	return keys;
+}
+
+static TransactionPtr createTx() {
+	TransactionPtr tx(new Transaction());
+	initTransaction(*tx, Transaction::TxVersion::Default);
+	tx->ClearPrograms();
+	return tx;
+}
+
+// the program of a standard address, or an m of n one, signed by signers in that order
+static ProgramPtr createProgram(const TransactionPtr &tx, const std::vector<Key> &keys, uint8_t m,
+								const std::vector<size_t> &signers) {
+	std::vector<bytes_t> pubKeys;
+	for (size_t i = 0; i < keys.size(); ++i)
+		pubKeys.push_back(keys[i].PubKey());
+
+	Address address = keys.size() == 1 ? Address(PrefixStandard, pubKeys[0]) : Address(PrefixMultiSign, pubKeys, m);
+	uint256 md = tx->GetShaData();
+	ByteStream stream;
+	for (size_t i = 0; i < signers.size(); ++i)
+		stream.WriteVarBytes(keys[signers[i]].Sign(md));
+
+	return ProgramPtr(new Program("", address.RedeemScript(), stream.GetBytes()));
+}
+
+TEST_CASE("SignatureVerifier test", "[SignatureVerifier]") {
+	Log::registerMultiLogger();
+
+	std::vector<Key> keys = createKeys(5);
+	std::vector<Key> single(1, keys[4]);
+	SignatureVerifier verifier;
+
+	SECTION("agrees with IsSigned") {
+		std::vector<TransactionPtr> txns;
+
+		TransactionPtr tx = createTx();
+		txns.push_back(tx);
+
+		tx = createTx();
+		tx->AddProgram(createProgram(tx, single, 1, {0}));
+		txns.push_back(tx);
+
+		// signers in any order
+		tx = createTx();
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 4), 3, {2, 0, 3}));
+		txns.push_back(tx);
+
+		tx = createTx();
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 4), 3, {3, 2, 1, 0}));
+		tx->AddProgram(createProgram(tx, single, 1, {0}));
+		txns.push_back(tx);
+
+		// not enough signers
+		tx = createTx();
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 4), 3, {1, 3}));
+		txns.push_back(tx);
+
+		// a signer out of the program
+		tx = createTx();
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 4), 2, {0, 1}));
+		ByteStream stream;
+		stream.WriteBytes(tx->GetPrograms()[0]->GetParameter());
+		stream.WriteVarBytes(keys[4].Sign(tx->GetShaData()));
+		tx->GetPrograms()[0]->SetParameter(stream.GetBytes());
+		txns.push_back(tx);
+
+		// a signature of another tx
+		tx = createTx();
+		tx->AddProgram(createProgram(txns[1], single, 1, {0}));
+		txns.push_back(tx);
+
+		// a good program next to a bad one
+		tx = createTx();
+		tx->AddProgram(createProgram(tx, single, 1, {0}));
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 2), 2, {1}));
+		txns.push_back(tx);
+
+		tx = createTx();
+		tx->SetTransactionType(Transaction::coinBase);
+		txns.push_back(tx);
+
+		bool expected[] = {false, true, true, true, false, false, false, false, true};
+		REQUIRE(txns.size() == sizeof(expected) / sizeof(expected[0]));
+
+		std::vector<bool> results;
+		verifier.Verify(txns, results);
+		REQUIRE(results.size() == txns.size());
+		for (size_t i = 0; i < txns.size(); ++i) {
+			INFO("tx " << i);
+			REQUIRE(txns[i]->IsSigned() == expected[i]);
+			REQUIRE(results[i] == expected[i]);
+			REQUIRE(verifier.Verify(txns[i]) == expected[i]);
+		}
+
+		REQUIRE(!verifier.Verify(nullptr));
+	}
+
+	SECTION("results follow the programs") {
+		TransactionPtr tx = createTx();
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 3), 2, {0}));
+		REQUIRE(!verifier.Verify(tx));
+
+		tx->ClearPrograms();
+		tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 3), 2, {0, 2}));
+		REQUIRE(verifier.Verify(tx));
+
+		bytes_t parameter = tx->GetPrograms()[0]->GetParameter();
+		parameter[parameter.size() - 1] ^= 1;
+		tx->GetPrograms()[0]->SetParameter(parameter);
+		REQUIRE(!tx->IsSigned());
+		REQUIRE(!verifier.Verify(tx));
+
+		verifier.Clear();
+		REQUIRE(!verifier.Verify(tx));
+	}
+
+	SECTION("batch of many programs") {
+		std::vector<TransactionPtr> txns;
+		std::vector<bool> expected, results;
+		for (size_t i = 0; i < 40; ++i) {
+			TransactionPtr tx = createTx();
+			tx->AddProgram(createProgram(tx, std::vector<Key>(keys.begin(), keys.begin() + 4), 3, {i % 4, (i + 1) % 4,
+																									(i + 2) % 4}));
+			if (i % 5 == 0)
+				tx->AddProgram(createProgram(txns.empty() ? tx : txns[0], single, 1, {0}));
+			txns.push_back(tx);
+			expected.push_back(i == 0 || i % 5 != 0);
+		}
+
+		verifier.Verify(txns, results);
+		REQUIRE(results == expected);
+		verifier.Verify(txns, results);
+		REQUIRE(results == expected);
+	}
+}
+
+TEST_CASE("SignatureVerifier benchmark", "[.benchmark][SignatureVerifier]") {
+	Log::registerMultiLogger();
+
+	std::vector<Key> keys = createKeys(5);
+	std::vector<TransactionPtr> txns;
+	for (size_t i = 0; i < 50; ++i) {
+		TransactionPtr tx = createTx();
+		tx->AddProgram(createProgram(tx, keys, 4, {4, 3, 2, 1}));
+		txns.push_back(tx);
+	}
+
+	size_t count = 0;
+	BENCHMARK("IsSigned, 50 4 of 5 txs") {
+		for (size_t i = 0; i < txns.size(); ++i)
+			count += txns[i]->IsSigned() ? 1 : 0;
+	}
+
+	BENCHMARK("SignatureVerifier, 50 4 of 5 txs") {
+		SignatureVerifier verifier;
+		for (size_t i = 0; i < txns.size(); ++i)
+			count += verifier.Verify(txns[i]) ? 1 : 0;
+	}
+
+	SignatureVerifier verifier;
+	std::vector<bool> results;
+	verifier.Verify(txns, results);
+	BENCHMARK("SignatureVerifier, 50 4 of 5 txs seen before") {
+		verifier.Verify(txns, results);
+	}
+
+	REQUIRE(count == 2 * txns.size());
+	REQUIRE(results == std::vector<bool>(txns.size(), true));
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+
+#include <SDK/Account/Account.h>
+#include <SDK/Account/SubAccount.h>
+#include <SDK/Common/Log.h>
+
+#include <boost/bind.hpp>
+
+using namespace Elastos::ElaWallet;
+
+static Address chainAddress(const AccountPtr &account, uint32_t chain, uint32_t index) {
+	return Address(PrefixStandard, account->MasterPubKey().getChild(chain).getChild(index).pubkey());
+}
+
+static void collect(std::vector<Address> *addrs, const Address &address) {
+	addrs->push_back(address);
+}
+
+TEST_CASE("SubAccount address derivation", "[SubAccount]") {
+	Log::registerMultiLogger();
+
+	std::string mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+	LocalStorePtr localstore(new LocalStore("./Data/subaccount", mnemonic, "", false, "12345678"));
+	AccountPtr account(new Account(localstore));
+	Lockable lock;
+
+	SECTION("chains match serial derivation") {
+		SubAccountPtr subAccount(new SubAccount(account, 0));
+		subAccount->Init({}, &lock);
+
+		std::vector<Address> addrs;
+		size_t total = subAccount->GetAllAddresses(addrs, 0, size_t(-1), true);
+		REQUIRE(total == SEQUENCE_GAP_LIMIT_EXTERNAL + 100 + SEQUENCE_GAP_LIMIT_INTERNAL + 100);
+		REQUIRE(addrs.size() == total);
+
+		for (uint32_t i = 0; i < SEQUENCE_GAP_LIMIT_EXTERNAL + 100; ++i)
+			REQUIRE(addrs[i] == chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, i));
+		for (uint32_t i = 0; i < SEQUENCE_GAP_LIMIT_INTERNAL + 100; ++i)
+			REQUIRE(addrs[SEQUENCE_GAP_LIMIT_EXTERNAL + 100 + i] == chainAddress(account, SEQUENCE_INTERNAL_CHAIN, i));
+
+		bytes_t code;
+		std::string path;
+		REQUIRE(subAccount->GetCodeAndPath(addrs[7], code, path));
+		REQUIRE(code == chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, 7).RedeemScript());
+		REQUIRE(path == "44'/0'/0'/0/7");
+		REQUIRE(subAccount->GetCodeAndPath(addrs[SEQUENCE_GAP_LIMIT_EXTERNAL + 100 + 3], code, path));
+		REQUIRE(code == chainAddress(account, SEQUENCE_INTERNAL_CHAIN, 3).RedeemScript());
+		REQUIRE(path == "44'/0'/0'/1/3");
+	}
+
+	SECTION("used addresses move the gap") {
+		// 105 is in the first batch of 110 and asks for a second one, which finds 150 and asks for a third
+		std::vector<Address> used;
+		used.push_back(chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, 3));
+		used.push_back(chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, 105));
+		used.push_back(chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, 150));
+
+		SubAccountPtr subAccount(new SubAccount(account, 0));
+		subAccount->InitUsedAddrs(used, &lock);
+
+		std::vector<Address> addrs = subAccount->UnusedAddresses(SEQUENCE_GAP_LIMIT_EXTERNAL, 0);
+		REQUIRE(addrs.size() == SEQUENCE_GAP_LIMIT_EXTERNAL);
+		for (uint32_t i = 0; i < SEQUENCE_GAP_LIMIT_EXTERNAL; ++i)
+			REQUIRE(addrs[i] == chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, 151 + i));
+
+		std::vector<Address> all;
+		REQUIRE(subAccount->GetAllAddresses(all, 0, size_t(-1), false) == 151 + SEQUENCE_GAP_LIMIT_EXTERNAL + 100);
+		REQUIRE(all.back() == chainAddress(account, SEQUENCE_EXTERNAL_CHAIN, 150 + SEQUENCE_GAP_LIMIT_EXTERNAL + 100));
+		REQUIRE(subAccount->ContainsAddress(all.back()));
+	}
+
+	SECTION("visitor sees what the vector gets") {
+		SubAccountPtr subAccount(new SubAccount(account, 0));
+		subAccount->Init({}, &lock);
+
+		std::vector<Address> expected, visited;
+		for (uint32_t start = 0; start < 250; start += 35) {
+			size_t total = subAccount->GetAllAddresses(expected, start, 40, true);
+			visited.clear();
+			REQUIRE(subAccount->GetAllAddresses(boost::bind(&collect, &visited, _1), start, 40, true) == total);
+			REQUIRE(visited == expected);
+		}
+	}
+}
+
+TEST_CASE("SubAccount derivation benchmark", "[.benchmark][SubAccount]") {
+	Log::registerMultiLogger();
+
+	std::string mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+	LocalStorePtr localstore(new LocalStore("./Data/subaccount", mnemonic, "", false, "12345678"));
+	AccountPtr account(new Account(localstore));
+	Lockable lock;
+
+	// what InitUsedAddrs derives for a new wallet
+	uint32_t external = SEQUENCE_GAP_LIMIT_EXTERNAL + 100, internal = SEQUENCE_GAP_LIMIT_INTERNAL + 100;
+	size_t count = 0;
+
+	BENCHMARK("serial, mpk.getChild(chain).getChild(i)") {
+		HDKeychain mpk = account->MasterPubKey();
+		for (uint32_t i = 0; i < external; ++i)
+			count += Address(PrefixStandard, mpk.getChild(SEQUENCE_EXTERNAL_CHAIN).getChild(i).pubkey()).Valid() ? 1 : 0;
+		for (uint32_t i = 0; i < internal; ++i)
+			count += Address(PrefixStandard, mpk.getChild(SEQUENCE_INTERNAL_CHAIN).getChild(i).pubkey()).Valid() ? 1 : 0;
+	}
+
+	BENCHMARK("SubAccount::InitUsedAddrs") {
+		SubAccountPtr subAccount(new SubAccount(account, 0));
+		subAccount->InitUsedAddrs({}, &lock);
+		count += subAccount->GetAllAddresses(boost::bind(&collect, (std::vector<Address> *) nullptr, _1), 0, 0, true);
+	}
+
+	Key::SetBackend(Key::BackendNative);
+	BENCHMARK("SubAccount::InitUsedAddrs, native backend") {
+		SubAccountPtr subAccount(new SubAccount(account, 0));
+		subAccount->InitUsedAddrs({}, &lock);
+		count += subAccount->GetAllAddresses(boost::bind(&collect, (std::vector<Address> *) nullptr, _1), 0, 0, true);
+	}
+	Key::SetBackend(Key::BackendOpenSSL);
+
+	REQUIRE(count == 3 * (external + internal));
+}
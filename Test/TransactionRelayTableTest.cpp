@@ -0,0 +1,111 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/P2P/TransactionRelayTable.h>
+#include <SDK/Common/Log.h>
+
+using namespace Elastos::ElaWallet;
+
+// the table only tells peers apart, it never touches them
+static PeerPtr fakePeer() {
+	return PeerPtr((Peer *) new char, [](Peer *p) { delete (char *) p; });
+}
+
+TEST_CASE("TransactionRelayTable test", "[TransactionRelayTable]") {
+	Log::registerMultiLogger();
+
+	TransactionRelayTable table;
+	PeerPtr p1 = fakePeer(), p2 = fakePeer(), p3 = fakePeer();
+	uint256 tx1 = getRanduint256(), tx2 = getRanduint256();
+
+	REQUIRE(table.Add(p1, tx1) == 1);
+	REQUIRE(table.Add(p2, tx1) == 2);
+	REQUIRE(table.Add(p1, tx1) == 2);
+	REQUIRE(table.Add(p3, tx2) == 1);
+
+	SECTION("count and contains") {
+		REQUIRE(table.Size() == 2);
+		REQUIRE(table.Count(tx1) == 2);
+		REQUIRE(table.Count(tx2) == 1);
+		REQUIRE(table.Count(getRanduint256()) == 0);
+		REQUIRE(table.Contains(tx1, p1));
+		REQUIRE(table.Contains(tx1, p2));
+		REQUIRE(!table.Contains(tx1, p3));
+		REQUIRE(!table.Contains(tx2, fakePeer()));
+	}
+
+	SECTION("remove") {
+		REQUIRE(table.Remove(p1, tx1));
+		REQUIRE(!table.Remove(p1, tx1));
+		REQUIRE(!table.Remove(p3, tx1));
+		REQUIRE(table.Count(tx1) == 1);
+
+		REQUIRE(table.Remove(p2, tx1));
+		REQUIRE(table.Count(tx1) == 0);
+		REQUIRE(table.Size() == 1);
+	}
+
+	SECTION("removed peers give their slot back") {
+		table.RemovePeer(p1);
+		REQUIRE(table.Count(tx1) == 1);
+		REQUIRE(!table.Contains(tx1, p1));
+
+		// the new peer gets p1's slot and doesn't inherit what p1 had
+		PeerPtr p4 = fakePeer();
+		REQUIRE(table.Add(p4, tx2) == 2);
+		REQUIRE(!table.Contains(tx1, p4));
+
+		table.RemovePeer(p3);
+		table.RemovePeer(p4);
+		REQUIRE(table.Size() == 1);
+	}
+
+	SECTION("peers beyond the slots are not counted") {
+		std::vector<PeerPtr> peers;
+		for (size_t i = 0; i < TX_RELAY_MAX_PEERS; ++i)
+			peers.push_back(fakePeer());
+
+		// p1 and p2 hold a slot without having tx2
+		for (size_t i = 0; i < peers.size(); ++i)
+			table.Add(peers[i], tx2);
+		REQUIRE(table.Count(tx2) == TX_RELAY_MAX_PEERS - 2);
+		REQUIRE(table.Contains(tx2, p3));
+		REQUIRE(!table.Contains(tx2, peers.back()));
+
+		// nor does a tx only they relayed leave an empty entry behind
+		size_t size = table.Size();
+		uint256 tx3 = getRanduint256();
+		REQUIRE(table.Add(peers.back(), tx3) == 0);
+		REQUIRE(table.Size() == size);
+
+		table.RemovePeer(p1);
+		REQUIRE(table.Add(peers.back(), tx2) == TX_RELAY_MAX_PEERS - 1);
+		REQUIRE(table.Contains(tx2, peers.back()));
+	}
+
+	SECTION("erase") {
+		// a confirmed tx goes whoever relayed it
+		REQUIRE(table.Erase(tx1));
+		REQUIRE(!table.Erase(tx1));
+		REQUIRE(table.Count(tx1) == 0);
+		REQUIRE(!table.Contains(tx1, p1));
+		REQUIRE(table.Count(tx2) == 1);
+		REQUIRE(table.Size() == 1);
+
+		// the peers keep their slots
+		REQUIRE(table.Add(p2, tx2) == 2);
+	}
+
+	SECTION("clear") {
+		table.Clear();
+		REQUIRE(table.Size() == 0);
+		REQUIRE(!table.Contains(tx1, p1));
+		REQUIRE(table.Add(p2, tx1) == 1);
+	}
+}
@@ -42,6 +42,27 @@ TEST_CASE("Transaction Serialize and Deserialize", "[Transaction]") {
 		verifyTransaction(tx1, tx2, true);
 	}
 
+	SECTION("output amount out of range") {
+		// a non ELA asset, its amount is var bytes
+		ByteStream stream;
+		stream.WriteBytes(getRanduint256());
+		stream.WriteVarBytes(bytes_t("0100000000000000000000000000000000"));
+		stream.WriteUint32(0);
+		stream.WriteBytes(uint168());
+
+		TransactionOutput output;
+		REQUIRE(!output.Deserialize(stream, Transaction::TxVersion::Default));
+
+		// the largest amount a token can be registered with still reads
+		stream.Reset();
+		stream.WriteBytes(getRanduint256());
+		stream.WriteVarBytes(bytes_t("ffffffffffffffff"));
+		stream.WriteUint32(0);
+		stream.WriteBytes(uint168());
+		REQUIRE(output.Deserialize(stream, Transaction::TxVersion::Default));
+		REQUIRE(output.Amount() == Int128(uint64_t(-1)));
+	}
+
 }
 
 TEST_CASE("Convert to and from json", "[Transaction]") {
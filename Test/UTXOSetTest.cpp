@@ -0,0 +1,119 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Wallet/UTXOSet.h>
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
+
+using namespace Elastos::ElaWallet;
+
+static UTXOPtr createUTXO(const uint256 &hash, uint16_t n) {
+	OutputPtr output(new TransactionOutput());
+	output->SetAmount(getRandUInt64());
+	return UTXOPtr(new UTXO(hash, n, time(nullptr), getRandUInt16(), output));
+}
+
+TEST_CASE("UTXOSet test", "[UTXOSet]") {
+	srand(time(nullptr));
+
+	UTXOSet set;
+	std::vector<UTXOPtr> utxos;
+	for (size_t i = 0; i < 100; ++i) {
+		uint256 hash = getRanduint256();
+		for (uint16_t n = 0; n < 5; ++n) {
+			UTXOPtr u = createUTXO(hash, n);
+			utxos.push_back(u);
+			REQUIRE(set.Add(u, UTXOSet::Category(n)));
+		}
+	}
+
+	SECTION("add, get and contains") {
+		REQUIRE(set.Size() == utxos.size());
+		for (size_t c = 0; c < UTXOSet::CategoryCount; ++c)
+			REQUIRE(set.Size(UTXOSet::Category(c)) == utxos.size() / 5);
+
+		REQUIRE(!set.Add(createUTXO(utxos[0]->Hash(), utxos[0]->Index()), UTXOSet::Normal));
+		REQUIRE(set.Size() == utxos.size());
+
+		UTXOSet::Category category;
+		for (size_t i = 0; i < utxos.size(); ++i) {
+			REQUIRE(set.Contains(utxos[i]->Hash(), utxos[i]->Index()));
+			REQUIRE(set.Get(utxos[i]->Hash(), utxos[i]->Index(), category) == utxos[i]);
+			REQUIRE(category == UTXOSet::Category(utxos[i]->Index()));
+		}
+
+		REQUIRE(!set.Contains(utxos[0]->Hash(), 5));
+		REQUIRE(set.Get(getRanduint256(), 0) == nullptr);
+	}
+
+	SECTION("category order, remove and set category") {
+		UTXOArray vote = set.GetUTXOs(UTXOSet::Vote);
+		REQUIRE(vote.size() == utxos.size() / 5);
+		for (size_t i = 0; i < vote.size(); ++i)
+			REQUIRE(vote[i] == utxos[i * 5 + 1]);
+
+		UTXOSet::Category category;
+		REQUIRE(set.Remove(utxos[1]->Hash(), utxos[1]->Index(), category) == utxos[1]);
+		REQUIRE(category == UTXOSet::Vote);
+		REQUIRE(set.Remove(utxos[1]->Hash(), utxos[1]->Index(), category) == nullptr);
+		REQUIRE(set.Size(UTXOSet::Vote) == utxos.size() / 5 - 1);
+		REQUIRE(set.GetUTXOs(UTXOSet::Vote)[0] == utxos[6]);
+
+		REQUIRE(set.SetCategory(utxos[4]->Hash(), utxos[4]->Index(), UTXOSet::Coinbase));
+		REQUIRE(set.Size(UTXOSet::Locked) == utxos.size() / 5 - 1);
+		REQUIRE(set.Size(UTXOSet::Coinbase) == utxos.size() / 5 + 1);
+		REQUIRE(set.Get(utxos[4]->Hash(), utxos[4]->Index(), category) == utxos[4]);
+		REQUIRE(category == UTXOSet::Coinbase);
+
+		UTXOSet copy(set);
+		REQUIRE(copy.Size() == set.Size());
+		REQUIRE(copy.GetUTXOs(UTXOSet::Coinbase) == set.GetUTXOs(UTXOSet::Coinbase));
+		copy.Clear();
+		REQUIRE(copy.Size() == 0);
+		REQUIRE(set.Size() == utxos.size() - 1);
+	}
+
+	SECTION("amount and height order") {
+		UTXOArray byAmount = set.GetUTXOs(UTXOSet::Normal, UTXOSet::AmountDescending);
+		UTXOArray byHeight = set.GetUTXOs(UTXOSet::Normal, UTXOSet::HeightAscending);
+		REQUIRE(byAmount.size() == set.Size(UTXOSet::Normal));
+		REQUIRE(byHeight.size() == set.Size(UTXOSet::Normal));
+		for (size_t i = 1; i < byAmount.size(); ++i) {
+			REQUIRE(byAmount[i - 1]->Output()->Amount() >= byAmount[i]->Output()->Amount());
+			REQUIRE(byHeight[i - 1]->BlockHeight() <= byHeight[i]->BlockHeight());
+		}
+
+		UTXOSet::Category category;
+		UTXOPtr largest = byAmount.front();
+		set.Remove(largest->Hash(), largest->Index(), category);
+		REQUIRE(set.GetUTXOs(UTXOSet::Normal, UTXOSet::AmountDescending).front() == byAmount[1]);
+
+		set.SetCategory(byAmount[1]->Hash(), byAmount[1]->Index(), UTXOSet::Coinbase);
+		REQUIRE(set.GetUTXOs(UTXOSet::Normal, UTXOSet::AmountDescending).front() == byAmount[2]);
+		REQUIRE(set.GetUTXOs(UTXOSet::Coinbase, UTXOSet::AmountDescending).size() == utxos.size() / 5 + 1);
+	}
+
+	SECTION("block height changed after add") {
+		UTXOArray byHeight = set.GetUTXOs(UTXOSet::Normal, UTXOSet::HeightAscending);
+		UTXOPtr first = byHeight.front();
+		first->SetBlockHeight(byHeight.back()->BlockHeight() + 1);
+
+		// the order is the one of the heights at add time until it is updated
+		REQUIRE(set.GetUTXOs(UTXOSet::Normal, UTXOSet::HeightAscending) == byHeight);
+		REQUIRE(set.UpdateHeight(first->Hash(), first->Index()));
+		REQUIRE(!set.UpdateHeight(getRanduint256(), 0));
+		REQUIRE(set.GetUTXOs(UTXOSet::Normal, UTXOSet::HeightAscending).back() == first);
+		REQUIRE(set.GetUTXOs(UTXOSet::Normal, UTXOSet::HeightAscending).size() == byHeight.size());
+
+		UTXOSet::Category category;
+		for (size_t i = 0; i < byHeight.size(); ++i)
+			REQUIRE(set.Remove(byHeight[i]->Hash(), byHeight[i]->Index(), category) == byHeight[i]);
+		REQUIRE(set.Size(UTXOSet::Normal) == 0);
+		REQUIRE(set.GetUTXOs(UTXOSet::Normal, UTXOSet::HeightAscending).empty());
+	}
+}
@@ -0,0 +1,251 @@
+// Copyright (c) 2012-2018 The Elastos Open Source Project
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+#include "TestHelper.h"
+
+#include <SDK/Account/Account.h>
+#include <SDK/Account/SubAccount.h>
+#include <SDK/Common/Log.h>
+#include <SDK/Database/DatabaseManager.h>
+#include <SDK/Plugin/Transaction/Transaction.h>
+#include <SDK/Plugin/Transaction/TransactionInput.h>
+#include <SDK/Plugin/Transaction/TransactionOutput.h>
+#include <SDK/Wallet/Wallet.h>
+
+#include <boost/filesystem.hpp>
+
+using namespace Elastos::ElaWallet;
+
+#define ISO "ela1"
+
+class DatabaseHistoryLoader : public Wallet::HistoryLoader {
+public:
+	DatabaseHistoryLoader(DatabaseManager &dbm) : _dbm(dbm), loaded(0), fromSnapshot(false) {}
+
+	virtual std::vector<uint168> loadUsedProgramHashes() {
+		return _dbm.GetOutputProgramHashes();
+	}
+
+	virtual UTXOKeySet loadUnspentOutputs(const SubAccountPtr &subAccount) {
+		std::vector<OutputEntity> outputs = _dbm.GetUnspentOutputs();
+		UTXOKeySet unspent;
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			if (subAccount->ContainsAddress(Address(outputs[i].programHash)))
+				unspent.insert(UTXOKey(outputs[i].txHash, outputs[i].index));
+		}
+		return unspent;
+	}
+
+	virtual std::vector<TransactionPtr> loadTransactions(uint32_t blockHeight, const UTXOKeySet &unspent) {
+		std::vector<TransactionPtr> txns = _dbm.GetTransactionsFrom(0), result;
+		for (size_t i = 0; i < txns.size(); ++i) {
+			bool hasUnspent = false;
+			for (size_t j = 0; j < txns[i]->GetOutputs().size(); ++j)
+				hasUnspent |= unspent.count(UTXOKey(txns[i]->GetHash(), txns[i]->GetOutputs()[j]->FixedIndex())) > 0;
+			if (hasUnspent || txns[i]->GetBlockHeight() >= blockHeight)
+				result.push_back(txns[i]);
+		}
+		loaded = result.size();
+		return result;
+	}
+
+	virtual std::vector<TransactionPtr> loadAllTransactions() {
+		return _dbm.GetTransactionsFrom(0);
+	}
+
+	virtual TransactionPtr loadTransaction(const uint256 &hash) {
+		return _dbm.GetTransaction(hash);
+	}
+
+	virtual bool loadSnapshot(UTXOArray &utxos, uint32_t &blockHeight) {
+		UTXOSnapshot snapshot;
+		fromSnapshot = _dbm.GetUTXOSnapshot(snapshot) &&
+					   _dbm.GetConfirmedTransactionsCount(snapshot.blockHeight) == snapshot.txCount;
+		if (fromSnapshot) {
+			utxos = snapshot.utxos;
+			blockHeight = snapshot.blockHeight;
+		}
+		return fromSnapshot;
+	}
+
+private:
+	DatabaseManager &_dbm;
+
+public:
+	size_t loaded;
+	bool fromSnapshot;
+};
+
+static TransactionPtr createTx(const std::vector<InputPtr> &inputs, const std::vector<OutputPtr> &outputs,
+							   uint32_t blockHeight) {
+	TransactionPtr tx(new Transaction());
+
+	for (size_t i = 0; i < inputs.size(); ++i)
+		tx->AddInput(inputs[i]);
+	for (size_t i = 0; i < outputs.size(); ++i)
+		tx->AddOutput(outputs[i]);
+	tx->FixIndex();
+	tx->SetBlockHeight(blockHeight);
+	tx->SetTimestamp(blockHeight);
+
+	return tx;
+}
+
+static InputPtr spend(const TransactionPtr &tx, uint16_t n) {
+	InputPtr input(new TransactionInput());
+	input->SetTxHash(tx ? tx->GetHash() : getRanduint256());
+	input->SetIndex(n);
+	return input;
+}
+
+TEST_CASE("Wallet lazy history test", "[Wallet]") {
+	Log::registerMultiLogger();
+	std::string dbFile = "wallet_lazy.db";
+	if (boost::filesystem::exists(dbFile))
+		boost::filesystem::remove(dbFile);
+
+	std::string mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+	LocalStorePtr localstore(new LocalStore("./Data/lazy", mnemonic, "", false, "12345678"));
+	AccountPtr account(new Account(localstore));
+	SubAccountPtr subAccount(new SubAccount(account, 0));
+	Lockable lock;
+	subAccount->Init({}, &lock);
+
+	std::vector<Address> addrs = subAccount->UnusedAddresses(2, 0);
+	Address foreign("EHNyVMorACaza9SThNN27CcZND2Vfkuok2");
+
+	// received 100, sent 30 with 60 back as change, received 50 and sent all of it, 7 unconfirmed on the way
+	std::vector<TransactionPtr> txns;
+	txns.push_back(createTx({spend(nullptr, 0)}, {OutputPtr(new TransactionOutput(100, addrs[0]))}, 10));
+	txns.push_back(createTx({spend(txns[0], 0)}, {OutputPtr(new TransactionOutput(30, foreign)),
+												  OutputPtr(new TransactionOutput(60, addrs[1]))}, 20));
+	txns.push_back(createTx({spend(nullptr, 1)}, {OutputPtr(new TransactionOutput(50, addrs[0]))}, 30));
+	txns.push_back(createTx({spend(txns[2], 0)}, {OutputPtr(new TransactionOutput(50, foreign))}, 40));
+	txns.push_back(createTx({spend(nullptr, 2)}, {OutputPtr(new TransactionOutput(7, addrs[0]))}, TX_UNCONFIRMED));
+
+	boost::shared_ptr<Wallet::Listener> listener;
+	Wallet eager(10000, "eager", {}, txns, {}, subAccount, listener);
+	REQUIRE(eager.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) == 60);
+
+	DatabaseManager dbm(dbFile);
+	REQUIRE(dbm.PutTransactions(ISO, txns));
+
+	SECTION("only active transactions are loaded") {
+		DatabaseHistoryLoader loader(dbm);
+		SubAccountPtr lazyAccount(new SubAccount(account, 0));
+		Wallet lazy(10000, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+
+		// the one with the change and the unconfirmed one
+		REQUIRE(loader.loaded == 2);
+		REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) == 60);
+		REQUIRE(lazy.GetAllUTXO("").size() == 1);
+
+		// older history is read on demand
+		TransactionPtr tx = lazy.TransactionForHash(txns[0]->GetHash());
+		REQUIRE(tx != nullptr);
+		REQUIRE(tx->GetHash() == txns[0]->GetHash());
+		REQUIRE(lazy.TransactionForHash(getRanduint256()) == nullptr);
+		REQUIRE(lazy.AmountSentByTx(txns[1]) == 100);
+		REQUIRE(lazy.AmountSentByTx(txns[3]) == 50);
+		REQUIRE(lazy.GetAllTransactions().size() == txns.size());
+	}
+
+	SECTION("walks below the recent blocks read the store") {
+		DatabaseHistoryLoader loader(dbm);
+		SubAccountPtr lazyAccount(new SubAccount(account, 0));
+		Wallet lazy(10000, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+		REQUIRE(loader.loaded == 2);
+
+		std::vector<TransactionPtr> before = lazy.TxUnconfirmedBefore(15);
+		REQUIRE(before.size() == 4);
+		for (size_t i = 0; i < before.size(); ++i)
+			REQUIRE(before[i]->GetHash() == txns[i + 1]->GetHash());
+
+		// a reorg back to block 25 unconfirms the two stored only transactions as well
+		eager.SetTxUnconfirmedAfter(25);
+		lazy.SetTxUnconfirmedAfter(25);
+		std::vector<TransactionPtr> unconfirmed = lazy.TxUnconfirmedBefore(TX_UNCONFIRMED);
+		REQUIRE(unconfirmed.size() == eager.TxUnconfirmedBefore(TX_UNCONFIRMED).size());
+		REQUIRE(unconfirmed.size() == 3);
+		REQUIRE(lazy.TransactionForHash(txns[3]->GetHash())->GetBlockHeight() == TX_UNCONFIRMED);
+		REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) ==
+				eager.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total));
+	}
+
+	SECTION("removing old history removes its stored dependents") {
+		DatabaseHistoryLoader loader(dbm);
+		SubAccountPtr lazyAccount(new SubAccount(account, 0));
+		Wallet lazy(10000, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+
+		eager.RemoveTransaction(txns[2]->GetHash());
+		lazy.RemoveTransaction(txns[2]->GetHash());
+		REQUIRE(eager.TxUnconfirmedBefore(30).size() == 1);
+		REQUIRE(lazy.TxUnconfirmedBefore(30).size() == 1);
+		REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) ==
+				eager.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total));
+	}
+
+	SECTION("recent blocks are loaded") {
+		DatabaseHistoryLoader loader(dbm);
+		SubAccountPtr lazyAccount(new SubAccount(account, 0));
+		Wallet lazy(35 + TX_RECENT_BLOCKS, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+
+		REQUIRE(loader.loaded == 3);
+		REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) == 60);
+	}
+
+	SECTION("start from snapshot") {
+		UTXOSnapshot snapshot;
+		snapshot.blockHeight = 40;
+		snapshot.utxos = eager.GetSnapshotUTXOs();
+		REQUIRE(snapshot.utxos.size() == 1);
+		REQUIRE(dbm.PutUTXOSnapshot(snapshot));
+
+		DatabaseHistoryLoader loader(dbm);
+		SubAccountPtr lazyAccount(new SubAccount(account, 0));
+		Wallet lazy(10000, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+
+		// only the block of the snapshot and the unconfirmed one are read
+		REQUIRE(loader.fromSnapshot);
+		REQUIRE(loader.loaded == 2);
+		REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) == 60);
+		REQUIRE(lazy.GetAllUTXO("").size() == 1);
+		REQUIRE(lazy.AmountSentByTx(txns[3]) == 50);
+	}
+
+	SECTION("replay after snapshot") {
+		Wallet older(20, "older", {}, {txns[0], txns[1]}, {}, subAccount, listener);
+		UTXOSnapshot snapshot;
+		snapshot.blockHeight = 20;
+		snapshot.utxos = older.GetSnapshotUTXOs();
+		REQUIRE(dbm.PutUTXOSnapshot(snapshot));
+
+		{
+			DatabaseHistoryLoader loader(dbm);
+			SubAccountPtr lazyAccount(new SubAccount(account, 0));
+			Wallet lazy(10000, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+
+			REQUIRE(loader.fromSnapshot);
+			REQUIRE(loader.loaded == 4);
+			REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) == 60);
+		}
+
+		// history below the snapshot changed, it is rebuilt instead
+		TransactionPtr late = createTx({spend(nullptr, 3)}, {OutputPtr(new TransactionOutput(5, addrs[0]))}, 15);
+		REQUIRE(dbm.PutTransaction(ISO, late));
+		{
+			DatabaseHistoryLoader loader(dbm);
+			SubAccountPtr lazyAccount(new SubAccount(account, 0));
+			Wallet lazy(10000, "lazy", {}, {}, {}, lazyAccount, listener, &loader);
+
+			REQUIRE(!loader.fromSnapshot);
+			REQUIRE(lazy.GetBalance(Asset::GetELAAssetID(), GroupedAsset::Total) == 65);
+		}
+	}
+
+	boost::filesystem::remove(dbFile);
+}